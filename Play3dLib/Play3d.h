@@ -26,6 +26,13 @@
 #include <algorithm>
 #include <functional>
 #include <atomic>
+#include <thread>
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <chrono>
 #include <filesystem>
 #include <windows.h>
 #include <wincodec.h>
@@ -1356,6 +1363,8 @@ namespace Play3d
 	};
 
 	void ComputeBoundsFromPositions(const Vector3f* pPositions, size_t numElements, AABBMinMax& rBoundsOut);
+	void ComputeBoundsFromQuantisedPositions(const u16* pPositions, size_t numElements, const Vector3f& scale,
+											 const Vector3f& offset, AABBMinMax& rBoundsOut);
 
 	inline AABBHalfSize ConvertBounds(const AABBMinMax& in)
 	{
@@ -1545,13 +1554,56 @@ namespace Play3d::Resources
 		return ResourceManager<T>::Instance().Create(args...);
 	}
 
+	//! @brief A batch of loads run on the background loading threads.
+	//! Each load reads and decodes on a loading thread, then creates its resources on the thread that calls
+	//! UpdateAsyncLoading, which System::BeginFrame does every frame.
 	class AsyncLoadingTask
 	{
+	public:
+		u32 GetLoadCount() const { return m_loadCount; }
+		u32 GetFinishedCount() const { return m_finishedCount; }
+		bool IsFinished() const { return m_finishedCount == m_loadCount; }
+
+	private:
+		friend class AsyncLoader_Impl;
+		u32 m_loadCount = 0;
+		u32 m_finishedCount = 0;
 	};
 
-	IdKey<AsyncLoadingTask> AsyncLoadAssets(std::string_view pathToAssetPack);
+	using AsyncLoadingTaskId = IdKey<AsyncLoadingTask>;
+
+	//! @brief Creates an empty task to add loads to.
+	AsyncLoadingTaskId CreateAsyncLoadingTask();
+
+	//! @brief Adds a load to a task, it starts on a loading thread straight away.
+	//! @param work : runs on a loading thread. It may read files and decode but must not create resources.
+	//! @param finish : runs on the owning thread once work is done, loads finish in the order their work completes.
+	void AddAsyncLoad(AsyncLoadingTaskId hAsyncLoad, std::function<void()> work, std::function<void()> finish);
+
+	//! @brief Adds a load that only reads a file, the IO threads read it so no loading thread waits on the disk.
+	//! @param finish : runs on the owning thread with the file data, null if the read failed.
+	//! Release the data with System::ReleaseFileData.
+	void AddAsyncRead(AsyncLoadingTaskId hAsyncLoad,
+					  std::string_view filePath,
+					  std::function<void(const void* pData, size_t sizeBytes)> finish);
+
+	//! @brief Runs the finish steps of completed loads on the calling thread.
+	//! @param budgetSeconds : stops once this much time is spent, at least one load finishes per call.
+	void UpdateAsyncLoading(f64 budgetSeconds = 0.008);
+
+	//! @brief Blocks until every load of the task has finished, running finish steps meanwhile.
+	void WaitForAssets(AsyncLoadingTaskId hAsyncLoad);
 
-	bool AssetsLoaded(IdKey<AsyncLoadingTask> hAsyncLoad);
+	//! @brief Returns the fraction of the task's loads that have finished, 1 for an empty task.
+	f32 GetAsyncLoadingProgress(AsyncLoadingTaskId hAsyncLoad);
+
+	//! @brief Destroys a task once all of its loads have finished. Its id may then be reused by a new task.
+	void ReleaseAsyncLoadingTask(AsyncLoadingTaskId hAsyncLoad);
+
+	//! @brief Maps and indexes an asset pack on a loading thread, see System::AddPackFile.
+	AsyncLoadingTaskId AsyncLoadAssets(std::string_view pathToAssetPack);
+
+	bool AssetsLoaded(AsyncLoadingTaskId hAsyncLoad);
 
 	result_t LoadAssets(std::string_view pathToAssetPack);
 }
@@ -1665,6 +1717,8 @@ namespace Play3d::Audio
 namespace Play3d::Audio
 {
 	SoundId LoadSoundFromFile(const char* filePath, bool bEnableLooping = false);
+	//! @brief Reads the file on a loading thread, pSoundOut is written when the load finishes and must stay valid until then.
+	void AsyncLoadSoundFromFile(Resources::AsyncLoadingTaskId hAsyncLoad, SoundId* pSoundOut, const char* filePath, bool bEnableLooping = false);
 	VoiceId PlaySound(SoundId soundId, f32 fGain = 1.0f, f32 fPan = 0.5f);
 	void StopSound(VoiceId voiceId);
 
@@ -1971,6 +2025,17 @@ namespace Play3d::Graphics
 			return *this;
 		}
 
+		template <typename T>
+		BufferDesc& SetImmutableStructuredBuffer(u32 itemCount, const T* pItems)
+		{
+			m_sizeBytes = sizeof(T) * itemCount;
+			m_pInitialData = pItems;
+			m_bindFlags = BufferBindFlags::SRV;
+			m_flags = Graphics::BufferFlags::IMMUTABLE | Graphics::BufferFlags::STRUCTURED;
+			m_structureStrideBytes = sizeof(T);
+			return *this;
+		}
+
 		template <typename T>
 		BufferDesc& SetStructuredBuffer(u32 itemCount, const T* pItems = nullptr)
 		{
@@ -2065,6 +2130,13 @@ namespace Play3d::Graphics
 		//! @brief Helper to construct a StreamInfo from a vector of T
 		template <typename T>
 		static StreamInfo Create(StreamType type, const std::vector<T>& buffer)
+		{
+			return Create(type, std::span<const T>(buffer));
+		}
+
+		//! @brief Helper to construct a StreamInfo from a span of T, e.g. a ChunkFileReader::View
+		template <typename T>
+		static StreamInfo Create(StreamType type, std::span<const T> buffer)
 		{
 			StreamInfo info;
 			info.m_type = type;
@@ -2112,6 +2184,13 @@ namespace Play3d::Graphics
 		u32 m_vertexCount = 0;
 
 		MeshTopology m_topology = MeshTopology::TRI_LIST;
+
+		//! Compact meshes have u16 x4 unorm positions, s16 x2 octahedral normals and f16 x2 uvs.
+		//! A colour stream of a single element is used for every vertex.
+		//! Positions decode to position * m_positionScale + m_positionOffset, and must be drawn with COMPACT_MESH_LAYOUT materials.
+		bool m_bCompactVertices = false;
+		Vector3f m_positionScale = Vector3f(1, 1, 1);
+		Vector3f m_positionOffset = Vector3f(0, 0, 0);
 	};
 
 	//! @brief A Mesh resource.
@@ -2141,6 +2220,7 @@ namespace Play3d::Graphics
 		u32 GetMaterialCount() const { return (u32)m_materialInfos.size(); }
 
 		u32 GetStreamCount() const { return (u32) m_streamBufferIds.size();};
+		bool HasCompactVertices() const { return m_bCompactVertices; }
 		Graphics::BufferId GetMeshStreamBufferId(u32 index) const;
 		Graphics::BufferId GetIndexBufferId() const;
 		Play3d::Graphics::BufferId GetMeshStreamBufferIdByStreamType(StreamType type);
@@ -2167,6 +2247,9 @@ namespace Play3d::Graphics
 		D3D11_PRIMITIVE_TOPOLOGY m_topology;
 
 		bool m_bIsSkinnedMesh;
+		bool m_bCompactVertices;
+		Vector3f m_positionScale;
+		Vector3f m_positionOffset;
 	};
 }
 
@@ -2351,6 +2434,10 @@ namespace Play3d::Graphics
 		BC3,
 		BC1_SRGB,
 		BC3_SRGB,
+		BC4,
+		BC5,
+		BC7,
+		BC7_SRGB,
 	};
 
 	namespace TextureFlags
@@ -2411,6 +2498,9 @@ namespace Play3d::Graphics
 		ID3D11RenderTargetView* GetRTV(u16 mipLevel, u16 slice);
 		ID3D11DepthStencilView* GetDSV(u16 mipLevel, u16 slice);
 
+		//! Swaps in a texture holding more or fewer top mips, see Graphics::ResizeTextureMips.
+		result_t ResizeMips(const TextureDesc& rDesc);
+
 	private:
 		ComPtr<ID3D11Texture2D> m_pTexture;
 
@@ -2495,7 +2585,10 @@ namespace Play3d::Graphics
 		Int2,
 		Int3,
 		Int4,
-		ColourRGBA_8Bit
+		ColourRGBA_8Bit,
+		UNorm4_16Bit,
+		SNorm2_16Bit,
+		Half2
 	};
 
 	namespace InputElementFlags
@@ -2643,6 +2736,7 @@ namespace Play3d::Graphics
 		bool m_bEnableShadows = false;
 		bool m_bSkinnedMesh = false;
 		bool m_bInstancing = false;
+		bool m_bCompactVertices = false;
 	};
 
 	//! @brief Constant data for Built-in Pbr materials
@@ -2668,6 +2762,7 @@ namespace Play3d::Graphics
 		bool m_bEnableShadows = false;
 		bool m_bSkinnedMesh = false;
 		bool m_bInstancing = false;
+		bool m_bCompactVertices = false;
 	};
 
 	//! @brief For defining custom materials with custom shaders and data.
@@ -2793,6 +2888,7 @@ namespace Play3d::Graphics
 	{
 		MESH_LAYOUT,
 		SKINNED_MESH_LAYOUT,
+		COMPACT_MESH_LAYOUT,
 		MAX_LAYOUTS
 	};
 
@@ -2960,9 +3056,10 @@ namespace Play3d::Graphics
 
 	//! @brief Makes a draw call without a vertex buffer.
 	//! @param elements : Number of vertices to process 3 for a triangle.
+	//! @param elementOffset : optional, first vertex id, SV_VERTEX_ID starts counting from here.
 	//! Useful for shader only effects / postfx
 	//! Shaders must support the SV_VERTEX_ID semantic.
-	void DrawWithoutVertices(u32 elements);
+	void DrawWithoutVertices(u32 elements, u32 elementOffset = 0);
 
 	struct IndirectDrawArgs
 	{
@@ -3160,10 +3257,30 @@ namespace Play3d::Graphics
 	//! @brief Creates a texture from a .png or .jpg file.
 	TextureId CreateTextureFromFile(const char* filePath, bool bGenerateMipLevels = true, bool isLinear = true);
 
+	//! @brief Decodes a .png or .jpg file on a loading thread and creates the texture when the load finishes.
+	//! pTextureOut is written then and must stay valid until it is.
+	void AsyncCreateTextureFromFile(Resources::AsyncLoadingTaskId hAsyncLoad, TextureId* pTextureOut, const char* filePath,
+									bool bGenerateMipLevels = true, bool isLinear = true);
+
 	//! @brief Creates a Texture2dArray from a .dds file.
 	//! This method supports a limited subset of the full .dds format.
 	TextureId CreateTextureFromDDS(const char* filePath);
 
+	//! @brief Reads a .dds file already in memory into a TextureDesc without creating anything.
+	//! The image pointers of desc point into pFileData, most detailed mip of each slice first.
+	//! @return false if the file is malformed or in a format that is not supported.
+	bool ParseDDS(const void* pFileData, size_t fileSizeBytes, const char* pFilePath, TextureDesc& desc);
+
+	//! @brief Returns the sRGB or linear variant of a format, the data is read the same either way.
+	//! Only the view changes, so a texture cooked as sRGB can still be sampled as it would be from a png.
+	TextureFormat MatchColourSpace(TextureFormat format, bool isLinear);
+
+	//! @brief Replaces a 2D texture with one holding more or fewer of the top mips of the same chain.
+	//! The id is kept so materials using it pick up the change. Mips both have are copied on the GPU,
+	//! rDesc.imageDataPtrs holds the mips the old texture lacks, most detailed first.
+	//! rDesc.width and height are the size of the new top mip, which must be a multiple of 4 for BC formats.
+	result_t ResizeTextureMips(TextureId textureId, const TextureDesc& rDesc);
+
 	//! @brief Creates a Texture2dArray from series of equal sized .png or .jpg file.
 	TextureId CreateTextureArrayFromFiles(std::initializer_list<const char*> pFilePaths);
 
@@ -3194,6 +3311,45 @@ namespace Play3d::Graphics
 	//! This function provides an example.
 	SamplerId CreatePointSampler();
 
+	//! ---------------------------------------------------------
+	//! Shared Textures and Samplers
+	//! ---------------------------------------------------------
+
+	struct ResourceCacheStats
+	{
+		u32 textureRequests = 0;
+		u32 textureCount = 0; //!< Textures the cache created.
+		u32 pathHits = 0; //!< Requests for a file already loaded or loading with the same options.
+		u32 contentHits = 0; //!< Requests for another file whose decoded pixels match a cached texture.
+		size_t textureBytes = 0; //!< Estimated GPU memory of the created textures, mips included.
+		size_t bytesSaved = 0; //!< Estimated GPU memory the hits did not allocate.
+		u32 samplerRequests = 0;
+		u32 samplerCount = 0;
+	};
+
+	//! @brief Returns the texture shared by every caller that loads this file with the same options.
+	//! Files that decode to identical pixels share one texture as well. Release with ReleaseSharedTexture.
+	TextureId AcquireTextureFromFile(const char* filePath, bool bGenerateMipLevels = true, bool isLinear = true);
+
+	//! @brief AcquireTextureFromFile with the decode on a loading thread, see AsyncCreateTextureFromFile.
+	//! A file that is already loading is decoded once and written to every pTextureOut waiting on it.
+	void AsyncAcquireTextureFromFile(Resources::AsyncLoadingTaskId hAsyncLoad, TextureId* pTextureOut, const char* filePath,
+									 bool bGenerateMipLevels = true, bool isLinear = true);
+
+	//! @brief Returns the sampler shared by every caller with an identical description.
+	SamplerId AcquireSampler(const SamplerDesc& rDesc);
+
+	//! @brief Drops a reference from AcquireTextureFromFile, the texture is released with the last one.
+	void ReleaseSharedTexture(TextureId textureId);
+
+	//! @brief Drops a reference from AcquireSampler, the sampler is released with the last one.
+	void ReleaseSharedSampler(SamplerId samplerId);
+
+	const ResourceCacheStats& GetResourceCacheStats();
+
+	//! @brief Prints the stats and every cached texture with its reference count to the debug output.
+	void PrintResourceCacheStats();
+
 	//! ---------------------------------------------------------
 	//! Compute Shaders
 	//! ---------------------------------------------------------
@@ -3256,7 +3412,9 @@ namespace Play3d::Graphics
 		DDS4CC_DXT2 = FourCC("DXT2"),
 		DDS4CC_DXT3 = FourCC("DXT3"),
 		DDS4CC_DXT4 = FourCC("DXT4"),
-		DDS4CC_DXT5 = FourCC("DXT5")
+		DDS4CC_DXT5 = FourCC("DXT5"),
+		DDS4CC_ATI1 = FourCC("ATI1"),
+		DDS4CC_ATI2 = FourCC("ATI2")
 	};
 
 	enum DDSPixelFormatFlags
@@ -3605,8 +3763,9 @@ namespace Play3d
 		//! Uses a high precision clock internally.
 		f64 GetElapsedTime();
 
-		//! @brief Loads in a PackFile for Play3D
-		void AddPackFile(const char* filePath);
+		//! @brief Maps in a PackFile for Play3D
+		//! @param bPerfectHash : index the directory with a perfect hash, see Packfile::PackedFile.
+		void AddPackFile(const char* filePath, bool bPerfectHash = false);
 
 		//! @brief Returns the elapsed time since the previous frame in seconds.
 		//! Uses a high precision clock internally.
@@ -3628,6 +3787,79 @@ namespace Play3d
 		//! @param pMemory : a pointer returned by LoadFileData.
 		void ReleaseFileData(const void* pMemory);
 
+		//! @brief Maps a file read-only into the address space instead of reading it into a heap buffer.
+		//! Pages are read on first touch and can be dropped again by the OS, so nothing is copied up front.
+		//! Files in a loaded pack are returned from the pack as LoadFileData does.
+		//! @param filePath : Path to the file.
+		//! @param sizeOut : returns the size in bytes of the file.
+		//! @return a pointer to the mapped view, page aligned. Use UnmapFileData to release it.
+		const void* MapFileData(const char* filePath, size_t& sizeOut);
+
+		//! @brief Releases a view returned by MapFileData.
+		//! @param pMemory : a pointer returned by MapFileData.
+		void UnmapFileData(const void* pMemory);
+
+		//! @brief Queued async reads are issued highest priority first, in submission order within a priority.
+		enum class IoPriority : u32
+		{
+			kLow,
+			kNormal,
+			kHigh,
+			kCount
+		};
+
+		enum class IoStatus : u32
+		{
+			kInvalid, //!< Unknown request, or one whose result has already been delivered.
+			kPending,
+			kComplete,
+			kCancelled,
+			kFailed
+		};
+
+		//! @brief IoRequestDesc::sizeBytes value that reads from the offset to the end of the file.
+		constexpr u64 kIoReadToEnd = ~0ull;
+
+		struct IoResult
+		{
+			IoStatus status = IoStatus::kInvalid;
+			//! The caller's destination, or a buffer to free with ReleaseFileData when none was given.
+			const void* pData = nullptr;
+			size_t sizeBytes = 0;
+		};
+
+		//! @brief Describes a read for ReadFileAsync. Files in a loaded pack are read from the pack.
+		struct IoRequestDesc
+		{
+			std::string filePath;
+			u64 offset = 0;
+			u64 sizeBytes = kIoReadToEnd;
+			//! Optional caller-owned buffer of destinationSizeBytes to read into, the read fails if it is too small.
+			void* pDestination = nullptr;
+			size_t destinationSizeBytes = 0;
+			IoPriority priority = IoPriority::kNormal;
+			//! Called on an IO thread with the result, or on the cancelling thread if the read never started.
+			//! Without a callback the result is collected with WaitForRead.
+			std::function<void(const IoResult&)> callback;
+		};
+
+		using IoRequestId = IdKey<IoRequestDesc, u64, ~0ull>;
+
+		//! @brief Queues a read on the IO threads and returns straight away.
+		IoRequestId ReadFileAsync(const IoRequestDesc& rDesc);
+
+		//! @brief Cancels a queued or in-flight read, an in-flight read stops at its next block.
+		//! @return false if the read had already completed.
+		bool CancelRead(IoRequestId id);
+
+		//! @brief Moves a read that has not started yet to another priority.
+		void SetReadPriority(IoRequestId id, IoPriority priority);
+
+		IoStatus GetReadStatus(IoRequestId id);
+
+		//! @brief Blocks until a read without a callback completes and returns its result.
+		IoResult WaitForRead(IoRequestId id);
+
 	}
 }
 
@@ -3638,6 +3870,11 @@ namespace Play3d::System
 	constexpr u32 kChunkFileFormatId = FourCC("PL3D");
 	constexpr u32 kChunkFileFormatVersion = 3;
 
+	//! Chunk payloads are written at this alignment so a mapped file can be read in place.
+	constexpr u32 kChunkFileAlignment = 16;
+	//! Chunk id of the filler written ahead of a chunk to align its payload. Readers skip it.
+	constexpr u32 kChunkPaddingId = FourCC("pad_");
+
 	//! @brief Common format codes used in p3d assets.
 	namespace AssetFormatId
 	{
@@ -3654,6 +3891,12 @@ namespace Play3d::System
 			kSubmesh = FourCC("subm"),
 			kMaterial = FourCC("matl"),
 
+			//! Compact vertex streams, used in place of kPosition, kNormal and kUV0.
+			kPositionQuantised = FourCC("posq"), //!< u16 x4 positions relative to kPositionBounds, w is unused
+			kPositionBounds = FourCC("pbnd"),	 //!< Vector3f min and max the quantised positions span
+			kNormalOct = FourCC("noct"),		 //!< s16 x2 octahedral normals
+			kUV0Half = FourCC("uv0h"),			 //!< f16 x2 uvs
+
 			kAnimClip = FourCC("anim"),
 			kChannelInfo = FourCC("achi"),
 
@@ -3725,13 +3968,21 @@ namespace Play3d::System
 	class ChunkFileReader
 	{
 	public:
-		ChunkFileReader(const char* filePath);
+		//! @param bMapFile : map the file with MapFileData rather than loading it, see View.
+		ChunkFileReader(const char* filePath, bool bMapFile = false);
 		ChunkFileReader(const void* pMemory, size_t sizeBytes);
+		~ChunkFileReader();
+
+		//! @brief Not copyable, the reader may own the file it closes. Hold one in a std::unique_ptr to pass it on.
+		ChunkFileReader(const ChunkFileReader&) = delete;
+		ChunkFileReader& operator=(const ChunkFileReader&) = delete;
 
 		Result Parse(const void* pMemory, size_t sizeBytes);
 
 		bool IsGood() const { return m_bParseOk; }
 
+		size_t GetSizeBytes() const { return m_sizeBytes; }
+
 		u32 GetSubtype() const;
 
 		bool HasChunk(u32 chunkId) const;
@@ -3752,6 +4003,27 @@ namespace Play3d::System
 			return false;
 		}
 
+		//! @brief Returns the chunk in place, valid until Close. Only a payload not aligned for T is copied,
+		//! into storage, which is how files written before kChunkFileAlignment are read.
+		template <typename T>
+		std::span<const T> View(u32 chunkId, std::vector<T>& storage) const
+		{
+			size_t sizeBytes;
+			const T* pData = static_cast<const T*>(Read(chunkId, sizeBytes));
+			if (!pData)
+			{
+				return {};
+			}
+			size_t elements = sizeBytes / sizeof(T);
+			if (reinterpret_cast<uintptr_t>(pData) % alignof(T) != 0)
+			{
+				storage.resize(elements);
+				memcpy(storage.data(), pData, elements * sizeof(T));
+				return storage;
+			}
+			return {pData, elements};
+		}
+
 		template <typename T>
 		bool Read(u32 chunkId, T& vOut) const
 		{
@@ -3772,6 +4044,7 @@ namespace Play3d::System
 		size_t m_sizeBytes = 0;
 		const ChunkFileHeader* m_pHeader = nullptr;
 		bool m_bOwnsFile = false;
+		bool m_bMappedFile = false;
 		bool m_bParseOk = false;
 
 		struct ChunkMapEntry
@@ -3856,10 +4129,35 @@ namespace Play3d::Packfile
 		size_t dataSize;
 	};
 
+	//! @brief A slot of the directory index, entry is PackedFile::kEmptySlot for an empty one.
+	struct PackedFileSlot
+	{
+		u64 hash;
+		u32 entry;
+		u32 reserved;
+	};
+
+	//! @brief Ends a pack that carries its directory index, as Tools/AssetCooker writes them.
+	//! slotCount slots laid out as PackedFile::BuildIndex would build them start at slotsOffset in the file.
+	struct PackedFileIndexFooter
+	{
+		static constexpr u64 kMagic = 0x5844494b43415033ull; // "3PACKIDX"
+		u64 slotsOffset;
+		u64 slotCount;
+		u64 magic;
+	};
+
+	//! @brief A pack file with its directory indexed by case-folded path hash.
+	//! A pack with a PackedFileIndexFooter is looked up through its own index in place, so loading it touches
+	//! neither the directory nor the path strings. For packs from the asset tool the index is built beside the pack,
+	//! which only touches the directory pages of a mapped pack.
 	class PackedFile
 	{
 	public:
-		PackedFile(const void* pData, size_t sizeBytes);
+		//! @param bOwnsData : unmap pData with System::UnmapFileData on destruction.
+		//! @param bPerfectHash : look up with a hash-and-displace perfect hash, one slot per lookup instead of a
+		//! probe sequence. Falls back to probing when no displacement is found.
+		PackedFile(const void* pData, size_t sizeBytes, bool bOwnsData = true, bool bPerfectHash = false);
 
 		~PackedFile();
 
@@ -3871,12 +4169,35 @@ namespace Play3d::Packfile
 
 		bool CheckPointerIsInPack(const void* ptr);
 
+		bool HasPerfectHash() const { return !m_seeds.empty(); }
+
+		//! @brief Case-insensitive FNV-1a, matching the _stricmp comparison of paths.
+		static u64 HashPath(const char* pPath);
+
 	private:
+		friend class PackedFileManager;
+
+		static constexpr u32 kEmptySlot = ~0u;
+
+		using Slot = PackedFileSlot;
+
+		bool UseStoredIndex();
+		void BuildIndex();
+		bool BuildPerfectHash();
+		u32 FindEntry(const char* pFilePath) const;
+		u32 FindEntryLinear(const char* pFilePath) const;
+
 		const void* m_pRawData = nullptr;
 		const PackedFileHeader* m_pHeader = nullptr;
 		const PackedFileEntry* m_pDirBlock = nullptr;
 		const uint8_t* m_pDataBlock = nullptr;
 		size_t m_totalSizeBytes = 0;
+		bool m_bOwnsData = true;
+
+		const Slot* m_pSlots = nullptr; // m_slots, or the index stored in the pack
+		size_t m_slotCount = 0;			// power of two, at most half full
+		std::vector<Slot> m_slots;
+		std::vector<u32> m_seeds; // per bucket displacement, empty without a perfect hash
 	};
 
 	class PackedFileManager
@@ -3890,14 +4211,19 @@ namespace Play3d::Packfile
 		static PackedFileManager& Instance() { return *ms_pInstance; }
 		static void Initialise();
 		static void Destroy();
-		void AddPackFile(const char* pFilePath);
+		void AddPackFile(const char* pFilePath, bool bPerfectHash = false);
 		const void* FindFile(const char* pFilePath, size_t& sizeBytes);
 		bool CheckPointerIsInPack(const void* ptr);
 
+		//! @brief Times lookups in a generated pack of entryCount files with the linear scan, the probed index and
+		//! the perfect hash, and prints the results.
+		static void BenchmarkLookups(u32 entryCount);
+
 	private:
 		static PackedFileManager* ms_pInstance;
 
 		std::vector<PackedFile*> m_packedFiles;
+		std::shared_mutex m_mutex; // packs can be added from a loading thread, see Resources::AsyncLoadAssets
 	};
 
 }
@@ -4559,10 +4885,30 @@ namespace Play3d::Audio
 			desc.m_sizeBytes = sizeBytes;
 			desc.m_bLoop = bEnableLooping;
 			soundId = Resources::CreateAsset<Sound>(desc);
+			// The sound keeps its own copy of the samples.
+			System::ReleaseFileData(pData);
 		}
 		return soundId;
 	}
 
+	void AsyncLoadSoundFromFile(Resources::AsyncLoadingTaskId hAsyncLoad, SoundId* pSoundOut, const char* filePath, bool bEnableLooping)
+	{
+		Resources::AddAsyncRead(hAsyncLoad,
+								filePath,
+								[pSoundOut, bEnableLooping](const void* pData, size_t sizeBytes)
+								{
+									if (pData)
+									{
+										SoundDesc desc;
+										desc.m_pData = pData;
+										desc.m_sizeBytes = sizeBytes;
+										desc.m_bLoop = bEnableLooping;
+										*pSoundOut = Resources::CreateAsset<Sound>(desc);
+										System::ReleaseFileData(pData);
+									}
+								});
+	}
+
 	VoiceId PlaySound(SoundId soundId, f32 fGain, f32 fPan)
 	{
 		return Audio_Impl::Instance().PlaySound(soundId, fGain, fPan);
@@ -5262,7 +5608,7 @@ namespace Play3d::Graphics
 	struct MaterialShaderKey
 	{
 		static constexpr u32 kMaxLights = 8;
-		static constexpr u32 kUsedBits = 13;
+		static constexpr u32 kUsedBits = 14;
 		static constexpr u32 kPermutations = 1 << kUsedBits;
 
 		union {
@@ -5278,6 +5624,7 @@ namespace Play3d::Graphics
 				u32 m_useShadows  : 1; //! Determines if shadows are enabled
 				u32 m_skinnedMesh : 1; //! Is this material for a skinned mesh
 				u32 m_useInstancing : 1; //! Is this material for instanced meshes
+				u32 m_compactVertices : 1; //! Is this material for meshes with compact vertices
 
 			} m_bits;
 			u32 m_value;
@@ -5319,7 +5666,7 @@ namespace Play3d::Graphics
 		void DrawInstancedMesh(const Mesh* pMesh, u32 kInstanceCount, u32 kInstanceOffset, u32 elementOffset,
 							   u32 elementCount);
 
-		void DrawWithoutVertices(u32 elements);
+		void DrawWithoutVertices(u32 elements, u32 elementOffset);
 
 		void DrawIndirectWithoutVertices(BufferId hArgBuffer, u32 offset);
 
@@ -5511,6 +5858,8 @@ namespace Play3d::Graphics
 			Matrix4x4f mvpMtx;
 			Matrix4x4f worldMtx;
 			Matrix4x4f normalMtx;
+			Vector4f positionScale;
+			Vector4f positionOffset;
 		};
 		ShaderConstantBuffer_Impl<DrawConstantData> m_drawConstants;
 
@@ -6016,9 +6365,9 @@ namespace Play3d::Graphics
 		}
 	}
 
-	void DrawWithoutVertices(u32 elements)
+	void DrawWithoutVertices(u32 elements, u32 elementOffset)
 	{
-		Graphics_Impl::Instance().DrawWithoutVertices(elements);
+		Graphics_Impl::Instance().DrawWithoutVertices(elements, elementOffset);
 	}
 
 	void DrawIndirectWithoutVertices(BufferId hArgBuffer, u32 offset)
@@ -6450,9 +6799,11 @@ namespace Play3d::Graphics
 
 	MeshId CreateMeshFromAssetFile(const char* filePath)
 	{
-		System::ChunkFileReader reader(filePath);
+		// Streams are viewed in place in the mapped file and only copied into the D3D buffers.
+		System::ChunkFileReader reader(filePath, true);
 		if (reader.IsGood() && reader.GetSubtype() == System::AssetFormatId::kMesh)
 		{
+			// Only filled for chunks that are not aligned in the file, see ChunkFileReader::View.
 			std::vector<Vector3f> positionBuffer;
 			std::vector<u32> colourBuffer;
 			std::vector<Vector3f> normalBuffer;
@@ -6462,54 +6813,93 @@ namespace Play3d::Graphics
 			std::vector<Vector4f> jointWeightBuffer;
 
 			std::vector<u32> indexBuffer;
-			std::vector<Graphics::SubmeshDesc> submeshes;
-			std::vector<Graphics::MeshMaterialInfo> materialInfos;
+			std::vector<Graphics::SubmeshDesc> submeshBuffer;
+			std::vector<Graphics::MeshMaterialInfo> materialInfoBuffer;
 
-			reader.Read(System::AssetFormatId::kPosition, positionBuffer);
-			reader.Read(System::AssetFormatId::kNormal, normalBuffer);
-			reader.Read(System::AssetFormatId::kUV0, uvBuffer);
-			reader.Read(System::AssetFormatId::kColour, colourBuffer);
+			std::span<const Vector3f> positions = reader.View(System::AssetFormatId::kPosition, positionBuffer);
+			std::span<const Vector3f> normals = reader.View(System::AssetFormatId::kNormal, normalBuffer);
+			std::span<const Vector2f> uvs = reader.View(System::AssetFormatId::kUV0, uvBuffer);
+			std::span<const u32> colours = reader.View(System::AssetFormatId::kColour, colourBuffer);
 
+			std::span<const u32> jointIds;
+			std::span<const Vector4f> jointWeights;
 			bool bIsSkinnedMesh = false;
 			if (reader.HasChunk(System::AssetFormatId::kJointIndices)
 				&& reader.HasChunk(System::AssetFormatId::kJointWeights))
 			{
 				bIsSkinnedMesh = true;
-				reader.Read(System::AssetFormatId::kJointIndices, jointIdBuffer);
-				reader.Read(System::AssetFormatId::kJointWeights, jointWeightBuffer);
+				jointIds = reader.View(System::AssetFormatId::kJointIndices, jointIdBuffer);
+				jointWeights = reader.View(System::AssetFormatId::kJointWeights, jointWeightBuffer);
 			}
 
-			reader.Read(System::AssetFormatId::kIndex, indexBuffer);
-			reader.Read(System::AssetFormatId::kSubmesh, submeshes);
-			reader.Read(System::AssetFormatId::kMaterial, materialInfos);
+			std::span<const u32> indices = reader.View(System::AssetFormatId::kIndex, indexBuffer);
+			std::span<const Graphics::SubmeshDesc> submeshes = reader.View(System::AssetFormatId::kSubmesh, submeshBuffer);
+			std::span<const Graphics::MeshMaterialInfo> materialInfos = reader.View(System::AssetFormatId::kMaterial, materialInfoBuffer);
+
+			// Compact streams, packed per vertex as u16 x4 positions, s16 x2 normals and f16 x2 uvs.
+			std::vector<u16> quantisedPositionBuffer;
+			std::vector<u32> octNormalBuffer;
+			std::vector<u32> halfUVBuffer;
+			std::vector<Vector3f> positionBoundsBuffer;
+			std::span<const u16> quantisedPositions;
+			std::span<const u32> octNormals;
+			std::span<const u32> halfUVs;
+			std::span<const Vector3f> positionBounds;
+			if (!bIsSkinnedMesh && reader.HasChunk(System::AssetFormatId::kPositionQuantised))
+			{
+				quantisedPositions = reader.View(System::AssetFormatId::kPositionQuantised, quantisedPositionBuffer);
+				positionBounds = reader.View(System::AssetFormatId::kPositionBounds, positionBoundsBuffer);
+				octNormals = reader.View(System::AssetFormatId::kNormalOct, octNormalBuffer);
+				halfUVs = reader.View(System::AssetFormatId::kUV0Half, halfUVBuffer);
+			}
 
-			reader.Close();
+			static const u32 kWhite = 0xFFFFFFFF;
 
 			MeshDesc desc;
 			std::vector<StreamInfo> streamInfos;
-			streamInfos.push_back(StreamInfo::Create(StreamType::POSITION, positionBuffer));
-			streamInfos.push_back(StreamInfo::Create(StreamType::COLOUR, colourBuffer));
-			streamInfos.push_back(StreamInfo::Create(StreamType::NORMAL, normalBuffer));
-			streamInfos.push_back(StreamInfo::Create(StreamType::UV, uvBuffer));
+			if (!quantisedPositions.empty())
+			{
+				PLAY_ASSERT_MSG(positionBounds.size() == 2, "Quantised positions need their bounds.");
+				if (colours.empty())
+				{
+					colours = {&kWhite, 1};
+				}
+				desc.m_bCompactVertices = true;
+				desc.m_positionOffset = positionBounds[0];
+				desc.m_positionScale = positionBounds[1] - positionBounds[0];
+				streamInfos.push_back(StreamInfo::Create(StreamType::POSITION, quantisedPositions));
+				streamInfos.push_back(StreamInfo::Create(StreamType::COLOUR, colours));
+				streamInfos.push_back(StreamInfo::Create(StreamType::NORMAL, octNormals));
+				streamInfos.push_back(StreamInfo::Create(StreamType::UV, halfUVs));
+			}
+			else
+			{
+				streamInfos.push_back(StreamInfo::Create(StreamType::POSITION, positions));
+				streamInfos.push_back(StreamInfo::Create(StreamType::COLOUR, colours));
+				streamInfos.push_back(StreamInfo::Create(StreamType::NORMAL, normals));
+				streamInfos.push_back(StreamInfo::Create(StreamType::UV, uvs));
+			}
 
 			if (bIsSkinnedMesh)
 			{
-				streamInfos.push_back(StreamInfo::Create(StreamType::JOINTID, jointIdBuffer));
-				streamInfos.push_back(StreamInfo::Create(StreamType::JOINTWEIGHT, jointWeightBuffer));
+				streamInfos.push_back(StreamInfo::Create(StreamType::JOINTID, jointIds));
+				streamInfos.push_back(StreamInfo::Create(StreamType::JOINTWEIGHT, jointWeights));
 			}
 
-			streamInfos.push_back(StreamInfo::Create(StreamType::INDEX, indexBuffer));
+			streamInfos.push_back(StreamInfo::Create(StreamType::INDEX, indices));
 
 			desc.m_pStreams = streamInfos.data();
 			desc.m_streamCount = (u32)streamInfos.size();
-			desc.m_vertexCount = (u32)positionBuffer.size();
-			desc.m_indexCount = (u32)indexBuffer.size();
+			desc.m_vertexCount = desc.m_bCompactVertices ? (u32)quantisedPositions.size() / 4 : (u32)positions.size();
+			desc.m_indexCount = (u32)indices.size();
 			desc.m_pSubmeshes = submeshes.data();
 			desc.submeshCount = (u32)submeshes.size();
 			desc.m_pMaterialInfos = materialInfos.data();
 			desc.materialCount = (u32)materialInfos.size();
 
-			return Resources::CreateAsset<Mesh>(desc);
+			MeshId meshId = Resources::CreateAsset<Mesh>(desc);
+			reader.Close();
+			return meshId;
 		}
 		return MeshId();
 	}
@@ -6536,16 +6926,9 @@ namespace Play3d::Graphics
 					{
 						std::string texturePath =
 							std::string("Data/") + pMesh->GetMaterialInfo(i).texture[iTex].c_str();
-						if (std::filesystem::exists(texturePath))
-						{
-							desc.m_texture[iTex] = Graphics::CreateTextureFromDDS((texturePath + ".dds").c_str());
-						}
-						else
-						{
-							desc.m_texture[iTex] = Graphics::CreateTextureFromFile(
-								(texturePath + ".png").c_str());
-						}
-						desc.m_sampler[iTex] = Graphics::CreateLinearSampler();
+						// The cache loads a cooked .dds beside the png when there is one.
+						desc.m_texture[iTex] = Graphics::AcquireTextureFromFile((texturePath + ".png").c_str());
+						desc.m_sampler[iTex] = Graphics::AcquireSampler(SamplerDesc());
 					}
 				}
 
@@ -6594,6 +6977,23 @@ namespace Play3d::Graphics
 		return id;
 	}
 
+	static TextureId CreateTextureFromRGBA(const char* pFilePath, const std::vector<u8>& imageData, SurfaceSize surfaceSize,
+										   bool bGenerateMipLevels, bool isLinear)
+	{
+		TextureDesc desc;
+		desc.width = surfaceSize.m_width;
+		desc.height = surfaceSize.m_height;
+		desc.format = isLinear ? TextureFormat::RGBA : TextureFormat::RGBA_SRGB;
+		desc.imageDataPtrs.push_back(imageData.data());
+		desc.pDebugName = pFilePath;
+		desc.flags = TextureFlags::ENABLE_TEXTURE;
+		if (bGenerateMipLevels)
+		{
+			desc.flags |= TextureFlags::GENERATE_MIPS;
+		}
+		return Resources::CreateAsset<Texture>(desc);
+	}
+
 	TextureId CreateTextureFromFile(const char* pFilePath, bool bGenerateMipLevels, bool isLinear)
 	{
 		TextureId textureId;
@@ -6604,42 +7004,58 @@ namespace Play3d::Graphics
 
 		if (Result::RESULT_OK == result)
 		{
-			TextureDesc desc;
-			desc.width = surfaceSize.m_width;
-			desc.height = surfaceSize.m_height;
-			desc.format = isLinear ? TextureFormat::RGBA : TextureFormat::RGBA_SRGB;
-			desc.imageDataPtrs.push_back(imageData.data());
-			desc.pDebugName = pFilePath;
-			desc.flags = TextureFlags::ENABLE_TEXTURE;
-			if (bGenerateMipLevels)
-			{
-				desc.flags |= TextureFlags::GENERATE_MIPS;
-			}
-			textureId = Resources::CreateAsset<Texture>(desc);
+			textureId = CreateTextureFromRGBA(pFilePath, imageData, surfaceSize, bGenerateMipLevels, isLinear);
 		}
 
 		return textureId;
 	}
 
-	TextureId CreateTextureFromDDS(const char* pFilePath)
+	void AsyncCreateTextureFromFile(Resources::AsyncLoadingTaskId hAsyncLoad, TextureId* pTextureOut, const char* pFilePath,
+									bool bGenerateMipLevels, bool isLinear)
 	{
-		TextureId textureId;
+		// LoadImageAsRGBA makes its own WIC factory, so decoding is safe on a loading thread.
+		struct Image
+		{
+			std::string path;
+			std::vector<u8> data;
+			SurfaceSize size;
+			bool bDecoded = false;
+		};
+		auto pImage = std::make_shared<Image>();
+		pImage->path = pFilePath;
 
-		size_t fileSizeBytes = 0;
-		const uint8_t* pFileData = static_cast<const uint8_t*>(System::LoadFileData(pFilePath, fileSizeBytes));
-		if (!pFileData)
+		Resources::AddAsyncLoad(
+			hAsyncLoad,
+			[pImage]()
+			{
+				pImage->bDecoded = Result::RESULT_OK
+					== Graphics::Graphics_Impl::Instance().LoadImageAsRGBA(pImage->path.c_str(), pImage->data, pImage->size);
+			},
+			[pImage, pTextureOut, bGenerateMipLevels, isLinear]()
+			{
+				if (pImage->bDecoded)
+				{
+					*pTextureOut = CreateTextureFromRGBA(pImage->path.c_str(), pImage->data, pImage->size, bGenerateMipLevels, isLinear);
+				}
+			});
+	}
+
+	bool ParseDDS(const void* pFileData, size_t fileSizeBytes, const char* pFilePath, TextureDesc& desc)
+	{
+		const uint8_t* pFilePos = static_cast<const uint8_t*>(pFileData);
+		const uint8_t* pFileEnd = pFilePos + fileSizeBytes;
+		if (fileSizeBytes < sizeof(uint32_t) + sizeof(DDSHeader))
 		{
-			Debug::Printf("ERROR: DDS Image file load data failed! path='%s'\n", pFilePath);
-			return TextureId();
+			Debug::Printf("ERROR: DDS Image file load error, file too small! path='%s'\n", pFilePath);
+			return false;
 		}
-		const uint8_t* pFilePos = pFileData;
 
 		const uint32_t* pMagicFourcc = reinterpret_cast<const uint32_t*>(pFilePos);
 		pFilePos += sizeof(uint32_t);
 		if (*pMagicFourcc != DDSFourccCodes::DDS4CC_DDSFile)
 		{
 			Debug::Printf("ERROR: DDS Image file load error, not a DDS file! path='%s'\n", pFilePath);
-			return TextureId();
+			return false;
 		}
 
 		const DDSHeader* pHeader = reinterpret_cast<const DDSHeader*>(pFilePos);
@@ -6659,7 +7075,7 @@ namespace Play3d::Graphics
 			if (!(pHeader->flags & DDSFlags::DDSD_PITCH))
 			{
 				Debug::Printf("ERROR: DDS Uncompressed Image file RGB without PITCH! path='%s'\n", pFilePath);
-				return TextureId();
+				return false;
 			}
 		}
 		else if (pHeader->ddspf.flags & DDSPixelFormatFlags::DDPF_FOURCC)
@@ -6668,24 +7084,24 @@ namespace Play3d::Graphics
 			if (!(pHeader->flags & DDSFlags::DDSD_LINEARSIZE))
 			{
 				Debug::Printf("ERROR: DDS Compressed Image file FOURCC without LINEARSIZE! path='%s'\n", pFilePath);
-				return TextureId();
+				return false;
 			}
 		}
 		else
 		{
 			Debug::Printf("ERROR: DDS Image file unsupported pixel format! path='%s'\n", pFilePath);
-			return TextureId();
+			return false;
 		}
 
 		const uint8_t* pImageData = pFilePos;
 
-		const u32 kMipLevelCount = pHeader->mipMapCount;
+		// Files without a mip chain may leave the count at zero.
+		const u32 kMipLevelCount = std::max(1u, pHeader->mipMapCount);
 		u32 kSliceCount = 1;
 
 		const size_t bitsPerPixel = DDSBitsPerPixel(pHeader->ddspf, DXGI_FORMAT_UNKNOWN);
 		size_t blockSize = 0;
 
-		TextureDesc desc;
 		desc.type = TextureType::TEXTURE2D;
 		if (pHeader->caps2 & DDSCAPS2_CUBEMAP)
 		{
@@ -6722,6 +7138,22 @@ namespace Play3d::Graphics
 					desc.format = TextureFormat::BC3_SRGB;
 					blockSize = 16;
 					break;
+				case DXGI_FORMAT_BC4_UNORM:
+					desc.format = TextureFormat::BC4;
+					blockSize = 8;
+					break;
+				case DXGI_FORMAT_BC5_UNORM:
+					desc.format = TextureFormat::BC5;
+					blockSize = 16;
+					break;
+				case DXGI_FORMAT_BC7_UNORM:
+					desc.format = TextureFormat::BC7;
+					blockSize = 16;
+					break;
+				case DXGI_FORMAT_BC7_UNORM_SRGB:
+					desc.format = TextureFormat::BC7_SRGB;
+					blockSize = 16;
+					break;
 				}
 			}
 			else
@@ -6736,8 +7168,22 @@ namespace Play3d::Graphics
 					desc.format = TextureFormat::BC3;
 					blockSize = 16;
 					break;
+				case DDSFourccCodes::DDS4CC_ATI1:
+					desc.format = TextureFormat::BC4;
+					blockSize = 8;
+					break;
+				case DDSFourccCodes::DDS4CC_ATI2:
+					desc.format = TextureFormat::BC5;
+					blockSize = 16;
+					break;
 				}
 			}
+
+			if (blockSize == 0)
+			{
+				Debug::Printf("ERROR: DDS Image file unsupported compressed format! path='%s'\n", pFilePath);
+				return false;
+			}
 		}
 		else
 		{
@@ -6760,7 +7206,7 @@ namespace Play3d::Graphics
 			u32 mipWidth = pHeader->width;
 			u32 mipHeight = pHeader->height;
 
-			for (u32 miplevel = 0; miplevel < pHeader->mipMapCount; ++miplevel)
+			for (u32 miplevel = 0; miplevel < kMipLevelCount; ++miplevel)
 			{
 				size_t horizPitch;
 				size_t vertPitch;
@@ -6777,6 +7223,11 @@ namespace Play3d::Graphics
 				}
 
 				size_t imageSize = horizPitch * vertPitch;
+				if ((size_t)(pFileEnd - pImageData) < imageSize)
+				{
+					Debug::Printf("ERROR: DDS Image file is truncated! path='%s'\n", pFilePath);
+					return false;
+				}
 
 				desc.imageDataPtrs.push_back(pImageData);
 
@@ -6785,14 +7236,58 @@ namespace Play3d::Graphics
 				mipHeight /= 2;
 			}
 		}
+		return true;
+	}
 
-		textureId = Resources::CreateAsset<Texture>(desc);
+	TextureId CreateTextureFromDDS(const char* pFilePath)
+	{
+		TextureId textureId;
+
+		size_t fileSizeBytes = 0;
+		const uint8_t* pFileData = static_cast<const uint8_t*>(System::LoadFileData(pFilePath, fileSizeBytes));
+		if (!pFileData)
+		{
+			Debug::Printf("ERROR: DDS Image file load data failed! path='%s'\n", pFilePath);
+			return TextureId();
+		}
+
+		TextureDesc desc;
+		if (ParseDDS(pFileData, fileSizeBytes, pFilePath, desc))
+		{
+			textureId = Resources::CreateAsset<Texture>(desc);
+		}
 
 		System::ReleaseFileData(pFileData);
 
 		return textureId;
 	}
 
+	TextureFormat MatchColourSpace(TextureFormat format, bool isLinear)
+	{
+		switch (format)
+		{
+		case TextureFormat::BC1:
+		case TextureFormat::BC1_SRGB: return isLinear ? TextureFormat::BC1 : TextureFormat::BC1_SRGB;
+		case TextureFormat::BC3:
+		case TextureFormat::BC3_SRGB: return isLinear ? TextureFormat::BC3 : TextureFormat::BC3_SRGB;
+		case TextureFormat::BC7:
+		case TextureFormat::BC7_SRGB: return isLinear ? TextureFormat::BC7 : TextureFormat::BC7_SRGB;
+		case TextureFormat::RGBA:
+		case TextureFormat::RGBA_SRGB: return isLinear ? TextureFormat::RGBA : TextureFormat::RGBA_SRGB;
+		default: return format;
+		}
+	}
+
+	result_t ResizeTextureMips(TextureId textureId, const TextureDesc& rDesc)
+	{
+		Texture* pTexture = Resources::GetPtr(textureId);
+		if (!pTexture)
+		{
+			return RESULT_FAIL;
+		}
+		return pTexture->ResizeMips(rDesc);
+	}
+
 	Play3d::Graphics::TextureId CreateTextureArrayFromFiles(std::initializer_list<const char*> pFilePaths)
 	{
 		TextureId textureId;
@@ -7596,6 +8091,8 @@ namespace Play3d::Graphics
 			{
 				PLAY_ASSERT_MSG(!pMaterial->m_bSkinnedMeshMaterial, "ERROR: Non-skinned Mesh is being drawn with a skinned mesh material!");
 			}
+			PLAY_ASSERT_MSG(pMesh->m_bCompactVertices == (pMaterial->m_inputLayoutId == GetStandardInputLayout(StandardInputLayoutTypes::COMPACT_MESH_LAYOUT)),
+							"ERROR: Compact vertex meshes must be drawn with COMPACT_MESH_LAYOUT materials, and only those!");
 
 			pMesh->Bind(pDC);
 		}
@@ -7605,6 +8102,10 @@ namespace Play3d::Graphics
 	{
 		PLAY_ASSERT(pDC);
 
+		DrawConstantData& drawConstants(m_drawConstants.Get());
+		drawConstants.positionScale = pMesh ? Vector4f(pMesh->m_positionScale, 1.f) : Vector4f(1, 1, 1, 1);
+		drawConstants.positionOffset = pMesh ? Vector4f(pMesh->m_positionOffset, 0.f) : Vector4f(0, 0, 0, 0);
+
 		UpdateConstantBuffers();
 
 		BindActiveMaterial(pDC);
@@ -7680,13 +8181,13 @@ namespace Play3d::Graphics
 		}
 	}
 
-	void Graphics_Impl::DrawWithoutVertices(u32 elements)
+	void Graphics_Impl::DrawWithoutVertices(u32 elements, u32 elementOffset)
 	{
 		ID3D11DeviceContext* pDC = m_pDeviceContext.Get();
 		PrepareDrawMesh(pDC, nullptr);
 
 		pDC->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-		pDC->Draw(elements, 0);
+		pDC->Draw(elements, elementOffset);
 	}
 
 	void Graphics_Impl::DrawIndirectWithoutVertices(BufferId hArgBuffer, u32 offset)
@@ -8472,6 +8973,12 @@ namespace Play3d::Graphics
 			desc.m_name += "_INST";
 		}
 
+		if (key.m_bits.m_compactVertices)
+		{
+			desc.m_defines.push_back({"USE_COMPACT_VERTICES", "1"});
+			desc.m_name += "_CV";
+		}
+
 		return Shader::Compile(desc);
 	}
 
@@ -8499,6 +9006,16 @@ namespace Play3d::Graphics
 			m_StandardInputLayouts[(u32)StandardInputLayoutTypes::SKINNED_MESH_LAYOUT] = Resources::CreateAsset<InputLayout>(desc);
 		}
 
+		{
+			InputLayoutDesc desc;
+			desc.m_pDebugName = "CompactMeshInputLayout";
+			desc.m_inputElements.push_back({"POSITION", VertexFormatType::UNorm4_16Bit});
+			desc.m_inputElements.push_back({"COLOUR", VertexFormatType::ColourRGBA_8Bit});
+			desc.m_inputElements.push_back({"NORMAL", VertexFormatType::SNorm2_16Bit});
+			desc.m_inputElements.push_back({"UV", VertexFormatType::Half2});
+			m_StandardInputLayouts[(u32)StandardInputLayoutTypes::COMPACT_MESH_LAYOUT] = Resources::CreateAsset<InputLayout>(desc);
+		}
+
 		return RESULT_OK;
 	}
 
@@ -8787,6 +9304,9 @@ namespace Play3d::Graphics
 		case VertexFormatType::Int3: return DXGI_FORMAT_R32G32B32_SINT;
 		case VertexFormatType::Int4: return DXGI_FORMAT_R32G32B32A32_SINT;
 		case VertexFormatType::ColourRGBA_8Bit: return DXGI_FORMAT_R8G8B8A8_UNORM;
+		case VertexFormatType::UNorm4_16Bit: return DXGI_FORMAT_R16G16B16A16_UNORM;
+		case VertexFormatType::SNorm2_16Bit: return DXGI_FORMAT_R16G16_SNORM;
+		case VertexFormatType::Half2: return DXGI_FORMAT_R16G16_FLOAT;
 		}
 		return DXGI_FORMAT_UNKNOWN;
 	}
@@ -8809,6 +9329,9 @@ namespace Play3d::Graphics
 		case VertexFormatType::Int3: return "int3";
 		case VertexFormatType::Int4: return "int4";
 		case VertexFormatType::ColourRGBA_8Bit: return "float4";
+		case VertexFormatType::UNorm4_16Bit: return "float4";
+		case VertexFormatType::SNorm2_16Bit: return "float2";
+		case VertexFormatType::Half2: return "float2";
 		}
 		return "";
 	}
@@ -8964,11 +9487,17 @@ namespace Play3d::Graphics
 		m_bSkinnedMeshMaterial = rDesc.m_bSkinnedMesh;
 
 		key.m_bits.m_useInstancing = rDesc.m_bInstancing;
+		key.m_bits.m_compactVertices = rDesc.m_bCompactVertices;
+		PLAY_ASSERT_MSG(!(rDesc.m_bSkinnedMesh && rDesc.m_bCompactVertices), "Skinned meshes do not support compact vertices.");
 
 		if (rDesc.m_bSkinnedMesh)
 		{
 			m_inputLayoutId = Graphics_Impl::Instance().GetStandardInputLayout(StandardInputLayoutTypes::SKINNED_MESH_LAYOUT);
 		}
+		else if (rDesc.m_bCompactVertices)
+		{
+			m_inputLayoutId = Graphics_Impl::Instance().GetStandardInputLayout(StandardInputLayoutTypes::COMPACT_MESH_LAYOUT);
+		}
 		else
 		{
 			m_inputLayoutId = Graphics_Impl::Instance().GetStandardInputLayout(StandardInputLayoutTypes::MESH_LAYOUT);
@@ -9011,11 +9540,17 @@ namespace Play3d::Graphics
 		m_bSkinnedMeshMaterial = rDesc.m_bSkinnedMesh;
 
 		key.m_bits.m_useInstancing = rDesc.m_bInstancing;
+		key.m_bits.m_compactVertices = rDesc.m_bCompactVertices;
+		PLAY_ASSERT_MSG(!(rDesc.m_bSkinnedMesh && rDesc.m_bCompactVertices), "Skinned meshes do not support compact vertices.");
 
 		if (rDesc.m_bSkinnedMesh)
 		{
 			m_inputLayoutId = Graphics_Impl::Instance().GetStandardInputLayout(StandardInputLayoutTypes::SKINNED_MESH_LAYOUT);
 		}
+		else if (rDesc.m_bCompactVertices)
+		{
+			m_inputLayoutId = Graphics_Impl::Instance().GetStandardInputLayout(StandardInputLayoutTypes::COMPACT_MESH_LAYOUT);
+		}
 		else
 		{
 			m_inputLayoutId = Graphics_Impl::Instance().GetStandardInputLayout(StandardInputLayoutTypes::MESH_LAYOUT);
@@ -9037,6 +9572,7 @@ namespace Play3d::Graphics
 		m_VertexShader = rDesc.m_VertexShader;
 		m_PixelShader = rDesc.m_PixelShader;
 		SetupTextureBindings(pDevice, rDesc.m_texture, rDesc.m_sampler);
+		m_inputLayoutId = rDesc.m_inputLayoutId;
 		if (m_inputLayoutId.IsInvalid())
 			m_inputLayoutId = Graphics_Impl::Instance().GetStandardInputLayout(StandardInputLayoutTypes::MESH_LAYOUT);
 
@@ -9241,6 +9777,9 @@ namespace Play3d::Graphics
 		, m_initialVertexCount(rDesc.m_vertexCount)
 		, m_bIsSkinnedMesh(false)
 		, m_topology(TranslateMeshTopology(rDesc.m_topology))
+		, m_bCompactVertices(rDesc.m_bCompactVertices)
+		, m_positionScale(rDesc.m_positionScale)
+		, m_positionOffset(rDesc.m_positionOffset)
 	{
 		for (u32 i = 0; i < rDesc.m_streamCount; ++i)
 		{
@@ -9294,7 +9833,28 @@ namespace Play3d::Graphics
 			m_streamInfos.push_back(info);
 			m_streamBufferIds.push_back(bufferId);
 			UINT stride;
-			switch (info.m_type)
+			if (m_bCompactVertices && info.m_type == StreamType::POSITION)
+			{
+				stride = sizeof(u16) * 4;
+				if (info.m_pData)
+				{
+					ComputeBoundsFromQuantisedPositions(static_cast<const u16*>(info.m_pData),
+														info.m_dataSize / stride,
+														m_positionScale,
+														m_positionOffset,
+														m_bounds);
+				}
+			}
+			else if (m_bCompactVertices && info.m_type == StreamType::COLOUR)
+			{
+				// A single colour is read by every vertex.
+				stride = info.m_dataSize == sizeof(u32) ? 0 : sizeof(u32);
+			}
+			else if (m_bCompactVertices && (info.m_type == StreamType::NORMAL || info.m_type == StreamType::UV))
+			{
+				stride = sizeof(u16) * 2;
+			}
+			else switch (info.m_type)
 			{
 			case StreamType::POSITION:
 				stride = sizeof(f32) * 3;
@@ -10053,36 +10613,440 @@ namespace Play3d::Graphics
 
 }
 
-//-------------------------------------------- Graphics/Sampler.cpp --------------------------------------------
+//----------------------------------------- Graphics/ResourceCache.cpp -----------------------------------------
 
 namespace Play3d::Graphics
 {
-	D3D11_FILTER TranslateFilterMode(FilterMode mode)
+	//! @brief Shares textures and samplers between everything that asks for the same one.
+	//! Only used on the owning thread, loading threads just decode and hash.
+	class ResourceCache_Impl
 	{
-		switch (mode)
+		PLAY_SINGLETON_INTERFACE(ResourceCache_Impl);
+
+		ResourceCache_Impl() = default;
+		~ResourceCache_Impl() = default;
+
+	public:
+		TextureId AcquireTexture(const char* pFilePath, bool bGenerateMipLevels, bool isLinear);
+		void AsyncAcquireTexture(Resources::AsyncLoadingTaskId hAsyncLoad, TextureId* pTextureOut, const char* pFilePath,
+								 bool bGenerateMipLevels, bool isLinear);
+		SamplerId AcquireSampler(const SamplerDesc& rDesc);
+		void ReleaseTexture(TextureId textureId);
+		void ReleaseSampler(SamplerId samplerId);
+		const ResourceCacheStats& GetStats() const { return m_stats; }
+		void PrintStats() const;
+
+	private:
+		struct DecodedImage
 		{
-		case FilterMode::BILINEAR: return D3D11_FILTER_MIN_MAG_MIP_LINEAR;
-		case FilterMode::POINT: return D3D11_FILTER_MIN_MAG_MIP_POINT;
-		case FilterMode::ANISOTROPIC: return D3D11_FILTER_ANISOTROPIC;
-		default: return D3D11_FILTER_MIN_MAG_MIP_POINT;
+			~DecodedImage()
+			{
+				if (pFileData)
+				{
+					System::ReleaseFileData(pFileData);
+				}
+			}
+
+			std::string path;
+			std::vector<u8> data;
+			SurfaceSize size;
+			const u8* pFileData = nullptr; // a cooked .dds, ddsDesc points into it
+			size_t fileSizeBytes = 0;
+			TextureDesc ddsDesc;
+			size_t ddsPayloadBytes = 0;
+			u64 contentHash = 0;
+			u64 contentCheck = 0; // a second hash of the content, mixed differently
+			bool bDecoded = false;
 		};
-	}
 
-	D3D11_TEXTURE_ADDRESS_MODE TranslateAddressMode(AddressMode mode)
-	{
-		switch (mode)
+		struct CachedTexture
 		{
-		case AddressMode::CLAMP: return D3D11_TEXTURE_ADDRESS_CLAMP;
-		case AddressMode::WRAP: return D3D11_TEXTURE_ADDRESS_WRAP;
-		case AddressMode::MIRROR: return D3D11_TEXTURE_ADDRESS_MIRROR;
-		case AddressMode::MIRROR_ONCE: return D3D11_TEXTURE_ADDRESS_MIRROR_ONCE;
-		case AddressMode::BORDER: return D3D11_TEXTURE_ADDRESS_BORDER;
-		default: return D3D11_TEXTURE_ADDRESS_CLAMP;
+			std::string path;
+			u64 contentHash = 0;
+			u64 contentCheck = 0;
+			size_t sizeBytes = 0;
+			size_t contentBytes = 0; // of the cooked file or the decoded pixels that were hashed
+			bool bCooked = false;
+			u32 refCount = 0;
 		};
-	}
 
-	Sampler::Sampler(const SamplerDesc& rDesc)
-	{
+		struct CachedSampler
+		{
+			u64 key = 0;
+			u32 refCount = 0;
+		};
+
+		static std::string MakePathKey(const char* pFilePath, bool bGenerateMipLevels, bool isLinear);
+		static void Decode(DecodedImage& rImage, bool bGenerateMipLevels, bool isLinear);
+		static bool LoadCookedImage(DecodedImage& rImage, bool bGenerateMipLevels);
+		static bool HasSameContent(const CachedTexture& rCached, const DecodedImage& rImage);
+		TextureId AddRef(TextureId textureId);
+		TextureId AddTexture(const std::string& pathKey, DecodedImage& rImage, bool bGenerateMipLevels, bool isLinear);
+
+		std::unordered_map<std::string, TextureId> m_texturesByPath;
+		std::unordered_map<u64, TextureId> m_texturesByContent;
+		std::unordered_map<u32, CachedTexture> m_textures;
+		std::unordered_map<std::string, std::vector<TextureId*>> m_pendingByPath;
+		std::unordered_map<u64, SamplerId> m_samplersByDesc;
+		std::unordered_map<u32, CachedSampler> m_samplers;
+		ResourceCacheStats m_stats;
+	};
+
+	PLAY_SINGLETON_IMPL(ResourceCache_Impl);
+
+	std::string ResourceCache_Impl::MakePathKey(const char* pFilePath, bool bGenerateMipLevels, bool isLinear)
+	{
+		std::string key(pFilePath);
+		for (char& c : key)
+		{
+			c = c == '\\' ? '/' : (char)tolower((unsigned char)c);
+		}
+		key += bGenerateMipLevels ? "|mips" : "|nomips";
+		key += isLinear ? "|linear" : "|srgb";
+		return key;
+	}
+
+	bool ResourceCache_Impl::LoadCookedImage(DecodedImage& rImage, bool bGenerateMipLevels)
+	{
+		std::string ddsPath = std::filesystem::path(rImage.path).replace_extension(".dds").string();
+		if (ddsPath == rImage.path || !System::CheckFileExists(ddsPath.c_str()))
+		{
+			return false;
+		}
+
+		rImage.pFileData = static_cast<const u8*>(System::LoadFileData(ddsPath.c_str(), rImage.fileSizeBytes));
+		if (!rImage.pFileData || !ParseDDS(rImage.pFileData, rImage.fileSizeBytes, ddsPath.c_str(), rImage.ddsDesc))
+		{
+			return false;
+		}
+
+		const u8* pFirstLevel = rImage.ddsDesc.imageDataPtrs.front();
+		rImage.ddsPayloadBytes = rImage.fileSizeBytes - (size_t)(pFirstLevel - rImage.pFileData);
+
+		// The cooker always writes the mip chain, drop it when the caller asked for none.
+		if (!bGenerateMipLevels && rImage.ddsDesc.slices == 1 && rImage.ddsDesc.mipLevels > 1)
+		{
+			rImage.ddsPayloadBytes = (size_t)(rImage.ddsDesc.imageDataPtrs[1] - pFirstLevel);
+			rImage.ddsDesc.mipLevels = 1;
+			rImage.ddsDesc.imageDataPtrs.resize(1);
+		}
+		rImage.size = SurfaceSize{rImage.ddsDesc.width, rImage.ddsDesc.height};
+		return true;
+	}
+
+	void ResourceCache_Impl::Decode(DecodedImage& rImage, bool bGenerateMipLevels, bool isLinear)
+	{
+		// A .dds cooked next to the source is preferred, it is already compressed and has its mips.
+		bool bCooked = LoadCookedImage(rImage, bGenerateMipLevels);
+		if (!bCooked && rImage.pFileData)
+		{
+			System::ReleaseFileData(rImage.pFileData);
+			rImage.pFileData = nullptr;
+		}
+
+		rImage.bDecoded = bCooked ||
+			Result::RESULT_OK == Graphics_Impl::Instance().LoadImageAsRGBA(rImage.path.c_str(), rImage.data, rImage.size);
+		if (!rImage.bDecoded)
+		{
+			return;
+		}
+
+		// The options are part of the content, the same pixels in another format are a different texture.
+		// Two independent 64 bit hashes, so content is only shared when all 128 bits match.
+		u64 hash = 0xcbf29ce484222325ull;
+		u64 check = 0x84222325cbf29ce4ull;
+		auto mix = [&hash, &check](u64 value)
+		{
+			hash ^= value;
+			hash *= 0x9e3779b97f4a7c15ull;
+			hash ^= hash >> 29;
+			check += value;
+			check *= 0xff51afd7ed558ccdull;
+			check ^= check >> 33;
+		};
+		mix(rImage.size.m_width);
+		mix(rImage.size.m_height);
+		mix((bGenerateMipLevels ? 1 : 0) | (isLinear ? 2 : 0) | (bCooked ? 4 : 0));
+
+		const u8* pData = bCooked ? rImage.pFileData : rImage.data.data();
+		size_t dataSize = bCooked ? rImage.fileSizeBytes : rImage.data.size();
+		size_t wordCount = dataSize / sizeof(u64);
+		for (size_t i = 0; i < wordCount; ++i)
+		{
+			u64 word;
+			memcpy(&word, pData + i * sizeof(u64), sizeof(u64));
+			mix(word);
+		}
+		for (size_t i = wordCount * sizeof(u64); i < dataSize; ++i)
+		{
+			mix(pData[i]);
+		}
+		rImage.contentHash = hash;
+		rImage.contentCheck = check;
+	}
+
+	bool ResourceCache_Impl::HasSameContent(const CachedTexture& rCached, const DecodedImage& rImage)
+	{
+		// The loading thread hashed the content twice, nothing is read back here on the owning thread.
+		const bool bCooked = rImage.pFileData != nullptr;
+		const size_t contentBytes = bCooked ? rImage.fileSizeBytes : rImage.data.size();
+		return rCached.bCooked == bCooked && rCached.contentBytes == contentBytes && rCached.contentCheck == rImage.contentCheck;
+	}
+
+	TextureId ResourceCache_Impl::AddRef(TextureId textureId)
+	{
+		CachedTexture& rCached(m_textures.at(textureId.GetValue()));
+		++rCached.refCount;
+		m_stats.bytesSaved += rCached.sizeBytes;
+		return textureId;
+	}
+
+	TextureId ResourceCache_Impl::AddTexture(const std::string& pathKey, DecodedImage& rImage, bool bGenerateMipLevels,
+											 bool isLinear)
+	{
+		// A hash collision keeps its own texture, which stays out of m_texturesByContent.
+		auto it = m_texturesByContent.find(rImage.contentHash);
+		const bool bHashTaken = it != m_texturesByContent.end();
+		if (bHashTaken && HasSameContent(m_textures.at(it->second.GetValue()), rImage))
+		{
+			++m_stats.contentHits;
+			m_texturesByPath[pathKey] = it->second;
+			return AddRef(it->second);
+		}
+
+		TextureId textureId;
+		size_t sizeBytes = 0;
+		if (rImage.pFileData)
+		{
+			rImage.ddsDesc.format = MatchColourSpace(rImage.ddsDesc.format, isLinear);
+			textureId = Resources::CreateAsset<Texture>(rImage.ddsDesc);
+			sizeBytes = rImage.ddsPayloadBytes;
+		}
+		else
+		{
+			textureId = CreateTextureFromRGBA(rImage.path.c_str(), rImage.data, rImage.size, bGenerateMipLevels, isLinear);
+			sizeBytes = (size_t)rImage.size.m_width * rImage.size.m_height * 4;
+			if (bGenerateMipLevels)
+			{
+				sizeBytes += sizeBytes / 3;
+			}
+		}
+		if (textureId.IsInvalid())
+		{
+			return textureId;
+		}
+		const bool bCooked = rImage.pFileData != nullptr;
+		const size_t contentBytes = bCooked ? rImage.fileSizeBytes : rImage.data.size();
+		m_textures[textureId.GetValue()] = CachedTexture{rImage.path, rImage.contentHash, rImage.contentCheck, sizeBytes, contentBytes, bCooked, 1};
+		if (!bHashTaken)
+		{
+			m_texturesByContent[rImage.contentHash] = textureId;
+		}
+		m_texturesByPath[pathKey] = textureId;
+		++m_stats.textureCount;
+		m_stats.textureBytes += sizeBytes;
+		return textureId;
+	}
+
+	TextureId ResourceCache_Impl::AcquireTexture(const char* pFilePath, bool bGenerateMipLevels, bool isLinear)
+	{
+		++m_stats.textureRequests;
+		std::string pathKey = MakePathKey(pFilePath, bGenerateMipLevels, isLinear);
+		auto it = m_texturesByPath.find(pathKey);
+		if (it != m_texturesByPath.end())
+		{
+			++m_stats.pathHits;
+			return AddRef(it->second);
+		}
+
+		DecodedImage image;
+		image.path = pFilePath;
+		Decode(image, bGenerateMipLevels, isLinear);
+		return image.bDecoded ? AddTexture(pathKey, image, bGenerateMipLevels, isLinear) : TextureId();
+	}
+
+	void ResourceCache_Impl::AsyncAcquireTexture(Resources::AsyncLoadingTaskId hAsyncLoad, TextureId* pTextureOut,
+												 const char* pFilePath, bool bGenerateMipLevels, bool isLinear)
+	{
+		++m_stats.textureRequests;
+		std::string pathKey = MakePathKey(pFilePath, bGenerateMipLevels, isLinear);
+		auto it = m_texturesByPath.find(pathKey);
+		if (it != m_texturesByPath.end())
+		{
+			++m_stats.pathHits;
+			*pTextureOut = AddRef(it->second);
+			return;
+		}
+
+		// Later requests for a file that is still decoding wait on the first one.
+		std::vector<TextureId*>& rWaiters(m_pendingByPath[pathKey]);
+		rWaiters.push_back(pTextureOut);
+		if (rWaiters.size() > 1)
+		{
+			return;
+		}
+
+		auto pImage = std::make_shared<DecodedImage>();
+		pImage->path = pFilePath;
+		Resources::AddAsyncLoad(
+			hAsyncLoad,
+			[pImage, bGenerateMipLevels, isLinear]() { Decode(*pImage, bGenerateMipLevels, isLinear); },
+			[this, pImage, pathKey, bGenerateMipLevels, isLinear]()
+			{
+				std::vector<TextureId*> waiters = std::move(m_pendingByPath.at(pathKey));
+				m_pendingByPath.erase(pathKey);
+				if (!pImage->bDecoded)
+				{
+					return;
+				}
+
+				TextureId textureId = AddTexture(pathKey, *pImage, bGenerateMipLevels, isLinear);
+				for (size_t i = 0; i < waiters.size(); ++i)
+				{
+					if (i > 0 && textureId.IsValid())
+					{
+						++m_stats.pathHits;
+						AddRef(textureId);
+					}
+					*waiters[i] = textureId;
+				}
+			});
+	}
+
+	SamplerId ResourceCache_Impl::AcquireSampler(const SamplerDesc& rDesc)
+	{
+		++m_stats.samplerRequests;
+		u64 key = (u64)rDesc.m_filter | ((u64)rDesc.m_addressModeU << 4) | ((u64)rDesc.m_addressModeV << 8)
+				  | ((u64)rDesc.m_addressModeW << 12) | ((u64)rDesc.m_borderColour.as_u32() << 32);
+
+		auto it = m_samplersByDesc.find(key);
+		if (it != m_samplersByDesc.end())
+		{
+			++m_samplers.at(it->second.GetValue()).refCount;
+			return it->second;
+		}
+
+		SamplerId samplerId = Resources::CreateAsset<Sampler>(rDesc);
+		m_samplers[samplerId.GetValue()] = CachedSampler{key, 1};
+		m_samplersByDesc[key] = samplerId;
+		++m_stats.samplerCount;
+		return samplerId;
+	}
+
+	void ResourceCache_Impl::ReleaseTexture(TextureId textureId)
+	{
+		auto it = m_textures.find(textureId.GetValue());
+		if (it == m_textures.end() || --it->second.refCount > 0)
+		{
+			return;
+		}
+
+		auto contentIt = m_texturesByContent.find(it->second.contentHash);
+		if (contentIt != m_texturesByContent.end() && contentIt->second == textureId)
+		{
+			m_texturesByContent.erase(contentIt);
+		}
+		std::erase_if(m_texturesByPath, [textureId](const auto& rEntry) { return rEntry.second == textureId; });
+		m_textures.erase(it);
+		Resources::ResourceManager<Texture>::Instance().Release(textureId);
+	}
+
+	void ResourceCache_Impl::ReleaseSampler(SamplerId samplerId)
+	{
+		auto it = m_samplers.find(samplerId.GetValue());
+		if (it == m_samplers.end() || --it->second.refCount > 0)
+		{
+			return;
+		}
+
+		m_samplersByDesc.erase(it->second.key);
+		m_samplers.erase(it);
+		Resources::ResourceManager<Sampler>::Instance().Release(samplerId);
+	}
+
+	void ResourceCache_Impl::PrintStats() const
+	{
+		Debug::Printf("Texture cache: %u requests, %u textures (%zu KB), %u path hits, %u content hits, %zu KB saved\n",
+					  m_stats.textureRequests,
+					  m_stats.textureCount,
+					  m_stats.textureBytes / 1024,
+					  m_stats.pathHits,
+					  m_stats.contentHits,
+					  m_stats.bytesSaved / 1024);
+		for (const auto& [id, rCached] : m_textures)
+		{
+			Debug::Printf("  %3u refs %8zu KB  %s\n", rCached.refCount, rCached.sizeBytes / 1024, rCached.path.c_str());
+		}
+		Debug::Printf("Sampler cache: %u requests, %u samplers\n", m_stats.samplerRequests, m_stats.samplerCount);
+	}
+
+	TextureId AcquireTextureFromFile(const char* filePath, bool bGenerateMipLevels, bool isLinear)
+	{
+		return ResourceCache_Impl::Instance().AcquireTexture(filePath, bGenerateMipLevels, isLinear);
+	}
+
+	void AsyncAcquireTextureFromFile(Resources::AsyncLoadingTaskId hAsyncLoad, TextureId* pTextureOut, const char* filePath,
+									 bool bGenerateMipLevels, bool isLinear)
+	{
+		ResourceCache_Impl::Instance().AsyncAcquireTexture(hAsyncLoad, pTextureOut, filePath, bGenerateMipLevels, isLinear);
+	}
+
+	SamplerId AcquireSampler(const SamplerDesc& rDesc)
+	{
+		return ResourceCache_Impl::Instance().AcquireSampler(rDesc);
+	}
+
+	void ReleaseSharedTexture(TextureId textureId)
+	{
+		ResourceCache_Impl::Instance().ReleaseTexture(textureId);
+	}
+
+	void ReleaseSharedSampler(SamplerId samplerId)
+	{
+		ResourceCache_Impl::Instance().ReleaseSampler(samplerId);
+	}
+
+	const ResourceCacheStats& GetResourceCacheStats()
+	{
+		return ResourceCache_Impl::Instance().GetStats();
+	}
+
+	void PrintResourceCacheStats()
+	{
+		ResourceCache_Impl::Instance().PrintStats();
+	}
+}
+
+//-------------------------------------------- Graphics/Sampler.cpp --------------------------------------------
+
+namespace Play3d::Graphics
+{
+	D3D11_FILTER TranslateFilterMode(FilterMode mode)
+	{
+		switch (mode)
+		{
+		case FilterMode::BILINEAR: return D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+		case FilterMode::POINT: return D3D11_FILTER_MIN_MAG_MIP_POINT;
+		case FilterMode::ANISOTROPIC: return D3D11_FILTER_ANISOTROPIC;
+		default: return D3D11_FILTER_MIN_MAG_MIP_POINT;
+		};
+	}
+
+	D3D11_TEXTURE_ADDRESS_MODE TranslateAddressMode(AddressMode mode)
+	{
+		switch (mode)
+		{
+		case AddressMode::CLAMP: return D3D11_TEXTURE_ADDRESS_CLAMP;
+		case AddressMode::WRAP: return D3D11_TEXTURE_ADDRESS_WRAP;
+		case AddressMode::MIRROR: return D3D11_TEXTURE_ADDRESS_MIRROR;
+		case AddressMode::MIRROR_ONCE: return D3D11_TEXTURE_ADDRESS_MIRROR_ONCE;
+		case AddressMode::BORDER: return D3D11_TEXTURE_ADDRESS_BORDER;
+		default: return D3D11_TEXTURE_ADDRESS_CLAMP;
+		};
+	}
+
+	Sampler::Sampler(const SamplerDesc& rDesc)
+	{
 		ID3D11Device* pDevice = Graphics::Graphics_Impl::Instance().GetDevice();
 
 		D3D11_SAMPLER_DESC desc = {};
@@ -11123,8 +12087,24 @@ cbuffer DrawConstantData: register(PLAY3D_REG_DRAW_CONSTANTS)
 	float4x4 mvpMtx;
 	float4x4 worldMtx;
 	float4x4 normalMtx;
+	float4 positionScale;
+	float4 positionOffset;
 };
 
+// Compact vertex decoding, see MeshDesc::m_bCompactVertices.
+float3 DecodeQuantisedPosition(float4 position)
+{
+	return position.xyz * positionScale.xyz + positionOffset.xyz;
+}
+
+float3 DecodeOctNormal(float2 e)
+{
+	float3 n = float3(e.xy, 1.0f - abs(e.x) - abs(e.y));
+	float t = saturate(-n.z);
+	n.xy += n.xy >= 0.0f ? -t : t;
+	return normalize(n);
+}
+
 #ifdef USE_INSTANCING
 StructuredBuffer<matrix> g_InstanceBuffer: register(PLAY3D_REG_GLOBAL_INSTANCE_DATA_SRV);
 #endif
@@ -11260,10 +12240,17 @@ static const char* HLSL_MeshInputs = R"(
 
 struct VSInput
 {
+#ifdef USE_COMPACT_VERTICES
+	float4 position : POSITION;
+	float4 colour : COLOUR;
+	float2 normal : NORMAL;
+	float2 uv : UV;
+#else
 	float3 position : POSITION;
 	float4 colour : COLOUR;
 	float3 normal : NORMAL;
 	float2 uv : UV;
+#endif
 
 #ifdef USE_SKINNED_MESH
 	uint4  jointId : JOINTID;
@@ -11271,6 +12258,24 @@ struct VSInput
 #endif
 };
 
+float3 GetInputPosition(VSInput input)
+{
+#ifdef USE_COMPACT_VERTICES
+	return DecodeQuantisedPosition(input.position);
+#else
+	return input.position;
+#endif
+}
+
+float3 GetInputNormal(VSInput input)
+{
+#ifdef USE_COMPACT_VERTICES
+	return DecodeOctNormal(input.normal);
+#else
+	return input.normal;
+#endif
+}
+
 #endif
 
 )";
@@ -11279,7 +12284,7 @@ static const char* HLSL_MeshVertexStage = R"(
 PSInput VS_Main(VSInput input, uint vertexId : SV_VertexID, uint instanceId : SV_InstanceID)
 {
 	PSInput output;
-    output.position_w = mul(GetWorldMatrix(instanceId), float4(input.position.xyz, 1.0f));
+    output.position_w = mul(GetWorldMatrix(instanceId), float4(GetInputPosition(input), 1.0f));
 	output.position = mul(viewProjectionMtx, float4(output.position_w.xyz, 1.0f));
 
 	[unroll] for (uint i = 0; i < LIGHT_COUNT; ++i)
@@ -11288,7 +12293,7 @@ PSInput VS_Main(VSInput input, uint vertexId : SV_VertexID, uint instanceId : SV
 	}
 
 	output.colour = SRGBToLinear(input.colour);
-    output.normal = mul(GetNormalMatrix(instanceId), float4(input.normal.xyz, 0.0f)).xyz;
+    output.normal = mul(GetNormalMatrix(instanceId), float4(GetInputNormal(input), 0.0f)).xyz;
 	output.uv = input.uv;
 
 	return output;
@@ -11324,8 +12329,10 @@ float3x3 CotangentFrame( float3 N, float3 p, float2 uv )
 float3 GetNormalDirection(float3 inNormal, float3 inPosW, float2 inUV)
 {
 #if USE_TEXTURE_1
-	float3 normalTexture = g_texture1.Sample(g_sampler1, inUV);
-	normalTexture = (normalTexture * 2.0f) - 1.0f;
+	// Only xy is read so two channel (BC5) maps work, z is rebuilt from the unit length.
+	float3 normalTexture;
+	normalTexture.xy = (g_texture1.Sample(g_sampler1, inUV).xy * 2.0f) - 1.0f;
+	normalTexture.z = sqrt(saturate(1.0f - dot(normalTexture.xy, normalTexture.xy)));
 
 	float3 N = normalize(inNormal);
 	float3x3 TBN = CotangentFrame(N, inPosW, inUV);
@@ -11533,6 +12540,10 @@ namespace Play3d::Graphics
 		case TextureFormat::BC3: return DXGI_FORMAT_BC3_UNORM;
 		case TextureFormat::BC1_SRGB: return DXGI_FORMAT_BC1_UNORM_SRGB;
 		case TextureFormat::BC3_SRGB: return DXGI_FORMAT_BC3_UNORM_SRGB;
+		case TextureFormat::BC4: return DXGI_FORMAT_BC4_UNORM;
+		case TextureFormat::BC5: return DXGI_FORMAT_BC5_UNORM;
+		case TextureFormat::BC7: return DXGI_FORMAT_BC7_UNORM;
+		case TextureFormat::BC7_SRGB: return DXGI_FORMAT_BC7_UNORM_SRGB;
 		default: return DXGI_FORMAT_R8_UNORM;
 		};
 	}
@@ -11552,6 +12563,10 @@ namespace Play3d::Graphics
 		case TextureFormat::BC3: return std::max<u32>(1, ((width + 3) / 4)) * 16;
 		case TextureFormat::BC1_SRGB: return std::max<u32>(1, ((width + 3) / 4)) * 8;
 		case TextureFormat::BC3_SRGB: return std::max<u32>(1, ((width + 3) / 4)) * 16;
+		case TextureFormat::BC4: return std::max<u32>(1, ((width + 3) / 4)) * 8;
+		case TextureFormat::BC5: return std::max<u32>(1, ((width + 3) / 4)) * 16;
+		case TextureFormat::BC7: return std::max<u32>(1, ((width + 3) / 4)) * 16;
+		case TextureFormat::BC7_SRGB: return std::max<u32>(1, ((width + 3) / 4)) * 16;
 		default: return 4;
 		};
 	}
@@ -11808,6 +12823,63 @@ namespace Play3d::Graphics
 		}
 	}
 
+	result_t Texture::ResizeMips(const TextureDesc& rDesc)
+	{
+		D3D11_TEXTURE2D_DESC oldDesc;
+		m_pTexture->GetDesc(&oldDesc);
+		const u32 newLevelCount = rDesc.mipLevels > oldDesc.MipLevels ? rDesc.mipLevels - oldDesc.MipLevels : 0;
+		if (m_bIsDepthFormat || oldDesc.ArraySize != 1 || rDesc.slices != 1 || rDesc.imageDataPtrs.size() != newLevelCount ||
+			TranslateTextureFormat(rDesc.format) != oldDesc.Format)
+		{
+			return RESULT_FAIL;
+		}
+
+		D3D11_TEXTURE2D_DESC desc = oldDesc;
+		desc.Width = rDesc.width;
+		desc.Height = rDesc.height;
+		desc.MipLevels = rDesc.mipLevels;
+		desc.Usage = D3D11_USAGE_DEFAULT;
+		desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+		desc.CPUAccessFlags = 0;
+		desc.MiscFlags = 0;
+
+		ComPtr<ID3D11Texture2D> pNewTexture;
+		ID3D11Device* pDevice = Graphics::Graphics_Impl::Instance().GetDevice();
+		HRESULT hr = pDevice->CreateTexture2D(&desc, nullptr, &pNewTexture);
+		if (FAILED(hr))
+		{
+			return RESULT_FAIL;
+		}
+
+		// The bottom of both chains is the same, so level i from the end of one is level i from the end of the other.
+		ID3D11DeviceContext* pDC = Graphics::Graphics_Impl::Instance().GetDeviceContext();
+		u32 mipWidth = rDesc.width;
+		for (u32 mip = 0; mip < desc.MipLevels; ++mip)
+		{
+			if (mip < newLevelCount)
+			{
+				pDC->UpdateSubresource(pNewTexture.Get(), mip, nullptr, rDesc.imageDataPtrs[mip],
+									   TexturePitchByFormat(rDesc.format, mipWidth), 0);
+			}
+			else
+			{
+				const u32 oldMip = oldDesc.MipLevels - (desc.MipLevels - mip);
+				pDC->CopySubresourceRegion(pNewTexture.Get(), mip, 0, 0, 0, m_pTexture.Get(), oldMip, nullptr);
+			}
+			mipWidth = std::max(1u, mipWidth / 2);
+		}
+
+		if (rDesc.pDebugName)
+		{
+			pNewTexture->SetPrivateData(WKPDID_D3DDebugObjectName, (UINT)strlen(rDesc.pDebugName), rDesc.pDebugName);
+		}
+
+		m_pTexture = pNewTexture;
+		m_pSRV.Reset();
+		Graphics::Graphics_Impl::Instance().ClearStateCache();
+		return RESULT_OK;
+	}
+
 	Texture::~Texture()
 	{
 		for (auto& [key, pView] : m_rtvs)
@@ -12337,6 +13409,27 @@ namespace Play3d::Input
 namespace Play3d
 {
 
+	void ComputeBoundsFromQuantisedPositions(const u16* pPositions, size_t numElements, const Vector3f& scale,
+											 const Vector3f& offset, AABBMinMax& rBoundsOut)
+	{
+		PLAY_ASSERT(numElements > 0);
+
+		u16 qMin[3] = {0xffff, 0xffff, 0xffff};
+		u16 qMax[3] = {0, 0, 0};
+		for (size_t i = 0; i < numElements; ++i)
+		{
+			for (u32 k = 0; k < 3; ++k)
+			{
+				qMin[k] = std::min(qMin[k], pPositions[i * 4 + k]);
+				qMax[k] = std::max(qMax[k], pPositions[i * 4 + k]);
+			}
+		}
+
+		const f32 kUnorm = 1.f / 65535.f;
+		rBoundsOut.vMin = Vector3f(qMin[0] * kUnorm, qMin[1] * kUnorm, qMin[2] * kUnorm) * scale + offset;
+		rBoundsOut.vMax = Vector3f(qMax[0] * kUnorm, qMax[1] * kUnorm, qMax[2] * kUnorm) * scale + offset;
+	}
+
 	void ComputeBoundsFromPositions(const Vector3f* pPositions, size_t numElements, AABBMinMax& rBoundsOut)
 	{
 		PLAY_ASSERT(numElements > 0);
@@ -12383,25 +13476,280 @@ namespace Play3d
 
 namespace Play3d::Resources
 {
-	IdKey<AsyncLoadingTask> AsyncLoadAssets(std::string_view pathToAssetPack)
-	{
-		return IdKey<AsyncLoadingTask>();
-	}
-
-	bool AssetsLoaded(IdKey<AsyncLoadingTask> hAsyncLoad)
+	//! @brief The loading threads behind AsyncLoadingTask.
+	class AsyncLoader_Impl
 	{
-		return true;
-	}
+		PLAY_SINGLETON_INTERFACE(AsyncLoader_Impl);
 
-	Play3d::result_t LoadAssets(std::string_view pathToAssetPack)
-	{
-		return 0;
-	}
-}
+		AsyncLoader_Impl();
+		~AsyncLoader_Impl();
 
-//-------------------------------------------- Sprite/SpriteApi.cpp --------------------------------------------
+	public:
+		static constexpr u32 kMaxThreads = 8;
 
-//----------------------------------------- Sprite/SpriteBatch_Impl.h -----------------------------------------
+		void Submit(AsyncLoadingTaskId hAsyncLoad, std::function<void()>&& work, std::function<void()>&& finish);
+		void SubmitRead(AsyncLoadingTaskId hAsyncLoad,
+						std::string_view filePath,
+						std::function<void(const void*, size_t)>&& finish);
+		void Update(f64 budgetSeconds);
+		void Wait(AsyncLoadingTaskId hAsyncLoad);
+
+	private:
+		struct Job
+		{
+			AsyncLoadingTaskId hAsyncLoad;
+			std::function<void()> work;
+			std::function<void()> finish;
+		};
+
+		void WorkerMain();
+		bool FinishNext();
+
+		std::vector<std::thread> m_threads;
+		std::mutex m_mutex;
+		std::condition_variable m_workReady;
+		std::condition_variable m_workDone;
+		std::deque<Job> m_pending;
+		std::deque<Job> m_completed;
+		bool m_bQuit = false;
+	};
+
+	PLAY_SINGLETON_IMPL(AsyncLoader_Impl);
+
+	AsyncLoader_Impl::AsyncLoader_Impl()
+	{
+		// Leave a core to the owning thread, which keeps presenting frames while loads run.
+		u32 hardwareThreads = std::thread::hardware_concurrency();
+		u32 threadCount = std::clamp(hardwareThreads > 1 ? hardwareThreads - 1 : 1u, 1u, kMaxThreads);
+		for (u32 i = 0; i < threadCount; ++i)
+		{
+			m_threads.emplace_back(&AsyncLoader_Impl::WorkerMain, this);
+		}
+	}
+
+	AsyncLoader_Impl::~AsyncLoader_Impl()
+	{
+		// Loads still queued are dropped, their finish steps never run.
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_bQuit = true;
+		}
+		m_workReady.notify_all();
+		for (std::thread& thread : m_threads)
+		{
+			thread.join();
+		}
+	}
+
+	void AsyncLoader_Impl::WorkerMain()
+	{
+		// WIC decoding needs COM on this thread.
+		CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+
+		for (;;)
+		{
+			Job job;
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_workReady.wait(lock, [this]() { return m_bQuit || !m_pending.empty(); });
+				if (m_bQuit)
+				{
+					break;
+				}
+				job = std::move(m_pending.front());
+				m_pending.pop_front();
+			}
+
+			if (job.work)
+			{
+				job.work();
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_completed.push_back(std::move(job));
+			}
+			m_workDone.notify_one();
+		}
+
+		CoUninitialize();
+	}
+
+	void AsyncLoader_Impl::Submit(AsyncLoadingTaskId hAsyncLoad, std::function<void()>&& work, std::function<void()>&& finish)
+	{
+		AsyncLoadingTask* pTask = GetPtr(hAsyncLoad);
+		PLAY_ASSERT_MSG(pTask, "Invalid async loading task.");
+		if (!pTask)
+		{
+			return;
+		}
+		++pTask->m_loadCount;
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_pending.push_back({hAsyncLoad, std::move(work), std::move(finish)});
+		}
+		m_workReady.notify_one();
+	}
+
+	void AsyncLoader_Impl::SubmitRead(AsyncLoadingTaskId hAsyncLoad,
+									  std::string_view filePath,
+									  std::function<void(const void*, size_t)>&& finish)
+	{
+		AsyncLoadingTask* pTask = GetPtr(hAsyncLoad);
+		PLAY_ASSERT_MSG(pTask, "Invalid async loading task.");
+		if (!pTask)
+		{
+			return;
+		}
+		++pTask->m_loadCount;
+
+		// The IO thread queues the finish step straight onto the completed loads.
+		System::IoRequestDesc desc;
+		desc.filePath = filePath;
+		desc.callback = [this, hAsyncLoad, finish = std::move(finish)](const System::IoResult& rResult)
+		{
+			const void* pData = rResult.status == System::IoStatus::kComplete ? rResult.pData : nullptr;
+			size_t sizeBytes = rResult.sizeBytes;
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_completed.push_back({hAsyncLoad, nullptr, [finish, pData, sizeBytes]() { finish(pData, sizeBytes); }});
+			}
+			m_workDone.notify_one();
+		};
+		System::ReadFileAsync(desc);
+	}
+
+	bool AsyncLoader_Impl::FinishNext()
+	{
+		Job job;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (m_completed.empty())
+			{
+				return false;
+			}
+			job = std::move(m_completed.front());
+			m_completed.pop_front();
+		}
+
+		if (job.finish)
+		{
+			job.finish();
+		}
+		if (AsyncLoadingTask* pTask = GetPtr(job.hAsyncLoad))
+		{
+			++pTask->m_finishedCount;
+		}
+		return true;
+	}
+
+	void AsyncLoader_Impl::Update(f64 budgetSeconds)
+	{
+		auto start = std::chrono::steady_clock::now();
+		while (FinishNext())
+		{
+			if (std::chrono::duration<f64>(std::chrono::steady_clock::now() - start).count() >= budgetSeconds)
+			{
+				break;
+			}
+		}
+	}
+
+	void AsyncLoader_Impl::Wait(AsyncLoadingTaskId hAsyncLoad)
+	{
+		AsyncLoadingTask* pTask = GetPtr(hAsyncLoad);
+		while (pTask && !pTask->IsFinished())
+		{
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_workDone.wait(lock, [this]() { return !m_completed.empty(); });
+			}
+			while (FinishNext())
+			{
+			}
+		}
+	}
+
+	AsyncLoadingTaskId CreateAsyncLoadingTask()
+	{
+		return CreateAsset<AsyncLoadingTask>();
+	}
+
+	void AddAsyncLoad(AsyncLoadingTaskId hAsyncLoad, std::function<void()> work, std::function<void()> finish)
+	{
+		AsyncLoader_Impl::Instance().Submit(hAsyncLoad, std::move(work), std::move(finish));
+	}
+
+	void AddAsyncRead(AsyncLoadingTaskId hAsyncLoad,
+					  std::string_view filePath,
+					  std::function<void(const void* pData, size_t sizeBytes)> finish)
+	{
+		AsyncLoader_Impl::Instance().SubmitRead(hAsyncLoad, filePath, std::move(finish));
+	}
+
+	void UpdateAsyncLoading(f64 budgetSeconds)
+	{
+		AsyncLoader_Impl::Instance().Update(budgetSeconds);
+	}
+
+	void WaitForAssets(AsyncLoadingTaskId hAsyncLoad)
+	{
+		AsyncLoader_Impl::Instance().Wait(hAsyncLoad);
+	}
+
+	f32 GetAsyncLoadingProgress(AsyncLoadingTaskId hAsyncLoad)
+	{
+		const AsyncLoadingTask* pTask = GetPtr(hAsyncLoad);
+		if (!pTask || pTask->GetLoadCount() == 0)
+		{
+			return 1.f;
+		}
+		return (f32)pTask->GetFinishedCount() / (f32)pTask->GetLoadCount();
+	}
+
+	void ReleaseAsyncLoadingTask(AsyncLoadingTaskId hAsyncLoad)
+	{
+		// Finished loads look their task up by id, so one still running would count against the id's next task.
+		const AsyncLoadingTask* pTask = GetPtr(hAsyncLoad);
+		PLAY_ASSERT_MSG(!pTask || pTask->IsFinished(), "Async loading task released with loads still running.");
+		if (pTask)
+		{
+			ResourceManager<AsyncLoadingTask>::Instance().Release(hAsyncLoad);
+		}
+	}
+
+	AsyncLoadingTaskId AsyncLoadAssets(std::string_view pathToAssetPack)
+	{
+		AsyncLoadingTaskId hAsyncLoad = CreateAsyncLoadingTask();
+		AddAsyncLoad(
+			hAsyncLoad,
+			[path = std::string(pathToAssetPack)]() { Packfile::PackedFileManager::Instance().AddPackFile(path.c_str()); },
+			nullptr);
+		return hAsyncLoad;
+	}
+
+	bool AssetsLoaded(AsyncLoadingTaskId hAsyncLoad)
+	{
+		const AsyncLoadingTask* pTask = GetPtr(hAsyncLoad);
+		return !pTask || pTask->IsFinished();
+	}
+
+	Play3d::result_t LoadAssets(std::string_view pathToAssetPack)
+	{
+		std::string path(pathToAssetPack);
+		if (!System::CheckFileExistsOnDisk(path.c_str()))
+		{
+			return RESULT_FAIL;
+		}
+		Packfile::PackedFileManager::Instance().AddPackFile(path.c_str());
+		return RESULT_OK;
+	}
+}
+
+//-------------------------------------------- Sprite/SpriteApi.cpp --------------------------------------------
+
+//----------------------------------------- Sprite/SpriteBatch_Impl.h -----------------------------------------
 
 namespace Play3d::Sprite
 {
@@ -12877,6 +14225,18 @@ namespace Play3d::System
 
 	void ChunkFileWriter::Write(u32 chunkId, const void* pData, size_t sizeBytes)
 	{
+		// Pad so the payload after this chunk's info lands on kChunkFileAlignment.
+		size_t offset = (size_t)m_fStream.tellp() + sizeof(ChunkInfo);
+		if (offset % kChunkFileAlignment != 0)
+		{
+			static const u8 kZeros[kChunkFileAlignment] = {};
+			size_t padding = (kChunkFileAlignment - (offset + sizeof(ChunkInfo)) % kChunkFileAlignment) % kChunkFileAlignment;
+			ChunkInfo padInfo = {kChunkPaddingId, (u32)padding};
+			++m_header.totalChunks;
+			m_fStream.write(reinterpret_cast<const char*>(&padInfo), sizeof(ChunkInfo));
+			m_fStream.write(reinterpret_cast<const char*>(kZeros), padding);
+		}
+
 		ChunkInfo info = {chunkId, (u32)sizeBytes};
 		++m_header.totalChunks;
 		m_fStream.write(reinterpret_cast<const char*>(&info), sizeof(ChunkInfo));
@@ -12893,11 +14253,12 @@ namespace Play3d::System
 		m_fStream.close();
 	}
 
-	ChunkFileReader::ChunkFileReader(const char* filePath)
+	ChunkFileReader::ChunkFileReader(const char* filePath, bool bMapFile)
 	{
 		size_t sizeBytes;
-		const void* pMemory = System::LoadFileData(filePath, sizeBytes);
+		const void* pMemory = bMapFile ? System::MapFileData(filePath, sizeBytes) : System::LoadFileData(filePath, sizeBytes);
 		m_bOwnsFile = true;
+		m_bMappedFile = bMapFile;
 		m_bParseOk = RESULT_OK == Parse(pMemory, sizeBytes);
 	}
 
@@ -12907,6 +14268,11 @@ namespace Play3d::System
 		m_bParseOk = RESULT_OK == Parse(pMemory, sizeBytes);
 	}
 
+	ChunkFileReader::~ChunkFileReader()
+	{
+		Close();
+	}
+
 	Result ChunkFileReader::Parse(const void* pMemory, size_t sizeBytes)
 	{
 		if (!pMemory || sizeBytes < sizeof(ChunkFileHeader))
@@ -12953,7 +14319,10 @@ namespace Play3d::System
 			{
 				mapEntry.pChunkData = (p + offset);
 
-				m_chunkMap.insert({mapEntry.info->chunkId, mapEntry});
+				if (mapEntry.info->chunkId != kChunkPaddingId)
+				{
+					m_chunkMap.insert({mapEntry.info->chunkId, mapEntry});
+				}
 
 				offset += mapEntry.info->sizeBytes;
 				mapEntry = {nullptr, nullptr};
@@ -12994,8 +14363,16 @@ namespace Play3d::System
 	{
 		if (m_bOwnsFile)
 		{
-			System::ReleaseFileData(m_pMemory);
+			if (m_bMappedFile)
+			{
+				System::UnmapFileData(m_pMemory);
+			}
+			else
+			{
+				System::ReleaseFileData(m_pMemory);
+			}
 			m_bOwnsFile = false;
+			m_bMappedFile = false;
 		}
 		m_pMemory = nullptr;
 		m_pHeader = nullptr;
@@ -13035,20 +14412,37 @@ namespace Play3d::Packfile
 		ms_pInstance = nullptr;
 	}
 
-	void PackedFileManager::AddPackFile(const char* pFilePath)
+	void PackedFileManager::AddPackFile(const char* pFilePath, bool bPerfectHash)
 	{
 		if (System::CheckFileExistsOnDisk(pFilePath))
 		{
+			// Mapped, so only the directory and the files actually read become resident.
 			size_t sizeBytes;
-			const void* packFileData = System::LoadFileData(pFilePath, sizeBytes);
-			PackedFile* pNewFile = new PackedFile(packFileData, sizeBytes);
+			const void* packFileData = System::MapFileData(pFilePath, sizeBytes);
+			if (!packFileData)
+			{
+				return;
+			}
+
+			const PackedFileHeader* pHeader = static_cast<const PackedFileHeader*>(packFileData);
+			if (sizeBytes < sizeof(PackedFileHeader) || pHeader->dirBlockOffset > sizeBytes
+				|| pHeader->dirEntryCount > (sizeBytes - pHeader->dirBlockOffset) / sizeof(PackedFileEntry))
+			{
+				Debug::Printf("ERROR: Pack file is truncated! path='%s'\n", pFilePath);
+				System::UnmapFileData(packFileData);
+				return;
+			}
+
+			PackedFile* pNewFile = new PackedFile(packFileData, sizeBytes, true, bPerfectHash);
 
+			std::unique_lock lock(m_mutex);
 			m_packedFiles.push_back(pNewFile);
 		}
 	}
 
 	const void* PackedFileManager::FindFile(const char* pFilePath, size_t& sizeBytes)
 	{
+		std::shared_lock lock(m_mutex);
 		const void* file = nullptr;
 		for (auto packedFile : m_packedFiles)
 		{
@@ -13062,6 +14456,7 @@ namespace Play3d::Packfile
 
 	bool PackedFileManager::CheckPointerIsInPack(const void* ptr)
 	{
+		std::shared_lock lock(m_mutex);
 		for (auto packedFile : m_packedFiles)
 		{
 			if (packedFile->CheckPointerIsInPack(ptr))
@@ -13070,18 +14465,31 @@ namespace Play3d::Packfile
 		return false;
 	}
 
-	PackedFile::PackedFile(const void* pData, size_t sizeBytes)
+	PackedFile::PackedFile(const void* pData, size_t sizeBytes, bool bOwnsData, bool bPerfectHash)
 	{
 		m_pRawData = pData;
 		m_pHeader = static_cast<const PackedFileHeader*>(m_pRawData);
 		m_pDataBlock = reinterpret_cast<const uint8_t*>(static_cast<const uint8_t*>(m_pRawData) + m_pHeader->dataBlockOffset);
 		m_pDirBlock = reinterpret_cast<const PackedFileEntry*>(static_cast<const uint8_t*>(m_pRawData) + m_pHeader->dirBlockOffset);
 		m_totalSizeBytes = sizeBytes;
+		m_bOwnsData = bOwnsData;
+
+		if (!UseStoredIndex())
+		{
+			BuildIndex();
+		}
+		if (bPerfectHash && !BuildPerfectHash())
+		{
+			Debug::Printf("WARNING: No perfect hash found for %zu pack entries, probing instead.\n", m_pHeader->dirEntryCount);
+		}
 	}
 
 	PackedFile::~PackedFile()
 	{
-		System::ReleaseFileData(m_pRawData);
+		if (m_bOwnsData)
+		{
+			System::UnmapFileData(m_pRawData);
+		}
 		m_pRawData = nullptr;
 		m_pHeader = nullptr;
 		m_pDataBlock = nullptr;
@@ -13089,18 +14497,291 @@ namespace Play3d::Packfile
 	}
 
 	const void* PackedFile::GetFile(const char* pFilePath, size_t& sizeBytes)
+	{
+		u32 entry = FindEntry(pFilePath);
+		if (entry != kEmptySlot)
+		{
+			sizeBytes = m_pDirBlock[entry].dataSize;
+			return m_pDataBlock + m_pDirBlock[entry].offset;
+		}
+
+		sizeBytes = 0;
+		return nullptr;
+	}
+
+	u64 PackedFile::HashPath(const char* pPath)
+	{
+		u64 hash = 14695981039346656037ull;
+		for (const char* p = pPath; *p; ++p)
+		{
+			u8 c = (u8)*p;
+			if (c >= 'A' && c <= 'Z')
+			{
+				c = (u8)(c + ('a' - 'A'));
+			}
+			hash = (hash ^ c) * 1099511628211ull;
+		}
+		return hash;
+	}
+
+	// Mixes a seed into a path hash for the perfect hash (MurmurHash3 finaliser).
+	static u64 DisplacePathHash(u64 hash, u32 seed)
+	{
+		u64 h = hash ^ (seed * 0x9E3779B97F4A7C15ull);
+		h ^= h >> 33;
+		h *= 0xFF51AFD7ED558CCDull;
+		h ^= h >> 33;
+		h *= 0xC4CEB9FE1A85EC53ull;
+		h ^= h >> 33;
+		return h;
+	}
+
+	bool PackedFile::UseStoredIndex()
+	{
+		if (m_totalSizeBytes < sizeof(PackedFileHeader) + sizeof(PackedFileIndexFooter))
+		{
+			return false;
+		}
+
+		PackedFileIndexFooter footer;
+		memcpy(&footer, static_cast<const u8*>(m_pRawData) + m_totalSizeBytes - sizeof(footer), sizeof(footer));
+		const u64 indexEnd = m_totalSizeBytes - sizeof(footer);
+		if (footer.magic != PackedFileIndexFooter::kMagic || footer.slotCount == 0
+			|| (footer.slotCount & (footer.slotCount - 1)) != 0 || footer.slotCount < m_pHeader->dirEntryCount * 2
+			|| footer.slotsOffset % alignof(Slot) != 0 || footer.slotsOffset > indexEnd
+			|| footer.slotCount > (indexEnd - footer.slotsOffset) / sizeof(Slot))
+		{
+			return false;
+		}
+
+		// Checking the entries reads 16 bytes per slot, where hashing the paths would read the whole directory.
+		// No more slots may be used than there are entries, so at least half stay empty and every probe in FindEntry ends.
+		const Slot* pSlots = reinterpret_cast<const Slot*>(static_cast<const u8*>(m_pRawData) + footer.slotsOffset);
+		u64 usedSlots = 0;
+		for (size_t i = 0; i < footer.slotCount; ++i)
+		{
+			if (pSlots[i].entry == kEmptySlot)
+			{
+				continue;
+			}
+			if (pSlots[i].entry >= m_pHeader->dirEntryCount || ++usedSlots > m_pHeader->dirEntryCount)
+			{
+				return false;
+			}
+		}
+
+		m_pSlots = pSlots;
+		m_slotCount = (size_t)footer.slotCount;
+		return true;
+	}
+
+	void PackedFile::BuildIndex()
+	{
+		size_t slotCount = 1;
+		while (slotCount < m_pHeader->dirEntryCount * 2)
+		{
+			slotCount <<= 1;
+		}
+		const size_t mask = slotCount - 1;
+
+		// Entries go in directory order, so a duplicated path finds the first entry as the linear scan did.
+		m_slots.assign(slotCount, {0, kEmptySlot});
+		for (u32 i = 0; i < (u32)m_pHeader->dirEntryCount; ++i)
+		{
+			u64 hash = HashPath(m_pDirBlock[i].path);
+			size_t slot = hash & mask;
+			while (m_slots[slot].entry != kEmptySlot)
+			{
+				slot = (slot + 1) & mask;
+			}
+			m_slots[slot] = {hash, i};
+		}
+		m_pSlots = m_slots.data();
+		m_slotCount = m_slots.size();
+	}
+
+	bool PackedFile::BuildPerfectHash()
+	{
+		constexpr u32 kMaxSeed = 1 << 16;
+
+		// Buckets of about four entries take a seed each, placed largest first while the table is emptiest.
+		const u32 bucketCount = std::max(1u, ((u32)m_pHeader->dirEntryCount + 3) / 4);
+		std::vector<std::vector<Slot>> buckets(bucketCount);
+		for (size_t i = 0; i < m_slotCount; ++i)
+		{
+			const Slot& slot = m_pSlots[i];
+			if (slot.entry != kEmptySlot)
+			{
+				buckets[(slot.hash >> 32) % bucketCount].push_back(slot);
+			}
+		}
+		std::vector<u32> order(bucketCount);
+		for (u32 i = 0; i < bucketCount; ++i)
+		{
+			order[i] = i;
+		}
+		std::stable_sort(order.begin(), order.end(), [&buckets](u32 a, u32 b) { return buckets[a].size() > buckets[b].size(); });
+
+		const size_t mask = m_slotCount - 1;
+		std::vector<Slot> slots(m_slotCount, {0, kEmptySlot});
+		std::vector<u32> seeds(bucketCount, 0);
+		std::vector<size_t> placed;
+		for (u32 bucketIndex : order)
+		{
+			std::vector<Slot>& bucket = buckets[bucketIndex];
+			if (bucket.empty())
+			{
+				break;
+			}
+
+			// Keep only the first of a duplicated path, a real 64 bit collision can not be displaced.
+			std::sort(bucket.begin(), bucket.end(), [](const Slot& a, const Slot& b) { return a.hash < b.hash || (a.hash == b.hash && a.entry < b.entry); });
+			for (size_t i = 1; i < bucket.size();)
+			{
+				if (bucket[i].hash != bucket[i - 1].hash)
+				{
+					++i;
+				}
+				else if (_stricmp(m_pDirBlock[bucket[i].entry].path, m_pDirBlock[bucket[i - 1].entry].path) == 0)
+				{
+					bucket.erase(bucket.begin() + i);
+				}
+				else
+				{
+					return false;
+				}
+			}
+
+			u32 seed = 1;
+			for (; seed < kMaxSeed; ++seed)
+			{
+				placed.clear();
+				for (const Slot& slot : bucket)
+				{
+					size_t index = DisplacePathHash(slot.hash, seed) & mask;
+					if (slots[index].entry != kEmptySlot || std::find(placed.begin(), placed.end(), index) != placed.end())
+					{
+						break;
+					}
+					placed.push_back(index);
+				}
+				if (placed.size() == bucket.size())
+				{
+					break;
+				}
+			}
+			if (seed == kMaxSeed)
+			{
+				return false;
+			}
+
+			for (size_t i = 0; i < bucket.size(); ++i)
+			{
+				slots[placed[i]] = bucket[i];
+			}
+			seeds[bucketIndex] = seed;
+		}
+
+		m_slots.swap(slots);
+		m_seeds.swap(seeds);
+		m_pSlots = m_slots.data();
+		return true;
+	}
+
+	u32 PackedFile::FindEntry(const char* pFilePath) const
+	{
+		if (m_slotCount == 0)
+		{
+			return kEmptySlot;
+		}
+
+		const u64 hash = HashPath(pFilePath);
+		const size_t mask = m_slotCount - 1;
+		if (!m_seeds.empty())
+		{
+			const Slot& slot = m_pSlots[DisplacePathHash(hash, m_seeds[(hash >> 32) % m_seeds.size()]) & mask];
+			return slot.entry != kEmptySlot && slot.hash == hash && _stricmp(m_pDirBlock[slot.entry].path, pFilePath) == 0
+				? slot.entry
+				: kEmptySlot;
+		}
+
+		for (size_t i = hash & mask; m_pSlots[i].entry != kEmptySlot; i = (i + 1) & mask)
+		{
+			if (m_pSlots[i].hash == hash && _stricmp(m_pDirBlock[m_pSlots[i].entry].path, pFilePath) == 0)
+			{
+				return m_pSlots[i].entry;
+			}
+		}
+		return kEmptySlot;
+	}
+
+	// The scan every lookup used to do, kept as the baseline for BenchmarkLookups.
+	u32 PackedFile::FindEntryLinear(const char* pFilePath) const
 	{
 		for (size_t i = 0; i < m_pHeader->dirEntryCount; ++i)
 		{
 			if (_stricmp(m_pDirBlock[i].path, pFilePath) == 0)
 			{
-				sizeBytes = m_pDirBlock[i].dataSize;
-				return m_pDataBlock + m_pDirBlock[i].offset;
+				return (u32)i;
 			}
 		}
+		return kEmptySlot;
+	}
 
-		sizeBytes = 0;
-		return nullptr;
+	void PackedFileManager::BenchmarkLookups(u32 entryCount)
+	{
+		// A directory only pack, entry i is a file of 16 bytes at offset i * 16.
+		std::vector<u8> packData(sizeof(PackedFileHeader) + entryCount * sizeof(PackedFileEntry));
+		PackedFileHeader* pHeader = reinterpret_cast<PackedFileHeader*>(packData.data());
+		pHeader->dataBlockOffset = 0;
+		pHeader->dataBlockSize = (size_t)entryCount * 16;
+		pHeader->dirBlockOffset = sizeof(PackedFileHeader);
+		pHeader->dirEntryCount = entryCount;
+		PackedFileEntry* pEntries = reinterpret_cast<PackedFileEntry*>(packData.data() + sizeof(PackedFileHeader));
+		for (u32 i = 0; i < entryCount; ++i)
+		{
+			snprintf(pEntries[i].path, PackedFileEntry::PLAY_MAX_PATH_LENGTH, "Data/Models/Group%02u/Asset_%05u.p3dmesh", i % 37, i);
+			pEntries[i].offset = (size_t)i * 16;
+			pEntries[i].dataSize = 16;
+		}
+
+		// Every path once in a shuffled order and in upper case, plus as many misses.
+		std::vector<std::string> queries;
+		queries.reserve(entryCount * 2);
+		for (u32 i = 0; i < entryCount; ++i)
+		{
+			std::string path = pEntries[(i * 7919u) % entryCount].path;
+			std::transform(path.begin(), path.end(), path.begin(), [](char c) { return (char)toupper(c); });
+			queries.push_back(path);
+			queries.push_back(std::string("Data/Missing/File_") + std::to_string(i) + ".dds");
+		}
+
+		PackedFile probed(packData.data(), packData.size(), false, false);
+		PackedFile perfect(packData.data(), packData.size(), false, true);
+
+		LARGE_INTEGER frequency;
+		QueryPerformanceFrequency(&frequency);
+		auto timeLookups = [&](const char* name, auto find)
+		{
+			LARGE_INTEGER start, end;
+			u32 found = 0;
+			QueryPerformanceCounter(&start);
+			for (const std::string& query : queries)
+			{
+				found += find(query.c_str()) != PackedFile::kEmptySlot;
+			}
+			QueryPerformanceCounter(&end);
+			f64 ns = (f64)(end.QuadPart - start.QuadPart) * 1e9 / (f64)frequency.QuadPart / (f64)queries.size();
+			Debug::Printf("  %-8s %10.1f ns/lookup, %u found\n", name, ns, found);
+		};
+
+		Debug::Printf("Pack lookups over %u entries, %zu queries, perfect hash %s:\n",
+					  entryCount,
+					  queries.size(),
+					  perfect.HasPerfectHash() ? "built" : "not found");
+		timeLookups("linear", [&probed](const char* p) { return probed.FindEntryLinear(p); });
+		timeLookups("probed", [&probed](const char* p) { return probed.FindEntry(p); });
+		timeLookups("perfect", [&perfect](const char* p) { return perfect.FindEntry(p); });
 	}
 
 	const size_t PackedFile::GetNumberOfFilesInPackFile()
@@ -13125,6 +14806,374 @@ namespace Play3d::Packfile
 
 }
 
+//-------------------------------------------- System/IoService.cpp --------------------------------------------
+
+namespace Play3d::System
+{
+	//! @brief The IO threads behind ReadFileAsync.
+	//! Each thread issues blocking positional reads, so a few reads are in flight at once and the order they
+	//! start in follows the priority queues.
+	class IoService_Impl
+	{
+		PLAY_SINGLETON_INTERFACE(IoService_Impl);
+
+		IoService_Impl();
+		~IoService_Impl();
+
+	public:
+		//! Enough reads in flight to keep an SSD busy without competing with the loading threads.
+		static constexpr u32 kThreadCount = 2;
+		//! Reads are split into blocks of this size so cancelling a large read takes effect quickly.
+		static constexpr u32 kBlockSizeBytes = 1 << 20;
+
+		IoRequestId Submit(const IoRequestDesc& rDesc);
+		bool Cancel(IoRequestId id);
+		void SetPriority(IoRequestId id, IoPriority priority);
+		IoStatus GetStatus(IoRequestId id);
+		IoResult Wait(IoRequestId id);
+
+	private:
+		struct Request
+		{
+			IoRequestId id;
+			IoRequestDesc desc;
+			IoResult result;
+			std::atomic<bool> bCancel = false;
+		};
+		using RequestPtr = std::shared_ptr<Request>;
+
+		void WorkerMain();
+		static IoResult Execute(const Request& rRequest);
+		void Complete(const RequestPtr& pRequest, const IoResult& rResult);
+		bool RemoveQueued(const RequestPtr& pRequest);
+
+		std::vector<std::thread> m_threads;
+		std::mutex m_mutex;
+		std::condition_variable m_readReady;
+		std::condition_variable m_readDone;
+		std::deque<RequestPtr> m_queues[(u32)IoPriority::kCount];
+		std::unordered_map<u64, RequestPtr> m_requests;
+		u64 m_nextId = 0;
+		bool m_bQuit = false;
+	};
+
+	PLAY_SINGLETON_IMPL(IoService_Impl);
+
+	IoService_Impl::IoService_Impl()
+	{
+		for (u32 i = 0; i < kThreadCount; ++i)
+		{
+			m_threads.emplace_back(&IoService_Impl::WorkerMain, this);
+		}
+	}
+
+	IoService_Impl::~IoService_Impl()
+	{
+		// In-flight reads stop at their next block, queued ones are reported as cancelled.
+		std::vector<RequestPtr> queued;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_bQuit = true;
+			for (auto& [id, pRequest] : m_requests)
+			{
+				pRequest->bCancel = true;
+			}
+			for (std::deque<RequestPtr>& queue : m_queues)
+			{
+				queued.insert(queued.end(), queue.begin(), queue.end());
+				queue.clear();
+			}
+		}
+		m_readReady.notify_all();
+		for (std::thread& thread : m_threads)
+		{
+			thread.join();
+		}
+		for (const RequestPtr& pRequest : queued)
+		{
+			Complete(pRequest, IoResult{IoStatus::kCancelled});
+		}
+	}
+
+	void IoService_Impl::WorkerMain()
+	{
+		for (;;)
+		{
+			RequestPtr pRequest;
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_readReady.wait(lock,
+								 [this]()
+								 {
+									 return m_bQuit
+											|| std::any_of(std::begin(m_queues),
+														   std::end(m_queues),
+														   [](const std::deque<RequestPtr>& queue) { return !queue.empty(); });
+								 });
+				if (m_bQuit)
+				{
+					break;
+				}
+				for (u32 i = (u32)IoPriority::kCount; i-- > 0;)
+				{
+					if (!m_queues[i].empty())
+					{
+						pRequest = std::move(m_queues[i].front());
+						m_queues[i].pop_front();
+						break;
+					}
+				}
+			}
+
+			Complete(pRequest, Execute(*pRequest));
+		}
+	}
+
+	IoResult IoService_Impl::Execute(const Request& rRequest)
+	{
+		const IoRequestDesc& rDesc(rRequest.desc);
+		IoResult result{IoStatus::kFailed};
+
+		size_t packSizeBytes = 0;
+		const u8* pPacked =
+			static_cast<const u8*>(Packfile::PackedFileManager::Instance().FindFile(rDesc.filePath.c_str(), packSizeBytes));
+
+		u64 fileSizeBytes = packSizeBytes;
+		HANDLE hFile = INVALID_HANDLE_VALUE;
+		if (!pPacked)
+		{
+			hFile = CreateFileA(rDesc.filePath.c_str(),
+								GENERIC_READ,
+								FILE_SHARE_READ | FILE_SHARE_WRITE,
+								NULL,
+								OPEN_EXISTING,
+								FILE_ATTRIBUTE_NORMAL,
+								NULL);
+			LARGE_INTEGER size;
+			if (hFile == INVALID_HANDLE_VALUE || !GetFileSizeEx(hFile, &size))
+			{
+				Debug::Printf("ERROR: ReadFileAsync could not open '%s'\n", rDesc.filePath.c_str());
+				if (hFile != INVALID_HANDLE_VALUE)
+				{
+					CloseHandle(hFile);
+				}
+				return result;
+			}
+			fileSizeBytes = (u64)size.QuadPart;
+		}
+
+		if (rDesc.offset > fileSizeBytes)
+		{
+			Debug::Printf("ERROR: ReadFileAsync offset %llu is past the end of '%s'\n", rDesc.offset, rDesc.filePath.c_str());
+			if (hFile != INVALID_HANDLE_VALUE)
+			{
+				CloseHandle(hFile);
+			}
+			return result;
+		}
+		size_t sizeBytes = (size_t)std::min(rDesc.sizeBytes, fileSizeBytes - rDesc.offset);
+
+		// Without a destination the range is returned in place from a pack, or read into a buffer padded like
+		// LoadFileData's so ReleaseFileData frees it.
+		u8* pBuffer = static_cast<u8*>(rDesc.pDestination);
+		if (pBuffer && rDesc.destinationSizeBytes < sizeBytes)
+		{
+			Debug::Printf("ERROR: ReadFileAsync destination is too small for %zu bytes of '%s'\n",
+						  sizeBytes,
+						  rDesc.filePath.c_str());
+			if (hFile != INVALID_HANDLE_VALUE)
+			{
+				CloseHandle(hFile);
+			}
+			return result;
+		}
+		if (pPacked)
+		{
+			if (pBuffer)
+			{
+				memcpy(pBuffer, pPacked + rDesc.offset, sizeBytes);
+			}
+			result.pData = pBuffer ? pBuffer : pPacked + rDesc.offset;
+			result.sizeBytes = sizeBytes;
+			result.status = IoStatus::kComplete;
+			return result;
+		}
+
+		const bool bOwnsBuffer = !pBuffer;
+		if (bOwnsBuffer)
+		{
+			constexpr u32 kPadding = 16;
+			pBuffer = (u8*)_aligned_malloc(sizeBytes + kPadding, 16);
+			PLAY_ASSERT(pBuffer);
+			memset(pBuffer + sizeBytes, 0, kPadding);
+		}
+
+		result.status = IoStatus::kComplete;
+		for (size_t readBytes = 0; readBytes < sizeBytes;)
+		{
+			if (rRequest.bCancel)
+			{
+				result.status = IoStatus::kCancelled;
+				break;
+			}
+
+			u64 offset = rDesc.offset + readBytes;
+			OVERLAPPED overlapped{};
+			overlapped.Offset = (DWORD)offset;
+			overlapped.OffsetHigh = (DWORD)(offset >> 32);
+
+			DWORD blockBytes = (DWORD)std::min<size_t>(kBlockSizeBytes, sizeBytes - readBytes);
+			DWORD bytesRead = 0;
+			if (!ReadFile(hFile, pBuffer + readBytes, blockBytes, &bytesRead, &overlapped) || bytesRead != blockBytes)
+			{
+				Debug::Printf("ERROR: ReadFileAsync failed reading '%s'\n", rDesc.filePath.c_str());
+				result.status = IoStatus::kFailed;
+				break;
+			}
+			readBytes += bytesRead;
+		}
+		CloseHandle(hFile);
+
+		if (result.status != IoStatus::kComplete)
+		{
+			if (bOwnsBuffer)
+			{
+				_aligned_free(pBuffer);
+			}
+			return result;
+		}
+		result.pData = pBuffer;
+		result.sizeBytes = sizeBytes;
+		return result;
+	}
+
+	void IoService_Impl::Complete(const RequestPtr& pRequest, const IoResult& rResult)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			pRequest->result = rResult;
+		}
+
+		// Without a callback the record stays until Wait hands the result over.
+		if (pRequest->desc.callback)
+		{
+			pRequest->desc.callback(rResult);
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_requests.erase(pRequest->id.GetValue());
+			return;
+		}
+		m_readDone.notify_all();
+	}
+
+	bool IoService_Impl::RemoveQueued(const RequestPtr& pRequest)
+	{
+		std::deque<RequestPtr>& rQueue(m_queues[(u32)pRequest->desc.priority]);
+		auto it = std::find(rQueue.begin(), rQueue.end(), pRequest);
+		if (it == rQueue.end())
+		{
+			return false;
+		}
+		rQueue.erase(it);
+		return true;
+	}
+
+	IoRequestId IoService_Impl::Submit(const IoRequestDesc& rDesc)
+	{
+		auto pRequest = std::make_shared<Request>();
+		pRequest->desc = rDesc;
+		pRequest->result.status = IoStatus::kPending;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			pRequest->id = IoRequestId(m_nextId++);
+			m_requests.emplace(pRequest->id.GetValue(), pRequest);
+			m_queues[(u32)rDesc.priority].push_back(pRequest);
+		}
+		m_readReady.notify_one();
+		return pRequest->id;
+	}
+
+	bool IoService_Impl::Cancel(IoRequestId id)
+	{
+		RequestPtr pRequest;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			auto it = m_requests.find(id.GetValue());
+			if (it == m_requests.end() || it->second->result.status != IoStatus::kPending)
+			{
+				return false;
+			}
+			it->second->bCancel = true;
+			if (!RemoveQueued(it->second))
+			{
+				return true;
+			}
+			pRequest = it->second;
+		}
+
+		// It never reached an IO thread so it completes here.
+		Complete(pRequest, IoResult{IoStatus::kCancelled});
+		return true;
+	}
+
+	void IoService_Impl::SetPriority(IoRequestId id, IoPriority priority)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto it = m_requests.find(id.GetValue());
+		if (it != m_requests.end() && it->second->desc.priority != priority && RemoveQueued(it->second))
+		{
+			it->second->desc.priority = priority;
+			m_queues[(u32)priority].push_back(it->second);
+		}
+	}
+
+	IoStatus IoService_Impl::GetStatus(IoRequestId id)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto it = m_requests.find(id.GetValue());
+		return it != m_requests.end() ? it->second->result.status : IoStatus::kInvalid;
+	}
+
+	IoResult IoService_Impl::Wait(IoRequestId id)
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		auto it = m_requests.find(id.GetValue());
+		if (it == m_requests.end())
+		{
+			return IoResult();
+		}
+		PLAY_ASSERT_MSG(!it->second->desc.callback, "WaitForRead on a read that has a callback.");
+		RequestPtr pRequest = it->second;
+		m_readDone.wait(lock, [&pRequest]() { return pRequest->result.status != IoStatus::kPending; });
+		m_requests.erase(id.GetValue());
+		return pRequest->result;
+	}
+
+	IoRequestId ReadFileAsync(const IoRequestDesc& rDesc)
+	{
+		return IoService_Impl::Instance().Submit(rDesc);
+	}
+
+	bool CancelRead(IoRequestId id)
+	{
+		return IoService_Impl::Instance().Cancel(id);
+	}
+
+	void SetReadPriority(IoRequestId id, IoPriority priority)
+	{
+		IoService_Impl::Instance().SetPriority(id, priority);
+	}
+
+	IoStatus GetReadStatus(IoRequestId id)
+	{
+		return IoService_Impl::Instance().GetStatus(id);
+	}
+
+	IoResult WaitForRead(IoRequestId id)
+	{
+		return IoService_Impl::Instance().Wait(id);
+	}
+}
+
 //-------------------------------------------- System/SystemApi.cpp --------------------------------------------
 
 namespace Play3d::System
@@ -13189,6 +15238,8 @@ namespace Play3d::System
 			SystemImpl::ms_pInstance = new SystemImpl;
 
 			Packfile::PackedFileManager::Initialise();
+			IoService_Impl::Initialise();
+			Resources::AsyncLoader_Impl::Initialise();
 
 			Graphics::Graphics_Impl::Initialise(rDesc);
 			Input::Input_Impl::Initialise();
@@ -13198,6 +15249,7 @@ namespace Play3d::System
 			UI::FontRenderSystem::Initialise();
 			Sprite::SpriteRenderSystem::Initialise();
 			UI::UI_Impl::Initialise();
+			Graphics::ResourceCache_Impl::Initialise();
 
 			auto& rGraphicsImpl(Graphics::Graphics_Impl::Instance());
 			rGraphicsImpl.PostInitialise();
@@ -13225,6 +15277,9 @@ namespace Play3d::System
 
 		UI::UI_Impl::Instance().BeginFrame();
 
+		// Resources created by background loads appear at the start of a frame.
+		Resources::UpdateAsyncLoading();
+
 		return RESULT_OK;
 	}
 
@@ -13249,7 +15304,11 @@ namespace Play3d::System
 	{
 		if (SystemImpl::ms_pInstance)
 		{
+			// Reads still in flight hand their results to the loader, so the IO threads stop first.
+			IoService_Impl::Destroy();
+			Resources::AsyncLoader_Impl::Destroy();
 			Graphics::Graphics_Impl::Instance().Flush();
+			Graphics::ResourceCache_Impl::Destroy();
 
 			Resources::ResourceManager<UI::Font>::Instance().ReleaseAll();
 			Resources::ResourceManager<Graphics::Mesh>::Instance().ReleaseAll();
@@ -13375,10 +15434,61 @@ namespace Play3d::System
 			_aligned_free(const_cast<void*>(pMemory));
 		}
 	}
-	void AddPackFile(const char* filePath)
+
+	const void* MapFileData(const char* filePath, size_t& sizeOut)
+	{
+		sizeOut = 0;
+		const void* pMemoryRet = Packfile::PackedFileManager::Instance().FindFile(filePath, sizeOut);
+		if (pMemoryRet != nullptr)
+		{
+			Debug::Printf("System::MapFileData: From Pack: %s\n", filePath);
+			return pMemoryRet;
+		}
+
+		Debug::Printf("System::MapFileData: From Disk: %s\n", filePath);
+
+		HANDLE hFile = CreateFileA(filePath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+		if (hFile == INVALID_HANDLE_VALUE)
+		{
+			Debug::Printf("ERROR: File does not exist! path='%s'\n", filePath);
+			return nullptr;
+		}
+
+		LARGE_INTEGER size;
+		if (GetFileSizeEx(hFile, &size) && size.QuadPart > 0)
+		{
+			// The view holds its own reference to the mapping, so both handles can go now.
+			HANDLE hMapping = CreateFileMappingA(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+			if (hMapping)
+			{
+				pMemoryRet = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+				if (pMemoryRet)
+				{
+					sizeOut = (size_t)size.QuadPart;
+				}
+				CloseHandle(hMapping);
+			}
+		}
+		CloseHandle(hFile);
+		return pMemoryRet;
+	}
+
+	void UnmapFileData(const void* pMemory)
+	{
+		if (Packfile::PackedFileManager::Instance().CheckPointerIsInPack(pMemory))
+		{
+			return;
+		}
+
+		if (pMemory)
+		{
+			UnmapViewOfFile(pMemory);
+		}
+	}
+	void AddPackFile(const char* filePath, bool bPerfectHash)
 	{
 
-		Packfile::PackedFileManager::Instance().AddPackFile(filePath);
+		Packfile::PackedFileManager::Instance().AddPackFile(filePath, bPerfectHash);
 	}
 }
 
@@ -2,6 +2,13 @@
 #include "Types.h"
 #include "Assets.h"
 #include "AssetManager.h"
+#include "Utilities/MeshOptimiser.h"
+#include "Utilities/MeshSimplifier.h"
+#include "Utilities/VertexCompression.h"
+#include "Utilities/TextureStreamer.h"
+#include <chrono>
+#include <memory>
+#include <psapi.h>
 
 
 
@@ -17,15 +24,99 @@ AssetManager::~AssetManager()
 
 }
 
+// A mesh read and processed on a loading thread, waiting for its buffers. The spans point either into the buffers
+// or into the reader's mapped file, so the reader stays open until CreateMesh.
+struct AssetManager::MeshData
+{
+	const char* path = nullptr;
+	bool bGenerateLods = false;
+	bool bCompactVertices = false;
+	bool bSkinned = false;
+	f32 readMs = 0.f;
+	size_t copiedBytes = 0;
+	u32 vertexCount = 0;
+	std::unique_ptr< System::ChunkFileReader > pReader;
+
+	// Only hold data when it has to be processed, or when a chunk is not aligned in the file.
+	std::vector< Vector3f > positionBuffer;
+	std::vector< u32 > colourBuffer;
+	std::vector< Vector3f > normalBuffer;
+	std::vector< Vector2f > uvBuffer;
+	std::vector< u32 > indexBuffer;
+	std::vector< Graphics::SubmeshDesc > submeshBuffer;
+	std::vector< Graphics::MeshMaterialInfo > materialInfoBuffer;
+	std::vector< MeshSimplifier::LodRange > lodBuffer;
+	std::vector< VertexCompression::QuantisedPosition > compactPositionBuffer;
+	std::vector< VertexCompression::OctNormal > compactNormalBuffer;
+	std::vector< VertexCompression::HalfUV > compactUVBuffer;
+	std::vector< Vector3f > positionBoundsBuffer;
+
+	std::span< const Vector3f > positions;
+	std::span< const u32 > colours;
+	std::span< const Vector3f > normals;
+	std::span< const Vector2f > uvs;
+	std::span< const u32 > indices;
+	std::span< const Graphics::SubmeshDesc > submeshes;
+	std::span< const Graphics::MeshMaterialInfo > materialInfos;
+	std::span< const MeshSimplifier::LodRange > lods;
+	std::span< const VertexCompression::QuantisedPosition > compactPositions;
+	std::span< const VertexCompression::OctNormal > compactNormals;
+	std::span< const VertexCompression::HalfUV > compactUVs;
+	std::span< const Vector3f > positionBounds;
+};
+
 void AssetManager::LoadGameAssets()
 {
+	BeginLoadGameAssets();
+	Resources::WaitForAssets( m_loadingTask );
+	FinishLoadGameAssets();
+}
+
+void AssetManager::BeginLoadGameAssets()
+{
+	m_meshLoadStats = MeshLoadStats();
+	m_peakWorkingSetBefore = GetPeakWorkingSet();
+	m_loadStart = std::chrono::high_resolution_clock::now();
+	m_loadingTask = Resources::CreateAsyncLoadingTask();
+
+	for ( int i = 0; i < static_cast< int >(AssetType::TOTAL_ASSETS); i++ )
+	{
+		std::shared_ptr< MeshData > pMesh = std::make_shared< MeshData >();
+		pMesh->path = g_vAssetMeshPaths[ i ];
+		pMesh->bGenerateLods = g_vAssetGenerateLods[ i ];
+		// The laser's self illumination shader only reads full vertices.
+		pMesh->bCompactVertices = kCompactVerticesAtLoad && i != static_cast< int >(AssetType::TYPE_LASER);
+		Resources::AddAsyncLoad( m_loadingTask, [ pMesh ]() { ReadMesh( *pMesh ); }, [ this, pMesh, i ]() { m_assetList[ i ].mesh = CreateMesh( *pMesh ); } );
+
+		if ( i != static_cast< int >(AssetType::TYPE_LASER) )
+		{
+			// Slots sharing a file get the one texture. Cooked ones start with their small mips and stream the rest.
+			TextureStreamer::Instance().AsyncLoadTexture( m_loadingTask, &m_assetTextures[ i ][ 0 ], g_vAssetColourPaths[ i ] );
+			TextureStreamer::Instance().AsyncLoadTexture( m_loadingTask, &m_assetTextures[ i ][ 1 ], g_vAssetNormalPaths[ i ] );
+			TextureStreamer::Instance().AsyncLoadTexture( m_loadingTask, &m_assetTextures[ i ][ 2 ], g_vAssetORMPaths[ i ] );
+		}
+	}
+
+	for ( int i = 0; i < static_cast< int >(ParticleType::TOTAL_PARTICLE_TYPES); i++ )
+	{
+		Graphics::AsyncAcquireTextureFromFile( m_loadingTask, &m_particleTextures[ i ], g_vParticleSpritePaths[ i ] );
+	}
+}
+
+bool AssetManager::FinishLoadGameAssets()
+{
+	if ( !IsLoading() ) return true;
+	if ( !Resources::AssetsLoaded( m_loadingTask ) ) return false;
+
+	// Materials compile their shaders here, on the owning thread, once every texture they bind exists.
 	LoadParticles();
 	LoadDebugSphereMaterial();
 
 	for ( int i = 0; i < static_cast< int >(AssetType::TOTAL_ASSETS); i++ )
 	{
-		MeshId mesh = Graphics::CreateMeshFromAssetFile(g_vAssetMeshPaths[ i ]);
+		MeshId mesh = m_assetList[ i ].mesh;
 		MaterialId material;
+		MaterialId instancedMaterial;
 
 		if ( i != static_cast< int >(AssetType::TYPE_LASER) ) 
 		{
@@ -37,13 +128,22 @@ void AssetManager::LoadGameAssets()
 				matDesc.m_constants.metalness = 1.0f; // Multiplier for texture based metal/roughness
 				matDesc.m_constants.roughness = 1.0f;
 				matDesc.m_lightCount = kNumLights;
+				// A mesh that failed to load has no buffers, its material keeps the full vertex layout.
+				const Graphics::Mesh* pMesh = Resources::GetPtr( mesh );
+				matDesc.m_bCompactVertices = pMesh && pMesh->HasCompactVertices();
 
-				matDesc.m_texture[ 0 ] = Graphics::CreateTextureFromFile(g_vAssetColourPaths[ i ]);
-				matDesc.m_texture[ 1 ] = Graphics::CreateTextureFromFile(g_vAssetNormalPaths[ i ]);
-				matDesc.m_texture[ 2 ] = Graphics::CreateTextureFromFile(g_vAssetORMPaths[ i ]);
-				matDesc.m_sampler[ 0 ] = matDesc.m_sampler[ 1 ] = matDesc.m_sampler[ 2 ] = Graphics::CreateLinearSampler();
+				matDesc.m_texture[ 0 ] = m_assetTextures[ i ][ 0 ];
+				matDesc.m_texture[ 1 ] = m_assetTextures[ i ][ 1 ];
+				matDesc.m_texture[ 2 ] = m_assetTextures[ i ][ 2 ];
+				matDesc.m_sampler[ 0 ] = Graphics::AcquireSampler( Graphics::SamplerDesc() );
+				matDesc.m_sampler[ 1 ] = Graphics::AcquireSampler( Graphics::SamplerDesc() );
+				matDesc.m_sampler[ 2 ] = Graphics::AcquireSampler( Graphics::SamplerDesc() );
 			}
 			material = Resources::CreateAsset< Material >(matDesc);
+			TextureStreamer::Instance().AddMaterial( material, m_assetTextures[ i ], 3 );
+
+			matDesc.m_bInstancing = true;
+			instancedMaterial = Resources::CreateAsset< Material >(matDesc);
 		}
 		else
 		{
@@ -54,10 +154,252 @@ void AssetManager::LoadGameAssets()
 				matDesc.m_state.m_fillMode = Graphics::FillMode::SOLID;
 			}
 			material = Resources::CreateAsset< Material >(matDesc);
+
+			ComplexDesc instancedDesc;
+			{
+				instancedDesc.SetupFromHLSLFile( "SelfIlluminationInstanced", g_vShaderPaths[ static_cast< int >(ShaderType::SELF_ILLUMINATE_INSTANCED) ]);
+				instancedDesc.m_state.m_cullMode = Graphics::CullMode::BACK;
+				instancedDesc.m_state.m_fillMode = Graphics::FillMode::SOLID;
+			}
+			instancedMaterial = Resources::CreateAsset< Material >(instancedDesc);
 		}
 
-		m_assetList[ i ] = Asset(mesh, material);
+		m_assetList[ i ] = Asset(mesh, material, instancedMaterial);
+	}
+
+	const f32 totalMs = std::chrono::duration< f32, std::milli >( std::chrono::high_resolution_clock::now() - m_loadStart ).count();
+	m_meshLoadStats.peakWorkingSetGrowth = GetPeakWorkingSet() - m_peakWorkingSetBefore;
+	Debug::Printf( "Assets: %u loads in %.2fms\n", Resources::GetPtr( m_loadingTask )->GetLoadCount(), totalMs );
+	Debug::Printf( "Meshes: %u read in %.2fms on the loading threads, buffers created in %.2fms (mapped %s), %zu KB of files, %zu KB copied, peak staging %zu KB, peak working set +%zu KB\n",
+		m_meshLoadStats.meshCount, m_meshLoadStats.readMs, m_meshLoadStats.createMs, kMapMeshFiles ? "on" : "off", m_meshLoadStats.fileBytes / 1024,
+		m_meshLoadStats.copiedBytes / 1024, m_meshLoadStats.peakStagingBytes / 1024, m_meshLoadStats.peakWorkingSetGrowth / 1024 );
+	Graphics::PrintResourceCacheStats();
+
+	Resources::ReleaseAsyncLoadingTask( m_loadingTask );
+	m_loadingTask.Invalidate();
+	return true;
+}
+
+// The peak includes textures and shaders loaded alongside, so compare runs with kMapMeshFiles on and off.
+size_t AssetManager::GetPeakWorkingSet()
+{
+	PROCESS_MEMORY_COUNTERS counters = {};
+	GetProcessMemoryInfo( GetCurrentProcess(), &counters, sizeof( counters ) );
+	return counters.PeakWorkingSetSize;
+}
+
+namespace
+{
+	// Copies a viewed chunk into its vector so it can be processed in place. View may have filled it already.
+	template< typename T >
+	void CopyOut( std::span< const T >& view, std::vector< T >& buffer, size_t& copiedBytes )
+	{
+		if ( view.data() != buffer.data() ) buffer.assign( view.begin(), view.end() );
+		copiedBytes += buffer.size() * sizeof( T );
+		view = buffer;
+	}
+}
+
+// Reads a p3dmesh as CreateMeshFromAssetFile does, optionally with LODs appended to its index buffer as submeshes,
+// reorders it for the GPU and compacts its vertices. Cooked files carry all of this already, so their chunks go from
+// the mapped file to the GPU buffers without being copied. Runs on a loading thread, so it only touches mesh.
+void AssetManager::ReadMesh( MeshData& mesh )
+{
+	auto start = std::chrono::high_resolution_clock::now();
+	mesh.pReader = std::make_unique< System::ChunkFileReader >( mesh.path, kMapMeshFiles );
+	System::ChunkFileReader& reader = *mesh.pReader;
+	if ( !reader.IsGood() || reader.GetSubtype() != System::AssetFormatId::kMesh ) return;
+
+	// Skinned meshes carry extra streams, leave those to Play3d.
+	if ( reader.HasChunk( System::AssetFormatId::kJointIndices ) )
+	{
+		mesh.bSkinned = true;
+		return;
+	}
+
+	mesh.positions = reader.View( System::AssetFormatId::kPosition, mesh.positionBuffer );
+	mesh.normals = reader.View( System::AssetFormatId::kNormal, mesh.normalBuffer );
+	mesh.uvs = reader.View( System::AssetFormatId::kUV0, mesh.uvBuffer );
+	mesh.compactPositions = reader.View( System::AssetFormatId::kPositionQuantised, mesh.compactPositionBuffer );
+	mesh.positionBounds = reader.View( System::AssetFormatId::kPositionBounds, mesh.positionBoundsBuffer );
+	mesh.compactNormals = reader.View( System::AssetFormatId::kNormalOct, mesh.compactNormalBuffer );
+	mesh.compactUVs = reader.View( System::AssetFormatId::kUV0Half, mesh.compactUVBuffer );
+	mesh.colours = reader.View( System::AssetFormatId::kColour, mesh.colourBuffer );
+	mesh.indices = reader.View( System::AssetFormatId::kIndex, mesh.indexBuffer );
+	mesh.submeshes = reader.View( System::AssetFormatId::kSubmesh, mesh.submeshBuffer );
+	mesh.materialInfos = reader.View( System::AssetFormatId::kMaterial, mesh.materialInfoBuffer );
+	mesh.lods = reader.View( MeshSimplifier::kLodChunkId, mesh.lodBuffer );
+	const bool bOptimised = reader.HasChunk( MeshOptimiser::kOptimisedChunkId );
+
+	// Simplifying and reordering need full positions, a compact file only gets what it was cooked with.
+	const bool bCooked = !mesh.compactPositions.empty();
+	const u32 vertexCount = static_cast< u32 >(bCooked ? mesh.compactPositions.size() : mesh.positions.size());
+	const bool bBuildLods = mesh.bGenerateLods && mesh.lods.empty() && !bCooked;
+	const bool bOptimise = kOptimiseMeshesAtLoad && !bOptimised && !bCooked;
+	// Every vertex needs a normal and a uv to compact, a mesh missing either keeps its full streams.
+	const bool bCompact = mesh.bCompactVertices && !bCooked && vertexCount > 0 && mesh.normals.size() == vertexCount && mesh.uvs.size() == vertexCount;
+	mesh.vertexCount = vertexCount;
+
+	if ( bBuildLods || bOptimise || bCompact || !kMapMeshFiles )
+	{
+		CopyOut( mesh.positions, mesh.positionBuffer, mesh.copiedBytes );
+		CopyOut( mesh.colours, mesh.colourBuffer, mesh.copiedBytes );
+		CopyOut( mesh.normals, mesh.normalBuffer, mesh.copiedBytes );
+		CopyOut( mesh.uvs, mesh.uvBuffer, mesh.copiedBytes );
+		CopyOut( mesh.indices, mesh.indexBuffer, mesh.copiedBytes );
+		CopyOut( mesh.compactPositions, mesh.compactPositionBuffer, mesh.copiedBytes );
+		CopyOut( mesh.compactNormals, mesh.compactNormalBuffer, mesh.copiedBytes );
+		CopyOut( mesh.compactUVs, mesh.compactUVBuffer, mesh.copiedBytes );
+	}
+
+	std::vector< Vector3f >& positionBuffer = mesh.positionBuffer;
+	std::vector< u32 >& indexBuffer = mesh.indexBuffer;
+	if ( bBuildLods )
+	{
+		std::vector< u32 > sourceIndices;
+		sourceIndices.swap( indexBuffer );
+		MeshSimplifier::BuildLodChain( &positionBuffer[ 0 ].x, vertexCount, sizeof( Vector3f ),
+			sourceIndices.data(), static_cast< u32 >(sourceIndices.size()), MeshSimplifier::kLodRatios, static_cast< u32 >(std::size( MeshSimplifier::kLodRatios )),
+			indexBuffer, mesh.lodBuffer );
+		mesh.indices = indexBuffer;
+		mesh.lods = mesh.lodBuffer;
+	}
+
+	if ( !mesh.lods.empty() )
+	{
+		// The project draws each mesh with one material, so a LOD covers all of the source submeshes.
+		mesh.submeshBuffer.clear();
+		for ( const MeshSimplifier::LodRange& lod : mesh.lods )
+		{
+			mesh.submeshBuffer.push_back( { 0, lod.indexOffset, lod.indexCount } );
+		}
+		mesh.submeshes = mesh.submeshBuffer;
+	}
+	else if ( mesh.submeshes.empty() )
+	{
+		mesh.submeshBuffer.push_back( { 0, 0, static_cast< u32 >(mesh.indices.size()) } );
+		mesh.submeshes = mesh.submeshBuffer;
+	}
+
+	if ( bOptimise )
+	{
+		MeshOptimiser::OptimiseStats stats;
+		stats.before = MeshOptimiser::AnalyseVertexCache( indexBuffer.data(), mesh.submeshes[ 0 ].m_elementSize, vertexCount );
+
+		// Each submesh is drawn on its own, so each is ordered on its own.
+		for ( const Graphics::SubmeshDesc& submesh : mesh.submeshes )
+		{
+			u32* pIndices = indexBuffer.data() + submesh.m_elementOffset;
+			MeshOptimiser::OptimiseVertexCache( pIndices, submesh.m_elementSize, vertexCount );
+			MeshOptimiser::OptimiseOverdraw( pIndices, submesh.m_elementSize, &positionBuffer[ 0 ].x, vertexCount, sizeof( Vector3f ) );
+		}
+
+		std::vector< u32 > remap;
+		MeshOptimiser::OptimiseVertexFetch( indexBuffer.data(), static_cast< u32 >(indexBuffer.size()), vertexCount, remap );
+		MeshOptimiser::RemapVertexStream( positionBuffer, remap );
+		MeshOptimiser::RemapVertexStream( mesh.colourBuffer, remap );
+		MeshOptimiser::RemapVertexStream( mesh.normalBuffer, remap );
+		MeshOptimiser::RemapVertexStream( mesh.uvBuffer, remap );
+		mesh.positions = positionBuffer;
+		mesh.colours = mesh.colourBuffer;
+		mesh.normals = mesh.normalBuffer;
+		mesh.uvs = mesh.uvBuffer;
+
+		stats.after = MeshOptimiser::AnalyseVertexCache( indexBuffer.data(), mesh.submeshes[ 0 ].m_elementSize, vertexCount );
+		Debug::Printf( "%s ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n", mesh.path, stats.before.acmr, stats.after.acmr, stats.before.atvr, stats.after.atvr );
+	}
+
+	if ( bCompact )
+	{
+		f32 bounds[ 6 ];
+		VertexCompression::QuantisePositions( &positionBuffer[ 0 ].x, vertexCount, sizeof( Vector3f ), mesh.compactPositionBuffer, bounds );
+		VertexCompression::EncodeNormals( &mesh.normalBuffer[ 0 ].x, vertexCount, sizeof( Vector3f ), mesh.compactNormalBuffer );
+		VertexCompression::EncodeUVs( &mesh.uvBuffer[ 0 ].x, vertexCount, sizeof( Vector2f ), mesh.compactUVBuffer );
+		mesh.positionBoundsBuffer = { Vector3f( bounds[ 0 ], bounds[ 1 ], bounds[ 2 ] ), Vector3f( bounds[ 3 ], bounds[ 4 ], bounds[ 5 ] ) };
+		mesh.compactPositions = mesh.compactPositionBuffer;
+		mesh.compactNormals = mesh.compactNormalBuffer;
+		mesh.compactUVs = mesh.compactUVBuffer;
+		mesh.positionBounds = mesh.positionBoundsBuffer;
+	}
+
+	mesh.readMs = std::chrono::duration< f32, std::milli >( std::chrono::high_resolution_clock::now() - start ).count();
+}
+
+// Creates the buffers of a mesh ReadMesh has finished with, on the owning thread.
+AssetManager::MeshId AssetManager::CreateMesh( MeshData& mesh )
+{
+	static const u32 kWhite = 0xffffffff;
+
+	if ( mesh.bSkinned )
+	{
+		mesh.pReader.reset();
+		return Graphics::CreateMeshFromAssetFile( mesh.path );
+	}
+	if ( mesh.vertexCount == 0 ) return MeshId();
+
+	auto start = std::chrono::high_resolution_clock::now();
+	Graphics::MeshDesc desc;
+	std::vector< Graphics::StreamInfo > streamInfos;
+	std::span< const u32 > colours = mesh.colours;
+	if ( !mesh.compactPositions.empty() )
+	{
+		// A uniform colour stream shrinks to the one colour every vertex reads.
+		if ( colours.empty() ) colours = { &kWhite, 1 };
+		if ( VertexCompression::IsUniform( colours.data(), static_cast< u32 >(colours.size()) ) ) colours = colours.first( 1 );
+
+		desc.m_bCompactVertices = true;
+		desc.m_positionOffset = mesh.positionBounds[ 0 ];
+		desc.m_positionScale = mesh.positionBounds[ 1 ] - mesh.positionBounds[ 0 ];
+		streamInfos.push_back( Graphics::StreamInfo::Create( Graphics::StreamType::POSITION, mesh.compactPositions ) );
+		streamInfos.push_back( Graphics::StreamInfo::Create( Graphics::StreamType::COLOUR, colours ) );
+		streamInfos.push_back( Graphics::StreamInfo::Create( Graphics::StreamType::NORMAL, mesh.compactNormals ) );
+		streamInfos.push_back( Graphics::StreamInfo::Create( Graphics::StreamType::UV, mesh.compactUVs ) );
+	}
+	else
+	{
+		streamInfos.push_back( Graphics::StreamInfo::Create( Graphics::StreamType::POSITION, mesh.positions ) );
+		streamInfos.push_back( Graphics::StreamInfo::Create( Graphics::StreamType::COLOUR, colours ) );
+		streamInfos.push_back( Graphics::StreamInfo::Create( Graphics::StreamType::NORMAL, mesh.normals ) );
+		streamInfos.push_back( Graphics::StreamInfo::Create( Graphics::StreamType::UV, mesh.uvs ) );
+	}
+	streamInfos.push_back( Graphics::StreamInfo::Create( Graphics::StreamType::INDEX, mesh.indices ) );
+
+	desc.m_pStreams = streamInfos.data();
+	desc.m_streamCount = static_cast< u32 >(streamInfos.size());
+	desc.m_vertexCount = mesh.vertexCount;
+	desc.m_indexCount = mesh.lods.empty() ? static_cast< u32 >(mesh.indices.size()) : mesh.lods[ 0 ].indexCount; // a plain DrawMesh draws LOD 0
+	desc.m_pSubmeshes = mesh.submeshes.data();
+	desc.submeshCount = static_cast< u32 >(mesh.submeshes.size());
+	desc.m_pMaterialInfos = mesh.materialInfos.data();
+	desc.materialCount = static_cast< u32 >(mesh.materialInfos.size());
+
+	MeshId meshId = Resources::CreateAsset< Graphics::Mesh >(desc);
+	if ( !mesh.lods.empty() )
+	{
+		if ( meshId.GetValue() >= m_meshLodCounts.size() ) m_meshLodCounts.resize( meshId.GetValue() + 1, 1 );
+		m_meshLodCounts[ meshId.GetValue() ] = static_cast< u32 >(mesh.lods.size());
+	}
+
+	// A loaded file is a heap copy too, a mapped one is paged in from the file cache.
+	const size_t fileBytes = mesh.pReader->GetSizeBytes();
+	const size_t stagingBytes = mesh.copiedBytes + ( kMapMeshFiles ? 0 : fileBytes );
+	m_meshLoadStats.meshCount++;
+	m_meshLoadStats.readMs += mesh.readMs;
+	m_meshLoadStats.createMs += std::chrono::duration< f32, std::milli >( std::chrono::high_resolution_clock::now() - start ).count();
+	m_meshLoadStats.fileBytes += fileBytes;
+	m_meshLoadStats.copiedBytes += mesh.copiedBytes;
+	m_meshLoadStats.peakStagingBytes = std::max( m_meshLoadStats.peakStagingBytes, stagingBytes );
+	mesh.pReader.reset();
+	return meshId;
+}
+
+AssetManager::MaterialId AssetManager::GetInstancedMaterial( MaterialId material ) const
+{
+	for ( const Asset& asset : m_assetList )
+	{
+		if ( asset.mat == material ) return asset.instancedMat;
 	}
+	return MaterialId();
 }
 
 void AssetManager::LoadDebugSphereMaterial()
@@ -92,6 +434,6 @@ void AssetManager::CreateParticleAsset( ComplexDesc& desc, ParticleType type, co
 	desc.m_state.m_blendMode = Graphics::BlendMode::ADDITIVE;
 	desc.m_state.m_depthEnable = true;
 	desc.m_state.m_depthWrite = false;
-	desc.m_texture[ 0 ] = Graphics::CreateTextureFromFile(g_vParticleSpritePaths[ static_cast< int >(type) ]);
-	desc.m_sampler[ 0 ] = Graphics::CreateLinearSampler();
+	desc.m_texture[ 0 ] = m_particleTextures[ static_cast< int >(type) ];
+	desc.m_sampler[ 0 ] = Graphics::AcquireSampler( Graphics::SamplerDesc() );
 }
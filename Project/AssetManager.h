@@ -12,6 +12,12 @@ class AssetManager
 	PLAY_SINGLETON_INTERFACE(AssetManager);
 
 public:
+	// Reorder meshes for the vertex cache, overdraw and vertex fetch when the file was not cooked that way.
+	static constexpr bool kOptimiseMeshesAtLoad = true;
+	// Store meshes with 16 bytes per vertex instead of 48, see Graphics::MeshDesc::m_bCompactVertices.
+	static constexpr bool kCompactVerticesAtLoad = true;
+	// Map p3dmesh files so meshes that need no processing go from the file to the GPU without a copy.
+	static constexpr bool kMapMeshFiles = true;
 
 	using MeshId = Graphics::MeshId;
 	using MaterialId = Graphics::MaterialId;
@@ -24,28 +30,65 @@ public:
 	{
 		MeshId mesh;
 		MaterialId mat;
+		MaterialId instancedMat; // same material reading world matrices from the instance buffer
 
 		Asset() {}
-		Asset( MeshId meshID, MaterialId matID ) : mesh( meshID ), mat( matID ) {}
-		Asset( const Asset&& a ) : mesh( a.mesh ), mat( a.mat ) {}
+		Asset( MeshId meshID, MaterialId matID, MaterialId instancedMatID ) : mesh( meshID ), mat( matID ), instancedMat( instancedMatID ) {}
+		Asset( const Asset&& a ) : mesh( a.mesh ), mat( a.mat ), instancedMat( a.instancedMat ) {}
 
 		Asset& operator = ( const Asset& a ) = default;
 	};
 
+	// Measured over the meshes of LoadGameAssets.
+	struct MeshLoadStats
+	{
+		u32 meshCount = 0;
+		f32 readMs = 0.f;				 // summed over the loading threads
+		f32 createMs = 0.f;				 // buffer creation on the owning thread
+		size_t fileBytes = 0;
+		size_t copiedBytes = 0;			 // copied out of the files to be processed
+		size_t peakStagingBytes = 0;	 // most CPU memory one mesh held on its way to the GPU, a loaded file included
+		size_t peakWorkingSetGrowth = 0;
+	};
 
+
+	// Loads everything and returns once it is done.
 	void LoadGameAssets();
+	// Starts the loads on the loading threads, FinishLoadGameAssets creates the materials once they are in.
+	void BeginLoadGameAssets();
+	// Returns false while loads are still running. Sounds and anything else added to GetLoadingTask count too.
+	bool FinishLoadGameAssets();
+	bool IsLoading() const { return m_loadingTask.IsValid(); }
+	f32 GetLoadingProgress() const { return Resources::GetAsyncLoadingProgress( m_loadingTask ); }
+	Resources::AsyncLoadingTaskId GetLoadingTask() const { return m_loadingTask; }
 	const Asset& GetAsset( AssetType type ) const { return m_assetList[ static_cast< int >(type) ]; }
+	MaterialId GetInstancedMaterial( MaterialId material ) const;
+	// Submesh i of a mesh with more than one LOD is LOD i, see ReadMesh.
+	u32 GetMeshLodCount( MeshId mesh ) const { return mesh.GetValue() < m_meshLodCounts.size() ? m_meshLodCounts[ mesh.GetValue() ] : 1; }
 	const MaterialId& GetParticleMaterial( ParticleType type ) const { return m_particleList[ static_cast< int >(type) ]; }
 	const MaterialId& GetSphereMaterial() const { return m_simpleSphereMaterial; }
 	const MaterialId& GetTwinklyStarMaterial() const { return m_twinklyStarMaterial; }
+	const MeshLoadStats& GetMeshLoadStats() const { return m_meshLoadStats; }
 
 private:
+	struct MeshData;
+	static void ReadMesh( MeshData& mesh );
+	MeshId CreateMesh( MeshData& mesh );
 	void LoadParticles();
 	void LoadDebugSphereMaterial();
 	void CreateParticleAsset( ComplexDesc& mat, ParticleType type, const char* name, const char* shaderPath );
+	static size_t GetPeakWorkingSet();
 
 	Asset m_assetList[ static_cast< int >(AssetType::TOTAL_ASSETS) ];
 	MaterialId m_particleList[ static_cast< int >(ParticleType::TOTAL_PARTICLE_TYPES) ];
 	MaterialId m_simpleSphereMaterial;
 	MaterialId m_twinklyStarMaterial;
+	std::vector< u32 > m_meshLodCounts; // indexed by mesh id
+	MeshLoadStats m_meshLoadStats;
+
+	Resources::AsyncLoadingTaskId m_loadingTask;
+	Graphics::TextureId m_assetTextures[ static_cast< int >(AssetType::TOTAL_ASSETS) ][ 3 ]; // colour, normal, ORM
+	Graphics::TextureId m_particleTextures[ static_cast< int >(ParticleType::TOTAL_PARTICLE_TYPES) ];
+	std::chrono::high_resolution_clock::time_point m_loadStart;
+	size_t m_peakWorkingSetBefore{ 0 };
 };
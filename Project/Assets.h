@@ -35,6 +35,26 @@ const char* g_vAssetMeshPaths[ static_cast< int >(AssetType::TOTAL_ASSETS) ]
 
 };
 
+// Meshes that get a LOD chain at load, small or numerous objects that are often far away.
+const bool g_vAssetGenerateLods[ static_cast< int >(AssetType::TOTAL_ASSETS) ]
+{
+	false, // player
+	true,  // planet
+	false, // enemy
+	false, // laser
+	false, // missile
+	true,  // volcano
+	true,  // crater
+	false, // health
+	false, // shield
+	false, // speed
+	true,  // small asteroid
+	true,  // medium asteroid
+	true,  // large asteroid
+	true,  // small debris
+	true,  // medium debris
+};
+
 const char* g_vAssetColourPaths[ static_cast< int >(AssetType::TOTAL_ASSETS) ] // Albedo (colour)
 {
 	"Data/Player/Steel_Blue_Albedo.png",
@@ -100,4 +120,5 @@ const char* g_vShaderPaths[ static_cast< int >(ShaderType::TOTAL_SHADERS) ]
 	"Data/Shaders/ParticleShader.hlsl",
 	"Data/Shaders/TwinklyStar.hlsl",
 	"Data/Shaders/SelfIllumination.hlsl",
+	"Data/Shaders/SelfIlluminationInstanced.hlsl",
 };
\ No newline at end of file
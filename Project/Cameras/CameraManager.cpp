@@ -7,6 +7,7 @@
 #include "GameMath.h"
 #include "Types.h"
 #include "CameraManager.h"
+#include "Utilities/RenderCapture.h"
 
 
 
@@ -42,12 +43,32 @@ void CameraManager::SetActiveCamera( u32 id )
 void CameraManager::Update()
 {
 	GetActiveCamera().Update();
+	UpdateCullingVolume();
+}
+
+void CameraManager::UpdateCullingVolume()
+{
+	const Camera& camera = GetActiveCamera();
+	m_cameraPosition = AffineInverse( camera.GetView() ).m_column[3].xyz();
+
+	m_frustum = Frustum::FromViewProjection( camera.GetProject() * camera.GetView() );
+	m_planetOccluder = HorizonOccluder::FromSphere( m_cameraPosition, kPlanetOccluderRadius );
+}
+
+bool CameraManager::IsSphereInFrustum( const Vector3f& centre, f32 radius ) const
+{
+	return m_frustum.IsSphereInside( centre, radius );
+}
+
+bool CameraManager::IsSphereBehindPlanet( const Vector3f& centre, f32 radius ) const
+{
+	return m_planetOccluder.IsSphereHidden( centre, radius );
 }
 
 void CameraManager::ApplyActiveCameraMatrices()
 {
-	Graphics::SetViewMatrix( GetActiveCamera().GetView() );
-	Graphics::SetProjectionMatrix( GetActiveCamera().GetProject() );
+	CapturedGraphics::SetViewMatrix( GetActiveCamera().GetView() );
+	CapturedGraphics::SetProjectionMatrix( GetActiveCamera().GetProject() );
 }
 
 Camera& CameraManager::GetActiveCamera()
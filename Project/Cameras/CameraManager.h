@@ -6,6 +6,8 @@
 ///////////////////////////////////////////////////////////////////////////
 
 #pragma once
+#include "Frustum.h"
+#include "HorizonOccluder.h"
 
 class PlayerCamera;
 
@@ -50,6 +52,14 @@ public:
 	// Updates the active camera
 	void Update();
 
+	// Visibility tests against the active camera, refreshed every Update.
+	bool IsSphereInFrustum(const Vector3f& centre, f32 radius) const;
+	bool IsSphereBehindPlanet(const Vector3f& centre, f32 radius) const;
+	bool IsSphereVisible(const Vector3f& centre, f32 radius) const { return IsSphereInFrustum(centre, radius) && !IsSphereBehindPlanet(centre, radius); }
+	const Vector3f& GetCameraPosition() const { return m_cameraPosition; }
+	const Frustum& GetFrustum() const { return m_frustum; }
+	const HorizonOccluder& GetPlanetOccluder() const { return m_planetOccluder; }
+
 	void SetActiveCamera(u32 id);
 	u32 GetDebugCamID() const { return m_debugCamID; }
 	void SetDebugCamID(u32 id) { m_debugCamID = id; }
@@ -61,7 +71,12 @@ public:
 	PlayerCamera* GetPlayerCamera() { return (PlayerCamera*)m_cameras[m_playerCamID]; }
 	
 private:
+	void UpdateCullingVolume();
+
 	std::vector<Camera*> m_cameras;
+	Frustum m_frustum;
+	HorizonOccluder m_planetOccluder;
+	Vector3f m_cameraPosition{ 0.f };
 	u32 m_activeCameraId = 1;
 	u32 m_debugCamID{ 0 };
 	u32 m_playerCamID{ 0 };
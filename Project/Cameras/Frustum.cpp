@@ -0,0 +1,61 @@
+#include "GameMath.h"
+#include "Types.h"
+#include "Frustum.h"
+#include <emmintrin.h>
+
+
+Frustum Frustum::FromViewProjection(const Matrix4x4f& viewProjection)
+{
+	// Rows of the view-projection give the clip planes, depth is in the 0..1 range.
+	Matrix4x4f rows = Transpose(viewProjection);
+
+	Frustum frustum;
+	frustum.planes[0] = rows.m_column[3] + rows.m_column[0]; // left
+	frustum.planes[1] = rows.m_column[3] - rows.m_column[0]; // right
+	frustum.planes[2] = rows.m_column[3] + rows.m_column[1]; // bottom
+	frustum.planes[3] = rows.m_column[3] - rows.m_column[1]; // top
+	frustum.planes[4] = rows.m_column[2];                    // near
+	frustum.planes[5] = rows.m_column[3] - rows.m_column[2]; // far
+
+	for (Vector4f& plane : frustum.planes)
+	{
+		plane = plane / length(plane.xyz());
+	}
+	return frustum;
+}
+
+bool Frustum::IsSphereInside(const Vector3f& centre, f32 radius) const
+{
+	for (const Vector4f& plane : planes)
+	{
+		if (dot(plane.xyz(), centre) + plane.w < -radius) return false;
+	}
+	return true;
+}
+
+void CullSpheres(const Frustum& frustum, const f32* pX, const f32* pY, const f32* pZ, const f32* pRadius, u32 count, u8* pVisible)
+{
+	for (u32 i = 0; i < count; i += 4)
+	{
+		__m128 x = _mm_loadu_ps(pX + i);
+		__m128 y = _mm_loadu_ps(pY + i);
+		__m128 z = _mm_loadu_ps(pZ + i);
+		__m128 negRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(pRadius + i));
+		__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+		for (const Vector4f& plane : frustum.planes)
+		{
+			__m128 distance = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(plane.x)), _mm_mul_ps(y, _mm_set1_ps(plane.y))),
+				_mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(plane.z)), _mm_set1_ps(plane.w)));
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negRadius));
+		}
+
+		int mask = _mm_movemask_ps(inside);
+		u32 lanes = std::min(count - i, 4u);
+		for (u32 lane = 0; lane < lanes; lane++)
+		{
+			pVisible[i + lane] = static_cast<u8>((mask >> lane) & 1);
+		}
+	}
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+
+// Six clip planes extracted from a view-projection matrix, normals point inwards.
+// Works for both the perspective camera and the orthographic shadow projections.
+struct Frustum
+{
+	Vector4f planes[6];
+
+	static Frustum FromViewProjection(const Matrix4x4f& viewProjection);
+	bool IsSphereInside(const Vector3f& centre, f32 radius) const;
+};
+
+// Tests count spheres stored as separate x/y/z/radius arrays against the frustum, four at a time.
+// The arrays must be padded to a multiple of four. pVisible receives 1 for every sphere touching the frustum.
+void CullSpheres(const Frustum& frustum, const f32* pX, const f32* pY, const f32* pZ, const f32* pRadius, u32 count, u8* pVisible);
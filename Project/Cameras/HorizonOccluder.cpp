@@ -0,0 +1,83 @@
+#include "GameMath.h"
+#include "Types.h"
+#include "HorizonOccluder.h"
+#include <emmintrin.h>
+
+
+HorizonOccluder HorizonOccluder::FromSphere(const Vector3f& eye, f32 occluderRadius)
+{
+	HorizonOccluder occluder;
+	occluder.eye = eye;
+	occluder.eyeDistance = length(eye);
+	if (occluder.eyeDistance <= occluderRadius) return occluder;
+
+	const f32 d = occluder.eyeDistance;
+	const f32 R = occluderRadius;
+	occluder.axis = eye / d;
+	occluder.horizonDistance = R * R / d;
+	occluder.sinCone = R / d;
+	occluder.cosCone = sqrt(d * d - R * R) / d;
+	occluder.bActive = true;
+	return occluder;
+}
+
+bool HorizonOccluder::IsSphereHidden(const Vector3f& centre, f32 radius) const
+{
+	if (!bActive) return false;
+
+	f32 height = dot(centre, axis);
+	if (height + radius > horizonDistance) return false;
+
+	// Distance from the eye towards the occluder centre, and off that line.
+	f32 along = eyeDistance - height;
+	f32 across = sqrt(std::max(lengthSqr(centre - eye) - along * along, 0.f));
+	return along * sinCone - across * cosCone >= radius;
+}
+
+u32 OccludeSpheres(const HorizonOccluder& occluder, const f32* pX, const f32* pY, const f32* pZ, const f32* pRadius, u32 count, u8* pVisible)
+{
+	if (!occluder.bActive) return 0;
+
+	const __m128 axisX = _mm_set1_ps(occluder.axis.x);
+	const __m128 axisY = _mm_set1_ps(occluder.axis.y);
+	const __m128 axisZ = _mm_set1_ps(occluder.axis.z);
+	const __m128 eyeX = _mm_set1_ps(occluder.eye.x);
+	const __m128 eyeY = _mm_set1_ps(occluder.eye.y);
+	const __m128 eyeZ = _mm_set1_ps(occluder.eye.z);
+	const __m128 eyeDistance = _mm_set1_ps(occluder.eyeDistance);
+	const __m128 horizonDistance = _mm_set1_ps(occluder.horizonDistance);
+	const __m128 sinCone = _mm_set1_ps(occluder.sinCone);
+	const __m128 cosCone = _mm_set1_ps(occluder.cosCone);
+
+	u32 hiddenCount = 0;
+	for (u32 i = 0; i < count; i += 4)
+	{
+		__m128 x = _mm_loadu_ps(pX + i);
+		__m128 y = _mm_loadu_ps(pY + i);
+		__m128 z = _mm_loadu_ps(pZ + i);
+		__m128 radius = _mm_loadu_ps(pRadius + i);
+
+		__m128 height = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, axisX), _mm_mul_ps(y, axisY)), _mm_mul_ps(z, axisZ));
+		__m128 belowHorizon = _mm_cmple_ps(_mm_add_ps(height, radius), horizonDistance);
+
+		__m128 dx = _mm_sub_ps(x, eyeX);
+		__m128 dy = _mm_sub_ps(y, eyeY);
+		__m128 dz = _mm_sub_ps(z, eyeZ);
+		__m128 distanceSqr = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+		__m128 along = _mm_sub_ps(eyeDistance, height);
+		__m128 across = _mm_sqrt_ps(_mm_max_ps(_mm_sub_ps(distanceSqr, _mm_mul_ps(along, along)), _mm_setzero_ps()));
+		__m128 inCone = _mm_cmpge_ps(_mm_sub_ps(_mm_mul_ps(along, sinCone), _mm_mul_ps(across, cosCone)), radius);
+
+		int mask = _mm_movemask_ps(_mm_and_ps(belowHorizon, inCone));
+		u32 lanes = std::min(count - i, 4u);
+		for (u32 lane = 0; lane < lanes; lane++)
+		{
+			if ((mask >> lane) & 1 && pVisible[i + lane])
+			{
+				pVisible[i + lane] = 0;
+				hiddenCount++;
+			}
+		}
+	}
+	return hiddenCount;
+}
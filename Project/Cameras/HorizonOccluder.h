@@ -0,0 +1,22 @@
+#pragma once
+
+
+// A sphere occluder at the origin seen from a point outside it, i.e. the planet from the camera.
+// Anything beyond the horizon plane and inside the cone of rays that hit the occluder is hidden.
+struct HorizonOccluder
+{
+	Vector3f eye{ 0.f };
+	Vector3f axis{ 0.f, 1.f, 0.f }; // unit vector from the occluder centre to the eye
+	f32 eyeDistance = 0.f;          // from the occluder centre
+	f32 horizonDistance = 0.f;      // of the horizon plane along axis
+	f32 sinCone = 0.f;
+	f32 cosCone = 1.f;
+	bool bActive = false;           // false when the eye is inside the occluder
+
+	static HorizonOccluder FromSphere(const Vector3f& eye, f32 occluderRadius);
+	bool IsSphereHidden(const Vector3f& centre, f32 radius) const;
+};
+
+// Clears pVisible for every sphere hidden by the occluder, four at a time, leaving the rest untouched.
+// Takes the same padded x/y/z/radius arrays as CullSpheres. Returns the number of spheres newly hidden.
+u32 OccludeSpheres(const HorizonOccluder& occluder, const f32* pX, const f32* pY, const f32* pZ, const f32* pRadius, u32 count, u8* pVisible);
@@ -13,17 +13,30 @@ struct VSInput
 };
 
 // We can pull in particle data via a structured buffer.
-// Particle should match the version on the CPU.
-struct Particle
-{
-    float scale;
-	float3 pos;
-	float3 vel;
-    float3 colour;
-	float4 life; // extend
+// Particles are packed into 12 bytes, this should match GpuParticle on the CPU:
+//   x = half offset.x | half offset.y << 16
+//   y = half offset.z | emitter index << 16
+//   z = age (0..65535) | palette index << 16 | quantised scale << 24
+StructuredBuffer<uint3> g_particles : register(t8);
+StructuredBuffer<float4> g_emitterOrigins : register(t9);
+
+// Must match g_vParticleColours in GameMath.h.
+static const float3 g_palette[11] = {
+	float3(1.0f, 1.0f, 1.0f),
+	float3(0.7f, 0.5f, 1.0f),
+	float3(0.05f, 0.0f, 0.1f),
+	float3(0.7f, 1.0f, 1.0f),
+	float3(0.0f, 0.0f, 0.5f),
+	float3(0.2f, 1.0f, 0.4f),
+	float3(0.0f, 0.5f, 0.0f),
+	float3(1.0f, 1.0f, 0.5f),
+	float3(1.0f, 0.8f, 0.0f),
+	float3(1.0f, 0.5f, 1.0f),
+	float3(1.0f, 0.0f, 0.5f)
 };
 
-StructuredBuffer<Particle> g_particles : register(t8);
+// Must match kParticleScaleStep in ParticlePacking.h.
+static const float g_scaleStep = 0.5f / 255.0f;
 
 // Pixel Shader Input
 // This can be completely customized as long as it matches the output of your Vertex Shader.
@@ -61,18 +74,17 @@ PSInput VS_Main(VSInput input)
 	uint pid = input.vertexId / 6; // Particle ID
 
 	// Grab Particle Data
-	float3 position = g_particles[pid].pos;
-	float3 velocity = g_particles[pid].vel;
-	float lifeTime = g_particles[pid].life[0];
-	float maxLifeTime = g_particles[pid].life[1];
-	float scale = g_particles[pid].scale;
-	float3 color = g_particles[pid].colour;
-	
+	uint3 packed = g_particles[pid];
+	uint emitter = packed.y >> 16;
+	float3 position = g_emitterOrigins[emitter].xyz + f16tof32(uint3(packed.x, packed.x >> 16, packed.y));
+	float age = (packed.z & 0xffff) / 65535.0f;
+	float scale = (packed.z >> 24) * g_scaleStep;
+	float3 color = g_palette[min((packed.z >> 16) & 0xff, 10)];
 
 	PSInput output;
 
 	// Make degenerate vertex if outside of valid lifetime.
-	if (lifeTime < 0.f || lifeTime > 100.0f)
+	if (age >= 1.0f)
 	{
 		output.position = float4(0.f, 0.f, 0.f, 0.f);
 		return output;
@@ -91,7 +103,7 @@ PSInput VS_Main(VSInput input)
 	output.position = mul(viewProjectionMtx, float4(position.xyz + quadOffset, 1.0) );
 	//output.colour = (0.25 - lifeTime.xxxx * 0.01f);
     output.colour = float4(color, 0);
-    output.opacity = 1.0f - lifeTime / maxLifeTime;
+    output.opacity = 1.0f - age;
 	return output;
 }
 
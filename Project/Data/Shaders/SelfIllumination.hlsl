@@ -28,15 +28,20 @@ SamplerState myState : register(s0);
 
 // The Vertex Shaders entry point function
 // This is called on every vertex in the mesh.
-PSInput VS_Main(VSInput input)
+PSInput VS_Main(VSInput input, uint instanceId : SV_InstanceID)
 {
     PSInput output;
 
+#ifdef USE_INSTANCING
+    output.pos_w = mul(GetWorldMatrix(instanceId), float4(input.position.xyz, 1.0f));
+    output.position = mul(viewProjectionMtx, float4(output.pos_w, 1.0f));
+#else
     output.position = mul(mvpMtx, float4(input.position.xyz, 1.0f));
+    output.pos_w = mul(worldMtx, float4(input.position.xyz, 1.0f));
+#endif
     output.colour = pow(input.colour, 2.2); // Gamma correct from sRGB.
-    output.normal = mul(normalMtx, float4(input.normal.xyz, 0.0f));
+    output.normal = mul(GetNormalMatrix(instanceId), float4(input.normal.xyz, 0.0f));
     output.uv = input.uv;
-    output.pos_w = mul(worldMtx, float4(input.position.xyz, 1.0f));
 
     return output;
 }
@@ -0,0 +1,3 @@
+// Instanced variant of SelfIllumination.hlsl, world matrices come from the instance buffer.
+#define USE_INSTANCING 1
+#include "SelfIllumination.hlsl"
@@ -0,0 +1,30 @@
+#include "HLSL_StandardMacros"
+
+// Copies a cached static shadow layer into the live shadow map as depth,
+// before the dynamic casters are drawn on top.
+
+struct PSInput
+{
+	float4 position : SV_POSITION; //<< This attribute must exist.
+};
+
+Texture2DArray<float> StaticShadowCache : register(PLAY3D_REG_GLOBAL_SRV0);
+
+cbuffer ShadowCacheConstants : register(PLAY3D_REG_GLOBAL_CBV0)
+{
+	uint4 Slice; // X is the cache layer
+};
+
+// Full screen triangle, as in PostFXShader.hlsl
+PSInput VS_Main(uint id : SV_VertexID)
+{
+	PSInput output;
+	float2 uv = float2((id << 1) & 2, id & 2);
+	output.position = float4(uv.x * 2 - 1, uv.y * -2 + 1, 0, 1);
+	return output;
+}
+
+float PS_Main(PSInput input) : SV_Depth
+{
+	return StaticShadowCache.Load(int4(input.position.xy, Slice.x, 0));
+}
@@ -0,0 +1,3 @@
+// Variant of ShadowCastShader.hlsl for meshes with compact vertices.
+#define USE_COMPACT_VERTICES 1
+#include "ShadowCastShader.hlsl"
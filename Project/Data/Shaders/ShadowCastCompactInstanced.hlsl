@@ -0,0 +1,4 @@
+// Instanced variant of ShadowCastShader.hlsl for meshes with compact vertices.
+#define USE_INSTANCING 1
+#define USE_COMPACT_VERTICES 1
+#include "ShadowCastShader.hlsl"
@@ -4,7 +4,11 @@
 // Vertex Shader Input
 struct VSInput
 {
+#ifdef USE_COMPACT_VERTICES
+	float4 position : POSITION;
+#else
 	float3 position : POSITION;
+#endif
 };
 
 // Pixel Shader Input
@@ -14,10 +18,20 @@ struct PSInput
 };
 
 // The Vertex Shaders entry point function
-PSInput VS_Main(VSInput input)
+PSInput VS_Main(VSInput input, uint instanceId : SV_InstanceID)
 {
 	PSInput output;
-	output.position = mul(mvpMtx, float4(input.position.xyz, 1.0f));
+#ifdef USE_COMPACT_VERTICES
+	float3 position = DecodeQuantisedPosition(input.position);
+#else
+	float3 position = input.position;
+#endif
+#ifdef USE_INSTANCING
+	float4 position_w = mul(GetWorldMatrix(instanceId), float4(position, 1.0f));
+	output.position = mul(viewProjectionMtx, position_w);
+#else
+	output.position = mul(mvpMtx, float4(position, 1.0f));
+#endif
 	return output;
 }
 
@@ -20,7 +20,7 @@ struct Particle
     float3 pos;
     float3 vel;
     float3 colour;
-    float4 life; // extend
+    float4 life; // x = twinkle phase offset, the field is immutable
 };
 
 StructuredBuffer<Particle> g_particles : register(t8);
@@ -64,7 +64,7 @@ PSInput VS_Main(VSInput input)
 	// Grab Particle Data
     float3 position = g_particles[pid].pos;
     float3 velocity = g_particles[pid].vel;
-    float lifeTime = g_particles[pid].life[0];
+    float lifeTime = time.x + g_particles[pid].life[0]; // elapsed time from the frame constants
     float3 colour = g_particles[pid].colour;
     float scale = g_particles[pid].scale;
 
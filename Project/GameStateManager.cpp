@@ -3,6 +3,7 @@
 #include "Level.h"
 #include "Collisions/CollisionManager.h"
 #include "Particles/TwinkleLittleStar.h"
+#include "Particles/ParticleSystem.h"
 #include "Cameras/CameraManager.h"
 #include "Cameras/PlayerCamera.h"
 #include "Cameras/DebugCamera.h"
@@ -12,6 +13,9 @@
 #include "Utilities/LightManager.h"
 #include "Utilities/SoundManager.h"
 #include "Utilities/ShakeManager.h"
+#include "Utilities/JobManager.h"
+#include "Utilities/RenderCapture.h"
+#include "Utilities/TextureStreamer.h"
 #include "AssetManager.h"
 #include "ObjectFactory/GameObjectManager.h"
 #include "GameStateManager.h"
@@ -24,7 +28,9 @@ GameStateManager::GameStateManager()
 {
 	GameStateManager::Instance().InitialiseManagers();
 	GameStateManager::Instance().CreateDebugCamera();
-	AssetManager::Instance().LoadGameAssets();
+	// Assets load in the background while Main shows the loading screen, Update starts the level once they are in.
+	AssetManager::Instance().BeginLoadGameAssets();
+	SoundManager::Instance().LoadSounds( AssetManager::Instance().GetLoadingTask() );
 	LightManager::Instance().SetupLighting();
 	m_debugFontId = UI::GetDebugFont();
 }
@@ -36,12 +42,20 @@ GameStateManager::~GameStateManager()
 
 void GameStateManager::Update( float dT )
 {
+	if ( m_loading )
+	{
+		if ( !AssetManager::Instance().FinishLoadGameAssets() ) return;
+		m_loading = false;
+		GenerateLevel();
+	}
+
 	UpdateGameState();
 	CameraControls();
 	SoundManager::Instance().Update();
 	CollisionManager::Instance().UpdateCollisions();
 	GameObjectManager::Instance().Update(dT);
 	CameraManager::Instance().Update();
+	ParticleSystem::Instance().Update( dT ); // after the camera so culling uses this frame's view
 	LightManager::Instance().UpdateDirectionalLights();
 	GameObjectManager::Instance().PostUpdate();
 }
@@ -161,6 +175,10 @@ void GameStateManager::InitialiseManagers()
 	LightManager::Initialise();
 	ShakeManager::Initialise();
 	SoundManager::Initialise();
+	JobManager::Initialise();
+	RenderCapture::Initialise();
+	ParticleSystem::Initialise();
+	TextureStreamer::Initialise();
 }
 
 void GameStateManager::DrawDebugAxes()
@@ -181,6 +199,33 @@ void GameStateManager::CameraControls()
 	{
 		CameraManager::Instance().SetActiveCamera( CameraManager::Instance().GetDebugCamID() );
 	}
+	if ( Input::IsKeyPressed('T') )
+	{
+		// cycle the job workers used by particle update and render gather to compare 1 against N
+		u32 workers = JobManager::Instance().GetWorkerCount();
+		JobManager::Instance().SetWorkerCount( workers < JobManager::GetMaxWorkerCount() ? workers + 1 : 0 );
+	}
+	if ( Input::IsKeyPressed('R') )
+	{
+		// record the next frames for Tools/RenderCaptureAnalyser
+		RenderCapture::Instance().Start( "RenderCapture.rcap" );
+	}
+	if ( Input::IsKeyPressed('B') )
+	{
+		// print pack directory lookup timings to the debug output
+		Packfile::PackedFileManager::BenchmarkLookups( 4096 );
+	}
+	if ( Input::IsKeyPressed('X') )
+	{
+		// draw the axes of every object in the debug pass
+		m_debugAxes = !m_debugAxes;
+	}
+	if ( Input::IsKeyPressed('M') )
+	{
+		// halve the texture streaming budget to watch eviction, back to the default past the minimum
+		u64 budget = TextureStreamer::Instance().GetBudget() / 2;
+		TextureStreamer::Instance().SetBudget( budget < TextureStreamer::kMinBudgetBytes ? TextureStreamer::kDefaultBudgetBytes : budget );
+	}
 }
 
 
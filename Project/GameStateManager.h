@@ -17,6 +17,8 @@ public:
 	void CameraControls();
 	void Update( float dT );
 	void DrawUI();
+	bool IsLoading() const { return m_loading; }
+	bool IsDrawingDebugAxes() const { return m_debugAxes; }
 
 private:
 	void DestroyLevel();
@@ -25,8 +27,10 @@ private:
 	void CreatePlayerCamera( Player* p );
 
 	int m_gLevel{ LEVEL_1 };
+	bool m_loading{ true };
 	bool m_gameOver{ false };
 	bool m_levelPassed{ false };
+	bool m_debugAxes{ false };
 	u32 m_gameScore{ 0 };
 	UI::FontId m_debugFontId;
 };
@@ -9,6 +9,12 @@
 #include "RenderContext.h"
 #include "Cameras/CameraManager.h"
 #include "ObjectFactory/GameObjectManager.h"
+#include "Particles/ParticleSystem.h"
+#include "AssetManager.h"
+#include "Utilities/JobManager.h"
+#include "Utilities/RenderCapture.h"
+#include "Utilities/TextureStreamer.h"
+#include "Utilities/ShadowCache.h"
 
 
 constexpr u32 kShadowMapDim = 4096;
@@ -71,6 +77,18 @@ class GameAppClass
 	Graphics::TextureId m_shadowMapDepthTargetArray;
 	Graphics::SamplerId m_shadowMapSampler;
 
+	// Static casters of the directional lights, copied into m_shadowMapDepthTargetArray every frame.
+	Graphics::TextureId m_staticShadowCacheArray;
+	Graphics::MaterialId m_shadowRestoreMatId;
+	Graphics::BufferId m_shadowCacheConstantBufferId;
+	ShadowCache m_shadowCache;
+
+	struct ShadowCacheConstantData
+	{
+		u32 Slice[4]; // X is the layer to restore
+	};
+	ShadowCacheConstantData m_shadowCacheConstantData = {};
+
 public:
 	void Initialise()
 	{
@@ -81,6 +99,9 @@ public:
 		systemDesc.height = 1024;
 		System::Initialise(systemDesc);
 
+		// Cooked by Tools/AssetCooker, without it everything is read from the loose files under Data.
+		Resources::LoadAssets("Data.p3dpack");
+
 		// Grab the debug font.
 		m_debugFontId = UI::GetDebugFont();
 
@@ -104,6 +125,9 @@ public:
 			desc.pDebugName = "Shadow Map Array";
 
 			m_shadowMapDepthTargetArray = Resources::CreateAsset<Graphics::Texture>(desc);
+
+			desc.pDebugName = "Static Shadow Cache Array";
+			m_staticShadowCacheArray = Resources::CreateAsset<Graphics::Texture>(desc);
 		}
 
 		// Shadow Map sampler
@@ -124,6 +148,45 @@ public:
 			m_shadowCastMatId = Resources::CreateAsset<Graphics::Material>(desc);
 		}
 
+		// Instanced Shadow Casting material
+		{
+			Graphics::ComplexMaterialDesc desc;
+			desc.SetupFromHLSLFile("ShadowCastInstanced", "Data/Shaders/ShadowCastInstanced.hlsl");
+			desc.m_state.m_cullMode = Graphics::CullMode::FRONT;
+			desc.m_state.m_fillMode = Graphics::FillMode::SOLID;
+			desc.m_bNullPixelShader = true;
+			m_shadowCastInstancedMatId = Resources::CreateAsset<Graphics::Material>(desc);
+		}
+
+		// Shadow Casting materials for meshes with compact vertices
+		{
+			Graphics::ComplexMaterialDesc desc;
+			desc.SetupFromHLSLFile("ShadowCastCompact", "Data/Shaders/ShadowCastCompact.hlsl");
+			desc.m_state.m_cullMode = Graphics::CullMode::FRONT;
+			desc.m_state.m_fillMode = Graphics::FillMode::SOLID;
+			desc.m_bNullPixelShader = true;
+			desc.m_inputLayoutId = Graphics::GetStandardInputLayout(Graphics::StandardInputLayoutTypes::COMPACT_MESH_LAYOUT);
+			m_shadowCastCompactMatId = Resources::CreateAsset<Graphics::Material>(desc);
+
+			desc.SetupFromHLSLFile("ShadowCastCompactInstanced", "Data/Shaders/ShadowCastCompactInstanced.hlsl");
+			m_shadowCastCompactInstancedMatId = Resources::CreateAsset<Graphics::Material>(desc);
+		}
+
+		// Copies a cached static shadow layer into the shadow map
+		{
+			Graphics::ComplexMaterialDesc desc;
+			desc.SetupFromHLSLFile("ShadowCacheRestore", "Data/Shaders/ShadowCacheRestore.hlsl");
+			desc.m_state.m_cullMode = Graphics::CullMode::NONE;
+			desc.m_state.m_fillMode = Graphics::FillMode::SOLID;
+			desc.m_state.m_depthComparison = Graphics::ComparisonFunc::ALWAYS;
+			m_shadowRestoreMatId = Resources::CreateAsset<Graphics::Material>(desc);
+
+			Graphics::BufferDesc bufferDesc;
+			bufferDesc.m_bindFlags = Graphics::BufferBindFlags::CONSTANT;
+			bufferDesc.SetConstantBuffer<ShadowCacheConstantData>(&m_shadowCacheConstantData);
+			m_shadowCacheConstantBufferId = Resources::CreateAsset<Graphics::Buffer>(bufferDesc);
+		}
+
 		// Define PostFX material
 		{
 			Graphics::ComplexMaterialDesc desc;
@@ -161,9 +224,7 @@ public:
 			m_postfxConstantBufferId = Resources::CreateAsset<Graphics::Buffer>(desc);
 		}
 
-		//////////////////////////////////////////////////// Generate Level 1 //////////////////////////////////////////////////////////////
-		// will be moved into update once the game states are sorted
-		GameStateManager::Instance().GenerateLevel();
+		// Level 1 is generated by GameStateManager::Update once the assets have loaded.
 	}
 
 	bool Update()
@@ -181,22 +242,35 @@ public:
 			bKeepGoing = false;
 		}
 
+		// A captured frame starts here so it includes the uploads made during the update.
+		Graphics::SurfaceSize surfaceSize = Graphics::GetDisplaySurfaceSize();
+		RenderCapture::Instance().BeginFrame(surfaceSize.m_width, surfaceSize.m_height);
+
 		GameStateManager::Instance().Update( System::GetDeltaTime() );
+		// Acts on the texture requests of the last frame's forward pass.
+		TextureStreamer::Instance().Update();
 		
 		return bKeepGoing;
 	}
 
 	void Render()
 	{
-		// Pass 1: Shadowmap Rendering
-		Graphics::PushMarker("Shadowmap Rendering");
-		m_renderContext.BeginPass(RenderPassType::kShadowPass);
+		if (GameStateManager::Instance().IsLoading())
+		{
+			RenderLoadingScreen();
+			return;
+		}
 
-		// Render any objects that should be in the shadow pass here. 
-		// Your game objects will get the context, so can enquire what pass is being rendered.
+		// Gather the scene once, every pass below draws a filtered view of it.
+		m_renderContext.BeginFrame();
+		const CameraManager& cameras = CameraManager::Instance();
+		m_renderContext.SetLodView({ cameras.GetCameraPosition(), cameras.GetProject().m_column[1].y });
+		m_renderContext.EnableAxes(GameStateManager::Instance().IsDrawingDebugAxes());
 		GameObjectManager::Instance().Render(m_renderContext);
+		ParticleSystem::Instance().Render(m_renderContext);
 
-		m_renderContext.EndPass();
+		// Pass 1: Shadowmap Rendering
+		Graphics::PushMarker("Shadowmap Rendering");
 		// Render shadow objects to shadow buffer.
 
 		for (u16 sliceIndex = 0; sliceIndex < kNumLights; sliceIndex++)
@@ -205,31 +279,66 @@ public:
 			if (type == Graphics::LightType::LIGHT_POINT)
 				continue; // We do NOT support point light shadows. No way.
 
-			Matrix4x4f lightViewMatrix = Graphics::CreateShadowLightViewMatrix(sliceIndex);
+			// Directional lights reuse the matrices their static layer was cached with until the light turns too far.
+			Vector3f lightDirection = Graphics::GetLightDirection(sliceIndex);
+			bool bDirectional = type == Graphics::LightType::LIGHT_DIRECTIONAL;
+			bool bCachedMatrices = bDirectional && m_shadowCache.IsDirectionCached(sliceIndex, lightDirection);
+			Vector3f cacheDirection = bCachedMatrices ? m_shadowCache.GetDirection(sliceIndex) : lightDirection;
 
+			Matrix4x4f lightViewMatrix;
 			Matrix4x4f lightProjectMatrix;
-			if (type == Graphics::LightType::LIGHT_DIRECTIONAL)
-				lightProjectMatrix = Graphics::CreateShadowLightProjectMatrix(sliceIndex, 2.0f, -32, 32);
+			if (bCachedMatrices)
+			{
+				lightViewMatrix = m_shadowCache.GetView(sliceIndex);
+				lightProjectMatrix = m_shadowCache.GetProject(sliceIndex);
+			}
 			else
-				lightProjectMatrix = Graphics::CreateShadowLightProjectMatrix(sliceIndex, 0.0f, 0.1f, 100.f);
+			{
+				lightViewMatrix = Graphics::CreateShadowLightViewMatrix(sliceIndex);
+				if (bDirectional)
+					lightProjectMatrix = Graphics::CreateShadowLightProjectMatrix(sliceIndex, 2.0f, -32, 32);
+				else
+					lightProjectMatrix = Graphics::CreateShadowLightProjectMatrix(sliceIndex, 0.0f, 0.1f, 100.f);
+			}
 
-			Graphics::SetViewport(Graphics::Viewport({ kShadowMapDim,kShadowMapDim })); // prob scissor too.
-			Graphics::SetViewMatrix(lightViewMatrix);
-			Graphics::SetProjectionMatrix(lightProjectMatrix);
+			Matrix4x4f lightViewProjectMatrix = lightProjectMatrix * lightViewMatrix;
+			Graphics::SetLightMatrix(sliceIndex, lightViewProjectMatrix);
 
-			// Clear the shadow map and Render the Shadow Casting Objects	
-			Graphics::ClearDepthTarget(m_shadowMapDepthTargetArray, 1.0f, 0, sliceIndex);
-			Graphics::SetDepthOnlyTarget(m_shadowMapDepthTargetArray, 0, sliceIndex);
+			// Each light gets its own static and dynamic caster lists, culled to its frustum.
+			Frustum lightFrustum = Frustum::FromViewProjection(lightViewProjectMatrix);
+			PrepareShadowPass(RenderPassType::kStaticShadowPass, lightFrustum, lightViewMatrix, lightProjectMatrix);
 
-			Graphics::SetLightMatrix(sliceIndex, lightProjectMatrix * lightViewMatrix);
+			// Set once the capture is in the static pass, so it is recorded against it.
+			CapturedGraphics::SetViewport(Graphics::Viewport({ kShadowMapDim,kShadowMapDim })); // prob scissor too.
+			CapturedGraphics::SetViewMatrix(lightViewMatrix);
+			CapturedGraphics::SetProjectionMatrix(lightProjectMatrix);
 
 			// Colour is not important to us for the shadow map.
 			// We only want to render to the Depth buffer.
-			Graphics::SetMaterial(m_shadowCastMatId);
-			for (const MeshRenderCommand& cmd : m_renderContext.GetMeshCommands())
+			if (bDirectional)
+			{
+				u64 casterHash = m_renderContext.HashPassView();
+				if (m_shadowCache.NeedsRefresh(sliceIndex, cacheDirection, casterHash))
+				{
+					CapturedGraphics::ClearDepthTarget(m_staticShadowCacheArray, 1.0f, 0, sliceIndex);
+					CapturedGraphics::SetDepthOnlyTarget(m_staticShadowCacheArray, 0, sliceIndex);
+					DrawInstanceBatches(true);
+					m_shadowCache.Store(sliceIndex, cacheDirection, lightViewMatrix, lightProjectMatrix, casterHash);
+				}
+
+				CapturedGraphics::SetDepthOnlyTarget(m_shadowMapDepthTargetArray, 0, sliceIndex);
+				RestoreStaticShadows(sliceIndex);
+			}
+			else
 			{
-				Graphics::DrawMesh(cmd.meshId, cmd.worldMatrix);
+				// Spot lights follow the ships, so their static casters are drawn every frame.
+				CapturedGraphics::ClearDepthTarget(m_shadowMapDepthTargetArray, 1.0f, 0, sliceIndex);
+				CapturedGraphics::SetDepthOnlyTarget(m_shadowMapDepthTargetArray, 0, sliceIndex);
+				DrawInstanceBatches(true);
 			}
+
+			PrepareShadowPass(RenderPassType::kShadowPass, lightFrustum, lightViewMatrix, lightProjectMatrix);
+			DrawInstanceBatches(true);
 		}
 		Graphics::PopMarker();
 
@@ -238,71 +347,76 @@ public:
 		Graphics::TextureId postFXSurf = GetTransientSurface(Graphics::GetDisplaySurfaceSize(), Graphics::TextureFormat::RGBA_SRGB);
 		Graphics::TextureId postFXDepthSurf = GetTransientSurface(Graphics::GetDisplaySurfaceSize(), Graphics::TextureFormat::DEPTH);
 
-		Graphics::ClearRenderTarget(postFXSurf, Colour::Black);
-		Graphics::ClearDepthTarget(postFXDepthSurf);
-
 		// Pass 2: Forward rendering
-		m_renderContext.BeginPass(RenderPassType::kForwardPass);
-
-		GameObjectManager::Instance().Render(m_renderContext);
-
+		// Objects behind the planet are culled along with those outside the view.
+		m_renderContext.BeginPass(RenderPassType::kForwardPass, &CameraManager::Instance().GetFrustum(), &CameraManager::Instance().GetPlanetOccluder());
+		m_renderContext.SetViewPosition(CameraManager::Instance().GetCameraPosition());
 		m_renderContext.EndPass();
-
-		Graphics::SetRenderTargets(postFXSurf, postFXDepthSurf);
+		TextureStreamer::Instance().RequestForPass(m_renderContext, Graphics::GetDisplaySurfaceSize().m_height);
+		const Camera& camera = CameraManager::Instance().GetActiveCamera();
+		RenderCapture::Instance().BeginPass(RenderPassType::kForwardPass, camera.GetView(), camera.GetProject());
+		RenderCapture::Instance().RecordPassCommands(m_renderContext);
+		UploadInstanceBatches();
+
+		CapturedGraphics::ClearRenderTarget(postFXSurf, Colour::Black);
+		CapturedGraphics::ClearDepthTarget(postFXDepthSurf);
+		CapturedGraphics::SetRenderTargets(postFXSurf, postFXDepthSurf);
 		Graphics::SurfaceSize surfaceSize = Graphics::GetDisplaySurfaceSize();
-		Graphics::SetViewport(Graphics::Viewport(surfaceSize));
+		CapturedGraphics::SetViewport(Graphics::Viewport(surfaceSize));
 		CameraManager::Instance().ApplyActiveCameraMatrices();
 
-		Graphics::BindGlobalTexture(Graphics::kShadowMapTextureSlot, m_shadowMapDepthTargetArray, m_shadowMapSampler, Graphics::ShaderStageFlag::PIXEL_STAGE, Graphics::TextureBindFlags::SRV);
+		CapturedGraphics::BindGlobalTexture(Graphics::kShadowMapTextureSlot, m_shadowMapDepthTargetArray, m_shadowMapSampler, Graphics::ShaderStageFlag::PIXEL_STAGE, Graphics::TextureBindFlags::SRV);
 
-		// Render all the meshes
-		for (const MeshRenderCommand& cmd : m_renderContext.GetMeshCommands())
-		{
-			Graphics::SetMaterial(cmd.materialId);
-			Graphics::DrawMesh(cmd.meshId, cmd.worldMatrix);
-		}
+		// Render all the meshes, commands arrive sorted and grouped into instance batches.
+		m_meshDrawCalls = 0;
+		DrawInstanceBatches(false);
 
 		Graphics::DrawEnvironmentSkybox();
 
 		// Render all the particle FX
 		for (const ParticleRenderCommand& cmd : m_renderContext.GetParticleCommands())
 		{
-			Graphics::SetMaterial(cmd.materialId);
-			Graphics::SetWorldMatrix(cmd.worldMatrix);
-			Graphics::BindGlobalBuffer(Graphics::kGlobalBufferSlotStart, cmd.particleBufferId, Graphics::ShaderStageFlag::VERTEX_STAGE, Graphics::BufferBindFlags::SRV);
-			Graphics::DrawWithoutVertices(cmd.particleCount * 6);
+			CapturedGraphics::SetMaterial(cmd.materialId);
+			CapturedGraphics::SetWorldMatrix(cmd.worldMatrix);
+			CapturedGraphics::BindGlobalBuffer(Graphics::kGlobalBufferSlotStart, cmd.particleBufferId, Graphics::ShaderStageFlag::VERTEX_STAGE, Graphics::BufferBindFlags::SRV);
+			if (cmd.emitterBufferId.IsValid())
+			{
+				CapturedGraphics::BindGlobalBuffer(Graphics::kGlobalBufferSlotStart + 1, cmd.emitterBufferId, Graphics::ShaderStageFlag::VERTEX_STAGE, Graphics::BufferBindFlags::SRV);
+			}
+			CapturedGraphics::DrawWithoutVertices(cmd.particleCount * 6, cmd.particleOffset * 6);
 		}
 
 		Graphics::PopMarker();
 
 		// Pass 3: PostFX Rendering
 		Graphics::PushMarker("Post Processing Effects Rendering");
-		Graphics::SetRenderTargetsToSwapChain(true);
+		// Recorded as part of the forward pass, the capture has no pass of its own for it.
+		CapturedGraphics::SetRenderTargetsToSwapChain(true);
 
 		m_postfxConstantData.RcpFrame = Vector4f(1.0f / Graphics::GetDisplaySurfaceSize().m_width, 1.0f / Graphics::GetDisplaySurfaceSize().m_height, true, 0.0f);
-		Graphics::UpdateBuffer(m_postfxConstantBufferId, &m_postfxConstantData, sizeof(m_postfxConstantData));
-		Graphics::BindGlobalBuffer(Graphics::kGlobalBufferSlotStart, m_postfxConstantBufferId, Graphics::ShaderStageFlag::PIXEL_STAGE);
-		Graphics::BindGlobalTexture(Graphics::kGlobalTextureSlotStart, postFXSurf, Graphics::SamplerId(), Graphics::ShaderStageFlag::PIXEL_STAGE, Graphics::TextureBindFlags::SRV);
+		CapturedGraphics::UpdateBuffer(m_postfxConstantBufferId, &m_postfxConstantData, sizeof(m_postfxConstantData));
+		CapturedGraphics::BindGlobalBuffer(Graphics::kGlobalBufferSlotStart, m_postfxConstantBufferId, Graphics::ShaderStageFlag::PIXEL_STAGE);
+		CapturedGraphics::BindGlobalTexture(Graphics::kGlobalTextureSlotStart, postFXSurf, Graphics::SamplerId(), Graphics::ShaderStageFlag::PIXEL_STAGE, Graphics::TextureBindFlags::SRV);
 
-		Graphics::SetMaterial(m_PostFXMatId);
-		Graphics::DrawWithoutVertices(3);
+		CapturedGraphics::SetMaterial(m_PostFXMatId);
+		CapturedGraphics::DrawWithoutVertices(3);
 
-		Graphics::BindGlobalTexture(Graphics::kGlobalTextureSlotStart, Graphics::TextureId(), Graphics::SamplerId(), Graphics::ShaderStageFlag::PIXEL_STAGE, Graphics::TextureBindFlags::SRV);
+		CapturedGraphics::BindGlobalTexture(Graphics::kGlobalTextureSlotStart, Graphics::TextureId(), Graphics::SamplerId(), Graphics::ShaderStageFlag::PIXEL_STAGE, Graphics::TextureBindFlags::SRV);
 		Graphics::PopMarker();
 
 		// Pass 4: Debug Rendering ///////////////////////////////////// DEBUG PASS ///////////////////////////////////////////////////////////////
 		Graphics::PushMarker("Debug Rendering");
 		m_renderContext.BeginPass( RenderPassType::kDebugPass );
-		GameObjectManager::Instance().Render( m_renderContext );
 		m_renderContext.EndPass();
 
 		////////////////////////////////// Draw Debugging axes for player and light ////////////////////////////////////////////////////////////////
 		Graphics::BeginPrimitiveBatch(false);
 		//GameStateManager::Instance().DrawDebugAxes();
 
+		// Empty unless the debug axes are switched on, objects only gather them then.
 		for (const AxisRenderCommand& cmd : m_renderContext.GetAxisCommands())
 		{
-			//Graphics::DrawAxes( cmd.worldMatrix, 1.0f );
+			Graphics::DrawAxes( cmd.worldMatrix, 1.0f );
 		}
 
 		Graphics::EndPrimitiveBatch();
@@ -316,7 +430,60 @@ public:
 			System::GetDeltaTime() * 1000.f,
 			System::GetElapsedTime(),
 			Graphics::GetGPUFrameTime());
+		UI::DrawPrintf(m_debugFontId,
+			Vector2f(20, 60),
+			Colour::Lightblue,
+			"[particles emitters=%u culled=%u batches=%u live=%u/%u uploaded=%.1fKB recycled=%u evicted=%u update=%.3fms threads=%u (T)]",
+			ParticleSystem::Instance().GetStats().emitters,
+			ParticleSystem::Instance().GetStats().culled,
+			ParticleSystem::Instance().GetStats().batches,
+			ParticleSystem::Instance().GetStats().liveParticles,
+			ParticleSystem::kMaxParticles,
+			ParticleSystem::Instance().GetStats().bytesUploaded / 1024.f,
+			ParticleSystem::Instance().GetStats().recycled,
+			ParticleSystem::Instance().GetStats().evicted,
+			ParticleSystem::Instance().GetStats().updateMs,
+			ParticleSystem::Instance().GetStats().updateThreads);
+		const PassStats& forwardStats = m_renderContext.GetPassStats(RenderPassType::kForwardPass);
+		UI::DrawPrintf(m_debugFontId,
+			Vector2f(20, 80),
+			Colour::Lightblue,
+			"[forward commands=%u culled=%u (behind planet %u) draws=%u material switches=%u (unsorted %u) mesh switches=%u (unsorted %u)]",
+			forwardStats.commands,
+			forwardStats.culled,
+			forwardStats.occluded,
+			m_meshDrawCalls,
+			forwardStats.materialSwitches,
+			forwardStats.materialSwitchesUnsorted,
+			forwardStats.meshSwitches,
+			forwardStats.meshSwitchesUnsorted);
+		const PassStats& shadowStats = m_renderContext.GetPassStats(RenderPassType::kShadowPass);
+		UI::DrawPrintf(m_debugFontId,
+			Vector2f(20, 100),
+			Colour::Lightblue,
+			"[shadow dynamic=%u static=%u culled=%u (all lights) cache refreshes=%u] [gather=%.3fms threads=%u]",
+			shadowStats.commands,
+			m_renderContext.GetPassStats(RenderPassType::kStaticShadowPass).commands,
+			shadowStats.culled + m_renderContext.GetPassStats(RenderPassType::kStaticShadowPass).culled,
+			m_shadowCache.GetRefreshCount(),
+			GameObjectManager::Instance().GetGatherMs(),
+			JobManager::Instance().GetWorkerCount() + 1);
+		const TextureResidency::Stats& streamStats = TextureStreamer::Instance().GetStats();
+		UI::DrawPrintf(m_debugFontId,
+			Vector2f(20, 120),
+			Colour::Lightblue,
+			"[textures resident=%.1fMB wanted=%.1fMB full=%.1fMB budget=%.1fMB (M) loading=%u waiting=%u failed=%u loads=%u evictions=%u]",
+			streamStats.residentBytes / (1024.f * 1024.f),
+			streamStats.wantedBytes / (1024.f * 1024.f),
+			streamStats.fullBytes / (1024.f * 1024.f),
+			TextureStreamer::Instance().GetBudget() / (1024.f * 1024.f),
+			streamStats.loadsInFlight,
+			streamStats.waiting,
+			streamStats.failed,
+			streamStats.loads,
+			streamStats.evictions);
 		// End frame
+		RenderCapture::Instance().EndFrame();
 		System::EndFrame();
 		Graphics::PopMarker();
 	}
@@ -329,8 +496,137 @@ public:
 		System::Shutdown();
 
 	}
+	// Presents frames while the assets load, so the window stays responsive.
+	void RenderLoadingScreen()
+	{
+		Graphics::SetRenderTargetsToSwapChain(true);
+		Graphics::SurfaceSize surfaceSize = Graphics::GetDisplaySurfaceSize();
+		UI::DrawPrintf(m_debugFontId,
+			Vector2f(surfaceSize.m_width / 2.f - 60.f, surfaceSize.m_height / 2.f),
+			Colour::Lightblue,
+			"Loading %.0f%%",
+			AssetManager::Instance().GetLoadingProgress() * 100.f);
+		RenderCapture::Instance().EndFrame();
+		System::EndFrame();
+	}
+
+	// Selects the casters of one shadow pass for the light and uploads their instance data.
+	void PrepareShadowPass(RenderPassType type, const Frustum& lightFrustum, const Matrix4x4f& lightViewMatrix, const Matrix4x4f& lightProjectMatrix)
+	{
+		m_renderContext.BeginPass(type, &lightFrustum);
+		m_renderContext.SetViewPosition(CameraManager::Instance().GetCameraPosition());
+		m_renderContext.EndPass();
+		RenderCapture::Instance().BeginPass(type, lightViewMatrix, lightProjectMatrix);
+		RenderCapture::Instance().RecordPassCommands(m_renderContext);
+		UploadInstanceBatches();
+	}
+
+	// Overwrites the bound shadow map slice with the cached static layer.
+	void RestoreStaticShadows(u16 sliceIndex)
+	{
+		m_shadowCacheConstantData.Slice[0] = sliceIndex;
+		CapturedGraphics::UpdateBuffer(m_shadowCacheConstantBufferId, &m_shadowCacheConstantData, sizeof(m_shadowCacheConstantData));
+		CapturedGraphics::BindGlobalBuffer(Graphics::kGlobalBufferSlotStart, m_shadowCacheConstantBufferId, Graphics::ShaderStageFlag::PIXEL_STAGE);
+		CapturedGraphics::BindGlobalTexture(Graphics::kGlobalTextureSlotStart, m_staticShadowCacheArray, Graphics::SamplerId(), Graphics::ShaderStageFlag::PIXEL_STAGE, Graphics::TextureBindFlags::SRV);
+
+		CapturedGraphics::SetMaterial(m_shadowRestoreMatId);
+		CapturedGraphics::DrawWithoutVertices(3);
+
+		// Unbind, the cache is a render target again when it next refreshes.
+		CapturedGraphics::BindGlobalTexture(Graphics::kGlobalTextureSlotStart, Graphics::TextureId(), Graphics::SamplerId(), Graphics::ShaderStageFlag::PIXEL_STAGE, Graphics::TextureBindFlags::SRV);
+	}
+
+	// SV_InstanceID restarts at zero for every draw, so each instanced batch gets its own buffer.
+	void UploadInstanceBatches()
+	{
+		const std::vector<Matrix4x4f>& matrices = m_renderContext.GetInstanceMatrices();
+		u32 bufferIndex = 0;
+
+		for (const InstanceBatch& batch : m_renderContext.GetInstanceBatches())
+		{
+			if (batch.instanceCount < 2)
+				continue;
+
+			if (bufferIndex == m_instanceBuffers.size())
+			{
+				Graphics::BufferDesc desc;
+				desc.SetDynamicStructuredBuffer<Matrix4x4f>(RenderContext::kMaxInstancesPerBatch);
+				desc.m_pDebugName = "InstanceBatch";
+				m_instanceBuffers.push_back(Resources::CreateAsset<Graphics::Buffer>(desc));
+			}
+
+			CapturedGraphics::UpdateBuffer(m_instanceBuffers[bufferIndex], &matrices[batch.firstInstance], batch.instanceCount * sizeof(Matrix4x4f));
+			bufferIndex++;
+		}
+	}
+
+	// Draws the batches of the current pass, in the same order they were uploaded.
+	void DrawInstanceBatches(bool bShadowPass)
+	{
+		const std::vector<Matrix4x4f>& matrices = m_renderContext.GetInstanceMatrices();
+		Graphics::MaterialId currentMaterial;
+		u32 bufferIndex = 0;
+
+		for (const InstanceBatch& batch : m_renderContext.GetInstanceBatches())
+		{
+			// A mesh that failed to load draws nothing, but its batch still had a buffer uploaded.
+			const Graphics::Mesh* pMesh = Resources::GetPtr(batch.meshId);
+			if (!pMesh)
+			{
+				if (batch.instanceCount > 1)
+					bufferIndex++;
+				continue;
+			}
+
+			bool bInstanced = batch.instanceCount > 1;
+			Graphics::MaterialId material;
+			if (bShadowPass && pMesh->HasCompactVertices())
+				material = bInstanced ? m_shadowCastCompactInstancedMatId : m_shadowCastCompactMatId;
+			else if (bShadowPass)
+				material = bInstanced ? m_shadowCastInstancedMatId : m_shadowCastMatId;
+			else
+				material = bInstanced ? AssetManager::Instance().GetInstancedMaterial(batch.materialId) : batch.materialId;
+
+			// No instanced variant, fall back to a draw per command.
+			if (bInstanced && material.IsInvalid())
+			{
+				material = batch.materialId;
+				bInstanced = false;
+			}
+
+			if (material != currentMaterial)
+			{
+				CapturedGraphics::SetMaterial(material);
+				currentMaterial = material;
+			}
+
+			if (bInstanced)
+			{
+				CapturedGraphics::BindGlobalBuffer(Graphics::kInstanceDataBufferSlot, m_instanceBuffers[bufferIndex], Graphics::ShaderStageFlag::VERTEX_STAGE, Graphics::BufferBindFlags::SRV);
+				CapturedGraphics::DrawInstancedMesh(batch.meshId, batch.instanceCount, batch.elementOffset, batch.elementCount);
+				m_meshDrawCalls++;
+			}
+			else
+			{
+				for (u32 i = 0; i < batch.instanceCount; i++)
+				{
+					CapturedGraphics::DrawMesh(batch.meshId, matrices[batch.firstInstance + i], batch.elementOffset, batch.elementCount);
+					m_meshDrawCalls++;
+				}
+			}
+
+			if (batch.instanceCount > 1)
+				bufferIndex++;
+		}
+	}
+
 	Graphics::MaterialId m_shadowCastMatId;
+	Graphics::MaterialId m_shadowCastInstancedMatId;
+	Graphics::MaterialId m_shadowCastCompactMatId;
+	Graphics::MaterialId m_shadowCastCompactInstancedMatId;
 	Graphics::MaterialId m_PostFXMatId;
+	std::vector<Graphics::BufferId> m_instanceBuffers;
+	u32 m_meshDrawCalls = 0;
 };
 
 int PlayMain()
@@ -7,6 +7,9 @@
 #include "Objects/Volcano.h"
 #include "GameObjectManager.h"
 #include "RenderContext.h"
+#include "Utilities/JobManager.h"
+#include "Utilities/ParallelGather.h"
+#include <chrono>
 
 ///////////////////////////////////////////////////////////////////////////
 //	File		: GameObjectManager.cpp
@@ -32,6 +35,8 @@ void GameObjectManager::Update( float dT )
 {
 	for ( auto obj : m_pGameObjects )
 	{
+		// particle emitters are stepped in parallel by the ParticleSystem
+		if ( obj->GetType() == GameObjectType::TYPE_PARTICLE ) continue;
 		if ( !obj->IsObjDead() )
 			obj->Update( dT );
 	}
@@ -52,12 +57,14 @@ void GameObjectManager::PostUpdate()
 	m_pCreatedGameObjects.clear();
 }
 
-void GameObjectManager::Render( RenderContext& ctx ) const
+void GameObjectManager::Render( RenderContext& ctx )
 {
-	for ( const auto obj : m_pGameObjects )
-	{
-		obj->Render( ctx );
-	}
+	auto start = std::chrono::high_resolution_clock::now();
+
+	ParallelGather( JobManager::Instance(), m_pGameObjects, kObjectsPerGatherChunk, m_gatherContexts, ctx );
+
+	auto end = std::chrono::high_resolution_clock::now();
+	m_gatherMs = std::chrono::duration< float, std::milli >( end - start ).count();
 }
 
 GameObject* GameObjectManager::GetObjectByType( GameObjectType type )
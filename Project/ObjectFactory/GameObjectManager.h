@@ -29,7 +29,11 @@ public:
 
 	void Update( float dT );
 	void PostUpdate();
-	void Render( RenderContext& ctx ) const;
+	static constexpr u32 kObjectsPerGatherChunk = 64;
+
+	// Gathers render commands in chunks across the job workers, then merges them into ctx in object order.
+	void Render( RenderContext& ctx );
+	float GetGatherMs() const { return m_gatherMs; }
 	void DestroyAllObjects();
 
 	GameObject* GetObjectByType( GameObjectType type );
@@ -54,6 +58,8 @@ private:
 	std::vector< GameObject* > m_pCreatedGameObjects;
 	std::vector< GameObject* > m_pGameObjects;
 	std::vector< Vector3f > m_volcanoPositions;
+	std::vector< RenderContext > m_gatherContexts; // one per chunk, reused every frame
+	float m_gatherMs{ 0.f };
 };
 
 template< GameObjectable T, typename... Args >
@@ -122,19 +122,17 @@ AssetType Asteroid::ConvertType( AsteroidType type )
 
 void Asteroid::Render( RenderContext& ctx ) const 
 {
-	if( ctx.GetRenderPassType() != RenderPassType::kDebugPass )
-	{
-		MeshRenderCommand cmd;
-		cmd.meshId = m_meshId;
-		cmd.materialId = m_materialId;
-		cmd.worldMatrix = m_drawTransform;
-		ctx.RenderMesh( cmd );
-	}
-	else // collect commands only if right pass is being rendered
+	MeshRenderCommand cmd;
+	cmd.meshId = m_meshId;
+	cmd.materialId = m_materialId;
+	cmd.worldMatrix = m_drawTransform;
+	ctx.RenderMesh( cmd );
+
+	if ( ctx.WantsAxes() )
 	{
-		AxisRenderCommand cmd;
-		cmd.worldMatrix = m_transform;
-		ctx.RenderAxis( cmd );
+		AxisRenderCommand axisCmd;
+		axisCmd.worldMatrix = m_transform;
+		ctx.RenderAxis( axisCmd );
 	}
 }
 
@@ -35,18 +35,16 @@ AssetType Debris::ConvertType( AsteroidType type ) const
 
 void Debris::Render( RenderContext& ctx ) const
 {
-	if ( ctx.GetRenderPassType() != RenderPassType::kDebugPass )
-	{
-		MeshRenderCommand cmd;
-		cmd.meshId = m_meshId;
-		cmd.materialId = m_materialId;
-		cmd.worldMatrix = m_transform;
-		ctx.RenderMesh( cmd );
-	}
-	else // collect commands only if right pass is being rendered
+	MeshRenderCommand cmd;
+	cmd.meshId = m_meshId;
+	cmd.materialId = m_materialId;
+	cmd.worldMatrix = m_transform;
+	ctx.RenderMesh( cmd );
+
+	if ( ctx.WantsAxes() )
 	{
-		AxisRenderCommand cmd;
-		cmd.worldMatrix = m_transform;
-		ctx.RenderAxis( cmd );
+		AxisRenderCommand axisCmd;
+		axisCmd.worldMatrix = m_transform;
+		ctx.RenderAxis( axisCmd );
 	}
 }
\ No newline at end of file
@@ -136,19 +136,17 @@ void Enemy::BounceOff( GameObject* obj, float overlap )
 
 void Enemy::Render( RenderContext& ctx ) const
 {
-	if ( ctx.GetRenderPassType() != RenderPassType::kDebugPass )
-	{
-		MeshRenderCommand cmd;
-		cmd.meshId = m_meshId;
-		cmd.materialId = m_materialId;
-		cmd.worldMatrix = m_drawTransform;
-		ctx.RenderMesh( cmd );
-	}
-	else
+	MeshRenderCommand cmd;
+	cmd.meshId = m_meshId;
+	cmd.materialId = m_materialId;
+	cmd.worldMatrix = m_drawTransform;
+	ctx.RenderMesh( cmd );
+
+	if ( ctx.WantsAxes() )
 	{
-		AxisRenderCommand cmd;
-		//cmd.worldMatrix = m_drawTranform;
-		cmd.worldMatrix = m_transform;
-		ctx.RenderAxis( cmd );
+		AxisRenderCommand axisCmd;
+		//axisCmd.worldMatrix = m_drawTranform;
+		axisCmd.worldMatrix = m_transform;
+		ctx.RenderAxis( axisCmd );
 	}
 }
\ No newline at end of file
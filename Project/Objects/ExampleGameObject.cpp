@@ -26,18 +26,16 @@ void ExampleGameObject::Update( float dT )
 
 void ExampleGameObject::Render( RenderContext& ctx ) const
 {
-	if ( ctx.GetRenderPassType() != RenderPassType::kDebugPass )
-	{
-		MeshRenderCommand cmd;
-		cmd.meshId = m_meshId;
-		cmd.materialId = m_materialId;
-		cmd.worldMatrix = m_transform;
-		ctx.RenderMesh(cmd);
-	}
-	else
+	MeshRenderCommand cmd;
+	cmd.meshId = m_meshId;
+	cmd.materialId = m_materialId;
+	cmd.worldMatrix = m_transform;
+	ctx.RenderMesh(cmd);
+
+	if (ctx.WantsAxes())
 	{
-		AxisRenderCommand cmd;
-		cmd.worldMatrix = m_transform;
-		ctx.RenderAxis(cmd);
+		AxisRenderCommand axisCmd;
+		axisCmd.worldMatrix = m_transform;
+		ctx.RenderAxis(axisCmd);
 	}
 }
@@ -24,18 +24,17 @@ void Planet::Update( float dT )
 
 void Planet::Render( RenderContext& ctx ) const
 {
-	if ( ctx.GetRenderPassType() != RenderPassType::kDebugPass )
-	{
-		MeshRenderCommand cmd; // create render command 
-		cmd.meshId = m_meshId;
-		cmd.materialId = m_materialId;
-		cmd.worldMatrix = m_transform;
-		ctx.RenderMesh(cmd); // add command to the render context
-	}
-	else
+	MeshRenderCommand cmd; // create render command 
+	cmd.meshId = m_meshId;
+	cmd.materialId = m_materialId;
+	cmd.worldMatrix = m_transform;
+	cmd.passMask = kStaticShadowAndForwardPasses; // never moves, so its shadow is cached
+	ctx.RenderMesh(cmd); // add command to the render context
+
+	if (ctx.WantsAxes())
 	{
-		AxisRenderCommand cmd;
-		cmd.worldMatrix = m_transform;
-		ctx.RenderAxis(cmd);
+		AxisRenderCommand axisCmd;
+		axisCmd.worldMatrix = m_transform;
+		ctx.RenderAxis(axisCmd);
 	}
 }
\ No newline at end of file
@@ -36,18 +36,17 @@ AssetType Volcano::ConvertType( VolcanoType type )
 
 void Volcano::Render( RenderContext& ctx ) const
 {
-	if (ctx.GetRenderPassType() != RenderPassType::kDebugPass)
+	MeshRenderCommand cmd; // create render command 
+	cmd.meshId = m_meshId;
+	cmd.materialId = m_materialId;
+	cmd.worldMatrix = m_transform;
+	cmd.passMask = kStaticShadowAndForwardPasses;
+	ctx.RenderMesh(cmd); // add command to the render context
+
+	if (ctx.WantsAxes())
 	{
-		MeshRenderCommand cmd; // create render command 
-		cmd.meshId = m_meshId;
-		cmd.materialId = m_materialId;
-		cmd.worldMatrix = m_transform;
-		ctx.RenderMesh(cmd); // add command to the render context
-	}
-	else
-	{
-		AxisRenderCommand cmd;
-		cmd.worldMatrix = m_transform;
-		ctx.RenderAxis(cmd);
+		AxisRenderCommand axisCmd;
+		axisCmd.worldMatrix = m_transform;
+		ctx.RenderAxis(axisCmd);
 	}
 }
\ No newline at end of file
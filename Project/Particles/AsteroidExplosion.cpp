@@ -12,10 +12,9 @@ AsteroidExplosion::AsteroidExplosion( ParticleType type, Vector3f pos, int count
 	m_position = pos;
 	m_color = color;
 
-	GenerateFreeList();
+	ReserveParticles();
 	GenerateParticlesBatch();
 	CreateParticleMaterial( type );
-	CreateParticleBuffer();
 }
 
 AsteroidExplosion::~AsteroidExplosion()
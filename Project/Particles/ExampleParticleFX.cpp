@@ -2,13 +2,15 @@
 #include "Types.h"
 #include "ExampleParticleFX.h"
 #include "AssetManager.h"
+#include "ParticleSystem.h"
+#include "ParticlePacking.h"
 #include "RenderContext.h"
 
 
 
 ParticleFX::~ParticleFX()
 {
-
+	if ( m_bRegistered ) ParticleSystem::Instance().Unregister( this );
 }
 
 void ParticleFX::CreateParticleMaterial( ParticleType type )
@@ -16,38 +18,42 @@ void ParticleFX::CreateParticleMaterial( ParticleType type )
 	m_materialId = AssetManager::Instance().GetParticleMaterial( type );
 }
 
-void ParticleFX::CreateParticleBuffer()
-{
-	// Make a GPU block of particles as a Structured buffer
-	Graphics::BufferDesc desc;
-	desc.SetDynamicStructuredBuffer< Particle >((u32)m_particlesCPU.size(), m_particlesCPU.data());
-	desc.m_pDebugName = "ParticleBuffer";
-	m_particlesGPU = Resources::CreateAsset< Graphics::Buffer >(desc);
-}
-
 void ParticleFX::AddParticleToCPU( Vector3f pos, Vector3f vel, float scale, Vector3f color )
 {
-	int index = m_freeList.back();
-	m_particlesCPU[ index ].pos = pos;
-	m_particlesCPU[ index ].vel = vel;
-	m_particlesCPU[ index ].scale = scale;
-	m_particlesCPU[ index ].colour = color;
-	m_particlesCPU[ index ].life[ 0 ] = 0.0f;
-	m_particlesCPU[ index ].life[ 1 ] = m_lifetime;
+	if ( m_liveParticles >= m_particleCount ) return; // emitter is full, drop the particle
+
+	// Grow the bounds by the furthest this particle can travel before it expires.
+	float reach = length( vel ) * m_lifetime + scale;
+	if ( m_liveParticles == 0 )
+	{
+		m_boundsCentre = pos;
+		m_boundsRadius = reach;
+		m_paletteIndex = FindParticleColourIndex( color );
+	}
+	else
+	{
+		m_boundsRadius = std::max( m_boundsRadius, length( pos - m_boundsCentre ) + reach );
+	}
 
-	CountParticles( 1 );
-	m_freeList.pop_back();
+	Particle& p = m_particlesCPU[ m_liveParticles ];
+	p.pos = pos;
+	p.vel = vel;
+	p.scale = scale;
+	p.colour = color;
+	p.life[ 0 ] = 0.0f;
+	p.life[ 1 ] = m_lifetime;
+
+	m_liveParticles++;
+	m_bDirty = true;
 }
 
-void ParticleFX::GenerateFreeList()
+void ParticleFX::ReserveParticles()
 {
+	// The particle system may grant less than asked for when the shared pool is over budget.
+	m_particleCount = ParticleSystem::Instance().Register( this, m_particleCount );
+	m_bRegistered = true;
 	m_particlesCPU.resize( m_particleCount );
-	m_freeList.reserve( m_particleCount );
-
-	for ( int i = m_particleCount; i > -1; i-- )
-	{
-		m_freeList.push_back( i );
-	}
+	m_liveParticles = 0;
 }
 
 void ParticleFX::GenerateParticlesBatch()
@@ -60,46 +66,39 @@ void ParticleFX::GenerateParticlesBatch()
 
 void ParticleFX::Update( float dT )
 {
-	// Animate the particles on the CPU.
-	for (u32 i = 0; i < m_particleCount; ++i)
+	// Animate the particles on the CPU, expired ones are swapped out so the index is re-checked.
+	for ( u32 i = 0; i < m_liveParticles; )
 	{
 		UpdateSingleParticle( i, dT );
-		KillExpiredParticle( i );
+		if ( !KillExpiredParticle( i ) ) ++i;
 	}
-	// Issue a command to update the particles.
-	Graphics::UpdateBuffer( m_particlesGPU, m_particlesCPU.data(), m_particlesCPU.size() * sizeof(Particle) );
 }
 
 void ParticleFX::UpdateSingleParticle( int index, float dT )
 {
-	if ( m_particlesCPU[ index ].life[ 0 ] >= 0.f )
-	{
-		m_particlesCPU[ index ].vel += m_acceleration;
-		m_particlesCPU[ index ].pos += m_particlesCPU[ index ].vel * dT;
-		m_particlesCPU[ index ].life[ 0 ] += dT;
-	}
+	// A paused step changes nothing, so the emitter stays clean and skips its upload. Time never runs backwards.
+	if ( dT <= 0.0f ) return;
+
+	m_particlesCPU[ index ].vel += m_acceleration * dT;
+	m_particlesCPU[ index ].pos += m_particlesCPU[ index ].vel * dT;
+	m_particlesCPU[ index ].life[ 0 ] += dT;
+	m_bDirty = true;
 }
 
-void ParticleFX::KillExpiredParticle( int index )
+bool ParticleFX::KillExpiredParticle( int index )
 {
-	if (m_particlesCPU[ index ].life[ 0 ] > m_lifetime)
+	if ( m_particlesCPU[ index ].life[ 0 ] > m_lifetime )
 	{
-		m_particlesCPU[ index ].life[ 0 ] = -1;
-		m_freeList.push_back( index );
-		CountParticles( -1 );
+		// move the last live particle into the hole to keep the live range packed
+		m_liveParticles--;
+		m_particlesCPU[ index ] = m_particlesCPU[ m_liveParticles ];
+		m_bDirty = true;
+		return true;
 	}
+	return false;
 }
 
 void ParticleFX::Render( RenderContext& ctx ) const
 {
-	if ( ctx.GetRenderPassType() == RenderPassType::kForwardPass )
-	{
-		ParticleRenderCommand cmd;
-		cmd.worldMatrix = m_transform;
-		cmd.particleCount = m_particleCount;
-		cmd.materialId = m_materialId;
-		cmd.particleBufferId = m_particlesGPU;
-		
-		ctx.RenderParticles( cmd );		
-	}
+	// Drawing is batched by material in ParticleSystem::Render.
 }
@@ -1,4 +1,3 @@
-
 ///////////////////////////////////////////////////////////////////////////
 //	File		: ExampleParticleFX.h
 //
@@ -31,28 +30,53 @@ public:
 	void Render( RenderContext& ctx ) const override;
 	GameObjectType GetType() const override { return GameObjectType::TYPE_PARTICLE; };
 
+	// Finished emitters are recycled by the ParticleSystem, evictable ones can be dropped when the budget is full.
+	virtual bool IsFinished() const { return m_liveParticles == 0; }
+	virtual bool IsEvictable() const { return true; }
+
 	void UpdatePosition( Vector3f pos ) { m_position = pos; }
 	void UpdateVelocity( Vector3f vel ) { m_velocity = vel; }
 	void CreateParticleMaterial( ParticleType type );
-	void CreateParticleBuffer();
 	void AddParticleToCPU( Vector3f pos, Vector3f vel, float scale, Vector3f color = { 1.f, 1.f, 1.f });
-	void GenerateFreeList();
+	void ReserveParticles();
 	void UpdateSingleParticle( int index, float dT );
-	void KillExpiredParticle( int index );
+	bool KillExpiredParticle( int index );
 	void UpdateBatch(u32 count) { m_particleBatch = count; }
-	void CountParticles( int delta ) { m_liveParticles += delta; }
+	u32 GetLiveParticleCount() const { return m_liveParticles; }
+	u32 GetCapacity() const { return m_particleCount; }
+	const Particle* GetParticles() const { return m_particlesCPU.data(); }
+	const Vector3f& GetEmitterOrigin() const { return m_position; }
+	u8 GetPaletteIndex() const { return m_paletteIndex; }
+	bool ConsumeDirty() { bool bDirty = m_bDirty; m_bDirty = false; return bDirty; }
+
+	// Conservative sphere around everything emitted since the emitter last ran empty.
+	const Vector3f& GetBoundsCentre() const { return m_boundsCentre; }
+	float GetBoundsRadius() const { return m_boundsRadius; }
+	bool IsBounded() const { return m_bBounded; }
+	bool IsVisible() const { return m_bVisible; }
+	void SetVisible( bool bVisible ) { m_bVisible = bVisible; }
+	// Hidden emitters bank their frame time and are stepped less often.
+	float AccumulateTime( float dT ) { return m_pendingTime += dT; }
+	void ClearPendingTime() { m_pendingTime = 0.0f; }
 	virtual void GenerateParticlesBatch();
 
 protected:
+	// Live particles are kept packed in [0, m_liveParticles), so only that prefix is uploaded and drawn.
 	std::vector< Particle > m_particlesCPU;
-	std::vector< int > m_freeList;
-	Graphics::BufferId m_particlesGPU;
 	Vector3f m_acceleration{ 0.0f };
 	Vector3f m_velocity{ 0.0f };
 	Vector3f m_position{ 0.0f };
 	u32 m_particleCount{ 1000 };
 	u32 m_particleBatch{ 0 };
-	int m_liveParticles{ 0 };
+	u32 m_liveParticles{ 0 };
+	bool m_bDirty{ false };
+	bool m_bRegistered{ false };
+	bool m_bBounded{ true }; // false when particles are steered and can't be bounded ballistically
+	bool m_bVisible{ true };
+	Vector3f m_boundsCentre{ 0.0f };
+	float m_boundsRadius{ 0.0f };
+	float m_pendingTime{ 0.0f };
+	u8 m_paletteIndex{ 0 }; // g_vParticleColours entry closest to the emitted colour
 	float m_lifetime{ 0.0f };
 	Vector3f m_color;
-};
\ No newline at end of file
+};
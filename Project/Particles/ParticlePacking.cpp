@@ -0,0 +1,96 @@
+#include "GameMath.h"
+#include "Types.h"
+#include "ParticlePacking.h"
+#include <emmintrin.h>
+
+
+u8 FindParticleColourIndex( const Vector3f& colour )
+{
+	u8 best = 0;
+	float bestDistance = FLT_MAX;
+	for ( int i = 0; i < static_cast< int >(Color::TOTAL_COLOURS); i++ )
+	{
+		float distance = lengthSqr( g_vParticleColours[ i ] - colour );
+		if ( distance < bestDistance )
+		{
+			bestDistance = distance;
+			best = static_cast< u8 >(i);
+		}
+	}
+	return best;
+}
+
+// Four floats to half floats with SSE2, rounding to nearest. Values out of half range clamp to the largest half.
+static __m128i FloatToHalf4( __m128 f )
+{
+	const __m128 signMask = _mm_castsi128_ps( _mm_set1_epi32( 0x80000000 ) );
+	const __m128 roundMask = _mm_castsi128_ps( _mm_set1_epi32( ~0xfff ) );
+	const __m128 magic = _mm_castsi128_ps( _mm_set1_epi32( 15 << 23 ) );
+	// 65504 after the rebias, the rounding below then stays short of the infinity exponent
+	const __m128 clampMax = _mm_castsi128_ps( _mm_set1_epi32( ( 31 << 23 ) - 0x2000 ) );
+
+	__m128 sign = _mm_and_ps( f, signMask );
+	__m128 absf = _mm_xor_ps( f, sign );
+	// rebias the exponent by multiplying, denormals fall out of the float maths for free
+	__m128 scaled = _mm_mul_ps( _mm_and_ps( absf, roundMask ), magic );
+	scaled = _mm_min_ps( scaled, clampMax );
+	__m128i biased = _mm_sub_epi32( _mm_castps_si128( scaled ), _mm_castps_si128( roundMask ) );
+	__m128i half = _mm_srli_epi32( biased, 13 );
+	return _mm_or_si128( half, _mm_srli_epi32( _mm_castps_si128( sign ), 16 ) );
+}
+
+void PackParticles( const ParticleFX::Particle* pSrc, u32 count, const Vector3f& origin, u16 emitterIndex, u8 paletteIndex, GpuParticle* pDst )
+{
+	const __m128 originX = _mm_set1_ps( origin.x );
+	const __m128 originY = _mm_set1_ps( origin.y );
+	const __m128 originZ = _mm_set1_ps( origin.z );
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps( 1.0f );
+	const __m128 ageScale = _mm_set1_ps( 65535.0f );
+	const __m128 scaleScale = _mm_set1_ps( 1.0f / kParticleScaleStep );
+	const __m128 scaleMax = _mm_set1_ps( 255.0f );
+
+	alignas( 16 ) u32 halfX[ 4 ], halfY[ 4 ], halfZ[ 4 ], age[ 4 ], scale[ 4 ];
+
+	for ( u32 i = 0; i < count; i += 4 )
+	{
+		// the tail group repeats the last particle and only the valid lanes are stored
+		const ParticleFX::Particle& p0 = pSrc[ i ];
+		const ParticleFX::Particle& p1 = pSrc[ std::min( i + 1, count - 1 ) ];
+		const ParticleFX::Particle& p2 = pSrc[ std::min( i + 2, count - 1 ) ];
+		const ParticleFX::Particle& p3 = pSrc[ std::min( i + 3, count - 1 ) ];
+
+		__m128 x = _mm_sub_ps( _mm_setr_ps( p0.pos.x, p1.pos.x, p2.pos.x, p3.pos.x ), originX );
+		__m128 y = _mm_sub_ps( _mm_setr_ps( p0.pos.y, p1.pos.y, p2.pos.y, p3.pos.y ), originY );
+		__m128 z = _mm_sub_ps( _mm_setr_ps( p0.pos.z, p1.pos.z, p2.pos.z, p3.pos.z ), originZ );
+		__m128 life = _mm_setr_ps( p0.life[ 0 ], p1.life[ 0 ], p2.life[ 0 ], p3.life[ 0 ] );
+		__m128 maxLife = _mm_setr_ps( p0.life[ 1 ], p1.life[ 1 ], p2.life[ 1 ], p3.life[ 1 ] );
+		__m128 size = _mm_setr_ps( p0.scale, p1.scale, p2.scale, p3.scale );
+
+		_mm_store_si128( reinterpret_cast< __m128i* >(halfX), FloatToHalf4( x ) );
+		_mm_store_si128( reinterpret_cast< __m128i* >(halfY), FloatToHalf4( y ) );
+		_mm_store_si128( reinterpret_cast< __m128i* >(halfZ), FloatToHalf4( z ) );
+
+		// no lifetime means already expired, and a NaN age from a bad step clamps to a fresh particle
+		__m128 hasLife = _mm_cmpgt_ps( maxLife, zero );
+		__m128 ratio = _mm_div_ps( life, _mm_or_ps( _mm_and_ps( hasLife, maxLife ), _mm_andnot_ps( hasLife, one ) ) );
+		ratio = _mm_or_ps( _mm_and_ps( hasLife, ratio ), _mm_andnot_ps( hasLife, one ) );
+		__m128 normalisedAge = _mm_min_ps( _mm_max_ps( ratio, zero ), one );
+		_mm_store_si128( reinterpret_cast< __m128i* >(age), _mm_cvtps_epi32( _mm_mul_ps( normalisedAge, ageScale ) ) );
+		__m128 quantisedScale = _mm_min_ps( _mm_max_ps( _mm_mul_ps( size, scaleScale ), zero ), scaleMax );
+		_mm_store_si128( reinterpret_cast< __m128i* >(scale), _mm_cvtps_epi32( quantisedScale ) );
+
+		u32 lanes = std::min( count - i, 4u );
+		for ( u32 lane = 0; lane < lanes; lane++ )
+		{
+			GpuParticle& out = pDst[ i + lane ];
+			out.offset[ 0 ] = static_cast< u16 >(halfX[ lane ]);
+			out.offset[ 1 ] = static_cast< u16 >(halfY[ lane ]);
+			out.offset[ 2 ] = static_cast< u16 >(halfZ[ lane ]);
+			out.emitter = emitterIndex;
+			out.age = static_cast< u16 >(age[ lane ]);
+			out.palette = paletteIndex;
+			out.scale = static_cast< u8 >(scale[ lane ]);
+		}
+	}
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include "ExampleParticleFX.h"
+
+
+// Compact 12 byte particle as uploaded to the GPU, decoded in ParticleShader.hlsl.
+// Position is a half precision offset from the emitter origin, colour comes from g_vParticleColours.
+struct GpuParticle
+{
+	u16 offset[ 3 ];  // half floats
+	u16 emitter;      // index into the emitter origin buffer
+	u16 age;          // life[0] / life[1] in 0..65535
+	u8 palette;       // index into g_vParticleColours
+	u8 scale;         // scale in units of kParticleScaleStep
+};
+static_assert(sizeof( GpuParticle ) == 12, "GpuParticle must match the shader layout");
+
+constexpr float kMaxParticleScale = 0.5f;
+constexpr float kParticleScaleStep = kMaxParticleScale / 255.0f;
+
+u8 FindParticleColourIndex( const Vector3f& colour );
+void PackParticles( const ParticleFX::Particle* pSrc, u32 count, const Vector3f& origin, u16 emitterIndex, u8 paletteIndex, GpuParticle* pDst );
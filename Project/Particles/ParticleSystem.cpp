@@ -0,0 +1,236 @@
+#include "GameMath.h"
+#include "Types.h"
+#include "ParticleSystem.h"
+#include "RenderContext.h"
+#include "Utilities/JobManager.h"
+#include "Cameras/CameraManager.h"
+#include "Utilities/RenderCapture.h"
+#include <chrono>
+
+
+PLAY_SINGLETON_IMPL( ParticleSystem );
+
+ParticleSystem::ParticleSystem()
+{
+	m_poolCPU.resize( kMaxParticles );
+	m_originsCPU.resize( kMaxDrawnEmitters );
+	m_emitters.reserve( 64 );
+	m_batches.reserve( static_cast< int >(ParticleType::TOTAL_PARTICLE_TYPES) + 1 );
+
+	Graphics::BufferDesc desc;
+	desc.SetDynamicStructuredBuffer< GpuParticle >( kMaxParticles, m_poolCPU.data() );
+	desc.m_pDebugName = "ParticlePool";
+	m_poolGPU = Resources::CreateAsset< Graphics::Buffer >(desc);
+
+	Graphics::BufferDesc originsDesc;
+	originsDesc.SetDynamicStructuredBuffer< Vector4f >( kMaxDrawnEmitters, m_originsCPU.data() );
+	originsDesc.m_pDebugName = "ParticleEmitterOrigins";
+	m_originsGPU = Resources::CreateAsset< Graphics::Buffer >(originsDesc);
+}
+
+ParticleSystem::~ParticleSystem()
+{
+	Resources::ResourceManager< Graphics::Buffer >::Instance().Release( m_poolGPU );
+	Resources::ResourceManager< Graphics::Buffer >::Instance().Release( m_originsGPU );
+}
+
+u32 ParticleSystem::Register( ParticleFX* pEmitter, u32 capacity )
+{
+	capacity = std::min( capacity, kMaxParticles );
+
+	// make room by evicting the oldest effects that are allowed to go
+	while ( m_reservedParticles + capacity > kMaxParticles )
+	{
+		if ( !EvictOldest() ) break;
+	}
+
+	u32 granted = std::min( capacity, kMaxParticles - m_reservedParticles );
+	m_reservedParticles += granted;
+	m_emitters.push_back( pEmitter );
+	m_bMembershipChanged = true;
+	return granted;
+}
+
+void ParticleSystem::Unregister( ParticleFX* pEmitter )
+{
+	auto it = std::find( m_emitters.begin(), m_emitters.end(), pEmitter );
+	if ( it != m_emitters.end() )
+	{
+		m_reservedParticles -= pEmitter->GetCapacity();
+		m_emitters.erase( it );
+		m_bMembershipChanged = true;
+	}
+}
+
+bool ParticleSystem::EvictOldest()
+{
+	for ( ParticleFX* pEmitter : m_emitters )
+	{
+		if ( pEmitter->IsEvictable() )
+		{
+			pEmitter->DestroySelf();
+			Unregister( pEmitter );
+			m_stats.evicted++;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool ParticleSystem::UpdateVisibility()
+{
+	const CameraManager& cameras = CameraManager::Instance();
+	bool bChanged = false;
+
+	for ( ParticleFX* pEmitter : m_emitters )
+	{
+		bool bVisible = !pEmitter->IsBounded() ||
+			cameras.IsSphereVisible( pEmitter->GetBoundsCentre(), pEmitter->GetBoundsRadius() );
+
+		bChanged |= bVisible != pEmitter->IsVisible();
+		pEmitter->SetVisible( bVisible );
+		if ( !bVisible ) m_stats.culled++;
+	}
+	return bChanged;
+}
+
+void ParticleSystem::UpdateEmitters( float dT )
+{
+	auto start = std::chrono::high_resolution_clock::now();
+	std::atomic< u32 > skipped{ 0 };
+
+	// Each emitter only touches its own particles, so they can be stepped independently.
+	JobManager::Instance().ParallelFor( static_cast< u32 >(m_emitters.size()), [ this, dT, &skipped ]( u32 i )
+		{
+			ParticleFX* pEmitter = m_emitters[ i ];
+			if ( pEmitter->IsObjDead() ) return;
+
+			float step = pEmitter->AccumulateTime( dT );
+			if ( !pEmitter->IsVisible() && step < kHiddenUpdateStep )
+			{
+				skipped++;
+				return;
+			}
+			pEmitter->ClearPendingTime();
+			pEmitter->Update( step );
+		} );
+
+	auto end = std::chrono::high_resolution_clock::now();
+	m_stats.updateMs = std::chrono::duration< float, std::milli >( end - start ).count();
+	m_stats.updateThreads = JobManager::Instance().GetWorkerCount() + 1;
+	m_stats.skippedUpdates = skipped;
+}
+
+void ParticleSystem::RecycleFinished()
+{
+	for ( size_t i = 0; i < m_emitters.size(); )
+	{
+		ParticleFX* pEmitter = m_emitters[ i ];
+		if ( pEmitter->IsFinished() )
+		{
+			// give the budget back now, the object itself is deleted in GameObjectManager::PostUpdate
+			pEmitter->DestroySelf();
+			Unregister( pEmitter );
+			m_stats.recycled++;
+		}
+		else
+		{
+			++i;
+		}
+	}
+}
+
+void ParticleSystem::PackBatches()
+{
+	m_sorted.assign( m_emitters.begin(), m_emitters.end() );
+	std::stable_sort( m_sorted.begin(), m_sorted.end(), []( const ParticleFX* a, const ParticleFX* b )
+		{ return a->m_materialId.GetValue() < b->m_materialId.GetValue(); } );
+
+	m_batches.clear();
+	u32 packed = 0;
+	u32 origins = 0;
+
+	for ( ParticleFX* pEmitter : m_sorted )
+	{
+		u32 count = pEmitter->GetLiveParticleCount();
+		if ( count == 0 || !pEmitter->IsVisible() ) continue;
+		if ( origins == kMaxDrawnEmitters ) break;
+
+		if ( m_batches.empty() || m_batches.back().materialId != pEmitter->m_materialId )
+		{
+			m_batches.push_back( { pEmitter->m_materialId, packed, 0 } );
+		}
+
+		m_originsCPU[ origins ] = Vector4f( pEmitter->GetEmitterOrigin(), 0.0f );
+		PackParticles( pEmitter->GetParticles(), count, pEmitter->GetEmitterOrigin(), static_cast< u16 >(origins),
+			pEmitter->GetPaletteIndex(), m_poolCPU.data() + packed );
+		origins++;
+
+		m_batches.back().particleCount += count;
+		packed += count;
+	}
+	m_stats.liveParticles = packed;
+	m_stats.drawnEmitters = origins;
+}
+
+void ParticleSystem::Update( float dT )
+{
+	u32 recycled = m_stats.recycled;
+	u32 evicted = m_stats.evicted;
+	m_stats = {};
+	m_stats.recycled = recycled;
+	m_stats.evicted = evicted;
+
+	bool bDirty = UpdateVisibility();
+	UpdateEmitters( dT );
+	RecycleFinished();
+
+	bDirty |= m_bMembershipChanged;
+	m_bMembershipChanged = false;
+	for ( ParticleFX* pEmitter : m_emitters )
+	{
+		// changes to hidden emitters don't need uploading until they come back into view
+		bool bChanged = pEmitter->ConsumeDirty();
+		if ( pEmitter->IsVisible() ) bDirty |= bChanged;
+	}
+
+	m_stats.emitters = static_cast< u32 >(m_emitters.size());
+	m_stats.reservedParticles = m_reservedParticles;
+
+	// Nothing changed since the last upload, so the pool on the GPU is still valid.
+	if ( !bDirty )
+	{
+		m_stats.batches = static_cast< u32 >(m_batches.size());
+		for ( const Batch& batch : m_batches ) m_stats.liveParticles += batch.particleCount;
+		return;
+	}
+
+	PackBatches();
+	m_stats.batches = static_cast< u32 >(m_batches.size());
+
+	if ( m_stats.liveParticles > 0 )
+	{
+		size_t sizeBytes = m_stats.liveParticles * sizeof( GpuParticle );
+		CapturedGraphics::UpdateBuffer( m_poolGPU, m_poolCPU.data(), sizeBytes );
+		size_t originBytes = m_stats.drawnEmitters * sizeof( Vector4f );
+		CapturedGraphics::UpdateBuffer( m_originsGPU, m_originsCPU.data(), originBytes );
+		m_stats.uploads++;
+		m_stats.bytesUploaded += sizeBytes + originBytes;
+	}
+}
+
+void ParticleSystem::Render( RenderContext& ctx ) const
+{
+	for ( const Batch& batch : m_batches )
+	{
+		ParticleRenderCommand cmd;
+		cmd.worldMatrix = MatrixIdentity4x4f();
+		cmd.materialId = batch.materialId;
+		cmd.particleBufferId = m_poolGPU;
+		cmd.emitterBufferId = m_originsGPU;
+		cmd.particleOffset = batch.firstParticle;
+		cmd.particleCount = batch.particleCount;
+
+		ctx.RenderParticles( cmd );
+	}
+}
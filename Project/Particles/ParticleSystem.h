@@ -0,0 +1,74 @@
+#pragma once
+#include "ExampleParticleFX.h"
+#include "ParticlePacking.h"
+
+
+class RenderContext;
+
+// Owns the single pooled GPU particle buffer shared by every emitter.
+// Emitters reserve capacity against a hard budget, and each frame their live particles are packed
+// into the pool grouped by material so every material is drawn with a single call.
+// The pool holds compact GpuParticles, positioned relative to a per emitter origin buffer.
+// Emitters are simulated in parallel on the JobManager workers, the GPU upload stays on the main thread.
+// Emitters outside the camera frustum or behind the planet are not packed or drawn and update at a reduced rate.
+class ParticleSystem
+{
+	ParticleSystem();
+	~ParticleSystem();
+
+	PLAY_SINGLETON_INTERFACE( ParticleSystem );
+
+public:
+	static constexpr size_t kParticleBudgetBytes = 1024 * 1024; // of the GPU pool
+	static constexpr u32 kMaxParticles = static_cast< u32 >(kParticleBudgetBytes / sizeof( GpuParticle ));
+	static constexpr u32 kMaxDrawnEmitters = 1024;
+	static constexpr float kHiddenUpdateStep = 0.1f; // seconds between updates of emitters nobody can see
+
+	struct Stats
+	{
+		u32 emitters{ 0 };
+		u32 culled{ 0 };
+		u32 skippedUpdates{ 0 };
+		u32 batches{ 0 };
+		u32 liveParticles{ 0 };
+		u32 drawnEmitters{ 0 };
+		u32 reservedParticles{ 0 };
+		u32 recycled{ 0 };
+		u32 evicted{ 0 };
+		u32 uploads{ 0 };
+		size_t bytesUploaded{ 0 };
+		u32 updateThreads{ 0 };
+		float updateMs{ 0.0f };
+	};
+
+	u32 Register( ParticleFX* pEmitter, u32 capacity );
+	void Unregister( ParticleFX* pEmitter );
+	void Update( float dT );
+	void Render( RenderContext& ctx ) const;
+	const Stats& GetStats() const { return m_stats; }
+
+private:
+	struct Batch
+	{
+		Graphics::MaterialId materialId;
+		u32 firstParticle;
+		u32 particleCount;
+	};
+
+	bool EvictOldest();
+	bool UpdateVisibility();
+	void UpdateEmitters( float dT );
+	void RecycleFinished();
+	void PackBatches();
+
+	std::vector< ParticleFX* > m_emitters; // in creation order, oldest first
+	std::vector< ParticleFX* > m_sorted;
+	std::vector< GpuParticle > m_poolCPU;
+	std::vector< Vector4f > m_originsCPU;
+	std::vector< Batch > m_batches;
+	Graphics::BufferId m_poolGPU;
+	Graphics::BufferId m_originsGPU;
+	u32 m_reservedParticles{ 0 };
+	bool m_bMembershipChanged{ false };
+	Stats m_stats;
+};
@@ -14,10 +14,9 @@ RingBlast::RingBlast( ParticleType type, Vector3f pos, Vector3f right, int count
 	m_color = color;
 	m_batchCount++;
 
-	GenerateFreeList();
+	ReserveParticles();
 	GenerateParticlesBatch();
 	CreateParticleMaterial( type );
-	CreateParticleBuffer();
 }
 
 RingBlast::~RingBlast()
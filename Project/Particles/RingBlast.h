@@ -10,6 +10,7 @@ public:
 	~RingBlast();
 
 	void Update( float dT ) override;
+	bool IsFinished() const override { return m_liveParticles == 0 && m_batchCount >= 3; }
 	void GenerateParticlesBatch() override;
 
 private:
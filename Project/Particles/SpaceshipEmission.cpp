@@ -14,11 +14,11 @@ SpaceshipEmission::SpaceshipEmission( ParticleType type, int count, Vector3f rig
 	m_velocity = velocity;
 	m_right = right;
 	m_color = color;
+	m_bBounded = false; // particles are steered every frame, so they are never culled
 
-	GenerateFreeList();
+	ReserveParticles();
 	GenerateParticlesBatch();
 	CreateParticleMaterial( type );
-	CreateParticleBuffer();
 }
 
 SpaceshipEmission::~SpaceshipEmission()
@@ -29,13 +29,12 @@ SpaceshipEmission::~SpaceshipEmission()
 void SpaceshipEmission::Update( float dT )
 {
 	GenerateNewParticles();
-	for (u32 i = 0; i < m_particleCount; ++i)
+	for ( u32 i = 0; i < m_liveParticles; )
 	{
 		UpdateParticleAcceleration( i );
 		UpdateSingleParticle( i, dT );
-		KillExpiredParticle( i );
+		if ( !KillExpiredParticle( i ) ) ++i;
 	}
-	Graphics::UpdateBuffer(m_particlesGPU, m_particlesCPU.data(), m_particlesCPU.size() * sizeof(Particle));
 }
 
 void SpaceshipEmission::GenerateNewParticles()
@@ -66,7 +65,10 @@ void SpaceshipEmission::UpdateParticleAcceleration( int index )
 	Vector3f offsetNorm = normalize(offset);
 	float distFromMiddle = dot(offset, m_velocity);
 
-	m_acceleration = ( dot(offsetNorm, m_right) < 0) ? normalize( m_right * distFromMiddle * 0.1f ) : normalize( m_right * -distFromMiddle * 0.1f );
+	// per second, the unit per frame the trail was tuned with at 60Hz
+	const float steering = 60.0f;
+	Vector3f direction = ( dot(offsetNorm, m_right) < 0) ? normalize( m_right * distFromMiddle * 0.1f ) : normalize( m_right * -distFromMiddle * 0.1f );
+	m_acceleration = direction * steering;
 }
 
 Vector3f SpaceshipEmission::RandomizePosition( Vector3f pos, Vector3f right, Vector3f forward )
@@ -11,6 +11,8 @@ public:
 	~SpaceshipEmission();
 
 	void Update( float dT ) override;
+	bool IsFinished() const override { return false; } // lives as long as the player owns it
+	bool IsEvictable() const override { return false; }
 	void UpdateRight( Vector3f right ) { m_right = right; }
 	Vector3f RandomizeVelocity( Vector3f right, Vector3f forward );
 	Vector3f RandomizePosition( Vector3f pos, Vector3f right, Vector3f forward );
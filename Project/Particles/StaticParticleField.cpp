@@ -0,0 +1,54 @@
+#include "GameMath.h"
+#include "Types.h"
+#include "StaticParticleField.h"
+#include "RenderContext.h"
+
+
+
+StaticParticleField::~StaticParticleField()
+{
+	Resources::ResourceManager< Graphics::Buffer >::Instance().Release( m_particlesGPU );
+}
+
+void StaticParticleField::AddParticle( Vector3f pos, Vector3f vel, float scale, Vector3f color, float phase )
+{
+	Particle p;
+	p.pos = pos;
+	p.vel = vel;
+	p.scale = scale;
+	p.colour = color;
+	p.life[ 0 ] = phase; // time offset, the shader adds the frame time to it
+	p.life[ 1 ] = 0.0f;
+	p.life[ 2 ] = 0.0f;
+	p.life[ 3 ] = 0.0f;
+	m_particlesCPU.push_back( p );
+}
+
+void StaticParticleField::Bake()
+{
+	m_particleCount = static_cast< u32 >(m_particlesCPU.size());
+	if ( m_particleCount == 0 ) return;
+
+	Graphics::BufferDesc desc;
+	desc.SetImmutableStructuredBuffer< Particle >( m_particleCount, m_particlesCPU.data() );
+	desc.m_pDebugName = "StaticParticleField";
+	m_particlesGPU = Resources::CreateAsset< Graphics::Buffer >(desc);
+
+	// the GPU copy is the only one we need from now on
+	m_particlesCPU.clear();
+	m_particlesCPU.shrink_to_fit();
+}
+
+void StaticParticleField::Render( RenderContext& ctx ) const
+{
+	if ( m_particleCount > 0 )
+	{
+		ParticleRenderCommand cmd;
+		cmd.worldMatrix = MatrixIdentity4x4f();
+		cmd.particleCount = m_particleCount;
+		cmd.materialId = m_materialId;
+		cmd.particleBufferId = m_particlesGPU;
+
+		ctx.RenderParticles( cmd );
+	}
+}
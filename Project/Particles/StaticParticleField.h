@@ -0,0 +1,30 @@
+#pragma once
+#include "ObjectFactory/GameObject.h"
+#include "ExampleParticleFX.h"
+
+
+class RenderContext;
+
+// An immutable layer of decorative particles.
+// The particles are uploaded once when baked and never touched on the CPU again,
+// any animation has to come from the frame constants in the material's shader.
+class StaticParticleField : public GameObject
+{
+public:
+	using Particle = ParticleFX::Particle;
+
+	StaticParticleField() {}
+	~StaticParticleField() override;
+
+	void Update( float dT ) override {}
+	void Render( RenderContext& ctx ) const override;
+	GameObjectType GetType() const override { return GameObjectType::TYPE_PARTICLE; };
+
+protected:
+	void AddParticle( Vector3f pos, Vector3f vel, float scale, Vector3f color, float phase );
+	void Bake();
+
+	std::vector< Particle > m_particlesCPU; // only alive until Bake()
+	Graphics::BufferId m_particlesGPU;
+	u32 m_particleCount{ 0 };
+};
@@ -8,14 +8,10 @@
 
 TwinkleLittleStar::TwinkleLittleStar( int count, Vector3f color )
 {
-	// Make a CPU buffer of particles.
-	m_particleBatch = count;
-	m_color = color;
-
-	GenerateFreeList();
-	GenerateParticlesBatch();
+	// The stars never move, so they are baked once and twinkle in TwinklyStar.hlsl using the frame time.
+	GenerateStars( count, color );
 	m_materialId = AssetManager::Instance().GetTwinklyStarMaterial();
-	CreateParticleBuffer();
+	Bake();
 }
 
 TwinkleLittleStar::~TwinkleLittleStar()
@@ -23,22 +19,11 @@ TwinkleLittleStar::~TwinkleLittleStar()
 
 }
 
-void TwinkleLittleStar::Update( float dT )
+void TwinkleLittleStar::GenerateStars( int count, Vector3f color )
 {
-	for (u32 i = 0; i < m_particleCount; ++i)
+	m_particlesCPU.reserve( count );
+	for ( int i = 0; i < count; i++ )
 	{
-		m_particlesCPU[ i ].life[ 0 ] += dT;
+		AddParticle(RandVector3f() * RandomFloatRange(25.f, 45.f), RandVector3f() * 0.1f, RandomFloatRange(0.05f, 0.10f), color, RandomFloatRange(0.0f, 10.0f));
 	}
-	Graphics::UpdateBuffer(m_particlesGPU, m_particlesCPU.data(), m_particlesCPU.size() * sizeof( Particle ));
 }
-
-void TwinkleLittleStar::GenerateParticlesBatch()
-{
-	for ( u32 i = 0; i < m_particleBatch; i++ )
-	{
-		AddParticleToCPU(RandVector3f() * RandomFloatRange(25.f, 45.f), RandVector3f() * 0.1f, RandomFloatRange(0.05f, 0.10f), m_color);
-	}
-}
-
-
-
@@ -1,18 +1,15 @@
 #pragma once
 #include "ObjectFactory/GameObject.h"
-#include "ExampleParticleFX.h"
+#include "StaticParticleField.h"
 
 
-class TwinkleLittleStar : public ParticleFX
+class TwinkleLittleStar : public StaticParticleField
 {
 public:
 
 	TwinkleLittleStar(int count, Vector3f color = { 1.0f, 1.0f, 1.0f });
 	~TwinkleLittleStar();
 
-	void Update( float dT ) override;
-	void GenerateParticlesBatch() override;
-
 private:
-
+	void GenerateStars( int count, Vector3f color );
 };
@@ -7,21 +7,80 @@
 
 #include "Types.h"
 #include "GameMath.h"
+#include "Cameras/Frustum.h"
+#include "Cameras/HorizonOccluder.h"
+#include "AssetManager.h"
+#include "Utilities/UnorderedHash.h"
 #include "RenderContext.h"
 
 
 RenderContext::RenderContext()
 {
 	m_meshRenderCommands.reserve(256);
+	m_boundsX.reserve(256);
+	m_boundsY.reserve(256);
+	m_boundsZ.reserve(256);
+	m_boundsRadius.reserve(256);
+	m_visible.reserve(256);
+	m_passView.reserve(256);
+	m_sortItems.reserve(256);
+	m_sortScratch.reserve(256);
 	m_particleCommands.reserve(256);
+	m_instanceBatches.reserve(64);
+	m_instanceMatrices.reserve(256);
 }
 
-void RenderContext::BeginPass( RenderPassType type )
+void RenderContext::BeginFrame()
 {
-	m_passType = type;
 	m_meshRenderCommands.clear();
 	m_particleCommands.clear();
 	m_axisCommands.clear();
+	m_boundsX.clear();
+	m_boundsY.clear();
+	m_boundsZ.clear();
+	m_boundsRadius.clear();
+
+	for ( PassStats& stats : m_passStats )
+	{
+		stats = {};
+	}
+}
+
+void RenderContext::BeginPass( RenderPassType type, const Frustum* pFrustum, const HorizonOccluder* pOccluder )
+{
+	m_passType = type;
+	m_passView.clear();
+
+	PassStats& stats = m_passStats[ static_cast< int >(type) ];
+	const u32 count = static_cast< u32 >(m_meshRenderCommands.size());
+	if ( pFrustum )
+	{
+		// CullSpheres reads four at a time. The padding is dropped again by the next AddBounds.
+		const u32 paddedCount = ( count + 3 ) & ~3u;
+		m_boundsX.resize( paddedCount );
+		m_boundsY.resize( paddedCount );
+		m_boundsZ.resize( paddedCount );
+		m_boundsRadius.resize( paddedCount );
+		m_visible.resize( paddedCount );
+		CullSpheres( *pFrustum, m_boundsX.data(), m_boundsY.data(), m_boundsZ.data(), m_boundsRadius.data(), count, m_visible.data() );
+		if ( pOccluder )
+		{
+			stats.occluded += OccludeSpheres( *pOccluder, m_boundsX.data(), m_boundsY.data(), m_boundsZ.data(), m_boundsRadius.data(), count, m_visible.data() );
+		}
+	}
+
+	const u8 passBit = PassBit( type );
+	for ( u32 i = 0; i < count; i++ )
+	{
+		if ( !( m_meshRenderCommands[ i ].passMask & passBit ) ) continue;
+
+		if ( pFrustum && !m_visible[ i ] )
+		{
+			stats.culled++;
+			continue;
+		}
+		m_passView.push_back( i );
+	}
 }
 
 RenderPassType RenderContext::GetRenderPassType() const
@@ -32,6 +91,55 @@ RenderPassType RenderContext::GetRenderPassType() const
 void RenderContext::RenderMesh( const MeshRenderCommand& cmd )
 {
 	m_meshRenderCommands.push_back( cmd );
+	AddBoundsAndSelectLod( m_meshRenderCommands.back() );
+}
+
+void RenderContext::AddBoundsAndSelectLod( MeshRenderCommand& cmd )
+{
+	Vector3f centre( 0.f );
+	f32 radius = 0.f;
+
+	const Graphics::Mesh* pMesh = Resources::ResourceManager< Graphics::Mesh >::Instance().GetPtr( cmd.meshId );
+	if ( pMesh )
+	{
+		const AABBMinMax& bounds = pMesh->GetBounds();
+		const Vector3f halfSize = ( bounds.vMax - bounds.vMin ) * 0.5f;
+		centre = ( bounds.vMax + bounds.vMin ) * 0.5f;
+
+		// Scale the radius by the largest axis so non-uniform scale stays conservative.
+		f32 scale = std::max( length( cmd.worldMatrix.m_column[ 0 ].xyz() ), length( cmd.worldMatrix.m_column[ 1 ].xyz() ) );
+		scale = std::max( scale, length( cmd.worldMatrix.m_column[ 2 ].xyz() ) );
+		radius = length( halfSize ) * scale;
+	}
+	centre = Transform( cmd.worldMatrix, Vector4f( centre, 1.f ) ).xyz();
+
+	const u32 lodCount = pMesh ? AssetManager::Instance().GetMeshLodCount( cmd.meshId ) : 1;
+	if ( lodCount > 1 && m_lodView.projectionScale > 0.f )
+	{
+		f32 distance = std::max( length( centre - m_lodView.position ), 0.001f );
+		f32 screenSize = radius * m_lodView.projectionScale / distance;
+
+		u32 lod = 0;
+		while ( lod + 1 < lodCount && lod < std::size( kLodScreenSizes ) && screenSize < kLodScreenSizes[ lod ] )
+		{
+			lod++;
+		}
+
+		const Graphics::SubmeshDesc& submesh = pMesh->GetSubmesh( lod );
+		cmd.subMeshIndex = lod;
+		cmd.elementOffset = submesh.m_elementOffset;
+		cmd.elementCount = submesh.m_elementSize;
+	}
+
+	const size_t count = m_meshRenderCommands.size();
+	m_boundsX.resize( count );
+	m_boundsY.resize( count );
+	m_boundsZ.resize( count );
+	m_boundsRadius.resize( count );
+	m_boundsX.back() = centre.x;
+	m_boundsY.back() = centre.y;
+	m_boundsZ.back() = centre.z;
+	m_boundsRadius.back() = radius;
 }
 
 void RenderContext::RenderParticles( const ParticleRenderCommand& cmd )
@@ -44,7 +152,158 @@ void RenderContext::RenderAxis( const AxisRenderCommand& cmd )
 	m_axisCommands.push_back(cmd);
 }
 
+void RenderContext::AppendCommands( const RenderContext& other )
+{
+	const size_t count = m_meshRenderCommands.size();
+	const size_t otherCount = other.m_meshRenderCommands.size();
+	m_meshRenderCommands.insert( m_meshRenderCommands.end(), other.m_meshRenderCommands.begin(), other.m_meshRenderCommands.end() );
+
+	// Either side may still carry padding from a culled pass.
+	m_boundsX.resize( count );
+	m_boundsY.resize( count );
+	m_boundsZ.resize( count );
+	m_boundsRadius.resize( count );
+	m_boundsX.insert( m_boundsX.end(), other.m_boundsX.begin(), other.m_boundsX.begin() + otherCount );
+	m_boundsY.insert( m_boundsY.end(), other.m_boundsY.begin(), other.m_boundsY.begin() + otherCount );
+	m_boundsZ.insert( m_boundsZ.end(), other.m_boundsZ.begin(), other.m_boundsZ.begin() + otherCount );
+	m_boundsRadius.insert( m_boundsRadius.end(), other.m_boundsRadius.begin(), other.m_boundsRadius.begin() + otherCount );
+
+	m_particleCommands.insert( m_particleCommands.end(), other.m_particleCommands.begin(), other.m_particleCommands.end() );
+	m_axisCommands.insert( m_axisCommands.end(), other.m_axisCommands.begin(), other.m_axisCommands.end() );
+}
+
 void RenderContext::EndPass()
 {
+	PassStats& stats = m_passStats[ static_cast< int >(m_passType) ];
+	stats.commands += static_cast< u32 >(m_passView.size());
+	CountSwitches( stats.materialSwitchesUnsorted, stats.meshSwitchesUnsorted );
+
+	SortPassView();
 
+	CountSwitches( stats.materialSwitches, stats.meshSwitches );
+	BuildInstanceBatches();
+}
+
+void RenderContext::BuildInstanceBatches()
+{
+	m_instanceBatches.clear();
+	m_instanceMatrices.clear();
+
+	// The view is sorted, so commands drawing the same LOD with the same material are already adjacent.
+	for ( u32 index : m_passView )
+	{
+		const MeshRenderCommand& cmd = m_meshRenderCommands[ index ];
+		bool bSameState = !m_instanceBatches.empty()
+			&& m_instanceBatches.back().meshId == cmd.meshId
+			&& m_instanceBatches.back().materialId == cmd.materialId
+			&& m_instanceBatches.back().elementOffset == cmd.elementOffset
+			&& m_instanceBatches.back().instanceCount < kMaxInstancesPerBatch;
+
+		if ( !bSameState )
+		{
+			InstanceBatch batch;
+			batch.meshId = cmd.meshId;
+			batch.materialId = cmd.materialId;
+			batch.firstInstance = static_cast< u32 >(m_instanceMatrices.size());
+			batch.elementOffset = cmd.elementOffset;
+			batch.elementCount = cmd.elementCount;
+			m_instanceBatches.push_back( batch );
+		}
+
+		m_instanceBatches.back().instanceCount++;
+		m_instanceMatrices.push_back( cmd.worldMatrix );
+	}
+}
+
+u64 RenderContext::BuildSortKey( const MeshRenderCommand& cmd ) const
+{
+	// | pass 3 | material 20 | mesh 18 | lod 3 | depth 16 | unused 4 |
+	// Ids are resource indices, so 18 bits is plenty. The shadow pass draws everything with one material,
+	// so the mesh takes the material bits there instead.
+	f32 distance = length( cmd.worldMatrix.m_column[ 3 ].xyz() - m_viewPosition );
+	u64 depth = static_cast< u64 >(std::min( distance / kMaxSortDistance, 1.f ) * 0xffff);
+	u64 pass = static_cast< u64 >(m_passType) & 0x7;
+	u64 material = cmd.materialId.GetValue() & 0xfffff;
+	u64 mesh = cmd.meshId.GetValue() & 0x3ffff;
+	u64 lod = cmd.subMeshIndex & 0x7;
+
+	if ( m_passType == RenderPassType::kShadowPass || m_passType == RenderPassType::kStaticShadowPass )
+	{
+		material = mesh;
+	}
+	return ( pass << 61 ) | ( material << 41 ) | ( mesh << 23 ) | ( lod << 20 ) | ( depth << 4 );
+}
+
+void RenderContext::SortPassView()
+{
+	const size_t count = m_passView.size();
+	if ( count < 2 ) return;
+
+	m_sortItems.resize( count );
+	m_sortScratch.resize( count );
+	for ( size_t i = 0; i < count; i++ )
+	{
+		u32 index = m_passView[ i ];
+		m_sortItems[ i ] = { BuildSortKey( m_meshRenderCommands[ index ] ), index };
+	}
+
+	// LSD radix sort, a byte per pass. Passes where every key has the same byte are skipped.
+	for ( u32 shift = 0; shift < 64; shift += 8 )
+	{
+		u32 histogram[ 256 ] = {};
+		for ( const SortItem& item : m_sortItems )
+		{
+			histogram[ ( item.key >> shift ) & 0xff ]++;
+		}
+		if ( histogram[ ( m_sortItems[ 0 ].key >> shift ) & 0xff ] == count ) continue;
+
+		u32 offset = 0;
+		for ( u32& bucket : histogram )
+		{
+			u32 bucketCount = bucket;
+			bucket = offset;
+			offset += bucketCount;
+		}
+		for ( const SortItem& item : m_sortItems )
+		{
+			m_sortScratch[ histogram[ ( item.key >> shift ) & 0xff ]++ ] = item;
+		}
+		m_sortItems.swap( m_sortScratch );
+	}
+
+	for ( size_t i = 0; i < count; i++ )
+	{
+		m_passView[ i ] = m_sortItems[ i ].index;
+	}
+}
+
+void RenderContext::CountSwitches( u32& materialSwitches, u32& meshSwitches ) const
+{
+	Graphics::MaterialId material;
+	Graphics::MeshId mesh;
+	for ( u32 index : m_passView )
+	{
+		const MeshRenderCommand& cmd = m_meshRenderCommands[ index ];
+		if ( cmd.materialId != material ) materialSwitches++;
+		if ( cmd.meshId != mesh ) meshSwitches++;
+		material = cmd.materialId;
+		mesh = cmd.meshId;
+	}
+}
+
+u64 RenderContext::HashPassView() const
+{
+	// The view is sorted by distance from the camera, so the hash must not depend on its order. The LOD is left out
+	// as it also follows the camera, and a cached shadow drawn from another LOD of the same caster is still right.
+	UnorderedHash hash;
+	for ( u32 index : m_passView )
+	{
+		const MeshRenderCommand& cmd = m_meshRenderCommands[ index ];
+		u8 caster[ 2 * sizeof( u32 ) + sizeof( Matrix4x4f ) ];
+		u32 ids[ 2 ] = { cmd.meshId.GetValue(), cmd.materialId.GetValue() };
+		memcpy( caster, ids, sizeof( ids ) );
+		memcpy( caster + sizeof( ids ), &cmd.worldMatrix, sizeof( Matrix4x4f ) );
+		hash.Add( caster, sizeof( caster ) );
+	}
+	return hash.Get();
 }
@@ -6,20 +6,34 @@
 ///////////////////////////////////////////////////////////////////////////
 
 #pragma once
+struct Frustum;
+struct HorizonOccluder;
+
 enum class RenderPassType
 {
 	kShadowPass,
 	kZPrepass,
 	kForwardPass,
 	kDebugPass,
+	kStaticShadowPass, // shadow casters that never move, cached between frames
+
+	kNumPasses,
 };
 
+constexpr u8 PassBit( RenderPassType type ) { return static_cast< u8 >(1u << static_cast< int >(type)); }
+constexpr u8 kShadowAndForwardPasses = PassBit( RenderPassType::kShadowPass ) | PassBit( RenderPassType::kForwardPass );
+constexpr u8 kStaticShadowAndForwardPasses = PassBit( RenderPassType::kStaticShadowPass ) | PassBit( RenderPassType::kForwardPass );
+// Pass masks are for mesh commands. Particles are only drawn in the forward pass and axes only in the debug pass, when enabled.
+
 struct MeshRenderCommand
 {
 	Matrix4x4f worldMatrix;
 	Graphics::MeshId meshId;
 	Graphics::MaterialId materialId;
-	u32 subMeshIndex = 0;
+	u32 subMeshIndex = 0; // the LOD for meshes with a LOD chain, picked by RenderContext::RenderMesh
+	u32 elementOffset = 0;
+	u32 elementCount = ~0u; // whole mesh
+	u8 passMask = kShadowAndForwardPasses; // PassBit of every pass that draws this command
 };
 
 struct ParticleRenderCommand
@@ -27,6 +41,8 @@ struct ParticleRenderCommand
 	Matrix4x4f worldMatrix;
 	Graphics::MaterialId materialId;
 	Graphics::BufferId particleBufferId;
+	Graphics::BufferId emitterBufferId; // origins for compact particles, unset for full ParticleFX::Particle data
+	u32 particleOffset = 0;
 	u32 particleCount;
 };
 
@@ -35,27 +51,107 @@ struct AxisRenderCommand
 	Matrix4x4f worldMatrix;
 };
 
-// Render context collects information for a each render pass.
+// A run of sorted commands sharing mesh and material, drawn with one instanced call.
+// Matrices for the run are contiguous in RenderContext::GetInstanceMatrices() from firstInstance.
+struct InstanceBatch
+{
+	Graphics::MeshId meshId;
+	Graphics::MaterialId materialId;
+	u32 firstInstance = 0;
+	u32 instanceCount = 0;
+	u32 elementOffset = 0;
+	u32 elementCount = ~0u;
+};
+
+// Camera that mesh LODs are picked for. projectionScale is the projection's y scale, 0 keeps every mesh at LOD 0.
+struct LodView
+{
+	Vector3f position{ 0.f };
+	f32 projectionScale = 0.f;
+};
+
+// Per pass counts for the frame, summed over every view of the pass (e.g. each shadow slice).
+// Switches are what submission order needs, against what insertion order would have needed.
+struct PassStats
+{
+	u32 commands = 0;
+	u32 culled = 0;   // outside the frustum or occluded
+	u32 occluded = 0; // inside the frustum but behind the occluder
+	u32 materialSwitchesUnsorted = 0;
+	u32 materialSwitches = 0;
+	u32 meshSwitchesUnsorted = 0;
+	u32 meshSwitches = 0;
+};
+
+// Render context retains the commands gathered once per frame, each tagged with the passes that use it.
+// BeginPass selects the commands used by a pass that touch its frustum and are not hidden by its occluder, and EndPass sorts that view by a 64-bit key so
+// it is submitted in state-minimal order.
 class RenderContext
 {
 public:
 	using MeshCmdList = std::vector< MeshRenderCommand >;
 	using ParticlesCmdList = std::vector< ParticleRenderCommand >;
 	using AxisRenderCmdList= std::vector< AxisRenderCommand >;
+	using InstanceBatchList = std::vector< InstanceBatch >;
+
+	static constexpr f32 kMaxSortDistance = 100.f; // matches the camera far clip
+	static constexpr u32 kMaxInstancesPerBatch = 256;
+	// Projected radius, as a fraction of half the screen height, below which LOD i + 1 is used.
+	static constexpr f32 kLodScreenSizes[] = { 0.25f, 0.08f, 0.025f };
 
 	RenderContext();
-	void BeginPass(RenderPassType type);
+	void BeginFrame();
+	void BeginPass( RenderPassType type, const Frustum* pFrustum = nullptr, const HorizonOccluder* pOccluder = nullptr );
 	RenderPassType GetRenderPassType() const;
+	void SetViewPosition( const Vector3f& position ) { m_viewPosition = position; }
+	void SetLodView( const LodView& view ) { m_lodView = view; } // applies to meshes added after it
+	const LodView& GetLodView() const { return m_lodView; }
+	void EnableAxes( bool bEnabled ) { m_bAxes = bEnabled; } // only the debug pass draws axes, so they are gathered only while it shows them
+	bool WantsAxes() const { return m_bAxes; }
+	const PassStats& GetPassStats( RenderPassType type ) const { return m_passStats[ static_cast< int >(type) ]; }
 	void RenderMesh( const MeshRenderCommand& cmd );
 	void RenderParticles( const ParticleRenderCommand& cmd );
 	void RenderAxis(const AxisRenderCommand& cmd);
+	void AppendCommands( const RenderContext& other ); // merges a context gathered on another thread
 	void EndPass();
 	const MeshCmdList& GetMeshCommands() const { return m_meshRenderCommands; }
+	Vector4f GetBoundingSphere( u32 index ) const { return Vector4f( m_boundsX[ index ], m_boundsY[ index ], m_boundsZ[ index ], m_boundsRadius[ index ] ); }
+	u64 HashPassView() const; // changes when a command in the view changes mesh, material or transform, whatever the view order
+	const std::vector< u32 >& GetPassView() const { return m_passView; } // indices into GetMeshCommands, sorted after EndPass
 	const ParticlesCmdList& GetParticleCommands() const { return m_particleCommands; }
 	const AxisRenderCmdList& GetAxisCommands() const { return m_axisCommands; }
+	const InstanceBatchList& GetInstanceBatches() const { return m_instanceBatches; }
+	const std::vector< Matrix4x4f >& GetInstanceMatrices() const { return m_instanceMatrices; }
 private:
+	struct SortItem
+	{
+		u64 key;
+		u32 index;
+	};
+
+	u64 BuildSortKey( const MeshRenderCommand& cmd ) const;
+	void SortPassView();
+	void BuildInstanceBatches();
+	void CountSwitches( u32& materialSwitches, u32& meshSwitches ) const;
+	void AddBoundsAndSelectLod( MeshRenderCommand& cmd );
+
 	RenderPassType m_passType;
+	Vector3f m_viewPosition{ 0.f };
+	LodView m_lodView;
+	bool m_bAxes = false;
 	MeshCmdList m_meshRenderCommands;
+	// World bounding sphere of each mesh command, split by component for CullSpheres.
+	std::vector< f32 > m_boundsX;
+	std::vector< f32 > m_boundsY;
+	std::vector< f32 > m_boundsZ;
+	std::vector< f32 > m_boundsRadius;
+	std::vector< u8 > m_visible;
+	std::vector< u32 > m_passView;
+	std::vector< SortItem > m_sortItems;
+	std::vector< SortItem > m_sortScratch;
+	InstanceBatchList m_instanceBatches;
+	std::vector< Matrix4x4f > m_instanceMatrices;
+	PassStats m_passStats[ static_cast< int >(RenderPassType::kNumPasses) ];
 	ParticlesCmdList m_particleCommands;
 	AxisRenderCmdList m_axisCommands;
 };
@@ -10,6 +10,7 @@
 
 constexpr float kMaxAsteroidRadius = 0.6f;
 constexpr float kOffsetMultiplier = 1.1f;
+constexpr float kPlanetOccluderRadius = 0.95f; // sphere fully inside the planet surface, used for horizon culling
 constexpr float kPowerUpDuration = 10.0f;
 constexpr float kHealthIncrease = 0.5f;
 constexpr float kMaxHealth = 5.0f;
@@ -93,6 +94,7 @@ enum ShaderType
 	PARTICLE_SHADER = 0,
 	TWINKLY_STAR,
 	SELF_ILLUMINATE,
+	SELF_ILLUMINATE_INSTANCED,
 
 	TOTAL_SHADERS,
 };
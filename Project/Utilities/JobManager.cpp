@@ -0,0 +1,118 @@
+#include "GameMath.h"
+#include "Types.h"
+#include "JobManager.h"
+
+
+PLAY_SINGLETON_IMPL( JobManager );
+
+JobManager::JobManager()
+{
+	StartWorkers( GetMaxWorkerCount() );
+}
+
+JobManager::~JobManager()
+{
+	StopWorkers();
+}
+
+u32 JobManager::GetMaxWorkerCount()
+{
+	// leave one core for the main thread, which also takes part in ParallelFor
+	u32 cores = std::thread::hardware_concurrency();
+	return cores > 1 ? cores - 1 : 0;
+}
+
+void JobManager::SetWorkerCount( u32 count )
+{
+	count = std::min( count, GetMaxWorkerCount() );
+	if ( count == GetWorkerCount() ) return;
+
+	StopWorkers();
+	StartWorkers( count );
+}
+
+void JobManager::StartWorkers( u32 count )
+{
+	// Workers start from the generation as it is now, a ParallelFor issued before one of them first takes the lock
+	// is then still new to it.
+	u64 generation = 0;
+	{
+		std::lock_guard< std::mutex > lock( m_mutex );
+		m_bQuit = false;
+		generation = m_generation;
+	}
+
+	m_workers.reserve( count );
+	for ( u32 i = 0; i < count; i++ )
+	{
+		m_workers.emplace_back( &JobManager::WorkerLoop, this, generation );
+	}
+}
+
+void JobManager::StopWorkers()
+{
+	{
+		std::lock_guard< std::mutex > lock( m_mutex );
+		m_bQuit = true;
+	}
+	m_wake.notify_all();
+
+	for ( std::thread& worker : m_workers )
+	{
+		worker.join();
+	}
+	m_workers.clear();
+}
+
+void JobManager::ParallelFor( u32 count, const Task& task )
+{
+	if ( m_workers.empty() || count < 2 )
+	{
+		for ( u32 i = 0; i < count; i++ ) task( i );
+		return;
+	}
+
+	{
+		std::lock_guard< std::mutex > lock( m_mutex );
+		m_pTask = &task;
+		m_taskCount = count;
+		m_nextIndex = 0;
+		m_busyWorkers = GetWorkerCount();
+		m_generation++;
+	}
+	m_wake.notify_all();
+
+	RunTasks();
+
+	std::unique_lock< std::mutex > lock( m_mutex );
+	m_done.wait( lock, [ this ]() { return m_busyWorkers == 0; } );
+	m_pTask = nullptr;
+}
+
+void JobManager::RunTasks()
+{
+	for ( u32 i = m_nextIndex++; i < m_taskCount; i = m_nextIndex++ )
+	{
+		(*m_pTask)( i );
+	}
+}
+
+void JobManager::WorkerLoop( u64 seenGeneration )
+{
+	while ( true )
+	{
+		{
+			std::unique_lock< std::mutex > lock( m_mutex );
+			m_wake.wait( lock, [ & ]() { return m_bQuit || m_generation != seenGeneration; } );
+			if ( m_bQuit ) return;
+			seenGeneration = m_generation;
+		}
+
+		RunTasks();
+
+		{
+			std::lock_guard< std::mutex > lock( m_mutex );
+			if ( --m_busyWorkers == 0 ) m_done.notify_one();
+		}
+	}
+}
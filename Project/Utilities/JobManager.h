@@ -0,0 +1,43 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+
+// Small pool of worker threads for splitting independent work across cores.
+// ParallelFor blocks until every index has been processed, the calling thread helps out.
+class JobManager
+{
+	JobManager();
+	~JobManager();
+
+	PLAY_SINGLETON_INTERFACE( JobManager );
+
+public:
+	using Task = std::function< void( u32 ) >;
+
+	void ParallelFor( u32 count, const Task& task );
+	void SetWorkerCount( u32 count ); // 0 runs everything on the calling thread
+	u32 GetWorkerCount() const { return static_cast< u32 >(m_workers.size()); }
+	static u32 GetMaxWorkerCount();
+
+private:
+	void StartWorkers( u32 count );
+	void StopWorkers();
+	void WorkerLoop( u64 seenGeneration );
+	void RunTasks();
+
+	std::vector< std::thread > m_workers;
+	std::mutex m_mutex;
+	std::condition_variable m_wake;
+	std::condition_variable m_done;
+	const Task* m_pTask{ nullptr };
+	u32 m_taskCount{ 0 };
+	std::atomic< u32 > m_nextIndex{ 0 };
+	u32 m_busyWorkers{ 0 };
+	u64 m_generation{ 0 };
+	bool m_bQuit{ false };
+};
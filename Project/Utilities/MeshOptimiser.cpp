@@ -0,0 +1,325 @@
+#include "MeshOptimiser.h"
+#include <algorithm>
+#include <cmath>
+
+
+namespace MeshOptimiser
+{
+	namespace
+	{
+		// Forsyth's scoring, the cache modelled here is larger than the FIFO it is measured against
+		// so the order stays good across hardware.
+		constexpr uint32_t kScoringCacheSize = 32;
+		constexpr uint32_t kValenceTableSize = 32;
+		constexpr float kCacheDecayPower = 1.5f;
+		constexpr float kLastTriangleScore = 0.75f;
+		constexpr float kValenceBoostScale = 2.f;
+		constexpr float kValenceBoostPower = 0.5f;
+
+		struct ScoreTables
+		{
+			float cache[ kScoringCacheSize ];
+			float valence[ kValenceTableSize ];
+
+			ScoreTables()
+			{
+				for ( uint32_t i = 0; i < kScoringCacheSize; i++ )
+				{
+					// The last triangle's vertices score a fixed amount so its neighbours are not always preferred.
+					cache[ i ] = i < 3 ? kLastTriangleScore : std::pow( 1.f - float( i - 3 ) / float( kScoringCacheSize - 3 ), kCacheDecayPower );
+				}
+				for ( uint32_t i = 0; i < kValenceTableSize; i++ )
+				{
+					valence[ i ] = i == 0 ? 0.f : kValenceBoostScale * std::pow( float( i ), -kValenceBoostPower );
+				}
+			}
+
+			float VertexScore( int32_t cachePosition, uint32_t remainingTriangles ) const
+			{
+				// A vertex with no triangles left is never wanted.
+				if ( remainingTriangles == 0 ) return -1.f;
+
+				float score = cachePosition >= 0 ? cache[ cachePosition ] : 0.f;
+				score += remainingTriangles < kValenceTableSize ? valence[ remainingTriangles ]
+					: kValenceBoostScale * std::pow( float( remainingTriangles ), -kValenceBoostPower );
+				return score;
+			}
+		};
+
+		// FIFO cache simulation by timestamp, a vertex is cached while fewer than cacheSize misses
+		// have happened since it was loaded. Adding cacheSize + 1 to the time flushes the cache.
+		struct FifoCache
+		{
+			std::vector< uint32_t > timestamps;
+			uint32_t time;
+			uint32_t cacheSize;
+
+			FifoCache( uint32_t vertexCount, uint32_t size ) : timestamps( vertexCount, 0 ), time( size + 1 ), cacheSize( size ) {}
+
+			uint32_t Touch( uint32_t vertex )
+			{
+				if ( time - timestamps[ vertex ] <= cacheSize ) return 0;
+				timestamps[ vertex ] = time++;
+				return 1;
+			}
+
+			uint32_t TouchTriangle( const uint32_t* pTriangle ) { return Touch( pTriangle[ 0 ] ) + Touch( pTriangle[ 1 ] ) + Touch( pTriangle[ 2 ] ); }
+			void Flush() { time += cacheSize + 1; }
+		};
+	}
+
+	VertexCacheStats AnalyseVertexCache( const uint32_t* pIndices, uint32_t indexCount, uint32_t vertexCount, uint32_t cacheSize )
+	{
+		VertexCacheStats stats;
+		if ( indexCount < 3 ) return stats;
+
+		FifoCache cache( vertexCount, cacheSize );
+		std::vector< uint8_t > used( vertexCount, 0 );
+		uint32_t usedCount = 0;
+		for ( uint32_t i = 0; i < indexCount; i++ )
+		{
+			stats.misses += cache.Touch( pIndices[ i ] );
+			usedCount += used[ pIndices[ i ] ] ? 0 : 1;
+			used[ pIndices[ i ] ] = 1;
+		}
+
+		stats.acmr = float( stats.misses ) / float( indexCount / 3 );
+		stats.atvr = float( stats.misses ) / float( usedCount );
+		return stats;
+	}
+
+	void OptimiseVertexCache( uint32_t* pIndices, uint32_t indexCount, uint32_t vertexCount )
+	{
+		static const ScoreTables s_tables;
+
+		const uint32_t triangleCount = indexCount / 3;
+		if ( triangleCount < 2 ) return;
+
+		// Triangles around each vertex. The first live[ v ] entries of a vertex are the ones not yet emitted.
+		std::vector< uint32_t > firstAdjacent( vertexCount + 1, 0 );
+		for ( uint32_t i = 0; i < triangleCount * 3; i++ ) firstAdjacent[ pIndices[ i ] + 1 ]++;
+		for ( uint32_t v = 0; v < vertexCount; v++ ) firstAdjacent[ v + 1 ] += firstAdjacent[ v ];
+
+		std::vector< uint32_t > live( vertexCount, 0 );
+		std::vector< uint32_t > adjacent( triangleCount * 3 );
+		for ( uint32_t i = 0; i < triangleCount * 3; i++ )
+		{
+			uint32_t v = pIndices[ i ];
+			adjacent[ firstAdjacent[ v ] + live[ v ]++ ] = i / 3;
+		}
+
+		std::vector< int32_t > cachePosition( vertexCount, -1 );
+		std::vector< float > vertexScore( vertexCount );
+		for ( uint32_t v = 0; v < vertexCount; v++ ) vertexScore[ v ] = s_tables.VertexScore( -1, live[ v ] );
+
+		auto triangleScore = [ & ]( uint32_t t )
+			{
+				return vertexScore[ pIndices[ t * 3 ] ] + vertexScore[ pIndices[ t * 3 + 1 ] ] + vertexScore[ pIndices[ t * 3 + 2 ] ];
+			};
+
+		uint32_t best = 0;
+		float bestScore = -1.f;
+		for ( uint32_t t = 0; t < triangleCount; t++ )
+		{
+			float score = triangleScore( t );
+			if ( score > bestScore )
+			{
+				best = t;
+				bestScore = score;
+			}
+		}
+
+		std::vector< uint32_t > output;
+		output.reserve( triangleCount * 3 );
+		std::vector< uint8_t > emitted( triangleCount, 0 );
+		uint32_t cache[ kScoringCacheSize + 3 ];
+		uint32_t newCache[ kScoringCacheSize + 3 ];
+		uint32_t cacheCount = 0;
+		uint32_t nextUnemitted = 0;
+
+		for ( uint32_t emittedCount = 0; emittedCount < triangleCount; emittedCount++ )
+		{
+			if ( bestScore < 0.f )
+			{
+				// Nothing in the cache has triangles left, carry on from the next one in input order.
+				while ( emitted[ nextUnemitted ] ) nextUnemitted++;
+				best = nextUnemitted;
+			}
+
+			const uint32_t* pTriangle = pIndices + best * 3;
+			emitted[ best ] = 1;
+			output.insert( output.end(), pTriangle, pTriangle + 3 );
+
+			uint32_t newCount = 0;
+			for ( uint32_t k = 0; k < 3; k++ )
+			{
+				uint32_t v = pTriangle[ k ];
+				uint32_t* pAdjacent = adjacent.data() + firstAdjacent[ v ];
+				uint32_t* pEnd = pAdjacent + live[ v ];
+				std::iter_swap( std::find( pAdjacent, pEnd, best ), pEnd - 1 );
+				live[ v ]--;
+
+				if ( std::find( newCache, newCache + newCount, v ) == newCache + newCount ) newCache[ newCount++ ] = v;
+			}
+			for ( uint32_t i = 0; i < cacheCount; i++ )
+			{
+				uint32_t v = cache[ i ];
+				if ( v != pTriangle[ 0 ] && v != pTriangle[ 1 ] && v != pTriangle[ 2 ] ) newCache[ newCount++ ] = v;
+			}
+
+			// Rescore everything that was or is in the cache, including what just fell out of it.
+			for ( uint32_t i = 0; i < newCount; i++ )
+			{
+				uint32_t v = newCache[ i ];
+				cachePosition[ v ] = i < kScoringCacheSize ? static_cast< int32_t >(i) : -1;
+				vertexScore[ v ] = s_tables.VertexScore( cachePosition[ v ], live[ v ] );
+			}
+
+			bestScore = -1.f;
+			for ( uint32_t i = 0; i < newCount; i++ )
+			{
+				uint32_t v = newCache[ i ];
+				for ( uint32_t j = 0; j < live[ v ]; j++ )
+				{
+					uint32_t t = adjacent[ firstAdjacent[ v ] + j ];
+					float score = triangleScore( t );
+					if ( score > bestScore || ( score == bestScore && t < best ) )
+					{
+						best = t;
+						bestScore = score;
+					}
+				}
+			}
+
+			cacheCount = std::min( newCount, kScoringCacheSize );
+			std::copy( newCache, newCache + cacheCount, cache );
+		}
+
+		std::copy( output.begin(), output.end(), pIndices );
+	}
+
+	void OptimiseOverdraw( uint32_t* pIndices, uint32_t indexCount, const float* pPositions, uint32_t vertexCount, uint32_t positionStride,
+		float threshold )
+	{
+		const uint32_t triangleCount = indexCount / 3;
+		if ( triangleCount < 2 ) return;
+
+		auto position = [ & ]( uint32_t v )
+			{
+				return reinterpret_cast< const float* >(reinterpret_cast< const uint8_t* >(pPositions) + size_t( v ) * positionStride);
+			};
+
+		// A triangle missing on all three vertices usually starts a disjoint patch, so order can change there for free.
+		FifoCache cache( vertexCount, kFifoCacheSize );
+		std::vector< uint32_t > hardBoundaries;
+		for ( uint32_t t = 0; t < triangleCount; t++ )
+		{
+			if ( cache.TouchTriangle( pIndices + t * 3 ) == 3 || t == 0 ) hardBoundaries.push_back( t );
+		}
+
+		// Split patches further once the running ACMR is back within threshold of the patch's own.
+		std::vector< uint32_t > clusters;
+		for ( size_t i = 0; i < hardBoundaries.size(); i++ )
+		{
+			const uint32_t start = hardBoundaries[ i ];
+			const uint32_t end = i + 1 < hardBoundaries.size() ? hardBoundaries[ i + 1 ] : triangleCount;
+
+			cache.Flush();
+			uint32_t patchMisses = 0;
+			for ( uint32_t t = start; t < end; t++ ) patchMisses += cache.TouchTriangle( pIndices + t * 3 );
+			const float patchThreshold = threshold * float( patchMisses ) / float( end - start );
+
+			cache.Flush();
+			clusters.push_back( start );
+			uint32_t runningMisses = 0;
+			uint32_t runningTriangles = 0;
+			for ( uint32_t t = start; t + 1 < end; t++ )
+			{
+				runningMisses += cache.TouchTriangle( pIndices + t * 3 );
+				runningTriangles++;
+				if ( float( runningMisses ) <= patchThreshold * float( runningTriangles ) )
+				{
+					clusters.push_back( t + 1 );
+					cache.Flush();
+					runningMisses = 0;
+					runningTriangles = 0;
+				}
+			}
+		}
+
+		// Clusters facing away from the middle of the mesh are more likely to occlude the rest, so they go first.
+		double meshCentre[ 3 ] = {};
+		for ( uint32_t v = 0; v < vertexCount; v++ )
+		{
+			for ( int k = 0; k < 3; k++ ) meshCentre[ k ] += position( v )[ k ];
+		}
+		for ( int k = 0; k < 3; k++ ) meshCentre[ k ] /= std::max( vertexCount, 1u );
+
+		const uint32_t clusterCount = static_cast< uint32_t >(clusters.size());
+		std::vector< float > sortKeys( clusterCount );
+		for ( uint32_t c = 0; c < clusterCount; c++ )
+		{
+			const uint32_t end = c + 1 < clusterCount ? clusters[ c + 1 ] : triangleCount;
+			double centroid[ 3 ] = {};
+			double normal[ 3 ] = {};
+			double totalArea = 0.0;
+			for ( uint32_t t = clusters[ c ]; t < end; t++ )
+			{
+				const float* p0 = position( pIndices[ t * 3 ] );
+				const float* p1 = position( pIndices[ t * 3 + 1 ] );
+				const float* p2 = position( pIndices[ t * 3 + 2 ] );
+				const double e1[ 3 ] = { p1[ 0 ] - p0[ 0 ], p1[ 1 ] - p0[ 1 ], p1[ 2 ] - p0[ 2 ] };
+				const double e2[ 3 ] = { p2[ 0 ] - p0[ 0 ], p2[ 1 ] - p0[ 1 ], p2[ 2 ] - p0[ 2 ] };
+				const double n[ 3 ] = { e1[ 1 ] * e2[ 2 ] - e1[ 2 ] * e2[ 1 ], e1[ 2 ] * e2[ 0 ] - e1[ 0 ] * e2[ 2 ], e1[ 0 ] * e2[ 1 ] - e1[ 1 ] * e2[ 0 ] };
+				const double area = std::sqrt( n[ 0 ] * n[ 0 ] + n[ 1 ] * n[ 1 ] + n[ 2 ] * n[ 2 ] );
+
+				for ( int k = 0; k < 3; k++ )
+				{
+					centroid[ k ] += ( p0[ k ] + p1[ k ] + p2[ k ] ) / 3.0 * area;
+					normal[ k ] += n[ k ];
+				}
+				totalArea += area;
+			}
+
+			const double normalLength = std::sqrt( normal[ 0 ] * normal[ 0 ] + normal[ 1 ] * normal[ 1 ] + normal[ 2 ] * normal[ 2 ] );
+			if ( totalArea <= 0.0 || normalLength <= 0.0 ) continue;
+
+			double key = 0.0;
+			for ( int k = 0; k < 3; k++ ) key += ( centroid[ k ] / totalArea - meshCentre[ k ] ) * normal[ k ] / normalLength;
+			sortKeys[ c ] = static_cast< float >(key);
+		}
+
+		std::vector< uint32_t > order( clusterCount );
+		for ( uint32_t c = 0; c < clusterCount; c++ ) order[ c ] = c;
+		std::stable_sort( order.begin(), order.end(), [ &sortKeys ]( uint32_t a, uint32_t b ) { return sortKeys[ a ] > sortKeys[ b ]; } );
+
+		std::vector< uint32_t > output;
+		output.reserve( triangleCount * 3 );
+		for ( uint32_t c : order )
+		{
+			const uint32_t end = c + 1 < clusterCount ? clusters[ c + 1 ] : triangleCount;
+			output.insert( output.end(), pIndices + clusters[ c ] * 3, pIndices + end * 3 );
+		}
+		std::copy( output.begin(), output.end(), pIndices );
+	}
+
+	uint32_t OptimiseVertexFetch( uint32_t* pIndices, uint32_t indexCount, uint32_t vertexCount, std::vector< uint32_t >& remapOut )
+	{
+		remapOut.assign( vertexCount, ~0u );
+
+		uint32_t next = 0;
+		for ( uint32_t i = 0; i < indexCount; i++ )
+		{
+			uint32_t& remap = remapOut[ pIndices[ i ] ];
+			if ( remap == ~0u ) remap = next++;
+			pIndices[ i ] = remap;
+		}
+
+		const uint32_t usedCount = next;
+		for ( uint32_t& remap : remapOut )
+		{
+			if ( remap == ~0u ) remap = next++;
+		}
+		return usedCount;
+	}
+}
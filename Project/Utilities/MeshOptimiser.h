@@ -0,0 +1,59 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Index and vertex reordering for the GPU. Triangles are ordered for the post-transform vertex cache
+// (Forsyth's linear-speed optimiser), then clusters of them are reordered so outward facing ones draw first
+// (Sander, Nehab and Barczak), then vertices are renumbered in first-use order for fetch locality.
+// Everything is deterministic, the same input always gives the same output.
+// Only depends on the standard library so it runs in the tools as well as the game.
+namespace MeshOptimiser
+{
+	// FourCC "mopt" chunk holding the OptimiseStats of a mesh reordered by the cooker, so loading can skip it.
+	constexpr uint32_t kOptimisedChunkId = 'm' | ( 'o' << 8 ) | ( 'p' << 16 ) | ( 't' << 24 );
+
+	// Size of the FIFO cache the statistics are measured against, typical of current hardware.
+	constexpr uint32_t kFifoCacheSize = 16;
+
+	struct VertexCacheStats
+	{
+		uint32_t misses = 0;
+		float acmr = 0.f; // average cache miss ratio, transformed vertices per triangle (0.5 is ideal for a large grid)
+		float atvr = 0.f; // average transformed to vertex ratio, 1 is ideal
+	};
+
+	struct OptimiseStats
+	{
+		VertexCacheStats before;
+		VertexCacheStats after;
+	};
+
+	VertexCacheStats AnalyseVertexCache( const uint32_t* pIndices, uint32_t indexCount, uint32_t vertexCount, uint32_t cacheSize = kFifoCacheSize );
+
+	// Reorders the triangles of a list in place for vertex cache locality.
+	void OptimiseVertexCache( uint32_t* pIndices, uint32_t indexCount, uint32_t vertexCount );
+
+	// Reorders clusters of an already cache-optimised list in place to reduce overdraw. A cluster may grow the
+	// ACMR by up to threshold, 1.05 allows 5% more vertex transforms. positionStride is in bytes.
+	void OptimiseOverdraw( uint32_t* pIndices, uint32_t indexCount, const float* pPositions, uint32_t vertexCount, uint32_t positionStride,
+		float threshold = 1.05f );
+
+	// Renumbers vertices in the order the indices first use them and rewrites the indices.
+	// remapOut[ old ] is the new index, unused vertices go to the end. Returns the number of used vertices.
+	uint32_t OptimiseVertexFetch( uint32_t* pIndices, uint32_t indexCount, uint32_t vertexCount, std::vector< uint32_t >& remapOut );
+
+	// Applies a remap from OptimiseVertexFetch to a vertex stream.
+	template< typename T >
+	void RemapVertexStream( std::vector< T >& stream, const std::vector< uint32_t >& remap )
+	{
+		if ( stream.size() != remap.size() ) return;
+
+		std::vector< T > remapped( stream.size() );
+		for ( size_t i = 0; i < stream.size(); i++ )
+		{
+			remapped[ remap[ i ] ] = stream[ i ];
+		}
+		stream.swap( remapped );
+	}
+}
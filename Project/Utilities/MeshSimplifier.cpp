@@ -0,0 +1,404 @@
+#include "MeshSimplifier.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <queue>
+#include <unordered_map>
+
+
+namespace MeshSimplifier
+{
+	namespace
+	{
+		// Open edges get a plane perpendicular to their face so the outline holds its shape.
+		constexpr double kBoundaryWeight = 10.0;
+
+		struct Vec3
+		{
+			double x, y, z;
+		};
+
+		Vec3 Sub( const Vec3& a, const Vec3& b ) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+		Vec3 Cross( const Vec3& a, const Vec3& b ) { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+		double Dot( const Vec3& a, const Vec3& b ) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+		// Symmetric 4x4 matrix of the plane equations around a vertex, upper triangle only.
+		struct Quadric
+		{
+			double m[ 10 ] = {};
+
+			void AddPlane( const Vec3& n, double d, double weight )
+			{
+				const double p[ 4 ] = { n.x, n.y, n.z, d };
+				int k = 0;
+				for ( int i = 0; i < 4; i++ )
+				{
+					for ( int j = i; j < 4; j++ )
+					{
+						m[ k++ ] += p[ i ] * p[ j ] * weight;
+					}
+				}
+			}
+
+			void Add( const Quadric& q )
+			{
+				for ( int i = 0; i < 10; i++ ) m[ i ] += q.m[ i ];
+			}
+
+			double Evaluate( const Vec3& v ) const
+			{
+				const double x = v.x, y = v.y, z = v.z;
+				return m[ 0 ] * x * x + 2 * m[ 1 ] * x * y + 2 * m[ 2 ] * x * z + 2 * m[ 3 ] * x
+					+ m[ 4 ] * y * y + 2 * m[ 5 ] * y * z + 2 * m[ 6 ] * y
+					+ m[ 7 ] * z * z + 2 * m[ 8 ] * z
+					+ m[ 9 ];
+			}
+		};
+
+		struct Collapse
+		{
+			double cost;
+			uint32_t from;
+			uint32_t to;
+			uint32_t fromVersion;
+			uint32_t toVersion;
+
+			bool operator>( const Collapse& other ) const { return cost > other.cost; }
+		};
+
+		struct PositionKey
+		{
+			uint32_t bits[ 3 ];
+			bool operator==( const PositionKey& other ) const { return std::memcmp( bits, other.bits, sizeof( bits ) ) == 0; }
+		};
+
+		struct PositionKeyHash
+		{
+			size_t operator()( const PositionKey& key ) const
+			{
+				return ( key.bits[ 0 ] * 73856093u ) ^ ( key.bits[ 1 ] * 19349663u ) ^ ( key.bits[ 2 ] * 83492791u );
+			}
+		};
+
+		class Simplifier
+		{
+		public:
+			Simplifier( const float* pPositions, uint32_t vertexCount, uint32_t positionStride, const uint32_t* pIndices, uint32_t indexCount );
+			float Run( uint32_t targetTriangleCount, double maxError );
+			void GetIndices( std::vector< uint32_t >& indicesOut ) const;
+
+		private:
+			struct Triangle
+			{
+				uint32_t vertex[ 3 ]; // original vertices
+				uint32_t point[ 3 ];  // welded positions
+				bool bAlive = true;
+			};
+
+			void PushCollapses( uint32_t point );
+			bool IsValid( const Collapse& collapse, std::vector< std::pair< uint32_t, uint32_t > >& remap );
+			void Apply( const Collapse& collapse, const std::vector< std::pair< uint32_t, uint32_t > >& remap );
+			void GatherNeighbours( uint32_t point, std::vector< uint32_t >& neighbours ) const;
+
+			std::vector< Vec3 > m_points;
+			std::vector< Quadric > m_quadrics;
+			std::vector< uint32_t > m_versions;
+			std::vector< bool > m_pointAlive;
+			std::vector< std::vector< uint32_t > > m_pointTriangles;
+			std::vector< Triangle > m_triangles;
+			std::priority_queue< Collapse, std::vector< Collapse >, std::greater< Collapse > > m_queue;
+			uint32_t m_liveTriangles = 0;
+		};
+
+		Simplifier::Simplifier( const float* pPositions, uint32_t vertexCount, uint32_t positionStride, const uint32_t* pIndices, uint32_t indexCount )
+		{
+			// Weld vertices that share a position.
+			std::vector< uint32_t > pointOfVertex( vertexCount );
+			std::unordered_map< PositionKey, uint32_t, PositionKeyHash > pointLookup;
+			pointLookup.reserve( vertexCount );
+			for ( uint32_t i = 0; i < vertexCount; i++ )
+			{
+				const float* p = reinterpret_cast< const float* >(reinterpret_cast< const uint8_t* >(pPositions) + size_t( i ) * positionStride);
+				PositionKey key;
+				std::memcpy( key.bits, p, sizeof( key.bits ) );
+				auto result = pointLookup.emplace( key, static_cast< uint32_t >(m_points.size()) );
+				if ( result.second ) m_points.push_back( { p[ 0 ], p[ 1 ], p[ 2 ] } );
+				pointOfVertex[ i ] = result.first->second;
+			}
+
+			const size_t pointCount = m_points.size();
+			m_quadrics.resize( pointCount );
+			m_versions.resize( pointCount, 0 );
+			m_pointAlive.resize( pointCount, true );
+			m_pointTriangles.resize( pointCount );
+
+			std::unordered_map< uint64_t, uint32_t > edgeUse;
+			for ( uint32_t i = 0; i + 2 < indexCount; i += 3 )
+			{
+				Triangle tri;
+				for ( int c = 0; c < 3; c++ )
+				{
+					tri.vertex[ c ] = pIndices[ i + c ];
+					tri.point[ c ] = pointOfVertex[ pIndices[ i + c ] ];
+				}
+				if ( tri.point[ 0 ] == tri.point[ 1 ] || tri.point[ 1 ] == tri.point[ 2 ] || tri.point[ 0 ] == tri.point[ 2 ] ) continue;
+
+				const uint32_t index = static_cast< uint32_t >(m_triangles.size());
+				for ( int c = 0; c < 3; c++ )
+				{
+					m_pointTriangles[ tri.point[ c ] ].push_back( index );
+					uint32_t a = tri.point[ c ], b = tri.point[ ( c + 1 ) % 3 ];
+					edgeUse[ ( uint64_t( std::min( a, b ) ) << 32 ) | std::max( a, b ) ]++;
+				}
+
+				// Face plane, weighted by area.
+				const Vec3& p0 = m_points[ tri.point[ 0 ] ];
+				Vec3 n = Cross( Sub( m_points[ tri.point[ 1 ] ], p0 ), Sub( m_points[ tri.point[ 2 ] ], p0 ) );
+				double length = std::sqrt( Dot( n, n ) );
+				if ( length > 0.0 )
+				{
+					Vec3 unit = { n.x / length, n.y / length, n.z / length };
+					Quadric q;
+					q.AddPlane( unit, -Dot( unit, p0 ), length * 0.5 );
+					for ( int c = 0; c < 3; c++ ) m_quadrics[ tri.point[ c ] ].Add( q );
+				}
+				m_triangles.push_back( tri );
+			}
+			m_liveTriangles = static_cast< uint32_t >(m_triangles.size());
+
+			for ( const Triangle& tri : m_triangles )
+			{
+				const Vec3& p0 = m_points[ tri.point[ 0 ] ];
+				Vec3 faceNormal = Cross( Sub( m_points[ tri.point[ 1 ] ], p0 ), Sub( m_points[ tri.point[ 2 ] ], p0 ) );
+				for ( int c = 0; c < 3; c++ )
+				{
+					uint32_t a = tri.point[ c ], b = tri.point[ ( c + 1 ) % 3 ];
+					if ( edgeUse[ ( uint64_t( std::min( a, b ) ) << 32 ) | std::max( a, b ) ] != 1 ) continue;
+
+					Vec3 edge = Sub( m_points[ b ], m_points[ a ] );
+					Vec3 n = Cross( edge, faceNormal );
+					double length = std::sqrt( Dot( n, n ) );
+					if ( length <= 0.0 ) continue;
+
+					Vec3 unit = { n.x / length, n.y / length, n.z / length };
+					Quadric q;
+					q.AddPlane( unit, -Dot( unit, m_points[ a ] ), Dot( edge, edge ) * kBoundaryWeight );
+					m_quadrics[ a ].Add( q );
+					m_quadrics[ b ].Add( q );
+				}
+			}
+
+			for ( uint32_t point = 0; point < pointCount; point++ )
+			{
+				PushCollapses( point );
+			}
+		}
+
+		void Simplifier::GatherNeighbours( uint32_t point, std::vector< uint32_t >& neighbours ) const
+		{
+			neighbours.clear();
+			for ( uint32_t t : m_pointTriangles[ point ] )
+			{
+				const Triangle& tri = m_triangles[ t ];
+				if ( !tri.bAlive ) continue;
+				for ( uint32_t other : tri.point )
+				{
+					if ( other != point ) neighbours.push_back( other );
+				}
+			}
+			std::sort( neighbours.begin(), neighbours.end() );
+			neighbours.erase( std::unique( neighbours.begin(), neighbours.end() ), neighbours.end() );
+		}
+
+		void Simplifier::PushCollapses( uint32_t point )
+		{
+			std::vector< uint32_t > neighbours;
+			GatherNeighbours( point, neighbours );
+			for ( uint32_t other : neighbours )
+			{
+				Quadric q = m_quadrics[ point ];
+				q.Add( m_quadrics[ other ] );
+				m_queue.push( { std::max( q.Evaluate( m_points[ other ] ), 0.0 ), point, other, m_versions[ point ], m_versions[ other ] } );
+				m_queue.push( { std::max( q.Evaluate( m_points[ point ] ), 0.0 ), other, point, m_versions[ other ], m_versions[ point ] } );
+			}
+		}
+
+		bool Simplifier::IsValid( const Collapse& collapse, std::vector< std::pair< uint32_t, uint32_t > >& remap )
+		{
+			const uint32_t from = collapse.from;
+			const uint32_t to = collapse.to;
+			remap.clear();
+
+			// Every original vertex at 'from' must map to exactly one at 'to' through the shared triangles,
+			// otherwise the collapse would tear a seam open.
+			uint32_t sharedTriangles = 0;
+			for ( uint32_t t : m_pointTriangles[ from ] )
+			{
+				const Triangle& tri = m_triangles[ t ];
+				if ( !tri.bAlive ) continue;
+
+				int fromCorner = -1, toCorner = -1;
+				for ( int c = 0; c < 3; c++ )
+				{
+					if ( tri.point[ c ] == from ) fromCorner = c;
+					if ( tri.point[ c ] == to ) toCorner = c;
+				}
+				if ( toCorner < 0 ) continue;
+
+				sharedTriangles++;
+				uint32_t fromVertex = tri.vertex[ fromCorner ];
+				uint32_t toVertex = tri.vertex[ toCorner ];
+				auto it = std::find_if( remap.begin(), remap.end(), [ fromVertex ]( const auto& pair ) { return pair.first == fromVertex; } );
+				if ( it == remap.end() ) remap.push_back( { fromVertex, toVertex } );
+				else if ( it->second != toVertex ) return false;
+			}
+			if ( sharedTriangles == 0 ) return false;
+
+			for ( uint32_t t : m_pointTriangles[ from ] )
+			{
+				const Triangle& tri = m_triangles[ t ];
+				if ( !tri.bAlive ) continue;
+				for ( int c = 0; c < 3; c++ )
+				{
+					if ( tri.point[ c ] != from ) continue;
+					uint32_t vertex = tri.vertex[ c ];
+					if ( std::none_of( remap.begin(), remap.end(), [ vertex ]( const auto& pair ) { return pair.first == vertex; } ) ) return false;
+				}
+			}
+
+			// Link condition, the two rings may only share the vertices opposite the collapsed edge.
+			std::vector< uint32_t > fromRing, toRing, common;
+			GatherNeighbours( from, fromRing );
+			GatherNeighbours( to, toRing );
+			std::set_intersection( fromRing.begin(), fromRing.end(), toRing.begin(), toRing.end(), std::back_inserter( common ) );
+			if ( common.size() != sharedTriangles ) return false;
+
+			// Reject collapses that fold a remaining triangle over.
+			for ( uint32_t t : m_pointTriangles[ from ] )
+			{
+				const Triangle& tri = m_triangles[ t ];
+				if ( !tri.bAlive || tri.point[ 0 ] == to || tri.point[ 1 ] == to || tri.point[ 2 ] == to ) continue;
+
+				Vec3 before[ 3 ], after[ 3 ];
+				for ( int c = 0; c < 3; c++ )
+				{
+					before[ c ] = m_points[ tri.point[ c ] ];
+					after[ c ] = tri.point[ c ] == from ? m_points[ to ] : before[ c ];
+				}
+				Vec3 n0 = Cross( Sub( before[ 1 ], before[ 0 ] ), Sub( before[ 2 ], before[ 0 ] ) );
+				Vec3 n1 = Cross( Sub( after[ 1 ], after[ 0 ] ), Sub( after[ 2 ], after[ 0 ] ) );
+				if ( Dot( n0, n1 ) <= 0.0 ) return false;
+			}
+			return true;
+		}
+
+		void Simplifier::Apply( const Collapse& collapse, const std::vector< std::pair< uint32_t, uint32_t > >& remap )
+		{
+			const uint32_t from = collapse.from;
+			const uint32_t to = collapse.to;
+
+			for ( uint32_t t : m_pointTriangles[ from ] )
+			{
+				Triangle& tri = m_triangles[ t ];
+				if ( !tri.bAlive ) continue;
+
+				if ( tri.point[ 0 ] == to || tri.point[ 1 ] == to || tri.point[ 2 ] == to )
+				{
+					tri.bAlive = false;
+					m_liveTriangles--;
+					continue;
+				}
+
+				for ( int c = 0; c < 3; c++ )
+				{
+					if ( tri.point[ c ] != from ) continue;
+					tri.point[ c ] = to;
+					for ( const auto& pair : remap )
+					{
+						if ( pair.first == tri.vertex[ c ] ) tri.vertex[ c ] = pair.second;
+					}
+				}
+				m_pointTriangles[ to ].push_back( t );
+			}
+
+			std::vector< uint32_t >& toTriangles = m_pointTriangles[ to ];
+			toTriangles.erase( std::remove_if( toTriangles.begin(), toTriangles.end(), [ this ]( uint32_t t ) { return !m_triangles[ t ].bAlive; } ), toTriangles.end() );
+			m_pointTriangles[ from ].clear();
+
+			m_quadrics[ to ].Add( m_quadrics[ from ] );
+			m_pointAlive[ from ] = false;
+			m_versions[ to ]++;
+			PushCollapses( to );
+		}
+
+		float Simplifier::Run( uint32_t targetTriangleCount, double maxError )
+		{
+			double largestError = 0.0;
+			std::vector< std::pair< uint32_t, uint32_t > > remap;
+
+			while ( m_liveTriangles > targetTriangleCount && !m_queue.empty() )
+			{
+				Collapse collapse = m_queue.top();
+				m_queue.pop();
+
+				if ( !m_pointAlive[ collapse.from ] || !m_pointAlive[ collapse.to ] ) continue;
+				if ( m_versions[ collapse.from ] != collapse.fromVersion || m_versions[ collapse.to ] != collapse.toVersion ) continue;
+				if ( collapse.cost > maxError ) break;
+				if ( !IsValid( collapse, remap ) ) continue;
+
+				Apply( collapse, remap );
+				largestError = std::max( largestError, collapse.cost );
+			}
+			return static_cast< float >(largestError);
+		}
+
+		void Simplifier::GetIndices( std::vector< uint32_t >& indicesOut ) const
+		{
+			indicesOut.clear();
+			indicesOut.reserve( size_t( m_liveTriangles ) * 3 );
+			for ( const Triangle& tri : m_triangles )
+			{
+				if ( !tri.bAlive ) continue;
+				indicesOut.insert( indicesOut.end(), tri.vertex, tri.vertex + 3 );
+			}
+		}
+	}
+
+	float Simplify( const float* pPositions, uint32_t vertexCount, uint32_t positionStride,
+		const uint32_t* pIndices, uint32_t indexCount, uint32_t targetIndexCount,
+		std::vector< uint32_t >& indicesOut, float maxError )
+	{
+		Simplifier simplifier( pPositions, vertexCount, positionStride, pIndices, indexCount );
+		float error = simplifier.Run( targetIndexCount / 3, maxError );
+		simplifier.GetIndices( indicesOut );
+		return error;
+	}
+
+	void BuildLodChain( const float* pPositions, uint32_t vertexCount, uint32_t positionStride,
+		const uint32_t* pIndices, uint32_t indexCount, const float* pRatios, uint32_t ratioCount,
+		std::vector< uint32_t >& indicesOut, std::vector< LodRange >& lodsOut )
+	{
+		LodRange base;
+		base.indexOffset = static_cast< uint32_t >(indicesOut.size());
+		base.indexCount = indexCount;
+		indicesOut.insert( indicesOut.end(), pIndices, pIndices + indexCount );
+		lodsOut.push_back( base );
+
+		std::vector< uint32_t > previous( pIndices, pIndices + indexCount );
+		std::vector< uint32_t > simplified;
+		float error = 0.f;
+		for ( uint32_t i = 0; i < ratioCount; i++ )
+		{
+			uint32_t target = static_cast< uint32_t >(indexCount * pRatios[ i ]) / 3 * 3;
+			error = std::max( error, Simplify( pPositions, vertexCount, positionStride, previous.data(), static_cast< uint32_t >(previous.size()), target, simplified ) );
+
+			LodRange lod;
+			lod.indexOffset = static_cast< uint32_t >(indicesOut.size());
+			lod.indexCount = static_cast< uint32_t >(simplified.size());
+			lod.error = error;
+			indicesOut.insert( indicesOut.end(), simplified.begin(), simplified.end() );
+			lodsOut.push_back( lod );
+			previous.swap( simplified );
+		}
+	}
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <cstdint>
+#include <cfloat>
+#include <vector>
+
+// Quadric error mesh simplification (Garland & Heckbert) by half-edge collapse.
+// Vertices are only ever removed, so every LOD indexes the original vertex buffer and the LODs of a
+// mesh can share it. Vertices split for UV or normal seams are welded by position while simplifying, and a
+// seam vertex only collapses along the seam so both sides stay attached.
+// Only depends on the standard library so it runs in the tools as well as the game.
+namespace MeshSimplifier
+{
+	// FourCC "lods" chunk holding a LodRange per LOD, written by the cooker next to the chained index buffer.
+	constexpr uint32_t kLodChunkId = 'l' | ( 'o' << 8 ) | ( 'd' << 16 ) | ( 's' << 24 );
+
+	struct LodRange
+	{
+		uint32_t indexOffset = 0;
+		uint32_t indexCount = 0;
+		float error = 0.f; // largest collapse error accepted for this LOD, in squared distance
+	};
+
+	// Share of the source triangles kept by LODs 1 to 3, for meshes simplified at load and by the MeshCooker tool alike.
+	constexpr float kLodRatios[] = { 0.35f, 0.12f, 0.04f };
+
+	// Simplifies a triangle list towards targetIndexCount, stopping early rather than exceed maxError.
+	// positionStride is in bytes. Returns the largest collapse error accepted.
+	float Simplify( const float* pPositions, uint32_t vertexCount, uint32_t positionStride,
+		const uint32_t* pIndices, uint32_t indexCount, uint32_t targetIndexCount,
+		std::vector< uint32_t >& indicesOut, float maxError = FLT_MAX );
+
+	// Appends a LOD chain to indicesOut, LOD 0 being the source indices and LOD i keeping pRatios[ i - 1 ]
+	// of the source triangles. Each LOD is simplified from the previous one.
+	void BuildLodChain( const float* pPositions, uint32_t vertexCount, uint32_t positionStride,
+		const uint32_t* pIndices, uint32_t indexCount, const float* pRatios, uint32_t ratioCount,
+		std::vector< uint32_t >& indicesOut, std::vector< LodRange >& lodsOut );
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// Gathers the render commands of objects in chunks across the workers of jobs, anything with a
+// ParallelFor( count, task ) like JobManager. Each chunk records into its own context, which are then merged into ctx
+// in chunk order, so ctx gets the same command stream a serial gather would give. Only depends on the standard
+// library, so Tests/ParallelGatherTest.cpp can check that against stand-in contexts.
+template< typename Jobs, typename Object, typename Context >
+void ParallelGather( Jobs& jobs, const std::vector< Object* >& objects, uint32_t objectsPerChunk, std::vector< Context >& chunkContexts, Context& ctx )
+{
+	const uint32_t objectCount = static_cast< uint32_t >(objects.size());
+	const uint32_t chunkCount = ( objectCount + objectsPerChunk - 1 ) / objectsPerChunk;
+	if ( chunkContexts.size() < chunkCount )
+	{
+		chunkContexts.resize( chunkCount );
+	}
+
+	// Render only reads the object, so each chunk can record into its own context.
+	jobs.ParallelFor( chunkCount, [ &objects, objectsPerChunk, objectCount, &chunkContexts, &ctx ]( uint32_t chunk )
+		{
+			Context& chunkCtx = chunkContexts[ chunk ];
+			chunkCtx.BeginFrame();
+			chunkCtx.SetLodView( ctx.GetLodView() );
+			chunkCtx.EnableAxes( ctx.WantsAxes() );
+
+			const uint32_t last = std::min( ( chunk + 1 ) * objectsPerChunk, objectCount );
+			for ( uint32_t i = chunk * objectsPerChunk; i < last; i++ )
+			{
+				objects[ i ]->Render( chunkCtx );
+			}
+		} );
+
+	for ( uint32_t chunk = 0; chunk < chunkCount; chunk++ )
+	{
+		ctx.AppendCommands( chunkContexts[ chunk ] );
+	}
+}
@@ -0,0 +1,187 @@
+#include "GameMath.h"
+#include "Types.h"
+#include "RenderContext.h"
+#include "RenderCapture.h"
+
+
+PLAY_SINGLETON_IMPL( RenderCapture );
+
+RenderCapture::RenderCapture()
+{
+
+}
+
+RenderCapture::~RenderCapture()
+{
+	if ( m_file.is_open() ) m_file.close();
+}
+
+void RenderCapture::Start( const char* pFilePath, u32 frameCount )
+{
+	if ( m_bCapturing ) return;
+
+	m_filePath = pFilePath;
+	m_framesLeft = frameCount;
+	m_frameIndex = 0;
+}
+
+void RenderCapture::BeginFrame( u32 screenWidth, u32 screenHeight )
+{
+	if ( !m_bCapturing && m_framesLeft > 0 )
+	{
+		m_file.open( m_filePath, std::ios::binary | std::ios::trunc );
+		if ( !m_file.is_open() )
+		{
+			Debug::Printf( "RenderCapture: unable to open %s\n", m_filePath.c_str() );
+			m_framesLeft = 0;
+			return;
+		}
+
+		RenderCaptureHeader header;
+		header.screenWidth = screenWidth;
+		header.screenHeight = screenHeight;
+		m_file.write( reinterpret_cast< const char* >(&header), sizeof( header ) );
+		m_bCapturing = true;
+	}
+	if ( !m_bCapturing ) return;
+
+	m_pass = 0xff;
+	m_boundMaterial = 0;
+	Write( RenderCaptureOp::kFrameBegin, m_frameIndex++ );
+}
+
+void RenderCapture::EndFrame()
+{
+	if ( !m_bCapturing ) return;
+
+	Write( RenderCaptureOp::kFrameEnd );
+	if ( --m_framesLeft == 0 )
+	{
+		m_file.close();
+		m_bCapturing = false;
+		Debug::Printf( "RenderCapture: wrote %u frames to %s\n", m_frameIndex, m_filePath.c_str() );
+	}
+}
+
+void RenderCapture::BeginPass( RenderPassType type, const Matrix4x4f& view, const Matrix4x4f& project )
+{
+	if ( !m_bCapturing ) return;
+
+	m_pass = static_cast< u8 >(type);
+	m_viewProject = project * view;
+	m_projectScaleX = project.m_column[ 0 ].x;
+	m_projectScaleY = project.m_column[ 1 ].y;
+	m_bPerspective = project.m_column[ 3 ].w == 0.f;
+	Write( RenderCaptureOp::kPassBegin );
+}
+
+void RenderCapture::RecordPassCommands( const RenderContext& ctx )
+{
+	if ( !m_bCapturing ) return;
+
+	for ( u32 index : ctx.GetPassView() )
+	{
+		const MeshRenderCommand& cmd = ctx.GetMeshCommands()[ index ];
+		Write( RenderCaptureOp::kMeshCommand, cmd.meshId.GetValue(), cmd.materialId.GetValue(), cmd.passMask, ComputeCoverage( ctx.GetBoundingSphere( index ) ) );
+	}
+
+	if ( m_pass == static_cast< u8 >(RenderPassType::kForwardPass) )
+	{
+		for ( const ParticleRenderCommand& cmd : ctx.GetParticleCommands() )
+		{
+			Write( RenderCaptureOp::kParticleCommand, cmd.materialId.GetValue(), cmd.particleCount );
+		}
+	}
+}
+
+void RenderCapture::RecordSetMaterial( Graphics::MaterialId id )
+{
+	if ( !m_bCapturing ) return;
+
+	m_boundMaterial = id.GetValue();
+	Write( RenderCaptureOp::kSetMaterial, m_boundMaterial );
+}
+
+void RenderCapture::RecordSetWorldMatrix()
+{
+	if ( m_bCapturing ) Write( RenderCaptureOp::kSetWorldMatrix );
+}
+
+void RenderCapture::RecordBindBuffer( u32 slot, Graphics::BufferId id )
+{
+	if ( m_bCapturing ) Write( RenderCaptureOp::kBindBuffer, slot, id.GetValue() );
+}
+
+void RenderCapture::RecordUpdateBuffer( Graphics::BufferId id, size_t sizeBytes )
+{
+	if ( m_bCapturing ) Write( RenderCaptureOp::kUpdateBuffer, id.GetValue(), static_cast< u32 >(sizeBytes) );
+}
+
+void RenderCapture::RecordDrawMesh( Graphics::MeshId id )
+{
+	if ( m_bCapturing ) Write( RenderCaptureOp::kDrawMesh, id.GetValue(), m_boundMaterial );
+}
+
+void RenderCapture::RecordDrawInstancedMesh( Graphics::MeshId id, u32 instanceCount )
+{
+	if ( m_bCapturing ) Write( RenderCaptureOp::kDrawInstancedMesh, id.GetValue(), m_boundMaterial, instanceCount );
+}
+
+void RenderCapture::RecordDrawWithoutVertices( u32 vertexCount )
+{
+	if ( m_bCapturing ) Write( RenderCaptureOp::kDrawWithoutVertices, m_boundMaterial, vertexCount );
+}
+
+void RenderCapture::RecordBindTexture( u32 slot, Graphics::TextureId id )
+{
+	if ( m_bCapturing ) Write( RenderCaptureOp::kBindTexture, slot, id.GetValue() );
+}
+
+void RenderCapture::RecordClearTarget( Graphics::TextureId id, bool bDepth, u16 slice )
+{
+	if ( m_bCapturing ) Write( RenderCaptureOp::kClearTarget, id.GetValue(), bDepth ? 1 : 0, slice );
+}
+
+void RenderCapture::RecordSetTargets( Graphics::TextureId colourId, Graphics::TextureId depthId, u16 slice )
+{
+	if ( m_bCapturing ) Write( RenderCaptureOp::kSetTargets, colourId.GetValue(), depthId.GetValue(), slice );
+}
+
+void RenderCapture::RecordSetViewport( const Graphics::Viewport& viewport )
+{
+	if ( m_bCapturing ) Write( RenderCaptureOp::kSetViewport, static_cast< u32 >(viewport.width), static_cast< u32 >(viewport.height) );
+}
+
+void RenderCapture::RecordSetViewMatrix()
+{
+	if ( m_bCapturing ) Write( RenderCaptureOp::kSetViewMatrix );
+}
+
+void RenderCapture::RecordSetProjectionMatrix()
+{
+	if ( m_bCapturing ) Write( RenderCaptureOp::kSetProjectionMatrix );
+}
+
+void RenderCapture::Write( RenderCaptureOp op, u32 a, u32 b, u32 c, f32 coverage )
+{
+	RenderCaptureRecord record;
+	record.op = op;
+	record.pass = m_pass;
+	record.a = a;
+	record.b = b;
+	record.c = c;
+	record.coverage = coverage;
+	m_file.write( reinterpret_cast< const char* >(&record), sizeof( record ) );
+}
+
+f32 RenderCapture::ComputeCoverage( const Vector4f& sphere ) const
+{
+	// Area of the projected bounding circle over the 2x2 clip square.
+	Vector4f clip = Transform( m_viewProject, Vector4f( sphere.xyz(), 1.f ) );
+	f32 radius = sphere.w;
+	if ( m_bPerspective && clip.w <= radius ) return 1.f;
+
+	f32 w = m_bPerspective ? clip.w : 1.f;
+	f32 area = kfPi * ( radius * m_projectScaleX / w ) * ( radius * m_projectScaleY / w ) * 0.25f;
+	return std::min( std::abs( area ), 1.f );
+}
@@ -0,0 +1,160 @@
+#pragma once
+#include <fstream>
+#include "RenderCaptureFormat.h"
+
+class RenderContext;
+enum class RenderPassType;
+
+// Records the command stream and the Graphics state calls made for it over a number of frames,
+// for offline analysis with Tools/RenderCaptureAnalyser. Recording is a no-op unless a capture is running.
+class RenderCapture
+{
+	RenderCapture();
+	~RenderCapture();
+
+	PLAY_SINGLETON_INTERFACE( RenderCapture );
+
+public:
+	static constexpr u32 kDefaultFrameCount = 60;
+
+	// Starts writing from the next BeginFrame.
+	void Start( const char* pFilePath, u32 frameCount = kDefaultFrameCount );
+	bool IsCapturing() const { return m_bCapturing; }
+	bool IsPending() const { return m_framesLeft > 0; }
+
+	void BeginFrame( u32 screenWidth, u32 screenHeight );
+	void EndFrame();
+	void BeginPass( RenderPassType type, const Matrix4x4f& view, const Matrix4x4f& project );
+	// Writes the mesh commands of the current pass in submission order, and the particles in the forward pass.
+	void RecordPassCommands( const RenderContext& ctx );
+
+	void RecordSetMaterial( Graphics::MaterialId id );
+	void RecordSetWorldMatrix();
+	void RecordBindBuffer( u32 slot, Graphics::BufferId id );
+	void RecordUpdateBuffer( Graphics::BufferId id, size_t sizeBytes );
+	void RecordDrawMesh( Graphics::MeshId id );
+	void RecordDrawInstancedMesh( Graphics::MeshId id, u32 instanceCount );
+	void RecordDrawWithoutVertices( u32 vertexCount );
+	void RecordBindTexture( u32 slot, Graphics::TextureId id );
+	void RecordClearTarget( Graphics::TextureId id, bool bDepth, u16 slice );
+	void RecordSetTargets( Graphics::TextureId colourId, Graphics::TextureId depthId, u16 slice = 0 );
+	void RecordSetViewport( const Graphics::Viewport& viewport );
+	void RecordSetViewMatrix();
+	void RecordSetProjectionMatrix();
+
+private:
+	void Write( RenderCaptureOp op, u32 a = 0, u32 b = 0, u32 c = 0, f32 coverage = 0.f );
+	f32 ComputeCoverage( const Vector4f& sphere ) const;
+
+	std::ofstream m_file;
+	std::string m_filePath;
+	u32 m_framesLeft{ 0 };
+	u32 m_frameIndex{ 0 };
+	bool m_bCapturing{ false };
+	u8 m_pass{ 0xff };
+	Matrix4x4f m_viewProject;
+	f32 m_projectScaleX{ 1.f };
+	f32 m_projectScaleY{ 1.f };
+	bool m_bPerspective{ true };
+	u32 m_boundMaterial{ 0 };
+};
+
+// Graphics calls that are also written to a running capture.
+namespace CapturedGraphics
+{
+	inline void SetMaterial( Graphics::MaterialId id )
+	{
+		RenderCapture::Instance().RecordSetMaterial( id );
+		Graphics::SetMaterial( id );
+	}
+
+	inline void SetWorldMatrix( const Matrix4x4f& m )
+	{
+		RenderCapture::Instance().RecordSetWorldMatrix();
+		Graphics::SetWorldMatrix( m );
+	}
+
+	inline void BindGlobalBuffer( u32 slot, Graphics::BufferId id, Graphics::ShaderStageFlag::Type stageBinding, Graphics::BufferBindFlags::Type bindFlags = Graphics::BufferBindFlags::CONSTANT )
+	{
+		RenderCapture::Instance().RecordBindBuffer( slot, id );
+		Graphics::BindGlobalBuffer( slot, id, stageBinding, bindFlags );
+	}
+
+	inline void UpdateBuffer( Graphics::BufferId id, const void* pData, size_t size )
+	{
+		RenderCapture::Instance().RecordUpdateBuffer( id, size );
+		Graphics::UpdateBuffer( id, pData, size );
+	}
+
+	inline void DrawMesh( Graphics::MeshId id, const Matrix4x4f& transform, u32 elementOffset = 0, u32 elementCount = ~0u )
+	{
+		RenderCapture::Instance().RecordDrawMesh( id );
+		Graphics::DrawMesh( id, transform, elementOffset, elementCount );
+	}
+
+	inline void DrawInstancedMesh( Graphics::MeshId id, u32 instanceCount, u32 elementOffset = 0, u32 elementCount = ~0u )
+	{
+		RenderCapture::Instance().RecordDrawInstancedMesh( id, instanceCount );
+		Graphics::DrawInstancedMesh( id, instanceCount, 0, elementOffset, elementCount );
+	}
+
+	inline void DrawWithoutVertices( u32 elements, u32 elementOffset = 0 )
+	{
+		RenderCapture::Instance().RecordDrawWithoutVertices( elements );
+		Graphics::DrawWithoutVertices( elements, elementOffset );
+	}
+
+	inline void BindGlobalTexture( u32 slot, Graphics::TextureId id, Graphics::SamplerId samplerId, Graphics::ShaderStageFlag::Type stageBinding, Graphics::TextureBindFlags::Type bindFlags = Graphics::TextureBindFlags::SRV )
+	{
+		RenderCapture::Instance().RecordBindTexture( slot, id );
+		Graphics::BindGlobalTexture( slot, id, samplerId, stageBinding, bindFlags );
+	}
+
+	inline void ClearRenderTarget( Graphics::TextureId id, ColourValue clearColour, u16 mipLevel = 0, u16 slice = 0 )
+	{
+		RenderCapture::Instance().RecordClearTarget( id, false, slice );
+		Graphics::ClearRenderTarget( id, clearColour, mipLevel, slice );
+	}
+
+	inline void ClearDepthTarget( Graphics::TextureId id, f32 depthValue = 1.0f, u16 mipLevel = 0, u16 slice = 0 )
+	{
+		RenderCapture::Instance().RecordClearTarget( id, true, slice );
+		Graphics::ClearDepthTarget( id, depthValue, mipLevel, slice );
+	}
+
+	inline void SetRenderTargets( Graphics::TextureId colourId, Graphics::TextureId depthId )
+	{
+		RenderCapture::Instance().RecordSetTargets( colourId, depthId );
+		Graphics::SetRenderTargets( colourId, depthId );
+	}
+
+	inline void SetDepthOnlyTarget( Graphics::TextureId depthId, u16 mipLevel = 0, u16 slice = 0 )
+	{
+		RenderCapture::Instance().RecordSetTargets( Graphics::TextureId(), depthId, slice );
+		Graphics::SetDepthOnlyTarget( depthId, mipLevel, slice );
+	}
+
+	inline void SetRenderTargetsToSwapChain( bool bEnableDefaultDepth )
+	{
+		RenderCapture::Instance().RecordSetTargets( Graphics::TextureId(), Graphics::TextureId() );
+		Graphics::SetRenderTargetsToSwapChain( bEnableDefaultDepth );
+	}
+
+	inline void SetViewport( const Graphics::Viewport& viewport )
+	{
+		RenderCapture::Instance().RecordSetViewport( viewport );
+		Graphics::SetViewport( viewport );
+	}
+
+	inline void SetViewMatrix( const Matrix4x4f& m )
+	{
+		RenderCapture::Instance().RecordSetViewMatrix();
+		Graphics::SetViewMatrix( m );
+	}
+
+	inline void SetProjectionMatrix( const Matrix4x4f& m )
+	{
+		RenderCapture::Instance().RecordSetProjectionMatrix();
+		Graphics::SetProjectionMatrix( m );
+	}
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+
+// Binary layout of a render capture, shared by RenderCapture and Tools/RenderCaptureAnalyser.
+// Only fixed width types so the file reads the same on every platform.
+// A capture is a RenderCaptureHeader followed by RenderCaptureRecords until the end of the file.
+
+constexpr uint32_t kRenderCaptureMagic = 0x50414352; // "RCAP"
+constexpr uint32_t kRenderCaptureVersion = 2;
+
+struct RenderCaptureHeader
+{
+	uint32_t magic = kRenderCaptureMagic;
+	uint32_t version = kRenderCaptureVersion;
+	uint32_t screenWidth = 0;
+	uint32_t screenHeight = 0;
+};
+
+enum class RenderCaptureOp : uint8_t
+{
+	kFrameBegin,        // a = frame index. Records before the first kPassBegin come from the game update.
+	kFrameEnd,
+	kPassBegin,         // pass = RenderPassType
+	kMeshCommand,       // a = mesh, b = material, c = pass mask, coverage of the bounding sphere. Submission order.
+	kParticleCommand,   // a = material, b = particle count
+	kSetMaterial,       // a = material
+	kSetWorldMatrix,
+	kBindBuffer,        // a = slot, b = buffer
+	kUpdateBuffer,      // a = buffer, b = bytes
+	kDrawMesh,          // a = mesh, b = bound material
+	kDrawInstancedMesh, // a = mesh, b = bound material, c = instance count
+	kDrawWithoutVertices, // a = bound material, b = vertex count
+	kBindTexture,       // a = slot, b = texture
+	kClearTarget,       // a = texture, b = 1 for depth, c = slice
+	kSetTargets,        // a = colour texture, b = depth texture, c = slice. An invalid id, ~0, is the swap chain or none.
+	kSetViewport,       // a = width, b = height
+	kSetViewMatrix,
+	kSetProjectionMatrix,
+
+	kNumOps,
+};
+
+struct RenderCaptureRecord
+{
+	RenderCaptureOp op;
+	uint8_t pass = 0;
+	uint16_t reserved = 0;
+	uint32_t a = 0;
+	uint32_t b = 0;
+	uint32_t c = 0;
+	float coverage = 0.f; // fraction of the viewport covered by the projected bounds, clamped to 1
+};
+
+static_assert(sizeof(RenderCaptureRecord) == 20, "RenderCaptureRecord is written to disk as is");
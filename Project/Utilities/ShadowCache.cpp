@@ -0,0 +1,43 @@
+#include "GameMath.h"
+#include "Types.h"
+#include "ShadowCache.h"
+
+
+bool ShadowCache::IsDirectionCached( u32 slice, const Vector3f& direction ) const
+{
+	const Layer& layer = m_layers[ slice ];
+	if ( !layer.bValid ) return false;
+
+	f32 lengths = length( direction ) * length( layer.direction );
+	if ( lengths <= 0.f ) return false;
+	return dot( direction, layer.direction ) / lengths >= cos( kAngleThreshold );
+}
+
+bool ShadowCache::NeedsRefresh( u32 slice, const Vector3f& direction, u64 casterHash ) const
+{
+	return !IsDirectionCached( slice, direction ) || m_layers[ slice ].casterHash != casterHash;
+}
+
+void ShadowCache::Store( u32 slice, const Vector3f& direction, const Matrix4x4f& view, const Matrix4x4f& project, u64 casterHash )
+{
+	Layer& layer = m_layers[ slice ];
+	layer.direction = direction;
+	layer.view = view;
+	layer.project = project;
+	layer.casterHash = casterHash;
+	layer.bValid = true;
+	m_refreshCount++;
+}
+
+void ShadowCache::Invalidate( u32 slice )
+{
+	m_layers[ slice ].bValid = false;
+}
+
+void ShadowCache::InvalidateAll()
+{
+	for ( Layer& layer : m_layers )
+	{
+		layer.bValid = false;
+	}
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+// Tracks the cached static shadow layer of each light. A layer stays valid while the light direction
+// stays within kAngleThreshold of the one it was rendered with, and the static casters it sees are unchanged.
+// While valid, the slice keeps using the light matrices the layer was rendered with so static and dynamic shadows line up.
+class ShadowCache
+{
+public:
+	static constexpr f32 kAngleThreshold = 0.5f * kfPi180;
+
+	// True when the layer was rendered from close enough to direction for its matrices to be reused.
+	bool IsDirectionCached( u32 slice, const Vector3f& direction ) const;
+	// True when the static layer must be rendered again before it can be used.
+	bool NeedsRefresh( u32 slice, const Vector3f& direction, u64 casterHash ) const;
+	void Store( u32 slice, const Vector3f& direction, const Matrix4x4f& view, const Matrix4x4f& project, u64 casterHash );
+	void Invalidate( u32 slice );
+	void InvalidateAll();
+
+	const Vector3f& GetDirection( u32 slice ) const { return m_layers[ slice ].direction; }
+	const Matrix4x4f& GetView( u32 slice ) const { return m_layers[ slice ].view; }
+	const Matrix4x4f& GetProject( u32 slice ) const { return m_layers[ slice ].project; }
+	u32 GetRefreshCount() const { return m_refreshCount; }
+
+private:
+	struct Layer
+	{
+		Vector3f direction{ 0.f };
+		Matrix4x4f view;
+		Matrix4x4f project;
+		u64 casterHash = 0;
+		bool bValid = false;
+	};
+
+	Layer m_layers[ kNumLights ];
+	u32 m_refreshCount{ 0 };
+};
@@ -28,7 +28,7 @@ PLAY_SINGLETON_IMPL( SoundManager );
 
 SoundManager::SoundManager()
 {
-	LoadSounds();
+
 }
 
 SoundManager::~SoundManager()
@@ -36,11 +36,11 @@ SoundManager::~SoundManager()
 
 }
 
-void SoundManager::LoadSounds()
+void SoundManager::LoadSounds( Resources::AsyncLoadingTaskId task )
 {
 	for (int i = 0; i < static_cast< int >(SoundType::TOTAL_SOUNDS); i++)
 	{
-		m_soundIdList[ i ] = Audio::LoadSoundFromFile( std::get< SOUND_PATH >(g_sounds[ i ]), std::get< LOOPING >(g_sounds[ i ]) );
+		Audio::AsyncLoadSoundFromFile( task, &m_soundIdList[ i ], std::get< SOUND_PATH >(g_sounds[ i ]), std::get< LOOPING >(g_sounds[ i ]) );
 	}
 }
 
@@ -26,6 +26,8 @@ class SoundManager
 
 public:
 	
+	// The sounds are ready once the task is, nothing plays before then.
+	void LoadSounds( Resources::AsyncLoadingTaskId task );
 	void Update();
 	void PlayBackgroundSound();
 	void PlaySound( SoundType sound );
@@ -38,8 +40,6 @@ public:
 	void SetGameOver( bool isOver ) { m_gameOver = isOver; }
 
 private:
-	void LoadSounds();
-
 	Audio::SoundId m_soundIdList[ static_cast< int >(SoundType::TOTAL_SOUNDS) ];
 	Audio::VoiceId m_voiceId;
 	Audio::VoiceId m_voiceIdBack;
@@ -0,0 +1,229 @@
+#include "TextureResidency.h"
+#include <algorithm>
+
+
+TextureResidency::TextureResidency( Backend& backend, uint64_t budgetBytes )
+	: m_backend( backend )
+	, m_budgetBytes( budgetBytes )
+{
+}
+
+uint32_t TextureResidency::AddTexture( uint32_t width, const uint64_t* pMipBytes, uint32_t mipCount, uint32_t floorMip )
+{
+	Texture texture;
+	texture.width = width;
+	texture.mipCount = std::min( mipCount, kMaxMips );
+	texture.floorMip = std::min( floorMip, texture.mipCount - 1 );
+	for ( uint32_t mip = texture.mipCount; mip-- > 0; )
+	{
+		texture.bytesFrom[ mip ] = texture.bytesFrom[ mip + 1 ] + pMipBytes[ mip ];
+	}
+	texture.residentMip = texture.floorMip;
+	texture.loadingMip = texture.floorMip;
+	texture.wantedMip = texture.floorMip;
+	texture.lastUsedFrame = m_frame;
+
+	m_stats.residentBytes += texture.bytesFrom[ texture.floorMip ];
+	m_stats.fullBytes += texture.bytesFrom[ 0 ];
+	m_stats.textureCount++;
+	m_textures.push_back( texture );
+	return static_cast< uint32_t >(m_textures.size() - 1);
+}
+
+void TextureResidency::Request( uint32_t handle, float texelCount )
+{
+	Texture& texture = m_textures[ handle ];
+	texture.requestedTexels = std::max( texture.requestedTexels, texelCount );
+}
+
+void TextureResidency::OnLoadComplete( uint32_t handle, bool bSuccess )
+{
+	Texture& texture = m_textures[ handle ];
+	if ( texture.loadingMip == texture.residentMip ) return;
+
+	const uint64_t bytes = texture.bytesFrom[ texture.loadingMip ] - texture.bytesFrom[ texture.residentMip ];
+	m_stats.pendingBytes -= bytes;
+	m_stats.loadsInFlight--;
+	if ( bSuccess )
+	{
+		m_stats.residentBytes += bytes;
+		texture.residentMip = texture.loadingMip;
+		texture.failedLoads = 0;
+	}
+	else if ( ++texture.failedLoads < kMaxFailedLoads )
+	{
+		// Back off so a file that keeps failing does not hold a load slot every frame.
+		texture.retryFrame = m_frame + ( 1ull << ( texture.failedLoads - 1 ) );
+	}
+	else
+	{
+		m_stats.failed++;
+	}
+	texture.loadingMip = texture.residentMip;
+}
+
+void TextureResidency::Update()
+{
+	m_frame++;
+	for ( Texture& texture : m_textures )
+	{
+		// Textures nothing asked for this frame only need their tail, their upper mips are the first to go.
+		if ( texture.requestedTexels > 0.f )
+		{
+			texture.wantedMip = MipForTexels( texture, texture.requestedTexels );
+			texture.lastUsedFrame = m_frame;
+		}
+		else
+		{
+			texture.wantedMip = texture.floorMip;
+		}
+		texture.requestedTexels = 0.f;
+	}
+
+	// The budget may have been lowered.
+	if ( GetUsedBytes() > m_budgetBytes )
+	{
+		EvictFor( GetUsedBytes() - m_budgetBytes, ~0u );
+	}
+
+	StartLoads();
+	UpdateStats();
+}
+
+// The smallest mip that is still at least texelCount wide.
+uint32_t TextureResidency::MipForTexels( const Texture& texture, float texelCount ) const
+{
+	uint32_t mip = 0;
+	while ( mip < texture.floorMip && static_cast< float >(texture.width >> ( mip + 1 )) >= texelCount )
+	{
+		mip++;
+	}
+	return mip;
+}
+
+uint64_t TextureResidency::GetEvictableBytes( uint32_t keepHandle ) const
+{
+	uint64_t bytes = 0;
+	for ( uint32_t handle = 0; handle < m_textures.size(); handle++ )
+	{
+		const Texture& texture = m_textures[ handle ];
+		if ( handle == keepHandle || texture.loadingMip != texture.residentMip ) continue;
+		if ( texture.residentMip < texture.wantedMip )
+		{
+			bytes += texture.bytesFrom[ texture.residentMip ] - texture.bytesFrom[ texture.wantedMip ];
+		}
+	}
+	return bytes;
+}
+
+// Drops mips that are not wanted, least recently used texture first, until bytes are freed or nothing more can go.
+// Textures that are loading keep what they have, their loads have reserved against the budget already.
+void TextureResidency::EvictFor( uint64_t bytes, uint32_t keepHandle )
+{
+	m_evictOrder.clear();
+	for ( uint32_t handle = 0; handle < m_textures.size(); handle++ )
+	{
+		const Texture& texture = m_textures[ handle ];
+		if ( handle != keepHandle && texture.loadingMip == texture.residentMip && texture.residentMip < texture.wantedMip )
+		{
+			m_evictOrder.push_back( handle );
+		}
+	}
+	std::sort( m_evictOrder.begin(), m_evictOrder.end(), [ this ]( uint32_t a, uint32_t b )
+	{
+		const Texture& textureA = m_textures[ a ];
+		const Texture& textureB = m_textures[ b ];
+		if ( textureA.lastUsedFrame != textureB.lastUsedFrame ) return textureA.lastUsedFrame < textureB.lastUsedFrame;
+		return a < b;
+	} );
+
+	uint64_t freed = 0;
+	for ( uint32_t handle : m_evictOrder )
+	{
+		if ( freed >= bytes ) break;
+
+		// One mip at a time, the top one is most of a texture anyway.
+		Texture& texture = m_textures[ handle ];
+		uint32_t firstMip = texture.residentMip;
+		while ( freed < bytes && firstMip < texture.wantedMip )
+		{
+			freed += texture.bytesFrom[ firstMip ] - texture.bytesFrom[ firstMip + 1 ];
+			firstMip++;
+		}
+
+		m_stats.residentBytes -= texture.bytesFrom[ texture.residentMip ] - texture.bytesFrom[ firstMip ];
+		m_stats.evictions++;
+		texture.residentMip = firstMip;
+		texture.loadingMip = firstMip;
+		m_backend.EvictMips( handle, firstMip );
+	}
+}
+
+void TextureResidency::StartLoads()
+{
+	m_loadOrder.clear();
+	for ( uint32_t handle = 0; handle < m_textures.size(); handle++ )
+	{
+		const Texture& texture = m_textures[ handle ];
+		if ( texture.loadingMip == texture.residentMip && texture.wantedMip < texture.residentMip &&
+			texture.failedLoads < kMaxFailedLoads && texture.retryFrame <= m_frame )
+		{
+			m_loadOrder.push_back( handle );
+		}
+	}
+
+	// Furthest from what they want first, so everything on screen gets close before anything gets perfect.
+	std::sort( m_loadOrder.begin(), m_loadOrder.end(), [ this ]( uint32_t a, uint32_t b )
+	{
+		const uint32_t missingA = m_textures[ a ].residentMip - m_textures[ a ].wantedMip;
+		const uint32_t missingB = m_textures[ b ].residentMip - m_textures[ b ].wantedMip;
+		if ( missingA != missingB ) return missingA > missingB;
+		return a < b;
+	} );
+
+	for ( uint32_t handle : m_loadOrder )
+	{
+		if ( m_stats.loadsInFlight >= kMaxLoadsInFlight ) break;
+
+		// Take as many of the wanted mips as fit, the rest follow when there is room.
+		Texture& texture = m_textures[ handle ];
+		// Saturates rather than wraps for an unlimited budget.
+		const uint64_t evictable = GetEvictableBytes( handle );
+		const uint64_t available = evictable > ~0ull - m_budgetBytes ? ~0ull : m_budgetBytes + evictable;
+		uint32_t firstMip = texture.wantedMip;
+		while ( firstMip < texture.residentMip &&
+			GetUsedBytes() + texture.bytesFrom[ firstMip ] - texture.bytesFrom[ texture.residentMip ] > available )
+		{
+			firstMip++;
+		}
+		if ( firstMip == texture.residentMip ) continue;
+
+		const uint64_t bytes = texture.bytesFrom[ firstMip ] - texture.bytesFrom[ texture.residentMip ];
+		if ( GetUsedBytes() + bytes > m_budgetBytes )
+		{
+			EvictFor( GetUsedBytes() + bytes - m_budgetBytes, handle );
+		}
+
+		// The backend may complete the load before returning, so the state is set first.
+		const uint32_t residentMip = texture.residentMip;
+		texture.loadingMip = firstMip;
+		m_stats.pendingBytes += bytes;
+		m_stats.loadsInFlight++;
+		m_stats.loads++;
+		m_backend.LoadMips( handle, firstMip, residentMip );
+	}
+}
+
+void TextureResidency::UpdateStats()
+{
+	m_stats.wantedBytes = 0;
+	m_stats.waiting = 0;
+	for ( const Texture& texture : m_textures )
+	{
+		m_stats.wantedBytes += texture.bytesFrom[ texture.wantedMip ];
+		if ( texture.wantedMip < texture.residentMip && texture.loadingMip == texture.residentMip && texture.failedLoads < kMaxFailedLoads )
+		{
+			m_stats.waiting++;
+		}
+	}
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// Decides which mips of streamed textures are resident. Every texture keeps its tail of small mips, from floorMip down.
+// The mips above are loaded once something on screen needs them, and only evicted when the resident and in-flight
+// bytes would pass the budget, least recently used texture first. The loading and freeing is left to a Backend, so
+// the policy only depends on the standard library and runs the same against a stand-in backend as against the GPU.
+class TextureResidency
+{
+public:
+	// Does the work the policy asks for. A load completes later through OnLoadComplete, an eviction straight away.
+	class Backend
+	{
+	public:
+		virtual ~Backend() = default;
+		// Loads mips [ firstMip, residentMip ) of a texture that has residentMip and below.
+		virtual void LoadMips( uint32_t handle, uint32_t firstMip, uint32_t residentMip ) = 0;
+		// Frees the mips above firstMip.
+		virtual void EvictMips( uint32_t handle, uint32_t firstMip ) = 0;
+	};
+
+	struct Stats
+	{
+		uint64_t residentBytes = 0;
+		uint64_t pendingBytes = 0; // reserved by loads in flight
+		uint64_t wantedBytes = 0;  // what every texture at its wanted mip would take
+		uint64_t fullBytes = 0;    // what every texture with all of its mips would take
+		uint32_t textureCount = 0;
+		uint32_t loadsInFlight = 0;
+		uint32_t waiting = 0; // textures short of their wanted mip with no load in flight, held back by the budget, kMaxLoadsInFlight or a retry backoff
+		uint32_t failed = 0;  // textures whose loads failed kMaxFailedLoads times in a row, left with the mips they have
+		uint32_t loads = 0;	  // since the start
+		uint32_t evictions = 0;
+	};
+
+	static constexpr uint32_t kMaxMips = 16;
+	// Keeps the IO queue short so loads follow the camera rather than where it was.
+	static constexpr uint32_t kMaxLoadsInFlight = 4;
+	// A failed load is retried after 1, 2, 4... frames, and a texture is given up on after this many failures in a row.
+	static constexpr uint32_t kMaxFailedLoads = 4;
+
+	TextureResidency( Backend& backend, uint64_t budgetBytes );
+
+	// pMipBytes[ i ] is the size of mip i. Mips from floorMip down are resident already and stay so.
+	// Returns the handle the backend is called with.
+	uint32_t AddTexture( uint32_t width, const uint64_t* pMipBytes, uint32_t mipCount, uint32_t floorMip );
+
+	// Asks for enough of a texture to cover texelCount texels across its width, the largest request of a frame wins.
+	void Request( uint32_t handle, float texelCount );
+
+	// Called for every LoadMips, the texture keeps its old mips if the load failed.
+	// Failed loads are retried with a backoff until kMaxFailedLoads, then the texture loads no more.
+	void OnLoadComplete( uint32_t handle, bool bSuccess );
+
+	// Once per frame after the requests. Works out the wanted mips, evicts to make room and starts loads.
+	void Update();
+
+	void SetBudget( uint64_t budgetBytes ) { m_budgetBytes = budgetBytes; }
+	uint64_t GetBudget() const { return m_budgetBytes; }
+	uint32_t GetResidentMip( uint32_t handle ) const { return m_textures[ handle ].residentMip; }
+	uint32_t GetWantedMip( uint32_t handle ) const { return m_textures[ handle ].wantedMip; }
+	bool IsLoading( uint32_t handle ) const { return m_textures[ handle ].loadingMip != m_textures[ handle ].residentMip; }
+	bool IsFailed( uint32_t handle ) const { return m_textures[ handle ].failedLoads >= kMaxFailedLoads; }
+	const Stats& GetStats() const { return m_stats; }
+
+private:
+	struct Texture
+	{
+		uint64_t bytesFrom[ kMaxMips + 1 ] = {}; // size of mip i and everything below it
+		uint32_t width = 0;
+		uint32_t mipCount = 0;
+		uint32_t floorMip = 0;
+		uint32_t residentMip = 0;
+		uint32_t loadingMip = 0; // the residentMip a load in flight will leave, residentMip when there is none
+		uint32_t wantedMip = 0;
+		float requestedTexels = 0.f;
+		uint64_t lastUsedFrame = 0;
+		uint32_t failedLoads = 0; // in a row, a successful load clears it
+		uint64_t retryFrame = 0;  // no load is started before this frame
+	};
+
+	uint32_t MipForTexels( const Texture& texture, float texelCount ) const;
+	uint64_t GetUsedBytes() const { return m_stats.residentBytes + m_stats.pendingBytes; }
+	uint64_t GetEvictableBytes( uint32_t keepHandle ) const;
+	void EvictFor( uint64_t bytes, uint32_t keepHandle );
+	void StartLoads();
+	void UpdateStats();
+
+	Backend& m_backend;
+	uint64_t m_budgetBytes;
+	uint64_t m_frame{ 0 };
+	std::vector< Texture > m_textures;
+	std::vector< uint32_t > m_loadOrder; // scratch for sorting handles
+	std::vector< uint32_t > m_evictOrder;
+	Stats m_stats;
+};
@@ -0,0 +1,207 @@
+#include "GameMath.h"
+#include "Types.h"
+#include "RenderContext.h"
+#include "TextureStreamer.h"
+#include <filesystem>
+
+
+PLAY_SINGLETON_IMPL( TextureStreamer );
+
+TextureStreamer::TextureStreamer()
+	: m_residency( *this, kDefaultBudgetBytes )
+{
+
+}
+
+TextureStreamer::~TextureStreamer()
+{
+
+}
+
+void TextureStreamer::AsyncLoadTexture( Resources::AsyncLoadingTaskId hAsyncLoad, Graphics::TextureId* pTextureOut, const char* filePath )
+{
+	std::string ddsPath = std::filesystem::path( filePath ).replace_extension( ".dds" ).string();
+	if ( !System::CheckFileExists( ddsPath.c_str() ) )
+	{
+		Graphics::AsyncAcquireTextureFromFile( hAsyncLoad, pTextureOut, filePath );
+		return;
+	}
+
+	auto it = m_texturesByPath.find( ddsPath );
+	if ( it != m_texturesByPath.end() )
+	{
+		StreamedTexture& texture = m_textures[ it->second ];
+		if ( texture.bLoaded ) *pTextureOut = texture.textureId;
+		else texture.waiters.push_back( pTextureOut );
+		return;
+	}
+
+	const u32 index = static_cast< u32 >(m_textures.size());
+	m_texturesByPath[ ddsPath ] = index;
+	m_textures.emplace_back();
+	m_textures.back().ddsPath = ddsPath;
+	m_textures.back().waiters.push_back( pTextureOut );
+
+	// The whole file is read to find the mips, only the tail goes to the GPU.
+	Resources::AddAsyncRead( hAsyncLoad, ddsPath, [ this, index ]( const void* pData, size_t sizeBytes ) { CreateTexture( index, pData, sizeBytes ); } );
+}
+
+void TextureStreamer::CreateTexture( u32 index, const void* pData, size_t sizeBytes )
+{
+	StreamedTexture& texture = m_textures[ index ];
+	texture.bLoaded = true;
+
+	Graphics::TextureDesc desc;
+	if ( pData && Graphics::ParseDDS( pData, sizeBytes, texture.ddsPath.c_str(), desc ) )
+	{
+		// Sampled as linear, like the pngs they were cooked from.
+		desc.format = Graphics::MatchColourSpace( desc.format, true );
+
+		if ( desc.type == Graphics::TextureType::TEXTURE2D && desc.slices == 1 )
+		{
+			// Every mip above the tail can become the top one, which for block compressed formats must be a multiple of 4.
+			u32 floorMip = 0;
+			while ( floorMip + 1 < desc.mipLevels && std::max( desc.width >> floorMip, desc.height >> floorMip ) > kInitialSize
+				&& ( desc.width >> ( floorMip + 1 ) ) % 4 == 0 && ( desc.height >> ( floorMip + 1 ) ) % 4 == 0 )
+			{
+				floorMip++;
+			}
+
+			const u8* pFileData = static_cast< const u8* >(pData);
+			std::vector< u64 > mipBytes( desc.mipLevels );
+			texture.mipOffsets.resize( desc.mipLevels + 1 );
+			for ( u32 mip = 0; mip < desc.mipLevels; mip++ )
+			{
+				texture.mipOffsets[ mip ] = static_cast< const u8* >(desc.imageDataPtrs[ mip ]) - pFileData;
+			}
+			texture.mipOffsets[ desc.mipLevels ] = sizeBytes;
+			for ( u32 mip = 0; mip < desc.mipLevels; mip++ )
+			{
+				mipBytes[ mip ] = texture.mipOffsets[ mip + 1 ] - texture.mipOffsets[ mip ];
+			}
+
+			texture.format = desc.format;
+			texture.width = desc.width;
+			texture.height = desc.height;
+			texture.mipCount = desc.mipLevels;
+
+			desc.width = std::max( 1u, desc.width >> floorMip );
+			desc.height = std::max( 1u, desc.height >> floorMip );
+			desc.mipLevels -= floorMip;
+			desc.imageDataPtrs.erase( desc.imageDataPtrs.begin(), desc.imageDataPtrs.begin() + floorMip );
+			texture.textureId = Resources::CreateAsset< Graphics::Texture >( desc );
+
+			const u32 handle = m_residency.AddTexture( texture.width, mipBytes.data(), texture.mipCount, floorMip );
+			m_texturesByHandle.push_back( index );
+			m_handlesByTexture[ texture.textureId.GetValue() ] = handle;
+		}
+		else
+		{
+			texture.textureId = Resources::CreateAsset< Graphics::Texture >( desc );
+		}
+	}
+	else
+	{
+		Debug::Printf( "ERROR: TextureStreamer could not load '%s'\n", texture.ddsPath.c_str() );
+	}
+	System::ReleaseFileData( pData );
+
+	for ( Graphics::TextureId* pTextureOut : texture.waiters )
+	{
+		*pTextureOut = texture.textureId;
+	}
+	texture.waiters.clear();
+}
+
+void TextureStreamer::AddMaterial( Graphics::MaterialId material, const Graphics::TextureId* pTextures, u32 count )
+{
+	for ( u32 i = 0; i < count; i++ )
+	{
+		auto it = m_handlesByTexture.find( pTextures[ i ].GetValue() );
+		if ( pTextures[ i ].IsValid() && it != m_handlesByTexture.end() )
+		{
+			m_handlesByMaterial[ material.GetValue() ].push_back( it->second );
+		}
+	}
+}
+
+void TextureStreamer::RequestForPass( const RenderContext& ctx, u32 screenHeight )
+{
+	const LodView& view = ctx.GetLodView();
+	if ( view.projectionScale <= 0.f ) return;
+
+	const RenderContext::MeshCmdList& commands = ctx.GetMeshCommands();
+	for ( u32 index : ctx.GetPassView() )
+	{
+		auto it = m_handlesByMaterial.find( commands[ index ].materialId.GetValue() );
+		if ( it == m_handlesByMaterial.end() ) continue;
+
+		// Projected diameter in pixels, the projection scale maps to half the screen height.
+		const Vector4f sphere = ctx.GetBoundingSphere( index );
+		const f32 distance = std::max( length( sphere.xyz() - view.position ), 0.001f );
+		const f32 pixels = sphere.w * view.projectionScale / distance * static_cast< f32 >(screenHeight);
+		for ( u32 handle : it->second )
+		{
+			m_residency.Request( handle, pixels * kTexelsPerPixel );
+		}
+	}
+}
+
+void TextureStreamer::Update()
+{
+	std::vector< CompletedLoad > completed;
+	{
+		std::lock_guard< std::mutex > lock( m_mutex );
+		completed.swap( m_completed );
+	}
+
+	for ( const CompletedLoad& load : completed )
+	{
+		bool bSuccess = load.result.status == System::IoStatus::kComplete
+			&& ResizeTexture( load.handle, load.firstMip, load.residentMip, static_cast< const u8* >(load.result.pData) );
+		System::ReleaseFileData( load.result.pData );
+		m_residency.OnLoadComplete( load.handle, bSuccess );
+	}
+
+	m_residency.Update();
+}
+
+// Mips from residentMip down are on the GPU already, pData holds the ones from firstMip up to it.
+bool TextureStreamer::ResizeTexture( u32 handle, u32 firstMip, u32 residentMip, const u8* pData )
+{
+	const StreamedTexture& texture = m_textures[ m_texturesByHandle[ handle ] ];
+
+	Graphics::TextureDesc desc;
+	desc.format = texture.format;
+	desc.width = std::max( 1u, texture.width >> firstMip );
+	desc.height = std::max( 1u, texture.height >> firstMip );
+	desc.mipLevels = texture.mipCount - firstMip;
+	desc.flags = Graphics::TextureFlags::ENABLE_TEXTURE;
+	desc.pDebugName = texture.ddsPath.c_str();
+	for ( u32 mip = firstMip; mip < residentMip; mip++ )
+	{
+		desc.imageDataPtrs.push_back( pData + ( texture.mipOffsets[ mip ] - texture.mipOffsets[ firstMip ] ) );
+	}
+	return Graphics::ResizeTextureMips( texture.textureId, desc ) == RESULT_OK;
+}
+
+void TextureStreamer::LoadMips( uint32_t handle, uint32_t firstMip, uint32_t residentMip )
+{
+	const StreamedTexture& texture = m_textures[ m_texturesByHandle[ handle ] ];
+
+	System::IoRequestDesc desc;
+	desc.filePath = texture.ddsPath;
+	desc.offset = texture.mipOffsets[ firstMip ];
+	desc.sizeBytes = texture.mipOffsets[ residentMip ] - texture.mipOffsets[ firstMip ];
+	desc.callback = [ this, handle, firstMip, residentMip ]( const System::IoResult& rResult )
+	{
+		std::lock_guard< std::mutex > lock( m_mutex );
+		m_completed.push_back( { handle, firstMip, residentMip, rResult } );
+	};
+	System::ReadFileAsync( desc );
+}
+
+void TextureStreamer::EvictMips( uint32_t handle, uint32_t firstMip )
+{
+	ResizeTexture( handle, firstMip, firstMip, nullptr );
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "TextureResidency.h"
+#include <mutex>
+
+class RenderContext;
+
+
+// Streams the upper mips of the cooked .dds textures of game assets. A texture is created with only the mips up to
+// kInitialSize, objects using it ask for more each frame by how big they are on screen, and TextureResidency decides
+// what is loaded and evicted within the budget. Mips are read with the async IO service and swapped in by
+// Graphics::ResizeTextureMips, so materials keep the same texture ids throughout.
+// Textures without a cooked .dds are loaded whole through the resource cache and are not streamed.
+class TextureStreamer : private TextureResidency::Backend
+{
+	TextureStreamer();
+	~TextureStreamer();
+
+	PLAY_SINGLETON_INTERFACE( TextureStreamer );
+
+public:
+	static constexpr u64 kDefaultBudgetBytes = 16 * 1024 * 1024;
+	static constexpr u64 kMinBudgetBytes = 1024 * 1024;
+	// Largest mip created at load, the tail from here down is never evicted.
+	static constexpr u32 kInitialSize = 64;
+	// A texture wraps once around its object, so the half facing the camera spans about twice its width in texels.
+	static constexpr f32 kTexelsPerPixel = 2.f;
+
+	// Creates the texture for a .png with the tail mips of its cooked .dds, pTextureOut is written when the load finishes.
+	// Requests for the same file share the texture.
+	void AsyncLoadTexture( Resources::AsyncLoadingTaskId hAsyncLoad, Graphics::TextureId* pTextureOut, const char* filePath );
+	// Streams the textures of a material for the meshes drawn with it, call once its textures have loaded.
+	void AddMaterial( Graphics::MaterialId material, const Graphics::TextureId* pTextures, u32 count );
+	// Asks for the textures of the meshes in the pass view, by their projected size with the context's LodView.
+	void RequestForPass( const RenderContext& ctx, u32 screenHeight );
+	// Once per frame on the owning thread. Swaps in completed loads, then evicts and starts loads for the requests.
+	void Update();
+
+	void SetBudget( u64 budgetBytes ) { m_residency.SetBudget( budgetBytes ); }
+	u64 GetBudget() const { return m_residency.GetBudget(); }
+	const TextureResidency::Stats& GetStats() const { return m_residency.GetStats(); }
+
+private:
+	struct StreamedTexture
+	{
+		std::string ddsPath;
+		Graphics::TextureId textureId;
+		Graphics::TextureFormat format = Graphics::TextureFormat::BC7;
+		u32 width = 0;
+		u32 height = 0;
+		u32 mipCount = 0;
+		std::vector< u64 > mipOffsets; // in the file, one past the end for the last mip
+		std::vector< Graphics::TextureId* > waiters;
+		bool bLoaded = false;
+	};
+
+	struct CompletedLoad
+	{
+		u32 handle;
+		u32 firstMip;
+		u32 residentMip;
+		System::IoResult result;
+	};
+
+	void CreateTexture( u32 index, const void* pData, size_t sizeBytes );
+	bool ResizeTexture( u32 handle, u32 firstMip, u32 residentMip, const u8* pData );
+	void LoadMips( uint32_t handle, uint32_t firstMip, uint32_t residentMip ) override;
+	void EvictMips( uint32_t handle, uint32_t firstMip ) override;
+
+	std::vector< StreamedTexture > m_textures;
+	std::unordered_map< std::string, u32 > m_texturesByPath;	 // into m_textures
+	std::vector< u32 > m_texturesByHandle;						 // residency handle to m_textures
+	std::unordered_map< u32, u32 > m_handlesByTexture;			 // texture id value to residency handle
+	std::unordered_map< u32, std::vector< u32 > > m_handlesByMaterial; // material id value to residency handles
+	TextureResidency m_residency;
+
+	std::mutex m_mutex;
+	std::vector< CompletedLoad > m_completed; // filled by the IO threads
+};
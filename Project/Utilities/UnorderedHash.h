@@ -0,0 +1,32 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Hash of an unordered set of items. Each item is hashed on its own and the results are summed, so the same items
+// give the same hash in any order. Only depends on the standard library.
+class UnorderedHash
+{
+public:
+	void Add( const void* pData, size_t sizeBytes )
+	{
+		// FNV-1a with a finaliser, so items differing in one byte do not differ in one bit of the sum.
+		uint64_t hash = 0xcbf29ce484222325ull;
+		const uint8_t* pBytes = static_cast< const uint8_t* >(pData);
+		for ( size_t i = 0; i < sizeBytes; i++ )
+		{
+			hash = ( hash ^ pBytes[ i ] ) * 0x100000001b3ull;
+		}
+		hash ^= hash >> 33;
+		hash *= 0xff51afd7ed558ccdull;
+		hash ^= hash >> 33;
+
+		m_sum += hash;
+		m_count++;
+	}
+
+	uint64_t Get() const { return m_sum ^ ( m_count * 0x9e3779b97f4a7c15ull ); }
+
+private:
+	uint64_t m_sum = 0;
+	uint64_t m_count = 0;
+};
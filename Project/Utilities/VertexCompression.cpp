@@ -0,0 +1,140 @@
+#include "VertexCompression.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+
+namespace VertexCompression
+{
+	namespace
+	{
+		const float* Element( const float* pData, uint32_t index, uint32_t stride )
+		{
+			return reinterpret_cast< const float* >(reinterpret_cast< const uint8_t* >(pData) + size_t( index ) * stride);
+		}
+
+		int16_t ToSnorm16( float value )
+		{
+			return static_cast< int16_t >(std::lround( std::clamp( value, -1.f, 1.f ) * 32767.f ));
+		}
+	}
+
+	void QuantisePositions( const float* pPositions, uint32_t count, uint32_t stride, std::vector< QuantisedPosition >& out, float boundsOut[ 6 ] )
+	{
+		out.resize( count );
+		if ( count == 0 )
+		{
+			std::fill( boundsOut, boundsOut + 6, 0.f );
+			return;
+		}
+
+		for ( int k = 0; k < 3; k++ )
+		{
+			boundsOut[ k ] = boundsOut[ k + 3 ] = pPositions[ k ];
+		}
+		for ( uint32_t i = 0; i < count; i++ )
+		{
+			const float* p = Element( pPositions, i, stride );
+			for ( int k = 0; k < 3; k++ )
+			{
+				boundsOut[ k ] = std::min( boundsOut[ k ], p[ k ] );
+				boundsOut[ k + 3 ] = std::max( boundsOut[ k + 3 ], p[ k ] );
+			}
+		}
+
+		float scale[ 3 ];
+		for ( int k = 0; k < 3; k++ )
+		{
+			const float extent = boundsOut[ k + 3 ] - boundsOut[ k ];
+			scale[ k ] = extent > 0.f ? 65535.f / extent : 0.f;
+		}
+
+		for ( uint32_t i = 0; i < count; i++ )
+		{
+			const float* p = Element( pPositions, i, stride );
+			uint16_t q[ 3 ];
+			for ( int k = 0; k < 3; k++ )
+			{
+				q[ k ] = static_cast< uint16_t >(std::clamp( std::lround( ( p[ k ] - boundsOut[ k ] ) * scale[ k ] ), 0l, 65535l ));
+			}
+			out[ i ] = { q[ 0 ], q[ 1 ], q[ 2 ], 0 };
+		}
+	}
+
+	void EncodeNormals( const float* pNormals, uint32_t count, uint32_t stride, std::vector< OctNormal >& out )
+	{
+		out.resize( count );
+		for ( uint32_t i = 0; i < count; i++ )
+		{
+			const float* n = Element( pNormals, i, stride );
+			const float l1 = std::abs( n[ 0 ] ) + std::abs( n[ 1 ] ) + std::abs( n[ 2 ] );
+			if ( l1 <= 0.f )
+			{
+				out[ i ] = { 0, 0 };
+				continue;
+			}
+
+			// Project onto the octahedron, and fold the lower half over the upper one.
+			float x = n[ 0 ] / l1;
+			float y = n[ 1 ] / l1;
+			if ( n[ 2 ] < 0.f )
+			{
+				const float foldedX = ( 1.f - std::abs( y ) ) * ( x >= 0.f ? 1.f : -1.f );
+				const float foldedY = ( 1.f - std::abs( x ) ) * ( y >= 0.f ? 1.f : -1.f );
+				x = foldedX;
+				y = foldedY;
+			}
+			out[ i ] = { ToSnorm16( x ), ToSnorm16( y ) };
+		}
+	}
+
+	void EncodeUVs( const float* pUVs, uint32_t count, uint32_t stride, std::vector< HalfUV >& out )
+	{
+		out.resize( count );
+		for ( uint32_t i = 0; i < count; i++ )
+		{
+			const float* uv = Element( pUVs, i, stride );
+			out[ i ] = { FloatToHalf( uv[ 0 ] ), FloatToHalf( uv[ 1 ] ) };
+		}
+	}
+
+	uint16_t FloatToHalf( float value )
+	{
+		uint32_t bits;
+		std::memcpy( &bits, &value, sizeof( bits ) );
+
+		const uint32_t sign = ( bits >> 16 ) & 0x8000u;
+		const uint32_t magnitude = bits & 0x7fffffffu;
+
+		if ( magnitude >= 0x7f800000u )
+		{
+			// Infinity stays infinity, NaN stays a quiet NaN.
+			return static_cast< uint16_t >(sign | 0x7c00u | ( magnitude > 0x7f800000u ? 0x200u : 0u ));
+		}
+		if ( magnitude >= 0x477ff000u )
+		{
+			// Rounds to a value past the largest half.
+			return static_cast< uint16_t >(sign | 0x7c00u);
+		}
+		if ( magnitude < 0x38800000u )
+		{
+			// Denormal or zero. Adding 0.5 lets the float unit do the rounding to the denormal step.
+			float denormal;
+			std::memcpy( &denormal, &magnitude, sizeof( denormal ) );
+			denormal += 0.5f;
+			uint32_t denormalBits;
+			std::memcpy( &denormalBits, &denormal, sizeof( denormalBits ) );
+			return static_cast< uint16_t >(sign | ( denormalBits - 0x3f000000u ));
+		}
+
+		// Rebias the exponent, then round the 13 dropped mantissa bits to nearest even.
+		const uint32_t oddMantissa = ( magnitude >> 13 ) & 1u;
+		const uint32_t rounded = magnitude + 0xc8000fffu + oddMantissa;
+		return static_cast< uint16_t >(sign | ( rounded >> 13 ));
+	}
+
+	bool IsUniform( const uint32_t* pColours, uint32_t count )
+	{
+		return std::all_of( pColours, pColours + count, [ pColours ]( uint32_t colour ) { return colour == pColours[ 0 ]; } );
+	}
+}
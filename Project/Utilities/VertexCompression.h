@@ -0,0 +1,35 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// Encoders for the compact vertex streams of a p3dmesh (see Graphics::MeshDesc::m_bCompactVertices):
+// 16-bit unorm positions relative to the mesh bounds, 16-bit octahedral normals and half float uvs.
+// Only depends on the standard library so it runs in the tools as well as the game.
+namespace VertexCompression
+{
+	struct QuantisedPosition
+	{
+		uint16_t x, y, z, w;
+	};
+
+	struct OctNormal
+	{
+		int16_t x, y;
+	};
+
+	struct HalfUV
+	{
+		uint16_t u, v;
+	};
+
+	// Strides are in bytes. boundsOut receives min xyz then max xyz, which the positions decode against.
+	void QuantisePositions( const float* pPositions, uint32_t count, uint32_t stride, std::vector< QuantisedPosition >& out, float boundsOut[ 6 ] );
+	void EncodeNormals( const float* pNormals, uint32_t count, uint32_t stride, std::vector< OctNormal >& out );
+	void EncodeUVs( const float* pUVs, uint32_t count, uint32_t stride, std::vector< HalfUV >& out );
+
+	// Round to nearest even, overflow goes to infinity.
+	uint16_t FloatToHalf( float value );
+
+	// True when every colour is the same, so the stream can be a single element.
+	bool IsUniform( const uint32_t* pColours, uint32_t count );
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <cstdio>
+
+// Minimal checks for the standalone tests, each test's main returns ReportChecks().
+inline int g_checkFailures = 0;
+inline int g_checkCount = 0;
+
+#define CHECK( condition )                                                              \
+	do                                                                                  \
+	{                                                                                   \
+		g_checkCount++;                                                                 \
+		if ( !( condition ) )                                                           \
+		{                                                                               \
+			g_checkFailures++;                                                          \
+			std::printf( "%s(%d): CHECK( %s ) failed\n", __FILE__, __LINE__, #condition ); \
+		}                                                                               \
+	} while ( 0 )
+
+inline int ReportChecks( const char* name )
+{
+	std::printf( "%s: %d of %d checks passed\n", name, g_checkCount - g_checkFailures, g_checkCount );
+	return g_checkFailures == 0 ? 0 : 1;
+}
@@ -0,0 +1,186 @@
+///////////////////////////////////////////////////////////////////////////
+//	File		: MeshOptimiserTest.cpp
+//	Platform	: All
+//
+//	Reorders grids with the mesh optimiser and checks the same input always
+//	gives the same output, the vertex cache is used no worse than before,
+//	every triangle survives the reordering and vertex streams remapped for
+//	fetch order still give the triangles they started with.
+//	Builds without Play3d from the repository root, on Linux:
+//		g++ -std=c++20 -O2 -o MeshOptimiserTest Tests/MeshOptimiserTest.cpp Project/Utilities/MeshOptimiser.cpp
+//
+//	Copyright (C) Sumo Digital Ltd. All rights reserved.
+///////////////////////////////////////////////////////////////////////////
+
+#include "../Project/Utilities/MeshOptimiser.h"
+#include "Check.h"
+#include <algorithm>
+#include <array>
+#include <random>
+#include <vector>
+
+namespace
+{
+	struct Float3
+	{
+		float x, y, z;
+
+		bool operator==( const Float3& other ) const = default;
+	};
+
+	// A flat grid of size by size quads, two triangles each, rows of triangles in order.
+	struct Grid
+	{
+		std::vector< Float3 > positions;
+		std::vector< uint32_t > indices;
+	};
+
+	Grid MakeGrid( uint32_t size )
+	{
+		Grid grid;
+		for ( uint32_t y = 0; y <= size; y++ )
+		{
+			for ( uint32_t x = 0; x <= size; x++ ) grid.positions.push_back( { float( x ), float( y ), 0.f } );
+		}
+		for ( uint32_t y = 0; y < size; y++ )
+		{
+			for ( uint32_t x = 0; x < size; x++ )
+			{
+				const uint32_t v = y * ( size + 1 ) + x;
+				grid.indices.insert( grid.indices.end(), { v, v + 1, v + size + 2, v, v + size + 2, v + size + 1 } );
+			}
+		}
+		return grid;
+	}
+
+	// The same grid with its triangles in a fixed random order, as an unoptimised export might leave them.
+	Grid MakeShuffledGrid( uint32_t size )
+	{
+		Grid grid = MakeGrid( size );
+		std::vector< std::array< uint32_t, 3 > > triangles( grid.indices.size() / 3 );
+		for ( size_t i = 0; i < triangles.size(); i++ ) triangles[ i ] = { grid.indices[ i * 3 ], grid.indices[ i * 3 + 1 ], grid.indices[ i * 3 + 2 ] };
+		std::shuffle( triangles.begin(), triangles.end(), std::mt19937( 42 ) );
+		for ( size_t i = 0; i < triangles.size(); i++ ) std::copy( triangles[ i ].begin(), triangles[ i ].end(), grid.indices.begin() + i * 3 );
+		return grid;
+	}
+
+	// Triangles with their smallest index first and then sorted, so two lists can be compared whatever their order.
+	std::vector< std::array< uint32_t, 3 > > CanonicalTriangles( const std::vector< uint32_t >& indices )
+	{
+		std::vector< std::array< uint32_t, 3 > > triangles;
+		for ( size_t i = 0; i < indices.size(); i += 3 )
+		{
+			std::array< uint32_t, 3 > t = { indices[ i ], indices[ i + 1 ], indices[ i + 2 ] };
+			std::rotate( t.begin(), std::min_element( t.begin(), t.end() ), t.end() );
+			triangles.push_back( t );
+		}
+		std::sort( triangles.begin(), triangles.end() );
+		return triangles;
+	}
+
+	uint32_t VertexCount( const Grid& grid ) { return static_cast< uint32_t >(grid.positions.size()); }
+	uint32_t IndexCount( const Grid& grid ) { return static_cast< uint32_t >(grid.indices.size()); }
+
+	// The cooker's order of steps.
+	void Optimise( Grid& grid, std::vector< uint32_t >& remap )
+	{
+		MeshOptimiser::OptimiseVertexCache( grid.indices.data(), IndexCount( grid ), VertexCount( grid ) );
+		MeshOptimiser::OptimiseOverdraw( grid.indices.data(), IndexCount( grid ), &grid.positions[ 0 ].x, VertexCount( grid ), sizeof( Float3 ) );
+		MeshOptimiser::OptimiseVertexFetch( grid.indices.data(), IndexCount( grid ), VertexCount( grid ), remap );
+		MeshOptimiser::RemapVertexStream( grid.positions, remap );
+	}
+
+	void TestDeterministic()
+	{
+		Grid a = MakeShuffledGrid( 24 ), b = MakeShuffledGrid( 24 );
+		std::vector< uint32_t > remapA, remapB;
+		Optimise( a, remapA );
+		Optimise( b, remapB );
+		CHECK( a.indices == b.indices );
+		CHECK( remapA == remapB );
+		CHECK( a.positions == b.positions );
+	}
+
+	void TestVertexCache()
+	{
+		for ( uint32_t size : { 1u, 4u, 16u, 64u } )
+		{
+			for ( bool bShuffled : { false, true } )
+			{
+				Grid grid = bShuffled ? MakeShuffledGrid( size ) : MakeGrid( size );
+				const auto triangles = CanonicalTriangles( grid.indices );
+				const MeshOptimiser::VertexCacheStats before = MeshOptimiser::AnalyseVertexCache( grid.indices.data(), IndexCount( grid ), VertexCount( grid ) );
+				MeshOptimiser::OptimiseVertexCache( grid.indices.data(), IndexCount( grid ), VertexCount( grid ) );
+				const MeshOptimiser::VertexCacheStats after = MeshOptimiser::AnalyseVertexCache( grid.indices.data(), IndexCount( grid ), VertexCount( grid ) );
+
+				CHECK( after.acmr <= before.acmr );
+				CHECK( after.misses >= VertexCount( grid ) ); // every vertex is transformed at least once
+				CHECK( CanonicalTriangles( grid.indices ) == triangles );
+				if ( bShuffled && size >= 16 ) CHECK( after.acmr < 0.8f * before.acmr );
+			}
+		}
+
+		// Overdraw reordering keeps every triangle and stays within its threshold of the cache order's ACMR.
+		Grid grid = MakeShuffledGrid( 32 );
+		const auto triangles = CanonicalTriangles( grid.indices );
+		MeshOptimiser::OptimiseVertexCache( grid.indices.data(), IndexCount( grid ), VertexCount( grid ) );
+		const float cacheAcmr = MeshOptimiser::AnalyseVertexCache( grid.indices.data(), IndexCount( grid ), VertexCount( grid ) ).acmr;
+		MeshOptimiser::OptimiseOverdraw( grid.indices.data(), IndexCount( grid ), &grid.positions[ 0 ].x, VertexCount( grid ), sizeof( Float3 ), 1.05f );
+		CHECK( CanonicalTriangles( grid.indices ) == triangles );
+		CHECK( MeshOptimiser::AnalyseVertexCache( grid.indices.data(), IndexCount( grid ), VertexCount( grid ) ).acmr <= cacheAcmr * 1.05f + 1e-4f );
+	}
+
+	void TestVertexFetchRoundTrip()
+	{
+		// Vertices nothing uses go to the end.
+		Grid grid = MakeShuffledGrid( 12 );
+		const uint32_t usedCount = VertexCount( grid );
+		grid.positions.push_back( { -1.f, -1.f, -1.f } );
+		grid.positions.push_back( { -2.f, -2.f, -2.f } );
+		const Grid original = grid;
+
+		std::vector< uint32_t > remap;
+		const uint32_t used = MeshOptimiser::OptimiseVertexFetch( grid.indices.data(), IndexCount( grid ), VertexCount( grid ), remap );
+		CHECK( used == usedCount );
+		CHECK( remap.size() == original.positions.size() );
+		MeshOptimiser::RemapVertexStream( grid.positions, remap );
+
+		// Every corner of every triangle is the vertex it was before.
+		bool bSameTriangles = true;
+		for ( uint32_t i = 0; i < IndexCount( grid ); i++ )
+		{
+			bSameTriangles &= grid.positions[ grid.indices[ i ] ] == original.positions[ original.indices[ i ] ];
+		}
+		CHECK( bSameTriangles );
+		CHECK( grid.positions[ usedCount ] == original.positions[ usedCount ] && grid.positions[ usedCount + 1 ] == original.positions[ usedCount + 1 ] );
+
+		// The remap is a permutation and the indices number vertices in the order they are first used.
+		std::vector< uint32_t > sorted = remap;
+		std::sort( sorted.begin(), sorted.end() );
+		bool bPermutation = true;
+		for ( uint32_t i = 0; i < sorted.size(); i++ ) bPermutation &= sorted[ i ] == i;
+		CHECK( bPermutation );
+
+		uint32_t next = 0;
+		bool bFirstUseOrder = true;
+		for ( uint32_t index : grid.indices )
+		{
+			bFirstUseOrder &= index <= next;
+			if ( index == next ) next++;
+		}
+		CHECK( bFirstUseOrder && next == usedCount );
+
+		// A stream that does not match the remap is left alone.
+		std::vector< Float3 > shortStream( original.positions.begin(), original.positions.begin() + 3 );
+		MeshOptimiser::RemapVertexStream( shortStream, remap );
+		CHECK( std::equal( shortStream.begin(), shortStream.end(), original.positions.begin() ) );
+	}
+}
+
+int main()
+{
+	TestDeterministic();
+	TestVertexCache();
+	TestVertexFetchRoundTrip();
+	return ReportChecks( "MeshOptimiserTest" );
+}
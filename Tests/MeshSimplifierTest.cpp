@@ -0,0 +1,172 @@
+///////////////////////////////////////////////////////////////////////////
+//	File		: MeshSimplifierTest.cpp
+//	Platform	: All
+//
+//	Simplifies a UV sphere, split along its seam as exported meshes are, into
+//	the LOD chain the game and the MeshCooker build, and checks the chain
+//	shrinks, stops at the error asked for and never opens the seam.
+//	Builds without Play3d from the repository root, on Linux:
+//		g++ -std=c++20 -O2 -o MeshSimplifierTest Tests/MeshSimplifierTest.cpp Project/Utilities/MeshSimplifier.cpp
+//
+//	Copyright (C) Sumo Digital Ltd. All rights reserved.
+///////////////////////////////////////////////////////////////////////////
+
+#include "../Project/Utilities/MeshSimplifier.h"
+#include "Check.h"
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace
+{
+	struct Vertex
+	{
+		float x, y, z;
+		float u, v;
+	};
+
+	// Rings of segments + 1 vertices, the first and last of a ring share a position but not a u.
+	void BuildSphere( uint32_t segments, uint32_t rings, std::vector< Vertex >& vertices, std::vector< uint32_t >& indices )
+	{
+		const float pi = 3.14159265358979f;
+		for ( uint32_t ring = 0; ring <= rings; ring++ )
+		{
+			const float v = float( ring ) / float( rings );
+			for ( uint32_t segment = 0; segment <= segments; segment++ )
+			{
+				const float u = float( segment ) / float( segments );
+				const float theta = ( segment == segments ? 0.f : u ) * 2.f * pi;
+				const float radius = ring == 0 || ring == rings ? 0.f : std::sin( v * pi ); // the poles are one point
+				vertices.push_back( { radius * std::cos( theta ), std::cos( v * pi ), radius * std::sin( theta ), u, v } );
+			}
+		}
+
+		for ( uint32_t ring = 0; ring < rings; ring++ )
+		{
+			for ( uint32_t segment = 0; segment < segments; segment++ )
+			{
+				const uint32_t a = ring * ( segments + 1 ) + segment, b = a + 1, c = a + segments + 1, d = c + 1;
+				if ( ring != 0 ) indices.insert( indices.end(), { a, b, c } );
+				if ( ring != rings - 1 ) indices.insert( indices.end(), { b, d, c } );
+			}
+		}
+	}
+
+	// Vertices at one position count as one, as they do in the simplifier.
+	uint32_t PositionId( const std::vector< Vertex >& vertices, uint32_t index, std::map< std::pair< float, std::pair< float, float > >, uint32_t >& ids )
+	{
+		const Vertex& vertex = vertices[ index ];
+		return ids.emplace( std::make_pair( vertex.x, std::make_pair( vertex.y, vertex.z ) ), static_cast< uint32_t >(ids.size()) ).first->second;
+	}
+
+	// Every edge of a closed surface has a triangle on each side. A seam that came apart leaves edges with one.
+	bool IsClosed( const std::vector< Vertex >& vertices, const uint32_t* pIndices, uint32_t indexCount )
+	{
+		std::map< std::pair< float, std::pair< float, float > >, uint32_t > ids;
+		std::map< std::pair< uint32_t, uint32_t >, int > edges;
+		for ( uint32_t i = 0; i < indexCount; i += 3 )
+		{
+			for ( uint32_t corner = 0; corner < 3; corner++ )
+			{
+				const uint32_t from = PositionId( vertices, pIndices[ i + corner ], ids );
+				const uint32_t to = PositionId( vertices, pIndices[ i + ( corner + 1 ) % 3 ], ids );
+				edges[ { std::min( from, to ), std::max( from, to ) } ] += from < to ? 1 : -1;
+			}
+		}
+		for ( const auto& edge : edges )
+		{
+			if ( edge.second != 0 ) return false;
+		}
+		return true;
+	}
+
+	// A triangle using vertices from both sides of the seam would stretch the texture across the whole sphere.
+	bool KeepsSeam( const std::vector< Vertex >& vertices, const uint32_t* pIndices, uint32_t indexCount )
+	{
+		for ( uint32_t i = 0; i < indexCount; i += 3 )
+		{
+			const float u0 = vertices[ pIndices[ i ] ].u, u1 = vertices[ pIndices[ i + 1 ] ].u, u2 = vertices[ pIndices[ i + 2 ] ].u;
+			if ( std::max( { u0, u1, u2 } ) - std::min( { u0, u1, u2 } ) > 0.5f ) return false;
+		}
+		return true;
+	}
+
+	void TestLodChain()
+	{
+		std::vector< Vertex > vertices;
+		std::vector< uint32_t > indices;
+		BuildSphere( 128, 64, vertices, indices );
+		const uint32_t vertexCount = static_cast< uint32_t >(vertices.size());
+		const uint32_t indexCount = static_cast< uint32_t >(indices.size());
+		CHECK( IsClosed( vertices, indices.data(), indexCount ) );
+
+		std::vector< uint32_t > chain;
+		std::vector< MeshSimplifier::LodRange > lods;
+		MeshSimplifier::BuildLodChain( &vertices[ 0 ].x, vertexCount, sizeof( Vertex ), indices.data(), indexCount,
+			MeshSimplifier::kLodRatios, static_cast< uint32_t >(std::size( MeshSimplifier::kLodRatios )), chain, lods );
+
+		CHECK( lods.size() == std::size( MeshSimplifier::kLodRatios ) + 1 );
+		CHECK( lods[ 0 ].indexOffset == 0 && lods[ 0 ].indexCount == indexCount && lods[ 0 ].error == 0.f );
+		for ( size_t i = 0; i < lods.size(); i++ )
+		{
+			const MeshSimplifier::LodRange& lod = lods[ i ];
+			std::printf( "LOD %zu: %u indices, error %g\n", i, lod.indexCount, lod.error );
+			CHECK( lod.indexCount % 3 == 0 );
+			if ( i > 0 )
+			{
+				// Each LOD follows the last in the chained buffer, has fewer triangles and cost at least as much.
+				CHECK( lod.indexOffset == lods[ i - 1 ].indexOffset + lods[ i - 1 ].indexCount );
+				CHECK( lod.indexCount < lods[ i - 1 ].indexCount );
+				CHECK( lod.indexCount <= static_cast< uint32_t >(indexCount * MeshSimplifier::kLodRatios[ i - 1 ]) + 3 );
+				CHECK( lod.error >= lods[ i - 1 ].error );
+			}
+
+			const uint32_t* pIndices = chain.data() + lod.indexOffset;
+			bool bInRange = true;
+			for ( uint32_t j = 0; j < lod.indexCount; j++ ) bInRange &= pIndices[ j ] < vertexCount;
+			CHECK( bInRange );
+			CHECK( IsClosed( vertices, pIndices, lod.indexCount ) );
+			CHECK( KeepsSeam( vertices, pIndices, lod.indexCount ) );
+		}
+		CHECK( chain.size() == lods.back().indexOffset + lods.back().indexCount );
+	}
+
+	void TestErrorBound()
+	{
+		std::vector< Vertex > vertices;
+		std::vector< uint32_t > indices;
+		BuildSphere( 64, 32, vertices, indices );
+		const uint32_t vertexCount = static_cast< uint32_t >(vertices.size());
+		const uint32_t indexCount = static_cast< uint32_t >(indices.size());
+
+		// Unbounded, the simplifier gets down to the target, and that costs some error.
+		std::vector< uint32_t > simplified;
+		const uint32_t target = indexCount / 20 / 3 * 3;
+		const float error = MeshSimplifier::Simplify( &vertices[ 0 ].x, vertexCount, sizeof( Vertex ), indices.data(), indexCount, target, simplified );
+		CHECK( simplified.size() <= target + 3 );
+		CHECK( error > 0.f );
+
+		// Allowed a tenth of that, it stops early with more triangles, and never goes past the bound.
+		const float maxError = error * 0.1f;
+		std::vector< uint32_t > bounded;
+		const float boundedError = MeshSimplifier::Simplify( &vertices[ 0 ].x, vertexCount, sizeof( Vertex ), indices.data(), indexCount, target, bounded, maxError );
+		CHECK( boundedError <= maxError );
+		CHECK( bounded.size() > simplified.size() && bounded.size() < indexCount );
+		CHECK( IsClosed( vertices, bounded.data(), static_cast< uint32_t >(bounded.size()) ) );
+
+		// Nothing can be removed at no cost from a curved surface.
+		std::vector< uint32_t > untouched;
+		MeshSimplifier::Simplify( &vertices[ 0 ].x, vertexCount, sizeof( Vertex ), indices.data(), indexCount, target, untouched, 0.f );
+		CHECK( untouched.size() == indexCount );
+	}
+}
+
+int main()
+{
+	TestLodChain();
+	TestErrorBound();
+	return ReportChecks( "MeshSimplifierTest" );
+}
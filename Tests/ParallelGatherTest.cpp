@@ -0,0 +1,136 @@
+///////////////////////////////////////////////////////////////////////////
+//	File		: ParallelGatherTest.cpp
+//	Platform	: All
+//
+//	Gathers a scene of stand-in objects with ParallelGather, as
+//	GameObjectManager::Render does, and checks the merged command stream is
+//	the one a serial gather gives, on the JobManager and on a stand-in that
+//	runs the chunks on their own threads, last chunk first.
+//	Builds without Play3d from the repository root, on Linux:
+//		g++ -std=c++20 -O2 -pthread -I Tests/Stubs -o ParallelGatherTest Tests/ParallelGatherTest.cpp Project/Utilities/JobManager.cpp
+//
+//	Copyright (C) Sumo Digital Ltd. All rights reserved.
+///////////////////////////////////////////////////////////////////////////
+
+#include "GameMath.h"
+#include "../Project/Utilities/JobManager.h"
+#include "../Project/Utilities/ParallelGather.h"
+#include "Check.h"
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	struct Command
+	{
+		u32 object;
+		u32 index;
+		u32 lodView;
+
+		bool operator==( const Command& other ) const = default;
+	};
+
+	// Records commands in order, as RenderContext does, with a number standing in for the LodView.
+	class StandInContext
+	{
+	public:
+		void BeginFrame() { commands.clear(); }
+		void SetLodView( u32 view ) { lodView = view; }
+		u32 GetLodView() const { return lodView; }
+		void EnableAxes( bool bEnabled ) { bAxes = bEnabled; }
+		bool WantsAxes() const { return bAxes; }
+		void Add( u32 object, u32 index ) { commands.push_back( { object, index, lodView } ); }
+		void AppendCommands( const StandInContext& other ) { commands.insert( commands.end(), other.commands.begin(), other.commands.end() ); }
+
+		std::vector< Command > commands;
+		u32 lodView = 0;
+		bool bAxes = false;
+	};
+
+	// Objects record different numbers of commands, some none, as hidden or dead ones do, and an axis when wanted.
+	class StandInObject
+	{
+	public:
+		static constexpr u32 kAxisIndex = ~0u;
+
+		explicit StandInObject( u32 id ) : m_id( id ) {}
+
+		void Render( StandInContext& ctx ) const
+		{
+			for ( u32 i = 0; i < ( m_id * 7 ) % 4; i++ ) ctx.Add( m_id, i );
+			if ( ctx.WantsAxes() ) ctx.Add( m_id, kAxisIndex );
+		}
+
+	private:
+		u32 m_id;
+	};
+
+	// Runs every chunk on a thread of its own, started last chunk first, so chunks finish in any order.
+	class StandInJobs
+	{
+	public:
+		void ParallelFor( u32 count, const std::function< void( u32 ) >& task )
+		{
+			std::vector< std::thread > threads;
+			for ( u32 i = count; i > 0; i-- ) threads.emplace_back( task, i - 1 );
+			for ( std::thread& thread : threads ) thread.join();
+		}
+	};
+
+	std::vector< Command > GatherSerially( const std::vector< StandInObject* >& objects, u32 lodView, bool bAxes = false )
+	{
+		StandInContext ctx;
+		ctx.SetLodView( lodView );
+		ctx.EnableAxes( bAxes );
+		for ( const StandInObject* pObject : objects ) pObject->Render( ctx );
+		return ctx.commands;
+	}
+
+	template< typename Jobs >
+	void TestGather( Jobs& jobs )
+	{
+		// Fewer objects than a chunk, a chunk exactly, one over, and scenes of many chunks.
+		std::vector< StandInContext > chunkContexts;
+		for ( u32 objectCount : { 0u, 1u, 63u, 64u, 65u, 1000u, 4097u } )
+		{
+			std::vector< StandInObject > scene;
+			for ( u32 i = 0; i < objectCount; i++ ) scene.emplace_back( i );
+			std::vector< StandInObject* > objects;
+			for ( StandInObject& object : scene ) objects.push_back( &object );
+
+			// Each frame reuses the chunk contexts of the last, as GameObjectManager does. Axes are only wanted in the middle one.
+			for ( u32 frame = 0; frame < 3; frame++ )
+			{
+				StandInContext ctx;
+				ctx.SetLodView( frame + 1 );
+				ctx.EnableAxes( frame == 1 );
+				ParallelGather( jobs, objects, 64, chunkContexts, ctx );
+				CHECK( ctx.commands == GatherSerially( objects, frame + 1, frame == 1 ) );
+			}
+		}
+
+		// Shrinking the scene leaves spare chunk contexts, which must not be merged again.
+		std::vector< StandInObject > scene = { StandInObject( 1 ), StandInObject( 2 ) };
+		std::vector< StandInObject* > objects = { &scene[ 0 ], &scene[ 1 ] };
+		StandInContext ctx;
+		ParallelGather( jobs, objects, 64, chunkContexts, ctx );
+		CHECK( chunkContexts.size() > 1 );
+		CHECK( ctx.commands == GatherSerially( objects, 0 ) );
+	}
+}
+
+int main()
+{
+	// The JobManager has as many workers as this machine has cores to spare, perhaps none.
+	JobManager::Initialise();
+	std::printf( "JobManager with %u workers\n", JobManager::Instance().GetWorkerCount() );
+	TestGather( JobManager::Instance() );
+	JobManager::Instance().SetWorkerCount( 0 );
+	TestGather( JobManager::Instance() );
+	JobManager::Destroy();
+
+	StandInJobs jobs;
+	TestGather( jobs );
+	return ReportChecks( "ParallelGatherTest" );
+}
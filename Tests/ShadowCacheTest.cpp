@@ -0,0 +1,132 @@
+///////////////////////////////////////////////////////////////////////////
+//	File		: ShadowCacheTest.cpp
+//	Platform	: All
+//
+//	Checks when ShadowCache asks for a static shadow layer to be drawn
+//	again, and that the caster hash fed to it ignores the order of the pass.
+//	Builds without Play3d from the repository root, on Linux:
+//		g++ -std=c++20 -O2 -I Tests/Stubs -o ShadowCacheTest Tests/ShadowCacheTest.cpp Project/Utilities/ShadowCache.cpp
+//
+//	Copyright (C) Sumo Digital Ltd. All rights reserved.
+///////////////////////////////////////////////////////////////////////////
+
+#include "GameMath.h"
+#include "../Project/Utilities/ShadowCache.h"
+#include "../Project/Utilities/UnorderedHash.h"
+#include "Check.h"
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace
+{
+	struct Caster
+	{
+		u32 meshId;
+		u32 materialId;
+		Matrix4x4f world;
+	};
+
+	// As RenderContext::HashPassView hashes the commands of a pass.
+	u64 HashCasters( const std::vector< Caster >& casters )
+	{
+		UnorderedHash hash;
+		for ( const Caster& caster : casters )
+		{
+			u8 data[ 2 * sizeof( u32 ) + sizeof( Matrix4x4f ) ];
+			u32 ids[ 2 ] = { caster.meshId, caster.materialId };
+			std::memcpy( data, ids, sizeof( ids ) );
+			std::memcpy( data + sizeof( ids ), &caster.world, sizeof( Matrix4x4f ) );
+			hash.Add( data, sizeof( data ) );
+		}
+		return hash.Get();
+	}
+
+	Vector3f RotateAboutY( const Vector3f& v, f32 degrees )
+	{
+		const f32 c = std::cos( degrees * kfPi180 ), s = std::sin( degrees * kfPi180 );
+		return Vector3f( v.x * c + v.z * s, v.y, v.z * c - v.x * s );
+	}
+
+	void TestNeedsRefresh()
+	{
+		ShadowCache cache;
+		const Vector3f direction( 0.8f, 0.f, 0.6f ); // at right angles to Y, so RotateAboutY turns it by the whole angle
+		const u64 hash = 1234;
+		CHECK( cache.NeedsRefresh( 0, direction, hash ) );
+
+		cache.Store( 0, direction, Matrix4x4f(), Matrix4x4f(), hash );
+		CHECK( !cache.NeedsRefresh( 0, direction, hash ) );
+		CHECK( cache.GetRefreshCount() == 1 );
+		CHECK( cache.NeedsRefresh( 1, direction, hash ) ); // other slices are untouched
+
+		// Only the angle counts, not the length of the direction.
+		CHECK( !cache.NeedsRefresh( 0, Vector3f( 1.6f, 0.f, 1.2f ), hash ) );
+		CHECK( !cache.NeedsRefresh( 0, RotateAboutY( direction, 0.3f ), hash ) );
+		CHECK( cache.NeedsRefresh( 0, RotateAboutY( direction, 1.f ), hash ) );
+		CHECK( cache.NeedsRefresh( 0, Vector3f( 0.f ), hash ) );
+
+		CHECK( cache.NeedsRefresh( 0, direction, hash + 1 ) );
+
+		cache.Invalidate( 0 );
+		CHECK( cache.NeedsRefresh( 0, direction, hash ) );
+
+		cache.Store( 0, direction, Matrix4x4f(), Matrix4x4f(), hash );
+		cache.Store( 1, direction, Matrix4x4f(), Matrix4x4f(), hash );
+		cache.InvalidateAll();
+		CHECK( cache.NeedsRefresh( 0, direction, hash ) && cache.NeedsRefresh( 1, direction, hash ) );
+	}
+
+	void TestCasterHash()
+	{
+		// Several casters sharing a mesh, which a pass sorts by distance from the camera.
+		std::mt19937 random( 7 );
+		std::uniform_real_distribution< f32 > position( -10.f, 10.f );
+		std::vector< Caster > casters;
+		for ( u32 i = 0; i < 40; i++ )
+		{
+			Caster caster = { 3 + i % 3, 9, {} };
+			caster.world.m[ 0 ] = caster.world.m[ 5 ] = caster.world.m[ 10 ] = caster.world.m[ 15 ] = 1.f;
+			caster.world.m[ 12 ] = position( random );
+			caster.world.m[ 13 ] = position( random );
+			caster.world.m[ 14 ] = position( random );
+			casters.push_back( caster );
+		}
+		const u64 hash = HashCasters( casters );
+
+		std::vector< Caster > reordered = casters;
+		for ( int i = 0; i < 10; i++ )
+		{
+			std::shuffle( reordered.begin(), reordered.end(), random );
+			CHECK( HashCasters( reordered ) == hash );
+		}
+
+		std::vector< Caster > changed = casters;
+		changed[ 17 ].world.m[ 13 ] += 0.001f;
+		CHECK( HashCasters( changed ) != hash );
+		changed = casters;
+		changed[ 17 ].materialId++;
+		CHECK( HashCasters( changed ) != hash );
+		changed = casters;
+		changed.pop_back();
+		CHECK( HashCasters( changed ) != hash );
+
+		// A caster twice is not the same as once, and two swapped meshes are not the same set.
+		changed = casters;
+		changed.push_back( casters[ 0 ] );
+		CHECK( HashCasters( changed ) != hash );
+		changed = casters;
+		std::swap( changed[ 0 ].meshId, changed[ 1 ].meshId );
+		CHECK( casters[ 0 ].meshId == casters[ 1 ].meshId || HashCasters( changed ) != hash );
+
+		CHECK( HashCasters( {} ) != HashCasters( { casters[ 0 ] } ) );
+	}
+}
+
+int main()
+{
+	TestNeedsRefresh();
+	TestCasterHash();
+	return ReportChecks( "ShadowCacheTest" );
+}
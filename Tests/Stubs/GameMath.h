@@ -0,0 +1,51 @@
+#pragma once
+// Stands in for Project/GameMath.h in the tests. Has just the Play3d maths the tested game code uses, so it builds
+// without Play3d.
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+using u8 = uint8_t;
+using u16 = uint16_t;
+using u32 = uint32_t;
+using u64 = uint64_t;
+using f32 = float;
+
+struct Vector3f
+{
+	f32 x, y, z;
+	Vector3f( f32 v = 0.f ) : x( v ), y( v ), z( v ) {}
+	Vector3f( f32 x_, f32 y_, f32 z_ ) : x( x_ ), y( y_ ), z( z_ ) {}
+};
+
+inline f32 dot( const Vector3f& a, const Vector3f& b ) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+inline f32 length( const Vector3f& v ) { return std::sqrt( dot( v, v ) ); }
+
+struct Matrix4x4f
+{
+	f32 m[ 16 ] = {};
+};
+
+constexpr f32 kfPi180 = 3.14159265358979f / 180.0f;
+constexpr u32 kNumLights = 4;
+using std::cos;
+
+// As in Play3d.h, for the game's singletons.
+#define PLAY_SINGLETON_INTERFACE( classname )               \
+public:                                                     \
+	static classname& Instance() { return *ms_pInstance; }  \
+	static void Initialise()                                \
+	{                                                       \
+		if ( !ms_pInstance ) ms_pInstance = new classname;  \
+	}                                                       \
+	static void Destroy()                                   \
+	{                                                       \
+		delete ms_pInstance;                                \
+		ms_pInstance = nullptr;                             \
+	}                                                       \
+                                                            \
+private:                                                    \
+	static classname* ms_pInstance;
+
+#define PLAY_SINGLETON_IMPL( classname ) classname* classname::ms_pInstance = nullptr;
@@ -0,0 +1,2 @@
+#pragma once
+// Stands in for Project/Types.h in the tests, the types they need are in the GameMath.h stub.
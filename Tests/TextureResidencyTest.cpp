@@ -0,0 +1,270 @@
+///////////////////////////////////////////////////////////////////////////
+//	File		: TextureResidencyTest.cpp
+//	Platform	: All
+//
+//	Runs the mip streaming policy against a stand-in backend that records
+//	what it is asked to load and evict, and checks loads stay within the
+//	budget, the least recently used textures are evicted first, a lowered
+//	budget is met on the next update and failed loads back off and give up.
+//	Builds without Play3d from the repository root, on Linux:
+//		g++ -std=c++20 -O2 -o TextureResidencyTest Tests/TextureResidencyTest.cpp Project/Utilities/TextureResidency.cpp
+//
+//	Copyright (C) Sumo Digital Ltd. All rights reserved.
+///////////////////////////////////////////////////////////////////////////
+
+#include "../Project/Utilities/TextureResidency.h"
+#include "Check.h"
+#include <vector>
+
+namespace
+{
+	// Loads complete when the test says so, as the IO service's do a few frames later.
+	class StandInBackend : public TextureResidency::Backend
+	{
+	public:
+		struct Load
+		{
+			uint32_t handle, firstMip, residentMip;
+		};
+
+		struct Eviction
+		{
+			uint32_t handle, firstMip;
+		};
+
+		void LoadMips( uint32_t handle, uint32_t firstMip, uint32_t residentMip ) override
+		{
+			loads.push_back( { handle, firstMip, residentMip } );
+			if ( bCompleteAtOnce ) pResidency->OnLoadComplete( handle, true );
+			else inFlight.push_back( handle );
+		}
+
+		void EvictMips( uint32_t handle, uint32_t firstMip ) override { evictions.push_back( { handle, firstMip } ); }
+
+		void CompleteLoads( bool bSuccess = true )
+		{
+			std::vector< uint32_t > handles;
+			handles.swap( inFlight );
+			for ( uint32_t handle : handles ) pResidency->OnLoadComplete( handle, bSuccess );
+		}
+
+		TextureResidency* pResidency = nullptr;
+		bool bCompleteAtOnce = false;
+		std::vector< Load > loads;
+		std::vector< Eviction > evictions;
+		std::vector< uint32_t > inFlight;
+	};
+
+	// A 1024 texel square texture at a byte per texel, its 64 texel mip and below always resident.
+	constexpr uint32_t kWidth = 1024;
+	constexpr uint32_t kMipCount = 11;
+	constexpr uint32_t kFloorMip = 4;
+
+	uint64_t MipBytes( uint32_t mip ) { return uint64_t( kWidth >> mip ) * ( kWidth >> mip ); }
+
+	uint64_t BytesFrom( uint32_t mip )
+	{
+		uint64_t bytes = 0;
+		for ( ; mip < kMipCount; mip++ ) bytes += MipBytes( mip );
+		return bytes;
+	}
+
+	uint32_t AddTexture( TextureResidency& residency )
+	{
+		uint64_t mipBytes[ kMipCount ];
+		for ( uint32_t mip = 0; mip < kMipCount; mip++ ) mipBytes[ mip ] = MipBytes( mip );
+		return residency.AddTexture( kWidth, mipBytes, kMipCount, kFloorMip );
+	}
+
+	uint64_t UsedBytes( const TextureResidency& residency )
+	{
+		return residency.GetStats().residentBytes + residency.GetStats().pendingBytes;
+	}
+
+	void TestBudgetLimitsLoads()
+	{
+		// Room for the tails, one whole texture and a little more.
+		const uint64_t tail = BytesFrom( kFloorMip );
+		const uint64_t budget = 3 * tail + BytesFrom( 0 ) - tail + 300000;
+		StandInBackend backend;
+		TextureResidency residency( backend, budget );
+		backend.pResidency = &residency;
+		const uint32_t textures[] = { AddTexture( residency ), AddTexture( residency ), AddTexture( residency ) };
+		CHECK( residency.GetStats().residentBytes == 3 * tail );
+
+		// Every texture wants its top mip. The first gets it, the others what is left, all within the budget.
+		for ( uint32_t texture : textures ) residency.Request( texture, float( kWidth ) );
+		residency.Update();
+		CHECK( backend.loads.size() == 3 );
+		CHECK( UsedBytes( residency ) <= budget );
+		CHECK( backend.loads[ 0 ].handle == textures[ 0 ] && backend.loads[ 0 ].firstMip == 0 && backend.loads[ 0 ].residentMip == kFloorMip );
+		CHECK( backend.loads[ 1 ].firstMip > 0 && backend.loads[ 2 ].firstMip > 0 );
+		CHECK( residency.IsLoading( textures[ 0 ] ) && residency.GetResidentMip( textures[ 0 ] ) == kFloorMip );
+
+		backend.CompleteLoads();
+		CHECK( residency.GetResidentMip( textures[ 0 ] ) == 0 && !residency.IsLoading( textures[ 0 ] ) );
+		CHECK( residency.GetStats().pendingBytes == 0 && residency.GetStats().loadsInFlight == 0 );
+
+		// Still wanted, the other two wait for room rather than evict each other.
+		const size_t loadCount = backend.loads.size();
+		for ( uint32_t texture : textures ) residency.Request( texture, float( kWidth ) );
+		residency.Update();
+		CHECK( backend.loads.size() == loadCount );
+		CHECK( backend.evictions.empty() );
+		CHECK( residency.GetStats().waiting == 2 );
+		CHECK( residency.GetStats().residentBytes <= budget );
+
+		// Asking for less than the width picks the mip that still covers it.
+		residency.Request( textures[ 0 ], 200.f );
+		residency.Update();
+		CHECK( residency.GetWantedMip( textures[ 0 ] ) == 2 );
+	}
+
+	void TestLoadsInFlight()
+	{
+		StandInBackend backend;
+		TextureResidency residency( backend, ~0ull );
+		backend.pResidency = &residency;
+		std::vector< uint32_t > textures;
+		for ( uint32_t i = 0; i < TextureResidency::kMaxLoadsInFlight + 2; i++ ) textures.push_back( AddTexture( residency ) );
+
+		for ( uint32_t texture : textures ) residency.Request( texture, float( kWidth ) );
+		residency.Update();
+		CHECK( backend.loads.size() == TextureResidency::kMaxLoadsInFlight );
+		CHECK( residency.GetStats().waiting == 2 );
+
+		// A failed load leaves the texture as it was, and it is tried again.
+		backend.CompleteLoads( false );
+		CHECK( residency.GetResidentMip( textures[ 0 ] ) == kFloorMip );
+		CHECK( residency.GetStats().pendingBytes == 0 && residency.GetStats().residentBytes == textures.size() * BytesFrom( kFloorMip ) );
+		for ( uint32_t texture : textures ) residency.Request( texture, float( kWidth ) );
+		residency.Update();
+		CHECK( backend.loads.size() == 2 * TextureResidency::kMaxLoadsInFlight );
+
+		// A backend may finish a load inside LoadMips.
+		backend.CompleteLoads();
+		backend.bCompleteAtOnce = true;
+		for ( uint32_t texture : textures ) residency.Request( texture, float( kWidth ) );
+		residency.Update();
+		for ( uint32_t texture : textures ) CHECK( residency.GetResidentMip( texture ) == 0 );
+		CHECK( residency.GetStats().loadsInFlight == 0 && residency.GetStats().residentBytes == textures.size() * BytesFrom( 0 ) );
+	}
+
+	void TestFailedLoads()
+	{
+		StandInBackend backend;
+		TextureResidency residency( backend, ~0ull );
+		backend.pResidency = &residency;
+		const uint32_t broken = AddTexture( residency ), flaky = AddTexture( residency ), other = AddTexture( residency );
+
+		// Still wanted every frame, the broken texture is tried again after 1, 2 and 4 frames, then given up on.
+		std::vector< uint32_t > tries;
+		for ( uint32_t frame = 1; frame <= 32; frame++ )
+		{
+			residency.Request( broken, float( kWidth ) );
+			residency.Update();
+			if ( residency.IsLoading( broken ) ) tries.push_back( frame );
+			backend.CompleteLoads( false );
+		}
+		CHECK( tries == std::vector< uint32_t >( { 1, 2, 4, 8 } ) );
+		CHECK( tries.size() == TextureResidency::kMaxFailedLoads );
+		CHECK( residency.IsFailed( broken ) && residency.GetResidentMip( broken ) == kFloorMip );
+		CHECK( residency.GetStats().failed == 1 && residency.GetStats().waiting == 0 && residency.GetStats().loadsInFlight == 0 );
+
+		// A load that gets through on the last try before the limit leaves the texture loaded, not failed.
+		uint32_t flakyTries = 0;
+		for ( uint32_t frame = 0; frame < 8 && !residency.IsFailed( flaky ); frame++ )
+		{
+			residency.Request( flaky, float( kWidth ) );
+			residency.Update();
+			if ( residency.IsLoading( flaky ) ) flakyTries++;
+			backend.CompleteLoads( flakyTries == TextureResidency::kMaxFailedLoads );
+		}
+		CHECK( !residency.IsFailed( flaky ) && residency.GetResidentMip( flaky ) == 0 );
+
+		// The given up texture holds no load slot, the others still load.
+		residency.Request( broken, float( kWidth ) );
+		residency.Request( other, float( kWidth ) );
+		residency.Update();
+		CHECK( !residency.IsLoading( broken ) && residency.IsLoading( other ) );
+		backend.CompleteLoads();
+		CHECK( residency.GetResidentMip( other ) == 0 && residency.GetStats().failed == 1 );
+	}
+
+	void TestLeastRecentlyUsedEviction()
+	{
+		// Room for two whole textures, the third has to push one out.
+		const uint64_t tail = BytesFrom( kFloorMip );
+		const uint64_t budget = 3 * tail + 2 * ( BytesFrom( 0 ) - tail );
+		StandInBackend backend;
+		TextureResidency residency( backend, budget );
+		backend.pResidency = &residency;
+		backend.bCompleteAtOnce = true;
+		const uint32_t a = AddTexture( residency ), b = AddTexture( residency ), c = AddTexture( residency );
+
+		residency.Request( a, float( kWidth ) );
+		residency.Request( b, float( kWidth ) );
+		residency.Update();
+		CHECK( residency.GetResidentMip( a ) == 0 && residency.GetResidentMip( b ) == 0 );
+
+		// b is seen a frame after a, then neither is, so their mips stay until something needs the room.
+		residency.Request( b, float( kWidth ) );
+		residency.Update();
+		residency.Update();
+		CHECK( residency.GetResidentMip( a ) == 0 && residency.GetResidentMip( b ) == 0 );
+		CHECK( backend.evictions.empty() );
+
+		residency.Request( c, float( kWidth ) );
+		residency.Update();
+		CHECK( residency.GetResidentMip( c ) == 0 );
+		CHECK( !backend.evictions.empty() && backend.evictions[ 0 ].handle == a );
+		CHECK( residency.GetResidentMip( a ) == kFloorMip );
+		CHECK( residency.GetResidentMip( b ) == 0 );
+		CHECK( residency.GetStats().residentBytes <= budget );
+	}
+
+	void TestShrinkingBudget()
+	{
+		const uint64_t tail = BytesFrom( kFloorMip );
+		StandInBackend backend;
+		TextureResidency residency( backend, ~0ull );
+		backend.pResidency = &residency;
+		backend.bCompleteAtOnce = true;
+		const uint32_t a = AddTexture( residency ), b = AddTexture( residency ), c = AddTexture( residency );
+		for ( uint32_t texture : { a, b, c } ) residency.Request( texture, float( kWidth ) );
+		residency.Update();
+		CHECK( residency.GetStats().residentBytes == 3 * BytesFrom( 0 ) );
+
+		// Lowered to a whole texture and the tails, with only c still on screen: a and b give up their mips.
+		const uint64_t budget = BytesFrom( 0 ) + 2 * tail;
+		residency.SetBudget( budget );
+		residency.Request( c, float( kWidth ) );
+		residency.Update();
+		CHECK( residency.GetStats().residentBytes <= budget );
+		CHECK( residency.GetResidentMip( c ) == 0 );
+		CHECK( residency.GetResidentMip( a ) > 0 && residency.GetResidentMip( b ) > 0 );
+		CHECK( backend.evictions.size() == 2 );
+
+		// Lowered below what is on screen, mips in use are kept rather than dropped and loaded again each frame.
+		residency.SetBudget( 3 * tail );
+		residency.Request( c, float( kWidth ) );
+		residency.Update();
+		CHECK( residency.GetResidentMip( c ) == 0 );
+		CHECK( residency.GetResidentMip( a ) == kFloorMip && residency.GetResidentMip( b ) == kFloorMip );
+
+		// Once off screen it goes too.
+		residency.Update();
+		CHECK( residency.GetResidentMip( c ) == kFloorMip );
+		CHECK( residency.GetStats().residentBytes == 3 * tail );
+	}
+}
+
+int main()
+{
+	TestBudgetLimitsLoads();
+	TestLoadsInFlight();
+	TestFailedLoads();
+	TestLeastRecentlyUsedEviction();
+	TestShrinkingBudget();
+	return ReportChecks( "TextureResidencyTest" );
+}
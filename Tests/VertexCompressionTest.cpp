@@ -0,0 +1,198 @@
+///////////////////////////////////////////////////////////////////////////
+//	File		: VertexCompressionTest.cpp
+//	Platform	: All
+//
+//	Encodes positions, normals and uvs into the compact vertex streams and
+//	decodes them as the vertex shader does, checking each comes back within
+//	the precision of its format.
+//	Builds without Play3d from the repository root, on Linux:
+//		g++ -std=c++20 -O2 -o VertexCompressionTest Tests/VertexCompressionTest.cpp Project/Utilities/VertexCompression.cpp
+//
+//	Copyright (C) Sumo Digital Ltd. All rights reserved.
+///////////////////////////////////////////////////////////////////////////
+
+#include "../Project/Utilities/VertexCompression.h"
+#include "Check.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace
+{
+	struct Float3
+	{
+		float x, y, z;
+	};
+
+	// As DecodeQuantisedPosition and DecodeOctNormal in Play3d.h, after the unorm and snorm input conversions.
+	float DecodePosition( uint16_t q, float min, float max )
+	{
+		return float( q ) / 65535.f * ( max - min ) + min;
+	}
+
+	Float3 DecodeNormal( const VertexCompression::OctNormal& e )
+	{
+		Float3 n = { std::max( float( e.x ) / 32767.f, -1.f ), std::max( float( e.y ) / 32767.f, -1.f ), 0.f };
+		n.z = 1.f - std::abs( n.x ) - std::abs( n.y );
+		const float t = std::clamp( -n.z, 0.f, 1.f );
+		n.x += n.x >= 0.f ? -t : t;
+		n.y += n.y >= 0.f ? -t : t;
+		const float length = std::sqrt( n.x * n.x + n.y * n.y + n.z * n.z );
+		return { n.x / length, n.y / length, n.z / length };
+	}
+
+	float HalfToFloat( uint16_t half )
+	{
+		const uint32_t sign = uint32_t( half & 0x8000u ) << 16;
+		const uint32_t exponent = ( half >> 10 ) & 0x1fu;
+		const uint32_t mantissa = half & 0x3ffu;
+		if ( exponent == 0 ) return ( half & 0x8000u ? -1.f : 1.f ) * std::ldexp( float( mantissa ), -24 );
+
+		const uint32_t bits = sign | ( exponent == 31 ? 0x7f800000u | ( mantissa << 13 ) : ( ( exponent + 112 ) << 23 ) | ( mantissa << 13 ) );
+		float value;
+		std::memcpy( &value, &bits, sizeof( value ) );
+		return value;
+	}
+
+	void TestPositions()
+	{
+		std::mt19937 random( 3 );
+		std::uniform_real_distribution< float > coordinate( -50.f, 120.f );
+		std::vector< Float3 > positions( 1000 );
+		for ( Float3& p : positions ) p = { coordinate( random ), coordinate( random ) * 0.01f, coordinate( random ) };
+
+		std::vector< VertexCompression::QuantisedPosition > quantised;
+		float bounds[ 6 ];
+		VertexCompression::QuantisePositions( &positions[ 0 ].x, static_cast< uint32_t >(positions.size()), sizeof( Float3 ), quantised, bounds );
+		CHECK( quantised.size() == positions.size() );
+
+		// Each axis is good to half a step of its own extent.
+		bool bWithinStep = true, bWithinBounds = true;
+		for ( size_t i = 0; i < positions.size(); i++ )
+		{
+			const float* p = &positions[ i ].x;
+			const uint16_t q[ 3 ] = { quantised[ i ].x, quantised[ i ].y, quantised[ i ].z };
+			for ( int k = 0; k < 3; k++ )
+			{
+				const float step = ( bounds[ k + 3 ] - bounds[ k ] ) / 65535.f;
+				bWithinStep &= std::abs( DecodePosition( q[ k ], bounds[ k ], bounds[ k + 3 ] ) - p[ k ] ) <= step * 0.5f + 1e-5f * std::abs( p[ k ] );
+				bWithinBounds &= p[ k ] >= bounds[ k ] && p[ k ] <= bounds[ k + 3 ];
+			}
+		}
+		CHECK( bWithinStep );
+		CHECK( bWithinBounds );
+
+		// The extremes land on the ends of the range.
+		const auto [ minX, maxX ] = std::minmax_element( quantised.begin(), quantised.end(), []( const auto& a, const auto& b ) { return a.x < b.x; } );
+		CHECK( minX->x == 0 && maxX->x == 65535 );
+
+		// A flat axis has no extent to divide, it decodes to the bound.
+		std::vector< Float3 > flat = { { 1.f, 2.f, 3.f }, { 4.f, 2.f, 5.f } };
+		VertexCompression::QuantisePositions( &flat[ 0 ].x, 2, sizeof( Float3 ), quantised, bounds );
+		CHECK( quantised[ 0 ].y == 0 && quantised[ 1 ].y == 0 && bounds[ 1 ] == 2.f && bounds[ 4 ] == 2.f );
+	}
+
+	void TestNormals()
+	{
+		std::mt19937 random( 5 );
+		std::normal_distribution< float > gaussian;
+		std::vector< Float3 > normals;
+		for ( int i = 0; i < 2000; i++ )
+		{
+			Float3 n = { gaussian( random ), gaussian( random ), gaussian( random ) };
+			const float length = std::sqrt( n.x * n.x + n.y * n.y + n.z * n.z );
+			normals.push_back( { n.x / length, n.y / length, n.z / length } );
+		}
+		// The axes and the folds of the octahedron, where the encoding is most likely to go wrong.
+		for ( float s : { 1.f, -1.f } )
+		{
+			normals.push_back( { s, 0.f, 0.f } );
+			normals.push_back( { 0.f, s, 0.f } );
+			normals.push_back( { 0.f, 0.f, s } );
+			normals.push_back( { 0.70710678f * s, 0.f, -0.70710678f } );
+			normals.push_back( { 0.f, 0.70710678f * s, -0.70710678f } );
+		}
+
+		std::vector< VertexCompression::OctNormal > encoded;
+		VertexCompression::EncodeNormals( &normals[ 0 ].x, static_cast< uint32_t >(normals.size()), sizeof( Float3 ), encoded );
+		CHECK( encoded.size() == normals.size() );
+
+		// 16 bits per component keeps normals well within a hundredth of a degree.
+		double worstDegrees = 0.0;
+		for ( size_t i = 0; i < normals.size(); i++ )
+		{
+			// The angle from the cross product, which unlike the dot product keeps its precision near zero.
+			const Float3 d = DecodeNormal( encoded[ i ] ), n = normals[ i ];
+			const double cx = double( d.y ) * n.z - double( d.z ) * n.y, cy = double( d.z ) * n.x - double( d.x ) * n.z, cz = double( d.x ) * n.y - double( d.y ) * n.x;
+			const double dot = double( d.x ) * n.x + double( d.y ) * n.y + double( d.z ) * n.z;
+			worstDegrees = std::max( worstDegrees, std::atan2( std::sqrt( cx * cx + cy * cy + cz * cz ), dot ) * 180.0 / 3.14159265358979 );
+		}
+		std::printf( "Worst normal error %.5f degrees\n", worstDegrees );
+		CHECK( worstDegrees < 0.01 );
+
+		// Normals need not be unit length, and a zero one encodes without dividing by zero.
+		std::vector< Float3 > unnormalised = { { 0.f, 0.f, 0.f }, { 0.f, 3.f, 4.f } };
+		VertexCompression::EncodeNormals( &unnormalised[ 0 ].x, 2, sizeof( Float3 ), encoded );
+		CHECK( encoded[ 0 ].x == 0 && encoded[ 0 ].y == 0 );
+		const Float3 decoded = DecodeNormal( encoded[ 1 ] );
+		CHECK( std::abs( decoded.y - 0.6f ) < 1e-4f && std::abs( decoded.z - 0.8f ) < 1e-4f );
+	}
+
+	void TestUVs()
+	{
+		// Texture coordinates, tiled ones past 1 and slightly negative ones from the exporter.
+		std::mt19937 random( 11 );
+		std::uniform_real_distribution< float > coordinate( -0.5f, 8.f );
+		std::vector< float > uvs( 2000 );
+		for ( float& uv : uvs ) uv = coordinate( random );
+
+		std::vector< VertexCompression::HalfUV > encoded;
+		VertexCompression::EncodeUVs( uvs.data(), static_cast< uint32_t >(uvs.size() / 2), 2 * sizeof( float ), encoded );
+		CHECK( encoded.size() == uvs.size() / 2 );
+
+		// Rounded to nearest, so within half a unit in the last place of the 11 bit significand.
+		bool bWithinUlp = true;
+		for ( size_t i = 0; i < encoded.size(); i++ )
+		{
+			const float u = uvs[ i * 2 ], v = uvs[ i * 2 + 1 ];
+			bWithinUlp &= std::abs( HalfToFloat( encoded[ i ].u ) - u ) <= std::abs( u ) * 0x1p-11f + 0x1p-25f;
+			bWithinUlp &= std::abs( HalfToFloat( encoded[ i ].v ) - v ) <= std::abs( v ) * 0x1p-11f + 0x1p-25f;
+		}
+		CHECK( bWithinUlp );
+
+		// Exact values, ties to even, the largest half, overflow and denormals.
+		CHECK( VertexCompression::FloatToHalf( 0.f ) == 0x0000 );
+		CHECK( VertexCompression::FloatToHalf( -0.f ) == 0x8000 );
+		CHECK( VertexCompression::FloatToHalf( 1.f ) == 0x3c00 );
+		CHECK( VertexCompression::FloatToHalf( -2.f ) == 0xc000 );
+		CHECK( VertexCompression::FloatToHalf( 0.5f ) == 0x3800 );
+		CHECK( VertexCompression::FloatToHalf( 1.f + 0x1p-11f ) == 0x3c00 );
+		CHECK( VertexCompression::FloatToHalf( 1.f + 3.f * 0x1p-11f ) == 0x3c02 );
+		CHECK( VertexCompression::FloatToHalf( 65504.f ) == 0x7bff );
+		CHECK( VertexCompression::FloatToHalf( 65520.f ) == 0x7c00 );
+		CHECK( VertexCompression::FloatToHalf( -1e9f ) == 0xfc00 );
+		CHECK( VertexCompression::FloatToHalf( 0x1p-24f ) == 0x0001 );
+		CHECK( VertexCompression::FloatToHalf( 0x1p-15f ) == 0x0200 );
+		CHECK( HalfToFloat( VertexCompression::FloatToHalf( 0x1p-14f ) ) == 0x1p-14f );
+	}
+
+	void TestUniformColours()
+	{
+		const uint32_t uniform[] = { 0xffffffffu, 0xffffffffu, 0xffffffffu };
+		const uint32_t mixed[] = { 0xffffffffu, 0xffffffffu, 0xff00ff00u };
+		CHECK( VertexCompression::IsUniform( uniform, 3 ) );
+		CHECK( !VertexCompression::IsUniform( mixed, 3 ) );
+		CHECK( VertexCompression::IsUniform( mixed, 2 ) );
+	}
+}
+
+int main()
+{
+	TestPositions();
+	TestNormals();
+	TestUVs();
+	TestUniformColours();
+	return ReportChecks( "VertexCompressionTest" );
+}
@@ -0,0 +1,501 @@
+///////////////////////////////////////////////////////////////////////////
+//	File		: AssetCooker.cpp
+//	Platform	: All
+//
+//	Packs the Data directory of a project into one pack file for
+//	System::AddPackFile. Files with the same contents are stored once, every
+//	payload starts on a 16 byte boundary (a page for large ones) so chunk files
+//	and textures are used in place from the mapped pack, and the directory's
+//	hash index is written into the pack so loading it hashes nothing.
+//	Has no dependencies beyond the standard library, on Linux:
+//		g++ -std=c++20 -O2 -o AssetCooker AssetCooker.cpp
+//
+//	Usage: AssetCooker [options] <project directory> <output.p3dpack>
+//		--manifest <name>=<list.txt>	files a level loads, one Data/ path per line
+//		--scan <source directory>	adds a manifest named Startup of the Data/
+//						paths quoted in the .cpp and .h files, with the
+//						includes of shaders and the cooked .dds of textures
+//		--drop-cooked-sources		leave out a .png with a .dds next to it, the
+//						game always loads the .dds
+//		--listed-only			leave out files no manifest lists
+//
+//	The files of each manifest are placed together in the pack in the order
+//	listed, so loading a level reads one run of the file. Next to the pack,
+//	<output>.<name>.manifest lists where each of its files ended up.
+//
+//	Copyright (C) Sumo Digital Ltd. All rights reserved.
+///////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <regex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+	// Matches System/Packfile.h in Play3d.h for a 64 bit build.
+	struct PackedFileHeader
+	{
+		uint64_t dataBlockOffset;
+		uint64_t dataBlockSize;
+		uint64_t dirBlockOffset;
+		uint64_t dirEntryCount;
+	};
+
+	struct PackedFileEntry
+	{
+		static constexpr size_t kMaxPathLength = 256;
+		char path[ kMaxPathLength ];
+		uint64_t offset; // from dataBlockOffset
+		uint64_t dataSize;
+	};
+
+	struct PackedFileSlot
+	{
+		uint64_t hash;
+		uint32_t entry;
+		uint32_t reserved;
+	};
+
+	struct PackedFileIndexFooter
+	{
+		uint64_t slotsOffset;
+		uint64_t slotCount;
+		uint64_t magic;
+	};
+
+	static_assert( sizeof( PackedFileHeader ) == 32 && sizeof( PackedFileEntry ) == 272 );
+	static_assert( sizeof( PackedFileSlot ) == 16 && sizeof( PackedFileIndexFooter ) == 24 );
+
+	constexpr uint64_t kIndexMagic = 0x5844494b43415033ull; // "3PACKIDX"
+	constexpr uint32_t kEmptySlot = ~0u;
+
+	// System::kChunkFileAlignment, so chunk payloads stay aligned in the pack.
+	constexpr uint64_t kPayloadAlignment = 16;
+	// Large files start on a page so reading one does not fault in the end of the file before it.
+	constexpr uint64_t kPageSize = 4096;
+	constexpr uint64_t kPageAlignFrom = 64 * 1024;
+	// Zeros after every payload, as System::LoadFileData leaves after a file read from disk.
+	constexpr uint64_t kPayloadPadding = 16;
+
+	struct DataFile
+	{
+		std::string path; // as the game asks for it, "Data/..."
+		std::filesystem::path diskPath;
+		uint64_t sizeBytes = 0;
+		int order = INT_MAX; // position among the manifests, INT_MAX when none lists it
+		uint64_t offset = 0;  // from the data block
+		bool bDuplicate = false;
+	};
+
+	struct Manifest
+	{
+		std::string name;
+		std::vector< std::string > paths;
+	};
+
+	struct Payload
+	{
+		uint32_t file; // the first file stored with these contents
+		uint64_t offset;
+	};
+
+	// PackedFile::HashPath, case-insensitive FNV-1a.
+	uint64_t HashPath( const std::string& path )
+	{
+		uint64_t hash = 14695981039346656037ull;
+		for ( char ch : path )
+		{
+			uint8_t c = static_cast< uint8_t >(ch);
+			if ( c >= 'A' && c <= 'Z' ) c = static_cast< uint8_t >(c + ( 'a' - 'A' ));
+			hash = ( hash ^ c ) * 1099511628211ull;
+		}
+		return hash;
+	}
+
+	uint64_t HashContents( const std::vector< uint8_t >& data )
+	{
+		uint64_t hash = 14695981039346656037ull;
+		for ( uint8_t c : data ) hash = ( hash ^ c ) * 1099511628211ull;
+		return hash ^ data.size();
+	}
+
+	std::string Lower( std::string s )
+	{
+		std::transform( s.begin(), s.end(), s.begin(), []( char c ) { return static_cast< char >(c >= 'A' && c <= 'Z' ? c + ( 'a' - 'A' ) : c); } );
+		return s;
+	}
+
+	std::string NormalisePath( std::string path )
+	{
+		std::replace( path.begin(), path.end(), '\\', '/' );
+		return std::filesystem::path( path ).lexically_normal().generic_string();
+	}
+
+	bool ReadFile( const std::filesystem::path& path, std::vector< uint8_t >& data )
+	{
+		std::ifstream file( path, std::ios::binary );
+		if ( !file ) return false;
+		data.assign( std::istreambuf_iterator< char >( file ), std::istreambuf_iterator< char >() );
+		return true;
+	}
+
+	bool ReadList( const std::filesystem::path& path, Manifest& manifest )
+	{
+		std::ifstream file( path );
+		if ( !file ) return false;
+
+		std::string line;
+		while ( std::getline( file, line ) )
+		{
+			line.erase( 0, line.find_first_not_of( " \t" ) );
+			line.erase( line.find_last_not_of( " \t\r" ) + 1 );
+			if ( !line.empty() && line[ 0 ] != '#' ) manifest.paths.push_back( NormalisePath( line ) );
+		}
+		return true;
+	}
+
+	// A shader and everything it includes, which the shader compiler looks up next to the including file.
+	void AddShader( const std::filesystem::path& projectDir, const std::string& path, Manifest& manifest, std::set< std::string >& seen )
+	{
+		if ( !seen.insert( Lower( path ) ).second ) return;
+		manifest.paths.push_back( path );
+
+		std::ifstream file( projectDir / path );
+		std::stringstream source;
+		source << file.rdbuf();
+		const std::string code = source.str();
+
+		static const std::regex kInclude( "#include\\s*\"([^\"]+)\"" );
+		for ( std::sregex_iterator it( code.begin(), code.end(), kInclude ), end; it != end; ++it )
+		{
+			std::string include = NormalisePath( std::filesystem::path( path ).parent_path().generic_string() + "/" + ( *it )[ 1 ].str() );
+			if ( std::filesystem::is_regular_file( projectDir / include ) ) AddShader( projectDir, include, manifest, seen );
+		}
+	}
+
+	// Everything the game names in its source, which it loads at startup whatever the level.
+	void ScanSources( const std::filesystem::path& projectDir, const std::filesystem::path& sourceDir, Manifest& manifest )
+	{
+		std::vector< std::filesystem::path > sources;
+		for ( const auto& entry : std::filesystem::recursive_directory_iterator( sourceDir ) )
+		{
+			const std::string extension = entry.path().extension().string();
+			if ( entry.is_regular_file() && ( extension == ".cpp" || extension == ".h" ) ) sources.push_back( entry.path() );
+		}
+		std::sort( sources.begin(), sources.end() );
+
+		static const std::regex kDataPath( "\"(Data/[^\"]+)\"" );
+		std::set< std::string > seen;
+		for ( const std::filesystem::path& source : sources )
+		{
+			std::ifstream file( source );
+			std::stringstream text;
+			text << file.rdbuf();
+			const std::string code = text.str();
+
+			for ( std::sregex_iterator it( code.begin(), code.end(), kDataPath ), end; it != end; ++it )
+			{
+				std::filesystem::path path( NormalisePath( ( *it )[ 1 ].str() ) );
+				if ( path.extension() == ".hlsl" )
+				{
+					AddShader( projectDir, path.generic_string(), manifest, seen );
+					continue;
+				}
+
+				// Textures load their cooked .dds when there is one, see ResourceCache_Impl::LoadCookedImage.
+				if ( path.extension() == ".png" && std::filesystem::is_regular_file( projectDir / std::filesystem::path( path ).replace_extension( ".dds" ) ) )
+				{
+					path.replace_extension( ".dds" );
+				}
+				if ( seen.insert( Lower( path.generic_string() ) ).second ) manifest.paths.push_back( path.generic_string() );
+			}
+		}
+	}
+
+	void WriteZeros( std::ofstream& out, uint64_t& offset, uint64_t bytes )
+	{
+		static const char kZeros[ kPageSize ] = {};
+		out.write( kZeros, static_cast< std::streamsize >(bytes) );
+		offset += bytes;
+	}
+
+	void WritePadding( std::ofstream& out, uint64_t& offset, uint64_t alignment )
+	{
+		WriteZeros( out, offset, ( alignment - offset % alignment ) % alignment );
+	}
+
+	bool WriteManifest( const std::filesystem::path& path, const Manifest& manifest, const std::vector< DataFile >& files,
+		const std::unordered_map< std::string, uint32_t >& filesByPath, const PackedFileHeader& header, const std::string& packName )
+	{
+		std::vector< const DataFile* > listed;
+		std::set< const DataFile* > seen;
+		for ( const std::string& path : manifest.paths )
+		{
+			auto it = filesByPath.find( Lower( path ) );
+			if ( it != filesByPath.end() && seen.insert( &files[ it->second ] ).second ) listed.push_back( &files[ it->second ] );
+		}
+		std::sort( listed.begin(), listed.end(), []( const DataFile* a, const DataFile* b ) { return a->offset < b->offset; } );
+
+		uint64_t begin = 0, end = 0, bytes = 0;
+		std::set< uint64_t > payloads;
+		for ( const DataFile* pFile : listed )
+		{
+			const uint64_t fileBegin = header.dataBlockOffset + pFile->offset;
+			if ( payloads.empty() || fileBegin < begin ) begin = fileBegin;
+			end = std::max( end, fileBegin + pFile->sizeBytes );
+			if ( payloads.insert( pFile->offset ).second ) bytes += pFile->sizeBytes;
+		}
+
+		std::ofstream out( path );
+		if ( !out ) return false;
+		out << "# " << manifest.name << ": " << listed.size() << " files, " << bytes << " bytes in [" << begin << ", " << end << ") of " << packName << "\n";
+		out << "# offset in the pack, size, path\n";
+		for ( const DataFile* pFile : listed )
+		{
+			out << header.dataBlockOffset + pFile->offset << " " << pFile->sizeBytes << " " << pFile->path << "\n";
+		}
+		return static_cast< bool >(out);
+	}
+}
+
+int main( int argc, char** argv )
+{
+	std::vector< Manifest > manifests;
+	std::vector< std::filesystem::path > scanDirs;
+	std::vector< std::filesystem::path > positional;
+	bool bDropCookedSources = false;
+	bool bListedOnly = false;
+	bool bBadOption = false;
+	for ( int i = 1; i < argc; i++ )
+	{
+		if ( std::strcmp( argv[ i ], "--manifest" ) == 0 && i + 1 < argc && std::strchr( argv[ i + 1 ], '=' ) )
+		{
+			const std::string arg = argv[ ++i ];
+			Manifest manifest;
+			manifest.name = arg.substr( 0, arg.find( '=' ) );
+			if ( !ReadList( arg.substr( arg.find( '=' ) + 1 ), manifest ) )
+			{
+				std::fprintf( stderr, "Could not read the file list '%s'\n", arg.c_str() + arg.find( '=' ) + 1 );
+				return 1;
+			}
+			manifests.push_back( manifest );
+		}
+		else if ( std::strcmp( argv[ i ], "--scan" ) == 0 && i + 1 < argc ) scanDirs.emplace_back( argv[ ++i ] );
+		else if ( std::strcmp( argv[ i ], "--drop-cooked-sources" ) == 0 ) bDropCookedSources = true;
+		else if ( std::strcmp( argv[ i ], "--listed-only" ) == 0 ) bListedOnly = true;
+		else if ( argv[ i ][ 0 ] == '-' ) bBadOption = true;
+		else positional.emplace_back( argv[ i ] );
+	}
+
+	if ( positional.size() != 2 || bBadOption || ( bListedOnly && manifests.empty() && scanDirs.empty() ) )
+	{
+		std::fprintf( stderr, "Usage: AssetCooker [--manifest <name>=<list.txt>]... [--scan <source directory>]... [--drop-cooked-sources] [--listed-only] <project directory> <output.p3dpack>\n" );
+		return 1;
+	}
+	const std::filesystem::path projectDir = positional[ 0 ];
+	const std::filesystem::path packPath = positional[ 1 ];
+	if ( !std::filesystem::is_directory( projectDir / "Data" ) )
+	{
+		std::fprintf( stderr, "No Data directory in '%s'\n", projectDir.string().c_str() );
+		return 1;
+	}
+
+	if ( !scanDirs.empty() )
+	{
+		Manifest startup;
+		startup.name = "Startup";
+		for ( const std::filesystem::path& dir : scanDirs ) ScanSources( projectDir, dir, startup );
+		manifests.insert( manifests.begin(), startup );
+	}
+
+	// Every file under Data, by the path the game asks for. The runtime compares paths without case.
+	// Loose files take whole clusters on disk, 4 KB on most file systems.
+	std::vector< DataFile > files;
+	std::unordered_map< std::string, uint32_t > filesByPath;
+	uint64_t looseBytes = 0, looseDiskBytes = 0;
+	for ( const auto& entry : std::filesystem::recursive_directory_iterator( projectDir / "Data" ) )
+	{
+		if ( !entry.is_regular_file() ) continue;
+
+		DataFile file;
+		file.path = std::filesystem::relative( entry.path(), projectDir ).generic_string();
+		file.diskPath = entry.path();
+		file.sizeBytes = entry.file_size();
+		if ( file.path.size() >= PackedFileEntry::kMaxPathLength )
+		{
+			std::fprintf( stderr, "Path is too long for the pack: %s\n", file.path.c_str() );
+			return 1;
+		}
+		looseBytes += file.sizeBytes;
+		looseDiskBytes += ( file.sizeBytes + kPageSize - 1 ) / kPageSize * kPageSize;
+		files.push_back( file );
+	}
+	std::sort( files.begin(), files.end(), []( const DataFile& a, const DataFile& b ) { return a.path < b.path; } );
+
+	std::set< std::string > paths;
+	for ( const DataFile& file : files ) paths.insert( Lower( file.path ) );
+	size_t droppedSources = 0;
+	for ( size_t i = 0; i < files.size(); )
+	{
+		std::string dds = Lower( std::filesystem::path( files[ i ].path ).replace_extension( ".dds" ).generic_string() );
+		if ( bDropCookedSources && std::filesystem::path( files[ i ].path ).extension() == ".png" && paths.count( dds ) )
+		{
+			files.erase( files.begin() + i );
+			droppedSources++;
+		}
+		else if ( !filesByPath.emplace( Lower( files[ i ].path ), static_cast< uint32_t >(i) ).second )
+		{
+			std::fprintf( stderr, "Paths differ only by case, keeping the first: %s\n", files[ i ].path.c_str() );
+			files.erase( files.begin() + i );
+		}
+		else
+		{
+			i++;
+		}
+	}
+
+	// Manifest files go first in the order listed, the rest after by path.
+	int order = 0;
+	for ( const Manifest& manifest : manifests )
+	{
+		for ( const std::string& path : manifest.paths )
+		{
+			auto it = filesByPath.find( Lower( path ) );
+			if ( it == filesByPath.end() ) std::fprintf( stderr, "Warning: %s lists %s, which is not in the data\n", manifest.name.c_str(), path.c_str() );
+			else if ( files[ it->second ].order == INT_MAX ) files[ it->second ].order = order++;
+		}
+	}
+	std::vector< uint32_t > layout;
+	size_t unlisted = 0;
+	for ( uint32_t i = 0; i < files.size(); i++ )
+	{
+		if ( bListedOnly && files[ i ].order == INT_MAX ) unlisted++;
+		else layout.push_back( i );
+	}
+	std::stable_sort( layout.begin(), layout.end(), [ &files ]( uint32_t a, uint32_t b ) { return files[ a ].order < files[ b ].order; } );
+
+	std::ofstream out( packPath, std::ios::binary );
+	if ( !out )
+	{
+		std::fprintf( stderr, "Could not create '%s'\n", packPath.string().c_str() );
+		return 1;
+	}
+
+	PackedFileHeader header = {};
+	out.write( reinterpret_cast< const char* >(&header), sizeof( header ) );
+	uint64_t offset = sizeof( header );
+	header.dataBlockOffset = offset;
+
+	// Contents are matched by hash and then compared, a file identical to one already written shares its payload.
+	std::unordered_multimap< uint64_t, Payload > payloads;
+	uint64_t duplicateBytes = 0;
+	uint32_t duplicates = 0;
+	std::vector< uint8_t > data, other;
+	for ( uint32_t index : layout )
+	{
+		DataFile& file = files[ index ];
+		if ( !ReadFile( file.diskPath, data ) )
+		{
+			std::fprintf( stderr, "Could not read '%s'\n", file.diskPath.string().c_str() );
+			return 1;
+		}
+		file.sizeBytes = data.size();
+
+		const uint64_t hash = HashContents( data );
+		auto range = payloads.equal_range( hash );
+		for ( auto it = range.first; it != range.second && !file.bDuplicate; ++it )
+		{
+			if ( files[ it->second.file ].sizeBytes == data.size() && ReadFile( files[ it->second.file ].diskPath, other ) && other == data )
+			{
+				file.offset = it->second.offset;
+				file.bDuplicate = true;
+			}
+		}
+		if ( file.bDuplicate )
+		{
+			duplicates++;
+			duplicateBytes += data.size();
+			continue;
+		}
+
+		WritePadding( out, offset, data.size() >= kPageAlignFrom ? kPageSize : kPayloadAlignment );
+		file.offset = offset - header.dataBlockOffset;
+		out.write( reinterpret_cast< const char* >(data.data()), static_cast< std::streamsize >(data.size()) );
+		offset += data.size();
+		WriteZeros( out, offset, kPayloadPadding );
+		payloads.emplace( hash, Payload{ index, file.offset } );
+	}
+	header.dataBlockSize = offset - header.dataBlockOffset;
+
+	// The directory in layout order, so files read together have their entries together too.
+	WritePadding( out, offset, kPayloadAlignment );
+	header.dirBlockOffset = offset;
+	header.dirEntryCount = layout.size();
+	std::vector< PackedFileEntry > directory( layout.size() );
+	for ( uint32_t i = 0; i < layout.size(); i++ )
+	{
+		const DataFile& file = files[ layout[ i ] ];
+		PackedFileEntry& entry = directory[ i ];
+		std::memset( &entry, 0, sizeof( entry ) );
+		std::memcpy( entry.path, file.path.c_str(), file.path.size() );
+		entry.offset = file.offset;
+		entry.dataSize = file.sizeBytes;
+	}
+	out.write( reinterpret_cast< const char* >(directory.data()), static_cast< std::streamsize >(directory.size() * sizeof( PackedFileEntry )) );
+	offset += directory.size() * sizeof( PackedFileEntry );
+
+	// The same table PackedFile::BuildIndex builds, probed in directory order.
+	uint64_t slotCount = 1;
+	while ( slotCount < directory.size() * 2 ) slotCount <<= 1;
+	std::vector< PackedFileSlot > slots( slotCount, PackedFileSlot{ 0, kEmptySlot, 0 } );
+	for ( uint32_t i = 0; i < directory.size(); i++ )
+	{
+		const uint64_t hash = HashPath( directory[ i ].path );
+		uint64_t slot = hash & ( slotCount - 1 );
+		while ( slots[ slot ].entry != kEmptySlot ) slot = ( slot + 1 ) & ( slotCount - 1 );
+		slots[ slot ] = PackedFileSlot{ hash, i, 0 };
+	}
+	WritePadding( out, offset, kPayloadAlignment );
+	PackedFileIndexFooter footer = { offset, slotCount, kIndexMagic };
+	out.write( reinterpret_cast< const char* >(slots.data()), static_cast< std::streamsize >(slots.size() * sizeof( PackedFileSlot )) );
+	out.write( reinterpret_cast< const char* >(&footer), sizeof( footer ) );
+	offset += slots.size() * sizeof( PackedFileSlot ) + sizeof( footer );
+
+	out.seekp( 0 );
+	out.write( reinterpret_cast< const char* >(&header), sizeof( header ) );
+	out.close();
+	if ( !out )
+	{
+		std::fprintf( stderr, "Could not write '%s'\n", packPath.string().c_str() );
+		return 1;
+	}
+
+	for ( const Manifest& manifest : manifests )
+	{
+		std::filesystem::path manifestPath = packPath;
+		manifestPath += "." + manifest.name + ".manifest";
+		if ( !WriteManifest( manifestPath, manifest, files, filesByPath, header, packPath.filename().string() ) )
+		{
+			std::fprintf( stderr, "Could not write '%s'\n", manifestPath.string().c_str() );
+			return 1;
+		}
+	}
+
+	std::printf( "Loose: %zu files, %llu KB (%llu KB on disk)\n", files.size() + droppedSources, static_cast< unsigned long long >(looseBytes / 1024),
+		static_cast< unsigned long long >(looseDiskBytes / 1024) );
+	std::printf( "Pack: %zu files, %llu KB. %u duplicates stored once (%llu KB), %zu cooked sources and %zu unlisted files left out, %zu manifests\n",
+		layout.size(), static_cast< unsigned long long >(offset / 1024), duplicates, static_cast< unsigned long long >(duplicateBytes / 1024),
+		droppedSources, unlisted, manifests.size() );
+	return 0;
+}
@@ -0,0 +1,349 @@
+///////////////////////////////////////////////////////////////////////////
+//	File		: MeshCooker.cpp
+//	Platform	: All
+//
+//	Does the mesh processing of AssetManager::ReadMesh offline, so the game
+//	loads cooked meshes straight from the mapped file. Writes the LOD chain
+//	into the index buffer with a "lods" chunk of its ranges, and reorders the
+//	mesh for the GPU with a "mopt" chunk of the vertex cache statistics, then
+//	swaps the full vertex streams for the compact ones of VertexCompression,
+//	with a uniform colour stream cut down to its one colour.
+//	Skinned meshes are left alone. Builds with the game's own mesh code from
+//	the repository root, on Linux:
+//		g++ -std=c++20 -O2 -o MeshCooker Tools/MeshCooker/MeshCooker.cpp Project/Utilities/MeshSimplifier.cpp Project/Utilities/MeshOptimiser.cpp Project/Utilities/VertexCompression.cpp
+//
+//	Usage: MeshCooker [options] <file.p3dmesh>...
+//		--lods			build a LOD chain, the game does this for the
+//					meshes g_vAssetGenerateLods lists in Assets.h
+//		--full-vertices		keep the full vertex streams, for meshes drawn
+//					with shaders that only read those (the laser)
+//		--output <file.p3dmesh>	write the one input here rather than over it
+//
+//	Files that already have a "lods", "mopt" or "posq" chunk are cooked and
+//	skipped.
+//
+//	Copyright (C) Sumo Digital Ltd. All rights reserved.
+///////////////////////////////////////////////////////////////////////////
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "../../Project/Utilities/MeshOptimiser.h"
+#include "../../Project/Utilities/MeshSimplifier.h"
+#include "../../Project/Utilities/VertexCompression.h"
+
+namespace
+{
+	constexpr uint32_t FourCC( const char ( &code )[ 5 ] )
+	{
+		return uint32_t( uint8_t( code[ 0 ] ) ) | uint32_t( uint8_t( code[ 1 ] ) ) << 8 | uint32_t( uint8_t( code[ 2 ] ) ) << 16 | uint32_t( uint8_t( code[ 3 ] ) ) << 24;
+	}
+
+	// Matches System/ChunkFileFormat.h in Play3d.h.
+	constexpr uint32_t kChunkFileFormatId = FourCC( "PL3D" );
+	constexpr uint32_t kChunkFileFormatVersion = 3;
+	constexpr uint32_t kChunkFileAlignment = 16;
+	constexpr uint32_t kChunkPaddingId = FourCC( "pad_" );
+	constexpr uint32_t kMeshId = FourCC( "MESH" );
+	constexpr uint32_t kPositionId = FourCC( "pos_" );
+	constexpr uint32_t kNormalId = FourCC( "norm" );
+	constexpr uint32_t kUV0Id = FourCC( "uv_0" );
+	constexpr uint32_t kColourId = FourCC( "col_" );
+	constexpr uint32_t kIndexId = FourCC( "indx" );
+	constexpr uint32_t kSubmeshId = FourCC( "subm" );
+	constexpr uint32_t kJointIndicesId = FourCC( "jind" );
+	constexpr uint32_t kPositionQuantisedId = FourCC( "posq" );
+	constexpr uint32_t kPositionBoundsId = FourCC( "pbnd" );
+	constexpr uint32_t kNormalOctId = FourCC( "noct" );
+	constexpr uint32_t kUV0HalfId = FourCC( "uv0h" );
+
+	struct ChunkFileHeader
+	{
+		uint32_t formatIdCode;
+		uint32_t formatVersion;
+		uint32_t subtype;
+		uint32_t totalChunks;
+	};
+
+	struct ChunkInfo
+	{
+		uint32_t chunkId;
+		uint32_t sizeBytes;
+	};
+
+	// Graphics::SubmeshDesc
+	struct Submesh
+	{
+		uint32_t materialId;
+		uint32_t elementOffset;
+		uint32_t elementSize;
+	};
+
+	struct Float2
+	{
+		float x, y;
+	};
+
+	struct Float3
+	{
+		float x, y, z;
+	};
+
+	struct Chunk
+	{
+		uint32_t id;
+		std::vector< uint8_t > data;
+	};
+
+	struct ChunkFile
+	{
+		uint32_t subtype = 0;
+		std::vector< Chunk > chunks; // in file order, without the padding
+
+		const Chunk* Find( uint32_t id ) const
+		{
+			for ( const Chunk& chunk : chunks )
+			{
+				if ( chunk.id == id ) return &chunk;
+			}
+			return nullptr;
+		}
+
+		template< typename T >
+		std::vector< T > Get( uint32_t id ) const
+		{
+			std::vector< T > out;
+			if ( const Chunk* pChunk = Find( id ) )
+			{
+				out.resize( pChunk->data.size() / sizeof( T ) );
+				std::memcpy( out.data(), pChunk->data.data(), out.size() * sizeof( T ) );
+			}
+			return out;
+		}
+
+		// Replaces the chunk where it is in the file, or adds it at the end.
+		template< typename T >
+		void Set( uint32_t id, const std::vector< T >& values )
+		{
+			Chunk chunk = { id, std::vector< uint8_t >( values.size() * sizeof( T ) ) };
+			std::memcpy( chunk.data.data(), values.data(), chunk.data.size() );
+			for ( Chunk& existing : chunks )
+			{
+				if ( existing.id == id )
+				{
+					existing = chunk;
+					return;
+				}
+			}
+			chunks.push_back( chunk );
+		}
+	};
+
+	bool ReadChunkFile( const std::string& path, ChunkFile& file )
+	{
+		std::ifstream in( path, std::ios::binary );
+		if ( !in ) return false;
+		const std::vector< uint8_t > data( ( std::istreambuf_iterator< char >( in ) ), std::istreambuf_iterator< char >() );
+
+		ChunkFileHeader header;
+		if ( data.size() < sizeof( header ) ) return false;
+		std::memcpy( &header, data.data(), sizeof( header ) );
+		if ( header.formatIdCode != kChunkFileFormatId ) return false;
+		file.subtype = header.subtype;
+
+		size_t offset = sizeof( header );
+		while ( offset < data.size() )
+		{
+			ChunkInfo info;
+			if ( offset + sizeof( info ) > data.size() ) return false;
+			std::memcpy( &info, data.data() + offset, sizeof( info ) );
+			offset += sizeof( info );
+			if ( offset + info.sizeBytes > data.size() ) return false;
+			if ( info.chunkId != kChunkPaddingId ) file.chunks.push_back( { info.chunkId, std::vector< uint8_t >( data.begin() + offset, data.begin() + offset + info.sizeBytes ) } );
+			offset += info.sizeBytes;
+		}
+		return true;
+	}
+
+	// Lays chunks out as ChunkFileWriter does, with a filler ahead of any payload that would not be aligned.
+	bool WriteChunkFile( const std::string& path, const ChunkFile& file )
+	{
+		std::ofstream out( path, std::ios::binary );
+		if ( !out ) return false;
+
+		ChunkFileHeader header = { kChunkFileFormatId, kChunkFileFormatVersion, file.subtype, 0 };
+		out.write( reinterpret_cast< const char* >(&header), sizeof( header ) );
+		size_t offset = sizeof( header );
+		for ( const Chunk& chunk : file.chunks )
+		{
+			if ( ( offset + sizeof( ChunkInfo ) ) % kChunkFileAlignment != 0 )
+			{
+				static const char kZeros[ kChunkFileAlignment ] = {};
+				const uint32_t padding = static_cast< uint32_t >(( kChunkFileAlignment - ( offset + 2 * sizeof( ChunkInfo ) ) % kChunkFileAlignment ) % kChunkFileAlignment);
+				const ChunkInfo padInfo = { kChunkPaddingId, padding };
+				out.write( reinterpret_cast< const char* >(&padInfo), sizeof( padInfo ) );
+				out.write( kZeros, padding );
+				offset += sizeof( padInfo ) + padding;
+				header.totalChunks++;
+			}
+
+			const ChunkInfo info = { chunk.id, static_cast< uint32_t >(chunk.data.size()) };
+			out.write( reinterpret_cast< const char* >(&info), sizeof( info ) );
+			out.write( reinterpret_cast< const char* >(chunk.data.data()), static_cast< std::streamsize >(chunk.data.size()) );
+			offset += sizeof( info ) + chunk.data.size();
+			header.totalChunks++;
+		}
+
+		out.seekp( 0 );
+		out.write( reinterpret_cast< const char* >(&header), sizeof( header ) );
+		return static_cast< bool >(out);
+	}
+
+	// The steps of AssetManager::ReadMesh, in the same order so a cooked mesh draws as one processed at load.
+	bool CookMesh( const std::string& inPath, const std::string& outPath, bool bLods, bool bCompact )
+	{
+		ChunkFile file;
+		if ( !ReadChunkFile( inPath, file ) || file.subtype != kMeshId )
+		{
+			std::fprintf( stderr, "%s is not a p3dmesh\n", inPath.c_str() );
+			return false;
+		}
+		if ( file.Find( kJointIndicesId ) || file.Find( MeshSimplifier::kLodChunkId ) || file.Find( MeshOptimiser::kOptimisedChunkId ) || file.Find( kPositionQuantisedId ) )
+		{
+			std::printf( "%s: skinned or already cooked, skipped\n", inPath.c_str() );
+			return true;
+		}
+
+		std::vector< Float3 > positions = file.Get< Float3 >( kPositionId );
+		std::vector< Float3 > normals = file.Get< Float3 >( kNormalId );
+		std::vector< Float2 > uvs = file.Get< Float2 >( kUV0Id );
+		std::vector< uint32_t > colours = file.Get< uint32_t >( kColourId );
+		std::vector< uint32_t > indices = file.Get< uint32_t >( kIndexId );
+		std::vector< Submesh > submeshes = file.Get< Submesh >( kSubmeshId );
+		const uint32_t vertexCount = static_cast< uint32_t >(positions.size());
+		if ( vertexCount == 0 || indices.empty() )
+		{
+			std::fprintf( stderr, "%s has no positions or indices\n", inPath.c_str() );
+			return false;
+		}
+		const size_t sourceIndexCount = indices.size();
+
+		std::vector< MeshSimplifier::LodRange > lods;
+		if ( bLods )
+		{
+			std::vector< uint32_t > sourceIndices;
+			sourceIndices.swap( indices );
+			MeshSimplifier::BuildLodChain( &positions[ 0 ].x, vertexCount, sizeof( Float3 ), sourceIndices.data(), static_cast< uint32_t >(sourceIndices.size()),
+				MeshSimplifier::kLodRatios, static_cast< uint32_t >(std::size( MeshSimplifier::kLodRatios )), indices, lods );
+
+			// The game draws each mesh with one material, so a LOD covers all of the source submeshes.
+			submeshes.clear();
+			for ( const MeshSimplifier::LodRange& lod : lods )
+			{
+				submeshes.push_back( { 0, lod.indexOffset, lod.indexCount } );
+			}
+		}
+		else if ( submeshes.empty() )
+		{
+			submeshes.push_back( { 0, 0, static_cast< uint32_t >(indices.size()) } );
+		}
+
+		MeshOptimiser::OptimiseStats stats;
+		stats.before = MeshOptimiser::AnalyseVertexCache( indices.data(), submeshes[ 0 ].elementSize, vertexCount );
+		for ( const Submesh& submesh : submeshes )
+		{
+			uint32_t* pIndices = indices.data() + submesh.elementOffset;
+			MeshOptimiser::OptimiseVertexCache( pIndices, submesh.elementSize, vertexCount );
+			MeshOptimiser::OptimiseOverdraw( pIndices, submesh.elementSize, &positions[ 0 ].x, vertexCount, sizeof( Float3 ) );
+		}
+		std::vector< uint32_t > remap;
+		MeshOptimiser::OptimiseVertexFetch( indices.data(), static_cast< uint32_t >(indices.size()), vertexCount, remap );
+		MeshOptimiser::RemapVertexStream( positions, remap );
+		MeshOptimiser::RemapVertexStream( normals, remap );
+		MeshOptimiser::RemapVertexStream( uvs, remap );
+		MeshOptimiser::RemapVertexStream( colours, remap );
+		stats.after = MeshOptimiser::AnalyseVertexCache( indices.data(), submeshes[ 0 ].elementSize, vertexCount );
+
+		if ( bCompact && normals.size() == vertexCount && uvs.size() == vertexCount )
+		{
+			// AssetManager::CreateMesh only reads one set of streams, so the full ones go.
+			std::vector< VertexCompression::QuantisedPosition > compactPositions;
+			std::vector< VertexCompression::OctNormal > compactNormals;
+			std::vector< VertexCompression::HalfUV > compactUVs;
+			float bounds[ 6 ];
+			VertexCompression::QuantisePositions( &positions[ 0 ].x, vertexCount, sizeof( Float3 ), compactPositions, bounds );
+			VertexCompression::EncodeNormals( &normals[ 0 ].x, vertexCount, sizeof( Float3 ), compactNormals );
+			VertexCompression::EncodeUVs( &uvs[ 0 ].x, vertexCount, sizeof( Float2 ), compactUVs );
+			// Written over the full streams and renamed, so they keep their place in the file.
+			file.Set( kPositionId, compactPositions );
+			file.Set( kNormalId, compactNormals );
+			file.Set( kUV0Id, compactUVs );
+			for ( Chunk& chunk : file.chunks )
+			{
+				if ( chunk.id == kPositionId ) chunk.id = kPositionQuantisedId;
+				else if ( chunk.id == kNormalId ) chunk.id = kNormalOctId;
+				else if ( chunk.id == kUV0Id ) chunk.id = kUV0HalfId;
+			}
+			file.Set( kPositionBoundsId, std::vector< Float3 >{ { bounds[ 0 ], bounds[ 1 ], bounds[ 2 ] }, { bounds[ 3 ], bounds[ 4 ], bounds[ 5 ] } } );
+
+			// As in AssetManager::CreateMesh, a uniform colour stream shrinks to the one colour every vertex reads.
+			if ( colours.size() > 1 && VertexCompression::IsUniform( colours.data(), static_cast< uint32_t >(colours.size()) ) ) colours.resize( 1 );
+		}
+		else
+		{
+			file.Set( kPositionId, positions );
+			if ( !normals.empty() ) file.Set( kNormalId, normals );
+			if ( !uvs.empty() ) file.Set( kUV0Id, uvs );
+		}
+		if ( !colours.empty() ) file.Set( kColourId, colours );
+		file.Set( kIndexId, indices );
+		file.Set( kSubmeshId, submeshes );
+		if ( !lods.empty() ) file.Set( MeshSimplifier::kLodChunkId, lods );
+		file.Set( MeshOptimiser::kOptimisedChunkId, std::vector< MeshOptimiser::OptimiseStats >{ stats } );
+
+		if ( !WriteChunkFile( outPath, file ) )
+		{
+			std::fprintf( stderr, "Could not write '%s'\n", outPath.c_str() );
+			return false;
+		}
+
+		std::printf( "%s: %u vertices, %zu indices", inPath.c_str(), vertexCount, sourceIndexCount );
+		for ( size_t i = 1; i < lods.size(); i++ ) std::printf( " -> %u", lods[ i ].indexCount );
+		std::printf( ", ACMR %.3f -> %.3f%s\n", stats.before.acmr, stats.after.acmr, file.Find( kPositionQuantisedId ) ? ", compact vertices" : "" );
+		return true;
+	}
+}
+
+int main( int argc, char** argv )
+{
+	std::vector< std::string > inputs;
+	std::string output;
+	bool bLods = false;
+	bool bCompact = true;
+	bool bBadOption = false;
+	for ( int i = 1; i < argc; i++ )
+	{
+		if ( std::strcmp( argv[ i ], "--lods" ) == 0 ) bLods = true;
+		else if ( std::strcmp( argv[ i ], "--full-vertices" ) == 0 ) bCompact = false;
+		else if ( std::strcmp( argv[ i ], "--output" ) == 0 && i + 1 < argc ) output = argv[ ++i ];
+		else if ( argv[ i ][ 0 ] == '-' ) bBadOption = true;
+		else inputs.emplace_back( argv[ i ] );
+	}
+
+	if ( inputs.empty() || bBadOption || ( !output.empty() && inputs.size() != 1 ) )
+	{
+		std::fprintf( stderr, "Usage: MeshCooker [--lods] [--full-vertices] [--output <file.p3dmesh>] <file.p3dmesh>...\n" );
+		return 1;
+	}
+
+	int failures = 0;
+	for ( const std::string& input : inputs )
+	{
+		if ( !CookMesh( input, output.empty() ? input : output, bLods, bCompact ) ) failures++;
+	}
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,340 @@
+///////////////////////////////////////////////////////////////////////////
+//	File		: RenderCaptureAnalyser.cpp
+//	Platform	: All
+//
+//	Reports draw counts, redundant state, instancing opportunities, overdraw and
+//	upload bytes per pass from captures written by RenderCapture ('R' in game).
+//	Has no dependencies beyond the standard library, on Linux:
+//		g++ -std=c++20 -O2 -o RenderCaptureAnalyser RenderCaptureAnalyser.cpp
+//
+//	Usage: RenderCaptureAnalyser <capture.rcap> [baseline.rcap] [--frames]
+//
+//	Copyright (C) Sumo Digital Ltd. All rights reserved.
+///////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../../Project/Utilities/RenderCaptureFormat.h"
+
+namespace
+{
+	// Matches RenderPassType, records made outside a pass come from the game update.
+	constexpr uint8_t kUpdatePass = 0xff;
+	constexpr int kNumPasses = 6;
+	const char* kPassNames[ kNumPasses ] = { "shadow", "zprepass", "forward", "debug", "static", "update" };
+
+	int PassSlot( uint8_t pass ) { return pass < kNumPasses - 1 ? pass : kNumPasses - 1; }
+
+	struct PassStats
+	{
+		uint32_t commands = 0;
+		uint32_t uniqueStates = 0;       // distinct mesh/material pairs among the commands
+		uint32_t drawCalls = 0;
+		uint32_t instancedDraws = 0;
+		uint32_t instances = 0;
+		uint32_t particleDraws = 0;
+		uint32_t materialSets = 0;
+		uint32_t redundantMaterialSets = 0;
+		uint32_t bufferBinds = 0;
+		uint32_t redundantBufferBinds = 0;
+		uint32_t worldMatrixSets = 0;
+		uint32_t textureBinds = 0;
+		uint32_t redundantTextureBinds = 0;
+		uint32_t clears = 0;
+		uint32_t targetSets = 0;
+		uint32_t cameraSets = 0;         // viewport, view and projection matrix sets
+		uint32_t mergeableDraws = 0;     // DrawMesh calls that repeat the previous mesh and material
+		uint64_t uploadBytes = 0;
+		uint32_t uploads = 0;
+		double coverage = 0.0;           // summed screen coverage of the commands, ~ overdraw
+
+		void Add( const PassStats& other )
+		{
+			commands += other.commands;
+			uniqueStates += other.uniqueStates;
+			drawCalls += other.drawCalls;
+			instancedDraws += other.instancedDraws;
+			instances += other.instances;
+			particleDraws += other.particleDraws;
+			materialSets += other.materialSets;
+			redundantMaterialSets += other.redundantMaterialSets;
+			bufferBinds += other.bufferBinds;
+			redundantBufferBinds += other.redundantBufferBinds;
+			worldMatrixSets += other.worldMatrixSets;
+			textureBinds += other.textureBinds;
+			redundantTextureBinds += other.redundantTextureBinds;
+			clears += other.clears;
+			targetSets += other.targetSets;
+			cameraSets += other.cameraSets;
+			mergeableDraws += other.mergeableDraws;
+			uploadBytes += other.uploadBytes;
+			uploads += other.uploads;
+			coverage += other.coverage;
+		}
+	};
+
+	struct FrameStats
+	{
+		uint32_t index = 0;
+		PassStats passes[ kNumPasses ];
+
+		PassStats Total() const
+		{
+			PassStats total;
+			for ( const PassStats& pass : passes ) total.Add( pass );
+			return total;
+		}
+	};
+
+	struct Capture
+	{
+		RenderCaptureHeader header;
+		std::vector< FrameStats > frames;
+	};
+
+	bool LoadCapture( const char* pPath, Capture& capture )
+	{
+		std::ifstream file( pPath, std::ios::binary );
+		if ( !file )
+		{
+			std::fprintf( stderr, "Unable to open %s\n", pPath );
+			return false;
+		}
+
+		file.read( reinterpret_cast< char* >(&capture.header), sizeof( capture.header ) );
+		if ( !file || capture.header.magic != kRenderCaptureMagic || capture.header.version != kRenderCaptureVersion )
+		{
+			std::fprintf( stderr, "%s is not a version %u render capture\n", pPath, kRenderCaptureVersion );
+			return false;
+		}
+
+		FrameStats frame;
+		bool bInFrame = false;
+		uint32_t boundMaterial = ~0u;
+		uint32_t lastDrawMesh = ~0u;
+		uint32_t lastDrawMaterial = ~0u;
+		std::map< uint32_t, uint32_t > boundBuffers; // slot -> buffer
+		std::map< uint32_t, uint32_t > boundTextures; // slot -> texture
+		std::set< std::pair< uint32_t, uint32_t > > passStates;
+
+		RenderCaptureRecord record;
+		while ( file.read( reinterpret_cast< char* >(&record), sizeof( record ) ) )
+		{
+			if ( record.op >= RenderCaptureOp::kNumOps )
+			{
+				std::fprintf( stderr, "%s: unknown record %u, stopping\n", pPath, static_cast< unsigned >(record.op) );
+				break;
+			}
+
+			PassStats& pass = frame.passes[ PassSlot( record.pass ) ];
+			switch ( record.op )
+			{
+			case RenderCaptureOp::kFrameBegin:
+				frame = {};
+				frame.index = record.a;
+				bInFrame = true;
+				boundMaterial = ~0u;
+				boundBuffers.clear();
+				boundTextures.clear();
+				break;
+			case RenderCaptureOp::kFrameEnd:
+				if ( bInFrame ) capture.frames.push_back( frame );
+				bInFrame = false;
+				break;
+			case RenderCaptureOp::kPassBegin:
+				// The renderer does not assume state survives a pass boundary.
+				lastDrawMesh = ~0u;
+				lastDrawMaterial = ~0u;
+				passStates.clear();
+				break;
+			case RenderCaptureOp::kMeshCommand:
+				pass.commands++;
+				pass.coverage += record.coverage;
+				if ( passStates.insert( { record.a, record.b } ).second ) pass.uniqueStates++;
+				break;
+			case RenderCaptureOp::kParticleCommand:
+				break;
+			case RenderCaptureOp::kSetMaterial:
+				pass.materialSets++;
+				if ( record.a == boundMaterial ) pass.redundantMaterialSets++;
+				boundMaterial = record.a;
+				break;
+			case RenderCaptureOp::kSetWorldMatrix:
+				pass.worldMatrixSets++;
+				break;
+			case RenderCaptureOp::kBindBuffer:
+			{
+				pass.bufferBinds++;
+				auto it = boundBuffers.find( record.a );
+				if ( it != boundBuffers.end() && it->second == record.b ) pass.redundantBufferBinds++;
+				boundBuffers[ record.a ] = record.b;
+				break;
+			}
+			case RenderCaptureOp::kUpdateBuffer:
+				pass.uploads++;
+				pass.uploadBytes += record.b;
+				break;
+			case RenderCaptureOp::kDrawMesh:
+				pass.drawCalls++;
+				pass.instances++;
+				if ( record.a == lastDrawMesh && record.b == lastDrawMaterial ) pass.mergeableDraws++;
+				lastDrawMesh = record.a;
+				lastDrawMaterial = record.b;
+				break;
+			case RenderCaptureOp::kDrawInstancedMesh:
+				pass.drawCalls++;
+				pass.instancedDraws++;
+				pass.instances += record.c;
+				lastDrawMesh = record.a;
+				lastDrawMaterial = record.b;
+				break;
+			case RenderCaptureOp::kDrawWithoutVertices:
+				pass.drawCalls++;
+				pass.particleDraws++;
+				lastDrawMesh = ~0u;
+				break;
+			case RenderCaptureOp::kBindTexture:
+			{
+				pass.textureBinds++;
+				auto it = boundTextures.find( record.a );
+				if ( it != boundTextures.end() && it->second == record.b ) pass.redundantTextureBinds++;
+				boundTextures[ record.a ] = record.b;
+				break;
+			}
+			case RenderCaptureOp::kClearTarget:
+				pass.clears++;
+				break;
+			case RenderCaptureOp::kSetTargets:
+				pass.targetSets++;
+				break;
+			case RenderCaptureOp::kSetViewport:
+			case RenderCaptureOp::kSetViewMatrix:
+			case RenderCaptureOp::kSetProjectionMatrix:
+				pass.cameraSets++;
+				break;
+			default:
+				break;
+			}
+		}
+
+		if ( capture.frames.empty() )
+		{
+			std::fprintf( stderr, "%s has no complete frames\n", pPath );
+			return false;
+		}
+		return true;
+	}
+
+	void PrintSummary( const char* pPath, const Capture& capture )
+	{
+		const double frameCount = static_cast< double >(capture.frames.size());
+		const double screenArea = static_cast< double >(capture.header.screenWidth) * capture.header.screenHeight;
+		std::printf( "%s: %zu frames at %ux%u, averages per frame\n", pPath, capture.frames.size(), capture.header.screenWidth, capture.header.screenHeight );
+		std::printf( "  %-8s %8s %8s %8s %9s %10s %12s %12s %12s %7s %8s %8s %10s %10s %10s\n",
+			"pass", "commands", "states", "draws", "instanced", "instances", "mat sets", "buf binds", "tex binds", "clears", "targets", "cameras", "mergeable", "overdraw", "upload KB" );
+
+		for ( int passIndex = 0; passIndex < kNumPasses; passIndex++ )
+		{
+			PassStats sum;
+			for ( const FrameStats& frame : capture.frames ) sum.Add( frame.passes[ passIndex ] );
+			if ( sum.commands == 0 && sum.drawCalls == 0 && sum.uploads == 0 && sum.targetSets == 0 && sum.cameraSets == 0 ) continue;
+
+			char materialSets[ 32 ];
+			char bufferBinds[ 32 ];
+			char textureBinds[ 32 ];
+			std::snprintf( materialSets, sizeof( materialSets ), "%.1f (%.1f)", sum.materialSets / frameCount, sum.redundantMaterialSets / frameCount );
+			std::snprintf( bufferBinds, sizeof( bufferBinds ), "%.1f (%.1f)", sum.bufferBinds / frameCount, sum.redundantBufferBinds / frameCount );
+			std::snprintf( textureBinds, sizeof( textureBinds ), "%.1f (%.1f)", sum.textureBinds / frameCount, sum.redundantTextureBinds / frameCount );
+
+			std::printf( "  %-8s %8.1f %8.1f %8.1f %9.1f %10.1f %12s %12s %12s %7.1f %8.1f %8.1f %10.1f %10.2f %10.1f\n",
+				kPassNames[ passIndex ],
+				sum.commands / frameCount,
+				sum.uniqueStates / frameCount,
+				sum.drawCalls / frameCount,
+				sum.instancedDraws / frameCount,
+				sum.instances / frameCount,
+				materialSets,
+				bufferBinds,
+				textureBinds,
+				sum.clears / frameCount,
+				sum.targetSets / frameCount,
+				sum.cameraSets / frameCount,
+				sum.mergeableDraws / frameCount,
+				sum.coverage / frameCount,
+				sum.uploadBytes / 1024.0 / frameCount );
+		}
+		std::printf( "  (redundant sets in brackets, states = minimum draws with full instancing,\n"
+			"   cameras = viewport, view and projection sets, forward includes the post-processing draw,\n"
+			"   overdraw = summed bounding sphere coverage of the viewport, %.0f pixels)\n"
+			"  Not captured: the skybox, UI text and debug primitives, which Play3d draws with its own state.\n", screenArea );
+	}
+
+	void PrintFrames( const Capture& capture )
+	{
+		std::printf( "  %6s %8s %8s %10s %10s\n", "frame", "commands", "draws", "overdraw", "upload KB" );
+		for ( const FrameStats& frame : capture.frames )
+		{
+			PassStats total = frame.Total();
+			std::printf( "  %6u %8u %8u %10.2f %10.1f\n", frame.index, total.commands, total.drawCalls, total.coverage, total.uploadBytes / 1024.0 );
+		}
+	}
+
+	void PrintComparison( const Capture& capture, const Capture& baseline )
+	{
+		std::printf( "frame by frame against the baseline (capture - baseline)\n" );
+		std::printf( "  %6s %10s %10s %12s\n", "frame", "commands", "draws", "upload KB" );
+
+		const size_t frameCount = std::min( capture.frames.size(), baseline.frames.size() );
+		for ( size_t i = 0; i < frameCount; i++ )
+		{
+			PassStats a = capture.frames[ i ].Total();
+			PassStats b = baseline.frames[ i ].Total();
+			std::printf( "  %6zu %+10d %+10d %+12.1f\n", i,
+				static_cast< int >(a.commands) - static_cast< int >(b.commands),
+				static_cast< int >(a.drawCalls) - static_cast< int >(b.drawCalls),
+				( static_cast< double >(a.uploadBytes) - static_cast< double >(b.uploadBytes) ) / 1024.0 );
+		}
+		if ( capture.frames.size() != baseline.frames.size() )
+		{
+			std::printf( "  frame counts differ (%zu against %zu), compared the first %zu\n", capture.frames.size(), baseline.frames.size(), frameCount );
+		}
+	}
+}
+
+int main( int argc, char** argv )
+{
+	std::vector< const char* > paths;
+	bool bPerFrame = false;
+	for ( int i = 1; i < argc; i++ )
+	{
+		if ( std::strcmp( argv[ i ], "--frames" ) == 0 ) bPerFrame = true;
+		else paths.push_back( argv[ i ] );
+	}
+
+	if ( paths.empty() || paths.size() > 2 )
+	{
+		std::fprintf( stderr, "Usage: %s <capture.rcap> [baseline.rcap] [--frames]\n", argv[ 0 ] );
+		return 1;
+	}
+
+	std::vector< Capture > captures( paths.size() );
+	for ( size_t i = 0; i < paths.size(); i++ )
+	{
+		if ( !LoadCapture( paths[ i ], captures[ i ] ) ) return 1;
+		PrintSummary( paths[ i ], captures[ i ] );
+		if ( bPerFrame ) PrintFrames( captures[ i ] );
+	}
+
+	if ( captures.size() == 2 )
+	{
+		PrintComparison( captures[ 0 ], captures[ 1 ] );
+	}
+	return 0;
+}
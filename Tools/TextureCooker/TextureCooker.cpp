@@ -0,0 +1,889 @@
+///////////////////////////////////////////////////////////////////////////
+//	File		: TextureCooker.cpp
+//	Platform	: All
+//
+//	Converts .png textures to block compressed .dds files with a full mip chain
+//	built offline, which Graphics::AcquireTextureFromFile loads in place of the
+//	.png next to them. Has no dependencies beyond the standard library, on Linux:
+//		g++ -std=c++20 -O2 -o TextureCooker TextureCooker.cpp
+//
+//	Usage: TextureCooker [options] <file.png | directory>...
+//		--format bc1|bc3|bc5|bc7	override the format picked from the role
+//		--role colour|normal|data	override the role guessed from the file name
+//		--no-mips			write the top level only
+//		--force				cook files whose .dds is newer than the .png
+//
+//	Roles: colour textures get BC7 sRGB with mips filtered in linear light,
+//	normal maps BC5 with renormalised mips (the shader rebuilds z), anything
+//	else (ORM, masks) BC7 linear.
+//
+//	Copyright (C) Sumo Digital Ltd. All rights reserved.
+///////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+	//------------------------------------------------------------------
+	// Inflate, enough of RFC 1951 for the zlib stream inside a png.
+	//------------------------------------------------------------------
+
+	class BitReader
+	{
+	public:
+		BitReader( const uint8_t* pData, size_t size ) : m_pData( pData ), m_size( size ) {}
+
+		uint32_t Bits( int count )
+		{
+			while ( m_bitCount < count )
+			{
+				uint32_t byte = 0;
+				if ( m_pos < m_size ) byte = m_pData[ m_pos++ ];
+				else m_bOverrun = true;
+				m_bitBuffer |= byte << m_bitCount;
+				m_bitCount += 8;
+			}
+			uint32_t value = m_bitBuffer & ( ( 1u << count ) - 1 );
+			m_bitBuffer >>= count;
+			m_bitCount -= count;
+			return value;
+		}
+
+		// Bits left in the buffer all belong to the current byte.
+		void AlignToByte() { m_bitBuffer = 0; m_bitCount = 0; }
+		bool Overrun() const { return m_bOverrun; }
+
+	private:
+		const uint8_t* m_pData;
+		size_t m_size;
+		size_t m_pos = 0;
+		uint32_t m_bitBuffer = 0;
+		int m_bitCount = 0;
+		bool m_bOverrun = false;
+	};
+
+	struct Huffman
+	{
+		uint16_t counts[ 16 ] = {};
+		uint16_t symbols[ 288 ] = {};
+
+		void Build( const uint8_t* pLengths, int count )
+		{
+			std::fill( std::begin( counts ), std::end( counts ), uint16_t( 0 ) );
+			for ( int i = 0; i < count; i++ ) counts[ pLengths[ i ] ]++;
+			counts[ 0 ] = 0;
+
+			uint16_t offsets[ 16 ] = {};
+			for ( int i = 1; i < 16; i++ ) offsets[ i ] = offsets[ i - 1 ] + counts[ i - 1 ];
+			for ( int i = 0; i < count; i++ )
+			{
+				if ( pLengths[ i ] ) symbols[ offsets[ pLengths[ i ] ]++ ] = static_cast< uint16_t >(i);
+			}
+		}
+
+		// Canonical codes, read a bit at a time.
+		int Decode( BitReader& bits ) const
+		{
+			int code = 0, first = 0, index = 0;
+			for ( int length = 1; length < 16; length++ )
+			{
+				code |= static_cast< int >(bits.Bits( 1 ));
+				int count = counts[ length ];
+				if ( code - first < count ) return symbols[ index + code - first ];
+				index += count;
+				first = ( first + count ) << 1;
+				code <<= 1;
+			}
+			return -1;
+		}
+	};
+
+	constexpr uint16_t kLengthBase[ 29 ] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+	constexpr uint8_t kLengthExtra[ 29 ] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+	constexpr uint16_t kDistanceBase[ 30 ] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+	constexpr uint8_t kDistanceExtra[ 30 ] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+	bool InflateBlock( BitReader& bits, const Huffman& lengths, const Huffman& distances, std::vector< uint8_t >& out )
+	{
+		for ( ;; )
+		{
+			int symbol = lengths.Decode( bits );
+			if ( symbol < 0 || bits.Overrun() ) return false;
+			if ( symbol < 256 )
+			{
+				out.push_back( static_cast< uint8_t >(symbol) );
+				continue;
+			}
+			if ( symbol == 256 ) return true;
+
+			symbol -= 257;
+			if ( symbol >= 29 ) return false;
+			size_t length = kLengthBase[ symbol ] + bits.Bits( kLengthExtra[ symbol ] );
+			int distanceSymbol = distances.Decode( bits );
+			if ( distanceSymbol < 0 || distanceSymbol >= 30 ) return false;
+			size_t distance = kDistanceBase[ distanceSymbol ] + bits.Bits( kDistanceExtra[ distanceSymbol ] );
+			if ( distance > out.size() ) return false;
+
+			size_t from = out.size() - distance;
+			for ( size_t i = 0; i < length; i++ ) out.push_back( out[ from + i ] );
+		}
+	}
+
+	bool Inflate( const uint8_t* pData, size_t size, std::vector< uint8_t >& out )
+	{
+		// zlib header, deflate with no preset dictionary. The adler checksum at the end is not checked.
+		if ( size < 2 || ( pData[ 0 ] & 0x0f ) != 8 || ( pData[ 1 ] & 0x20 ) ) return false;
+		BitReader bits( pData + 2, size - 2 );
+
+		bool bFinal = false;
+		while ( !bFinal )
+		{
+			bFinal = bits.Bits( 1 ) != 0;
+			uint32_t type = bits.Bits( 2 );
+			if ( type == 0 )
+			{
+				bits.AlignToByte();
+				uint32_t length = bits.Bits( 16 );
+				uint32_t inverse = bits.Bits( 16 );
+				if ( ( length ^ 0xffff ) != inverse ) return false;
+				for ( uint32_t i = 0; i < length; i++ ) out.push_back( static_cast< uint8_t >(bits.Bits( 8 )) );
+			}
+			else if ( type == 1 )
+			{
+				uint8_t lengths[ 288 ];
+				std::fill( lengths, lengths + 144, uint8_t( 8 ) );
+				std::fill( lengths + 144, lengths + 256, uint8_t( 9 ) );
+				std::fill( lengths + 256, lengths + 280, uint8_t( 7 ) );
+				std::fill( lengths + 280, lengths + 288, uint8_t( 8 ) );
+				uint8_t distanceLengths[ 30 ];
+				std::fill( std::begin( distanceLengths ), std::end( distanceLengths ), uint8_t( 5 ) );
+
+				Huffman literal, distance;
+				literal.Build( lengths, 288 );
+				distance.Build( distanceLengths, 30 );
+				if ( !InflateBlock( bits, literal, distance, out ) ) return false;
+			}
+			else if ( type == 2 )
+			{
+				static constexpr uint8_t kCodeOrder[ 19 ] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+				uint32_t literalCount = bits.Bits( 5 ) + 257;
+				uint32_t distanceCount = bits.Bits( 5 ) + 1;
+				uint32_t codeCount = bits.Bits( 4 ) + 4;
+
+				uint8_t codeLengths[ 19 ] = {};
+				for ( uint32_t i = 0; i < codeCount; i++ ) codeLengths[ kCodeOrder[ i ] ] = static_cast< uint8_t >(bits.Bits( 3 ));
+				Huffman codes;
+				codes.Build( codeLengths, 19 );
+
+				uint8_t lengths[ 288 + 32 ] = {};
+				for ( uint32_t i = 0; i < literalCount + distanceCount; )
+				{
+					int symbol = codes.Decode( bits );
+					if ( symbol < 0 || bits.Overrun() ) return false;
+					if ( symbol < 16 )
+					{
+						lengths[ i++ ] = static_cast< uint8_t >(symbol);
+						continue;
+					}
+
+					uint8_t repeated = 0;
+					uint32_t count = 0;
+					if ( symbol == 16 )
+					{
+						if ( i == 0 ) return false;
+						repeated = lengths[ i - 1 ];
+						count = 3 + bits.Bits( 2 );
+					}
+					else if ( symbol == 17 ) count = 3 + bits.Bits( 3 );
+					else count = 11 + bits.Bits( 7 );
+					if ( i + count > literalCount + distanceCount ) return false;
+					while ( count-- ) lengths[ i++ ] = repeated;
+				}
+
+				Huffman literal, distance;
+				literal.Build( lengths, static_cast< int >(literalCount) );
+				distance.Build( lengths + literalCount, static_cast< int >(distanceCount) );
+				if ( !InflateBlock( bits, literal, distance, out ) ) return false;
+			}
+			else
+			{
+				return false;
+			}
+			if ( bits.Overrun() ) return false;
+		}
+		return true;
+	}
+
+	//------------------------------------------------------------------
+	// Png, every non-interlaced colour type decoded to RGBA8.
+	//------------------------------------------------------------------
+
+	struct Image
+	{
+		uint32_t width = 0;
+		uint32_t height = 0;
+		std::vector< uint8_t > rgba;
+	};
+
+	uint32_t ReadBE32( const uint8_t* p ) { return ( uint32_t( p[ 0 ] ) << 24 ) | ( uint32_t( p[ 1 ] ) << 16 ) | ( uint32_t( p[ 2 ] ) << 8 ) | p[ 3 ]; }
+
+	uint8_t Paeth( int a, int b, int c )
+	{
+		int p = a + b - c;
+		int pa = std::abs( p - a ), pb = std::abs( p - b ), pc = std::abs( p - c );
+		if ( pa <= pb && pa <= pc ) return static_cast< uint8_t >(a);
+		return static_cast< uint8_t >(pb <= pc ? b : c);
+	}
+
+	bool LoadPng( const std::filesystem::path& path, Image& image )
+	{
+		std::ifstream file( path, std::ios::binary );
+		std::vector< uint8_t > data( ( std::istreambuf_iterator< char >( file ) ), std::istreambuf_iterator< char >() );
+		static constexpr uint8_t kSignature[ 8 ] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+		if ( data.size() < 8 || std::memcmp( data.data(), kSignature, 8 ) != 0 )
+		{
+			std::fprintf( stderr, "%s: not a png\n", path.string().c_str() );
+			return false;
+		}
+
+		uint32_t bitDepth = 0, colourType = 0, interlace = 0;
+		std::vector< uint8_t > compressed;
+		std::vector< uint8_t > palette;
+		std::vector< uint8_t > paletteAlpha;
+		for ( size_t pos = 8; pos + 12 <= data.size(); )
+		{
+			uint32_t length = ReadBE32( &data[ pos ] );
+			const uint8_t* pType = &data[ pos + 4 ];
+			const uint8_t* pChunk = &data[ pos + 8 ];
+			if ( pos + 12 + static_cast< size_t >(length) > data.size() ) break;
+
+			if ( std::memcmp( pType, "IHDR", 4 ) == 0 && length >= 13 )
+			{
+				image.width = ReadBE32( pChunk );
+				image.height = ReadBE32( pChunk + 4 );
+				bitDepth = pChunk[ 8 ];
+				colourType = pChunk[ 9 ];
+				interlace = pChunk[ 12 ];
+			}
+			else if ( std::memcmp( pType, "PLTE", 4 ) == 0 ) palette.assign( pChunk, pChunk + length );
+			else if ( std::memcmp( pType, "tRNS", 4 ) == 0 ) paletteAlpha.assign( pChunk, pChunk + length );
+			else if ( std::memcmp( pType, "IDAT", 4 ) == 0 ) compressed.insert( compressed.end(), pChunk, pChunk + length );
+			else if ( std::memcmp( pType, "IEND", 4 ) == 0 ) break;
+			pos += 12 + static_cast< size_t >(length);
+		}
+
+		static constexpr uint32_t kChannels[ 7 ] = { 1, 0, 3, 1, 2, 0, 4 };
+		if ( image.width == 0 || image.height == 0 || colourType > 6 || kChannels[ colourType ] == 0 || interlace != 0 )
+		{
+			std::fprintf( stderr, "%s: unsupported png (colour type %u, interlace %u)\n", path.string().c_str(), colourType, interlace );
+			return false;
+		}
+
+		std::vector< uint8_t > raw;
+		if ( !Inflate( compressed.data(), compressed.size(), raw ) )
+		{
+			std::fprintf( stderr, "%s: corrupt image data\n", path.string().c_str() );
+			return false;
+		}
+
+		const uint32_t bitsPerPixel = kChannels[ colourType ] * bitDepth;
+		const size_t stride = ( static_cast< size_t >(image.width) * bitsPerPixel + 7 ) / 8;
+		const size_t filterBytes = std::max< size_t >( 1, bitsPerPixel / 8 );
+		if ( raw.size() < ( stride + 1 ) * image.height )
+		{
+			std::fprintf( stderr, "%s: image data is short\n", path.string().c_str() );
+			return false;
+		}
+
+		// Undo the per-row filters in place, the filter byte leads each row.
+		std::vector< uint8_t > previous( stride, 0 );
+		for ( uint32_t y = 0; y < image.height; y++ )
+		{
+			uint8_t filter = raw[ y * ( stride + 1 ) ];
+			uint8_t* pRow = &raw[ y * ( stride + 1 ) + 1 ];
+			for ( size_t x = 0; x < stride; x++ )
+			{
+				int left = x >= filterBytes ? pRow[ x - filterBytes ] : 0;
+				int up = previous[ x ];
+				int upLeft = x >= filterBytes ? previous[ x - filterBytes ] : 0;
+				switch ( filter )
+				{
+				case 1: pRow[ x ] = static_cast< uint8_t >(pRow[ x ] + left); break;
+				case 2: pRow[ x ] = static_cast< uint8_t >(pRow[ x ] + up); break;
+				case 3: pRow[ x ] = static_cast< uint8_t >(pRow[ x ] + ( ( left + up ) >> 1 )); break;
+				case 4: pRow[ x ] = static_cast< uint8_t >(pRow[ x ] + Paeth( left, up, upLeft )); break;
+				default: break;
+				}
+			}
+			std::memcpy( previous.data(), pRow, stride );
+		}
+
+		// Samples are read at their top eight bits, palette indices and sub-byte greys are widened.
+		auto sample = [ & ]( const uint8_t* pRow, uint32_t index ) -> uint32_t
+		{
+			if ( bitDepth == 8 ) return pRow[ index ];
+			if ( bitDepth == 16 ) return pRow[ index * 2 ];
+			uint32_t bit = index * bitDepth;
+			uint32_t value = ( pRow[ bit / 8 ] >> ( 8 - bitDepth - bit % 8 ) ) & ( ( 1u << bitDepth ) - 1 );
+			return colourType == 3 ? value : value * 255 / ( ( 1u << bitDepth ) - 1 );
+		};
+
+		image.rgba.resize( static_cast< size_t >(image.width) * image.height * 4 );
+		for ( uint32_t y = 0; y < image.height; y++ )
+		{
+			const uint8_t* pRow = &raw[ y * ( stride + 1 ) + 1 ];
+			for ( uint32_t x = 0; x < image.width; x++ )
+			{
+				uint8_t* pOut = &image.rgba[ ( static_cast< size_t >(y) * image.width + x ) * 4 ];
+				const uint32_t channels = kChannels[ colourType ];
+				uint32_t c[ 4 ] = {};
+				for ( uint32_t i = 0; i < channels; i++ ) c[ i ] = sample( pRow, x * channels + i );
+
+				switch ( colourType )
+				{
+				case 0: pOut[ 0 ] = pOut[ 1 ] = pOut[ 2 ] = static_cast< uint8_t >(c[ 0 ]); pOut[ 3 ] = 255; break;
+				case 2: pOut[ 0 ] = static_cast< uint8_t >(c[ 0 ]); pOut[ 1 ] = static_cast< uint8_t >(c[ 1 ]); pOut[ 2 ] = static_cast< uint8_t >(c[ 2 ]); pOut[ 3 ] = 255; break;
+				case 3:
+					for ( int i = 0; i < 3; i++ ) pOut[ i ] = c[ 0 ] * 3 + i < palette.size() ? palette[ c[ 0 ] * 3 + i ] : 0;
+					pOut[ 3 ] = c[ 0 ] < paletteAlpha.size() ? paletteAlpha[ c[ 0 ] ] : 255;
+					break;
+				case 4: pOut[ 0 ] = pOut[ 1 ] = pOut[ 2 ] = static_cast< uint8_t >(c[ 0 ]); pOut[ 3 ] = static_cast< uint8_t >(c[ 1 ]); break;
+				case 6: for ( int i = 0; i < 4; i++ ) pOut[ i ] = static_cast< uint8_t >(c[ i ]); break;
+				}
+			}
+		}
+		return true;
+	}
+
+	//------------------------------------------------------------------
+	// Mips
+	//------------------------------------------------------------------
+
+	enum class Role { kColour, kNormal, kData };
+
+	float SrgbToLinear( float c ) { return c <= 0.04045f ? c / 12.92f : std::pow( ( c + 0.055f ) / 1.055f, 2.4f ); }
+	float LinearToSrgb( float c ) { return c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow( c, 1.f / 2.4f ) - 0.055f; }
+	uint8_t ToByte( float c ) { return static_cast< uint8_t >(std::clamp( c, 0.f, 1.f ) * 255.f + 0.5f); }
+
+	// Box filters a level down, odd sizes clamp at the edge. Colour averages in linear light and
+	// normals are renormalised so mips do not shrink towards flat.
+	Image Downsample( const Image& source, Role role )
+	{
+		Image mip;
+		mip.width = std::max( 1u, source.width / 2 );
+		mip.height = std::max( 1u, source.height / 2 );
+		mip.rgba.resize( static_cast< size_t >(mip.width) * mip.height * 4 );
+
+		for ( uint32_t y = 0; y < mip.height; y++ )
+		{
+			for ( uint32_t x = 0; x < mip.width; x++ )
+			{
+				float sum[ 4 ] = {};
+				for ( uint32_t dy = 0; dy < 2; dy++ )
+				{
+					for ( uint32_t dx = 0; dx < 2; dx++ )
+					{
+						uint32_t sx = std::min( x * 2 + dx, source.width - 1 );
+						uint32_t sy = std::min( y * 2 + dy, source.height - 1 );
+						const uint8_t* p = &source.rgba[ ( static_cast< size_t >(sy) * source.width + sx ) * 4 ];
+						for ( int c = 0; c < 4; c++ )
+						{
+							float v = p[ c ] / 255.f;
+							if ( role == Role::kColour && c < 3 ) v = SrgbToLinear( v );
+							else if ( role == Role::kNormal && c < 3 ) v = v * 2.f - 1.f;
+							sum[ c ] += v * 0.25f;
+						}
+					}
+				}
+
+				uint8_t* pOut = &mip.rgba[ ( static_cast< size_t >(y) * mip.width + x ) * 4 ];
+				if ( role == Role::kNormal )
+				{
+					float length = std::sqrt( sum[ 0 ] * sum[ 0 ] + sum[ 1 ] * sum[ 1 ] + sum[ 2 ] * sum[ 2 ] );
+					float scale = length > 1e-6f ? 1.f / length : 0.f;
+					for ( int c = 0; c < 3; c++ ) pOut[ c ] = ToByte( sum[ c ] * scale * 0.5f + 0.5f );
+				}
+				else
+				{
+					for ( int c = 0; c < 3; c++ ) pOut[ c ] = ToByte( role == Role::kColour ? LinearToSrgb( sum[ c ] ) : sum[ c ] );
+				}
+				pOut[ 3 ] = ToByte( sum[ 3 ] );
+			}
+		}
+		return mip;
+	}
+
+	//------------------------------------------------------------------
+	// Block compression, each encoder takes a 4x4 block of RGBA8.
+	//------------------------------------------------------------------
+
+	enum class Format { kBC1, kBC3, kBC5, kBC7 };
+
+	uint32_t BlockBytes( Format format ) { return format == Format::kBC1 ? 8 : 16; }
+
+	struct Block
+	{
+		uint8_t pixels[ 16 ][ 4 ];
+	};
+
+	// Principal axis of the block's colours by power iteration, the endpoints are the extreme projections.
+	void FindEndpoints( const Block& block, int channels, float lo[ 4 ], float hi[ 4 ] )
+	{
+		float mean[ 4 ] = {};
+		for ( const auto& p : block.pixels ) for ( int c = 0; c < channels; c++ ) mean[ c ] += p[ c ] / 16.f;
+
+		float cov[ 4 ][ 4 ] = {};
+		for ( const auto& p : block.pixels )
+		{
+			for ( int i = 0; i < channels; i++ )
+			{
+				for ( int j = 0; j < channels; j++ ) cov[ i ][ j ] += ( p[ i ] - mean[ i ] ) * ( p[ j ] - mean[ j ] );
+			}
+		}
+
+		float axis[ 4 ] = { 1.f, 1.f, 1.f, 1.f };
+		for ( int iteration = 0; iteration < 8; iteration++ )
+		{
+			float next[ 4 ] = {};
+			for ( int i = 0; i < channels; i++ ) for ( int j = 0; j < channels; j++ ) next[ i ] += cov[ i ][ j ] * axis[ j ];
+			float length = 0.f;
+			for ( int i = 0; i < channels; i++ ) length = std::max( length, std::fabs( next[ i ] ) );
+			if ( length < 1e-6f ) break;
+			for ( int i = 0; i < channels; i++ ) axis[ i ] = next[ i ] / length;
+		}
+
+		float minT = 1e9f, maxT = -1e9f;
+		for ( const auto& p : block.pixels )
+		{
+			float t = 0.f;
+			for ( int c = 0; c < channels; c++ ) t += ( p[ c ] - mean[ c ] ) * axis[ c ];
+			minT = std::min( minT, t );
+			maxT = std::max( maxT, t );
+		}
+
+		float axisLengthSq = 0.f;
+		for ( int c = 0; c < channels; c++ ) axisLengthSq += axis[ c ] * axis[ c ];
+		if ( axisLengthSq < 1e-6f ) axisLengthSq = 1.f;
+		for ( int c = 0; c < channels; c++ )
+		{
+			lo[ c ] = std::clamp( mean[ c ] + axis[ c ] * minT / axisLengthSq, 0.f, 255.f );
+			hi[ c ] = std::clamp( mean[ c ] + axis[ c ] * maxT / axisLengthSq, 0.f, 255.f );
+		}
+	}
+
+	uint16_t To565( const float c[ 3 ] )
+	{
+		return static_cast< uint16_t >(( ( static_cast< int >(c[ 0 ] * 31.f / 255.f + 0.5f) ) << 11 ) | ( ( static_cast< int >(c[ 1 ] * 63.f / 255.f + 0.5f) ) << 5 )
+			| static_cast< int >(c[ 2 ] * 31.f / 255.f + 0.5f));
+	}
+
+	void From565( uint16_t v, int out[ 3 ] )
+	{
+		int r = ( v >> 11 ) & 31, g = ( v >> 5 ) & 63, b = v & 31;
+		out[ 0 ] = ( r << 3 ) | ( r >> 2 );
+		out[ 1 ] = ( g << 2 ) | ( g >> 4 );
+		out[ 2 ] = ( b << 3 ) | ( b >> 2 );
+	}
+
+	// Always the four colour mode, which BC3 requires and opaque BC1 wants.
+	void EncodeBC1Colour( const Block& block, uint8_t* pOut )
+	{
+		float lo[ 4 ], hi[ 4 ];
+		FindEndpoints( block, 3, lo, hi );
+		uint16_t c0 = To565( hi ), c1 = To565( lo );
+		if ( c0 < c1 ) std::swap( c0, c1 );
+
+		uint32_t indices = 0;
+		if ( c0 != c1 )
+		{
+			int e0[ 3 ], e1[ 3 ], palette[ 4 ][ 3 ];
+			From565( c0, e0 );
+			From565( c1, e1 );
+			for ( int c = 0; c < 3; c++ )
+			{
+				palette[ 0 ][ c ] = e0[ c ];
+				palette[ 1 ][ c ] = e1[ c ];
+				palette[ 2 ][ c ] = ( 2 * e0[ c ] + e1[ c ] ) / 3;
+				palette[ 3 ][ c ] = ( e0[ c ] + 2 * e1[ c ] ) / 3;
+			}
+			for ( int i = 0; i < 16; i++ )
+			{
+				int best = 0, bestError = INT32_MAX;
+				for ( int j = 0; j < 4; j++ )
+				{
+					int error = 0;
+					for ( int c = 0; c < 3; c++ ) error += ( block.pixels[ i ][ c ] - palette[ j ][ c ] ) * ( block.pixels[ i ][ c ] - palette[ j ][ c ] );
+					if ( error < bestError ) { bestError = error; best = j; }
+				}
+				indices |= static_cast< uint32_t >(best) << ( i * 2 );
+			}
+		}
+
+		pOut[ 0 ] = static_cast< uint8_t >(c0); pOut[ 1 ] = static_cast< uint8_t >(c0 >> 8);
+		pOut[ 2 ] = static_cast< uint8_t >(c1); pOut[ 3 ] = static_cast< uint8_t >(c1 >> 8);
+		std::memcpy( pOut + 4, &indices, 4 );
+	}
+
+	// Eight value mode between the channel's extremes.
+	void EncodeBC4( const Block& block, int channel, uint8_t* pOut )
+	{
+		int lo = 255, hi = 0;
+		for ( const auto& p : block.pixels ) { lo = std::min< int >( lo, p[ channel ] ); hi = std::max< int >( hi, p[ channel ] ); }
+
+		int palette[ 8 ] = { hi, lo };
+		for ( int i = 1; i < 7; i++ ) palette[ i + 1 ] = ( ( 7 - i ) * hi + i * lo ) / 7;
+
+		uint64_t indices = 0;
+		if ( hi != lo )
+		{
+			for ( int i = 0; i < 16; i++ )
+			{
+				int best = 0, bestError = INT32_MAX;
+				for ( int j = 0; j < 8; j++ )
+				{
+					int error = std::abs( block.pixels[ i ][ channel ] - palette[ j ] );
+					if ( error < bestError ) { bestError = error; best = j; }
+				}
+				indices |= static_cast< uint64_t >(best) << ( i * 3 );
+			}
+		}
+
+		pOut[ 0 ] = static_cast< uint8_t >(hi);
+		pOut[ 1 ] = static_cast< uint8_t >(lo);
+		for ( int i = 0; i < 6; i++ ) pOut[ 2 + i ] = static_cast< uint8_t >(indices >> ( i * 8 ));
+	}
+
+	class BitWriter
+	{
+	public:
+		explicit BitWriter( uint8_t* pOut ) : m_pOut( pOut ) { std::memset( pOut, 0, 16 ); }
+		void Write( uint32_t value, int count )
+		{
+			for ( int i = 0; i < count; i++, m_bit++ )
+			{
+				if ( ( value >> i ) & 1 ) m_pOut[ m_bit / 8 ] |= static_cast< uint8_t >(1 << ( m_bit % 8 ));
+			}
+		}
+
+	private:
+		uint8_t* m_pOut;
+		int m_bit = 0;
+	};
+
+	// BC7 mode 6 only: one subset, RGBA endpoints of 7 bits plus a p-bit each, 4 bit indices.
+	// Less precise than a search over all modes on blocks with several distinct colours, but fast and stable.
+	void EncodeBC7( const Block& block, uint8_t* pOut )
+	{
+		static constexpr int kWeights[ 16 ] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+		float lo[ 4 ], hi[ 4 ];
+		FindEndpoints( block, 4, lo, hi );
+
+		int bestError = INT32_MAX;
+		int bestEndpoints[ 2 ][ 4 ] = {}, bestPBits[ 2 ] = {}, bestIndices[ 16 ] = {};
+		for ( int pBits = 0; pBits < 4; pBits++ )
+		{
+			int p[ 2 ] = { pBits & 1, pBits >> 1 };
+			int quantised[ 2 ][ 4 ], endpoint[ 2 ][ 4 ];
+			for ( int c = 0; c < 4; c++ )
+			{
+				const float* source[ 2 ] = { lo, hi };
+				for ( int e = 0; e < 2; e++ )
+				{
+					quantised[ e ][ c ] = std::clamp( static_cast< int >(std::lround( ( source[ e ][ c ] - p[ e ] ) / 2.f )), 0, 127 );
+					endpoint[ e ][ c ] = ( quantised[ e ][ c ] << 1 ) | p[ e ];
+				}
+			}
+
+			int error = 0, indices[ 16 ];
+			for ( int i = 0; i < 16; i++ )
+			{
+				int bestIndexError = INT32_MAX;
+				for ( int j = 0; j < 16; j++ )
+				{
+					int indexError = 0;
+					for ( int c = 0; c < 4; c++ )
+					{
+						int v = ( ( 64 - kWeights[ j ] ) * endpoint[ 0 ][ c ] + kWeights[ j ] * endpoint[ 1 ][ c ] + 32 ) >> 6;
+						indexError += ( block.pixels[ i ][ c ] - v ) * ( block.pixels[ i ][ c ] - v );
+					}
+					if ( indexError < bestIndexError ) { bestIndexError = indexError; indices[ i ] = j; }
+				}
+				error += bestIndexError;
+			}
+
+			if ( error < bestError )
+			{
+				bestError = error;
+				std::memcpy( bestEndpoints, quantised, sizeof( quantised ) );
+				std::memcpy( bestPBits, p, sizeof( p ) );
+				std::memcpy( bestIndices, indices, sizeof( indices ) );
+			}
+		}
+
+		// The first index is stored with its top bit implied zero, swapping the endpoints makes it so.
+		if ( bestIndices[ 0 ] & 8 )
+		{
+			for ( int c = 0; c < 4; c++ ) std::swap( bestEndpoints[ 0 ][ c ], bestEndpoints[ 1 ][ c ] );
+			std::swap( bestPBits[ 0 ], bestPBits[ 1 ] );
+			for ( int& index : bestIndices ) index = 15 - index;
+		}
+
+		BitWriter bits( pOut );
+		bits.Write( 1 << 6, 7 );
+		for ( int c = 0; c < 4; c++ )
+		{
+			bits.Write( static_cast< uint32_t >(bestEndpoints[ 0 ][ c ]), 7 );
+			bits.Write( static_cast< uint32_t >(bestEndpoints[ 1 ][ c ]), 7 );
+		}
+		bits.Write( static_cast< uint32_t >(bestPBits[ 0 ]), 1 );
+		bits.Write( static_cast< uint32_t >(bestPBits[ 1 ]), 1 );
+		bits.Write( static_cast< uint32_t >(bestIndices[ 0 ]), 3 );
+		for ( int i = 1; i < 16; i++ ) bits.Write( static_cast< uint32_t >(bestIndices[ i ]), 4 );
+	}
+
+	void EncodeLevel( const Image& image, Format format, std::vector< uint8_t >& out )
+	{
+		const uint32_t blocksX = ( image.width + 3 ) / 4;
+		const uint32_t blocksY = ( image.height + 3 ) / 4;
+		const size_t start = out.size();
+		out.resize( start + static_cast< size_t >(blocksX) * blocksY * BlockBytes( format ) );
+		uint8_t* pOut = out.data() + start;
+
+		for ( uint32_t by = 0; by < blocksY; by++ )
+		{
+			for ( uint32_t bx = 0; bx < blocksX; bx++ )
+			{
+				// Levels smaller than a block repeat their edge pixels.
+				Block block;
+				for ( uint32_t i = 0; i < 16; i++ )
+				{
+					uint32_t x = std::min( bx * 4 + i % 4, image.width - 1 );
+					uint32_t y = std::min( by * 4 + i / 4, image.height - 1 );
+					std::memcpy( block.pixels[ i ], &image.rgba[ ( static_cast< size_t >(y) * image.width + x ) * 4 ], 4 );
+				}
+
+				switch ( format )
+				{
+				case Format::kBC1: EncodeBC1Colour( block, pOut ); break;
+				case Format::kBC3: EncodeBC4( block, 3, pOut ); EncodeBC1Colour( block, pOut + 8 ); break;
+				case Format::kBC5: EncodeBC4( block, 0, pOut ); EncodeBC4( block, 1, pOut + 8 ); break;
+				case Format::kBC7: EncodeBC7( block, pOut ); break;
+				}
+				pOut += BlockBytes( format );
+			}
+		}
+	}
+
+	//------------------------------------------------------------------
+	// Dds with the DX10 header, laid out as Play3d's DDSFileFormat.h.
+	//------------------------------------------------------------------
+
+	uint32_t DxgiFormat( Format format, bool bSrgb )
+	{
+		switch ( format )
+		{
+		case Format::kBC1: return bSrgb ? 72 : 71; // DXGI_FORMAT_BC1_UNORM(_SRGB)
+		case Format::kBC3: return bSrgb ? 78 : 77; // DXGI_FORMAT_BC3_UNORM(_SRGB)
+		case Format::kBC5: return 83; // DXGI_FORMAT_BC5_UNORM
+		case Format::kBC7: return bSrgb ? 99 : 98; // DXGI_FORMAT_BC7_UNORM(_SRGB)
+		}
+		return 0;
+	}
+
+	bool WriteDds( const std::filesystem::path& path, uint32_t width, uint32_t height, uint32_t mipCount, uint32_t dxgiFormat,
+		uint32_t topLevelBytes, const std::vector< uint8_t >& data )
+	{
+		uint32_t header[ 1 + 31 + 5 ] = {};
+		header[ 0 ] = 0x20534444; // "DDS "
+		header[ 1 ] = 124;
+		header[ 2 ] = 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000; // caps, height, width, pixel format, mip count, linear size
+		header[ 3 ] = height;
+		header[ 4 ] = width;
+		header[ 5 ] = topLevelBytes;
+		header[ 7 ] = mipCount;
+		header[ 19 ] = 32; // pixel format size
+		header[ 20 ] = 0x4; // fourCC
+		header[ 21 ] = 0x30315844; // "DX10"
+		header[ 27 ] = 0x1000 | ( mipCount > 1 ? 0x400008 : 0 ); // texture, mipmap and complex
+		header[ 32 ] = dxgiFormat;
+		header[ 33 ] = 3; // D3D11_RESOURCE_DIMENSION_TEXTURE2D
+		header[ 35 ] = 1; // array size
+
+		std::ofstream file( path, std::ios::binary );
+		file.write( reinterpret_cast< const char* >(header), sizeof( header ) );
+		file.write( reinterpret_cast< const char* >(data.data()), static_cast< std::streamsize >(data.size()) );
+		return static_cast< bool >(file);
+	}
+
+	//------------------------------------------------------------------
+	// Cooking
+	//------------------------------------------------------------------
+
+	struct Options
+	{
+		bool bFormatSet = false;
+		Format format = Format::kBC7;
+		bool bRoleSet = false;
+		Role role = Role::kColour;
+		bool bMips = true;
+		bool bForce = false;
+	};
+
+	Role GuessRole( const std::filesystem::path& path )
+	{
+		std::string name = path.stem().string();
+		std::transform( name.begin(), name.end(), name.begin(), []( unsigned char c ) { return static_cast< char >(std::tolower( c )); } );
+		if ( name.find( "normal" ) != std::string::npos ) return Role::kNormal;
+		for ( const char* pData : { "orm", "roughness", "metal", "occlusion", "mask" } )
+		{
+			if ( name.find( pData ) != std::string::npos ) return Role::kData;
+		}
+		return Role::kColour;
+	}
+
+	struct CookStats
+	{
+		uint32_t cooked = 0;
+		uint32_t skipped = 0;
+		uint32_t failed = 0;
+		uint64_t pngBytes = 0;
+		uint64_t rgbaBytes = 0; // RGBA8 with runtime mips, as uploaded from a png
+		uint64_t ddsBytes = 0;
+	};
+
+	void Cook( const std::filesystem::path& source, const Options& options, CookStats& stats )
+	{
+		std::filesystem::path target = source;
+		target.replace_extension( ".dds" );
+		std::error_code error;
+		if ( !options.bForce && std::filesystem::exists( target, error )
+			&& std::filesystem::last_write_time( target, error ) >= std::filesystem::last_write_time( source, error ) )
+		{
+			stats.skipped++;
+			return;
+		}
+
+		Image image;
+		if ( !LoadPng( source, image ) )
+		{
+			stats.failed++;
+			return;
+		}
+
+		// D3D11 wants the top level of a block compressed texture in whole blocks, these stay png.
+		if ( image.width % 4 || image.height % 4 )
+		{
+			std::fprintf( stderr, "%s: %ux%u is not a multiple of 4, left as png\n", source.string().c_str(), image.width, image.height );
+			stats.failed++;
+			return;
+		}
+
+		const Role role = options.bRoleSet ? options.role : GuessRole( source );
+		Format format = options.format;
+		if ( !options.bFormatSet ) format = role == Role::kNormal ? Format::kBC5 : Format::kBC7;
+
+		std::vector< uint8_t > data;
+		uint32_t mipCount = 0;
+		uint32_t topLevelBytes = 0;
+		for ( Image level = image;; level = Downsample( level, role ) )
+		{
+			EncodeLevel( level, format, data );
+			if ( mipCount++ == 0 ) topLevelBytes = static_cast< uint32_t >(data.size());
+			if ( !options.bMips || ( level.width == 1 && level.height == 1 ) ) break;
+		}
+
+		if ( !WriteDds( target, image.width, image.height, mipCount, DxgiFormat( format, role == Role::kColour ), topLevelBytes, data ) )
+		{
+			std::fprintf( stderr, "%s: unable to write\n", target.string().c_str() );
+			stats.failed++;
+			return;
+		}
+
+		static const char* kFormatNames[] = { "BC1", "BC3", "BC5", "BC7" };
+		static const char* kRoleNames[] = { "colour", "normal", "data" };
+		const uint64_t rgbaBytes = static_cast< uint64_t >(image.width) * image.height * 4 * 4 / 3;
+		std::printf( "%s: %ux%u %s %s, %u mips, %llu KB (RGBA8 %llu KB)\n", target.string().c_str(), image.width, image.height,
+			kFormatNames[ static_cast< int >(format) ], kRoleNames[ static_cast< int >(role) ], mipCount,
+			static_cast< unsigned long long >(data.size() / 1024), static_cast< unsigned long long >(rgbaBytes / 1024) );
+
+		stats.cooked++;
+		stats.pngBytes += std::filesystem::file_size( source, error );
+		stats.rgbaBytes += rgbaBytes;
+		stats.ddsBytes += data.size();
+	}
+
+	bool ParseFormat( const char* pName, Format& format )
+	{
+		static const char* kNames[] = { "bc1", "bc3", "bc5", "bc7" };
+		for ( int i = 0; i < 4; i++ )
+		{
+			if ( std::strcmp( pName, kNames[ i ] ) == 0 ) { format = static_cast< Format >(i); return true; }
+		}
+		return false;
+	}
+
+	bool ParseRole( const char* pName, Role& role )
+	{
+		static const char* kNames[] = { "colour", "normal", "data" };
+		for ( int i = 0; i < 3; i++ )
+		{
+			if ( std::strcmp( pName, kNames[ i ] ) == 0 ) { role = static_cast< Role >(i); return true; }
+		}
+		return false;
+	}
+}
+
+int main( int argc, char** argv )
+{
+	Options options;
+	std::vector< std::filesystem::path > inputs;
+	bool bBadOption = false;
+	for ( int i = 1; i < argc; i++ )
+	{
+		if ( std::strcmp( argv[ i ], "--format" ) == 0 && i + 1 < argc && ParseFormat( argv[ i + 1 ], options.format ) ) { options.bFormatSet = true; i++; }
+		else if ( std::strcmp( argv[ i ], "--role" ) == 0 && i + 1 < argc && ParseRole( argv[ i + 1 ], options.role ) ) { options.bRoleSet = true; i++; }
+		else if ( std::strcmp( argv[ i ], "--no-mips" ) == 0 ) options.bMips = false;
+		else if ( std::strcmp( argv[ i ], "--force" ) == 0 ) options.bForce = true;
+		else if ( argv[ i ][ 0 ] == '-' ) bBadOption = true;
+		else inputs.emplace_back( argv[ i ] );
+	}
+
+	if ( inputs.empty() || bBadOption )
+	{
+		std::fprintf( stderr, "Usage: TextureCooker [--format bc1|bc3|bc5|bc7] [--role colour|normal|data] [--no-mips] [--force] <file.png | directory>...\n" );
+		return 1;
+	}
+
+	CookStats stats;
+	for ( const std::filesystem::path& input : inputs )
+	{
+		if ( std::filesystem::is_directory( input ) )
+		{
+			std::vector< std::filesystem::path > files;
+			for ( const auto& entry : std::filesystem::recursive_directory_iterator( input ) )
+			{
+				if ( entry.is_regular_file() && entry.path().extension() == ".png" ) files.push_back( entry.path() );
+			}
+			std::sort( files.begin(), files.end() );
+			for ( const std::filesystem::path& file : files ) Cook( file, options, stats );
+		}
+		else
+		{
+			Cook( input, options, stats );
+		}
+	}
+
+	std::printf( "%u cooked, %u up to date, %u failed. png %llu KB, as RGBA8 with mips %llu KB, dds %llu KB\n", stats.cooked, stats.skipped, stats.failed,
+		static_cast< unsigned long long >(stats.pngBytes / 1024), static_cast< unsigned long long >(stats.rgbaBytes / 1024),
+		static_cast< unsigned long long >(stats.ddsBytes / 1024) );
+	return stats.failed ? 2 : 0;
+}